@@ -33,12 +33,20 @@
 #include <inviwo/core/util/stdextensions.h>
 #include <inviwo/core/util/glm.h>
 
+#include <atomic>
 #include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace inviwo {
 
 /**
  * \ingroup datastructures
+ * Copies of a Buffer share the data of their BufferRAMPrecision until
+ * Buffer::getEditableRepresentation or a non-const accessor of the whole container, like
+ * getDataContainer() or add(), is called on one of them, see VolumeRAMPrecision. The single
+ * element accessors, like operator[] and setFromDouble(), require that write access was granted.
  */
 template <typename T, BufferTarget Target = BufferTarget::Data>
 class BufferRAMPrecision : public BufferRAM {
@@ -49,10 +57,11 @@ public:
     explicit BufferRAMPrecision(BufferUsage usage = BufferUsage::Static);
     explicit BufferRAMPrecision(size_t size, BufferUsage usage = BufferUsage::Static);
     explicit BufferRAMPrecision(std::vector<T> data, BufferUsage usage = BufferUsage::Static);
-    BufferRAMPrecision(const BufferRAMPrecision<T, Target>& rhs) = default;
-    BufferRAMPrecision<T, Target>& operator=(const BufferRAMPrecision<T, Target>& that) = default;
+    BufferRAMPrecision(const BufferRAMPrecision<T, Target>& rhs);
+    BufferRAMPrecision<T, Target>& operator=(const BufferRAMPrecision<T, Target>& that);
     virtual ~BufferRAMPrecision() = default;
     virtual BufferRAMPrecision<T, Target>* clone() const override;
+    virtual BufferRAMPrecision<T, Target>* cloneShared() const override;
 
     virtual void setSize(size_t size) override;
     virtual size_t getSize() const override;
@@ -98,8 +107,26 @@ public:
 
     virtual void clear() override;
 
+    /**
+     * Returns true if the buffer shares its data with copies of the buffer, i.e. the next
+     * modification will copy the data.
+     */
+    bool isShared() const;
+
+    /**
+     * Copy shared data into memory owned only by this buffer. Called before any write access,
+     * safe to call concurrently. References and pointers returned by the non-const accessors are
+     * invalid after the buffer has been copied, write access has to be requested again.
+     */
+    virtual void detach() override;
+
 private:
-    std::vector<T> data_;
+    struct ShareData {};
+    BufferRAMPrecision(const BufferRAMPrecision<T, Target>& rhs, ShareData);
+
+    std::shared_ptr<std::vector<T>> data_;
+    mutable std::atomic<bool> exclusive_{false};  //< data not shared since the last detach
+    mutable std::mutex mutex_;
 };
 
 using FloatBufferRAM = BufferRAMPrecision<float>;
@@ -111,12 +138,12 @@ using IndexBufferRAM = BufferRAMPrecision<std::uint32_t, BufferTarget::Index>;
 
 template <typename T, BufferTarget Target>
 const T& inviwo::BufferRAMPrecision<T, Target>::operator[](size_t i) const {
-    return data_[i];
+    return (*data_)[i];
 }
 
 template <typename T, BufferTarget Target>
 T& inviwo::BufferRAMPrecision<T, Target>::operator[](size_t i) {
-    return data_[i];
+    return getDataContainer()[i];
 }
 
 template <typename T, BufferTarget Target>
@@ -125,172 +152,226 @@ BufferRAMPrecision<T, Target>::BufferRAMPrecision(BufferUsage usage)
 
 template <typename T, BufferTarget Target>
 BufferRAMPrecision<T, Target>::BufferRAMPrecision(size_t size, BufferUsage usage)
-    : BufferRAM(DataFormat<T>::get(), usage, Target), data_(size) {}
+    : BufferRAM(DataFormat<T>::get(), usage, Target)
+    , data_(std::make_shared<std::vector<T>>(size)) {}
 
 template <typename T, BufferTarget Target>
 inviwo::BufferRAMPrecision<T, Target>::BufferRAMPrecision(std::vector<T> data, BufferUsage usage)
-    : BufferRAM(DataFormat<T>::get(), usage, Target), data_(std::move(data)) {}
+    : BufferRAM(DataFormat<T>::get(), usage, Target)
+    , data_(std::make_shared<std::vector<T>>(std::move(data))) {}
+
+template <typename T, BufferTarget Target>
+BufferRAMPrecision<T, Target>::BufferRAMPrecision(const BufferRAMPrecision<T, Target>& rhs)
+    : BufferRAM(rhs), data_(std::make_shared<std::vector<T>>(*rhs.data_)) {}
+
+template <typename T, BufferTarget Target>
+BufferRAMPrecision<T, Target>::BufferRAMPrecision(const BufferRAMPrecision<T, Target>& rhs,
+                                                  ShareData)
+    : BufferRAM(rhs), data_(rhs.data_) {}
+
+template <typename T, BufferTarget Target>
+BufferRAMPrecision<T, Target>& BufferRAMPrecision<T, Target>::operator=(
+    const BufferRAMPrecision<T, Target>& that) {
+    if (this != &that) {
+        BufferRAM::operator=(that);
+        data_ = std::make_shared<std::vector<T>>(*that.data_);
+    }
+    return *this;
+}
 
 template <typename T, BufferTarget Target>
 BufferRAMPrecision<T, Target>* BufferRAMPrecision<T, Target>::clone() const {
     return new BufferRAMPrecision<T, Target>(*this);
 }
 
+template <typename T, BufferTarget Target>
+BufferRAMPrecision<T, Target>* BufferRAMPrecision<T, Target>::cloneShared() const {
+    std::scoped_lock lock{mutex_};
+    // both buffers copy the data on their next write
+    exclusive_.store(false, std::memory_order_release);
+    return new BufferRAMPrecision<T, Target>(*this, ShareData{});
+}
+
 template <typename T, BufferTarget Target>
 void BufferRAMPrecision<T, Target>::setSize(size_t size) {
-    return data_.resize(size);
+    return getDataContainer().resize(size);
 }
 
 template <typename T, BufferTarget Target>
 size_t BufferRAMPrecision<T, Target>::getSize() const {
-    return data_.size();
+    return data_->size();
 }
 
 template <typename T, BufferTarget Target>
 void* BufferRAMPrecision<T, Target>::getData() {
-    return (data_.empty() ? nullptr : data_.data());
+    auto& data = getDataContainer();
+    return (data.empty() ? nullptr : data.data());
 }
 
 template <typename T, BufferTarget Target>
 const void* BufferRAMPrecision<T, Target>::getData() const {
-    return (data_.empty() ? nullptr : data_.data());
+    return (data_->empty() ? nullptr : data_->data());
 }
 
 template <typename T, BufferTarget Target>
 std::vector<T>& inviwo::BufferRAMPrecision<T, Target>::getDataContainer() {
-    return data_;
+    detach();
+    return *data_;
 }
 
 template <typename T, BufferTarget Target>
 const std::vector<T>& BufferRAMPrecision<T, Target>::getDataContainer() const {
-    return data_;
+    return *data_;
 }
 
 template <typename T, BufferTarget Target>
 void BufferRAMPrecision<T, Target>::reserve(size_t size) {
-    data_.reserve(size);
+    getDataContainer().reserve(size);
 }
 
 template <typename T, BufferTarget Target>
 double BufferRAMPrecision<T, Target>::getAsDouble(const size_t& pos) const {
-    return util::glm_convert<double>(data_[pos]);
+    return util::glm_convert<double>((*data_)[pos]);
 }
 
 template <typename T, BufferTarget Target>
 dvec2 BufferRAMPrecision<T, Target>::getAsDVec2(const size_t& pos) const {
-    return util::glm_convert<dvec2>(data_[pos]);
+    return util::glm_convert<dvec2>((*data_)[pos]);
 }
 
 template <typename T, BufferTarget Target>
 dvec3 BufferRAMPrecision<T, Target>::getAsDVec3(const size_t& pos) const {
-    return util::glm_convert<dvec3>(data_[pos]);
+    return util::glm_convert<dvec3>((*data_)[pos]);
 }
 
 template <typename T, BufferTarget Target>
 dvec4 BufferRAMPrecision<T, Target>::getAsDVec4(const size_t& pos) const {
-    return util::glm_convert<dvec4>(data_[pos]);
+    return util::glm_convert<dvec4>((*data_)[pos]);
 }
 
 template <typename T, BufferTarget Target>
 void BufferRAMPrecision<T, Target>::setFromDouble(const size_t& pos, double val) {
-    data_[pos] = util::glm_convert<T>(val);
+    getDataContainer()[pos] = util::glm_convert<T>(val);
 }
 
 template <typename T, BufferTarget Target>
 void BufferRAMPrecision<T, Target>::setFromDVec2(const size_t& pos, dvec2 val) {
-    data_[pos] = util::glm_convert<T>(val);
+    getDataContainer()[pos] = util::glm_convert<T>(val);
 }
 
 template <typename T, BufferTarget Target>
 void BufferRAMPrecision<T, Target>::setFromDVec3(const size_t& pos, dvec3 val) {
-    data_[pos] = util::glm_convert<T>(val);
+    getDataContainer()[pos] = util::glm_convert<T>(val);
 }
 
 template <typename T, BufferTarget Target>
 void BufferRAMPrecision<T, Target>::setFromDVec4(const size_t& pos, dvec4 val) {
-    data_[pos] = util::glm_convert<T>(val);
+    getDataContainer()[pos] = util::glm_convert<T>(val);
 }
 
 template <typename T, BufferTarget Target>
 double BufferRAMPrecision<T, Target>::getAsNormalizedDouble(const size_t& pos) const {
-    return util::glm_convert_normalized<double>(data_[pos]);
+    return util::glm_convert_normalized<double>((*data_)[pos]);
 }
 
 template <typename T, BufferTarget Target>
 dvec2 BufferRAMPrecision<T, Target>::getAsNormalizedDVec2(const size_t& pos) const {
-    return util::glm_convert_normalized<dvec2>(data_[pos]);
+    return util::glm_convert_normalized<dvec2>((*data_)[pos]);
 }
 
 template <typename T, BufferTarget Target>
 dvec3 BufferRAMPrecision<T, Target>::getAsNormalizedDVec3(const size_t& pos) const {
-    return util::glm_convert_normalized<dvec3>(data_[pos]);
+    return util::glm_convert_normalized<dvec3>((*data_)[pos]);
 }
 
 template <typename T, BufferTarget Target>
 dvec4 BufferRAMPrecision<T, Target>::getAsNormalizedDVec4(const size_t& pos) const {
-    return util::glm_convert_normalized<dvec4>(data_[pos]);
+    return util::glm_convert_normalized<dvec4>((*data_)[pos]);
 }
 
 template <typename T, BufferTarget Target>
 void BufferRAMPrecision<T, Target>::setFromNormalizedDouble(const size_t& pos, double val) {
-    data_[pos] = util::glm_convert_normalized<T>(val);
+    getDataContainer()[pos] = util::glm_convert_normalized<T>(val);
 }
 
 template <typename T, BufferTarget Target>
 void BufferRAMPrecision<T, Target>::setFromNormalizedDVec2(const size_t& pos, dvec2 val) {
-    data_[pos] = util::glm_convert_normalized<T>(val);
+    getDataContainer()[pos] = util::glm_convert_normalized<T>(val);
 }
 
 template <typename T, BufferTarget Target>
 void BufferRAMPrecision<T, Target>::setFromNormalizedDVec3(const size_t& pos, dvec3 val) {
-    data_[pos] = util::glm_convert_normalized<T>(val);
+    getDataContainer()[pos] = util::glm_convert_normalized<T>(val);
 }
 
 template <typename T, BufferTarget Target>
 void BufferRAMPrecision<T, Target>::setFromNormalizedDVec4(const size_t& pos, dvec4 val) {
-    data_[pos] = util::glm_convert_normalized<T>(val);
+    getDataContainer()[pos] = util::glm_convert_normalized<T>(val);
 }
 
 template <typename T, BufferTarget Target>
 void BufferRAMPrecision<T, Target>::add(const T& item) {
-    data_.push_back(item);
+    getDataContainer().push_back(item);
 }
 
 template <typename T, BufferTarget Target>
 void BufferRAMPrecision<T, Target>::add(std::initializer_list<T> data) {
+    auto& container = getDataContainer();
     for (auto& elem : data) {
-        data_.push_back(elem);
+        container.push_back(elem);
     }
 }
 
 template <typename T, BufferTarget Target>
 void BufferRAMPrecision<T, Target>::append(const std::vector<T>* data) {
-    data_.insert(data_.end(), data->begin(), data->end());
+    auto& container = getDataContainer();
+    container.insert(container.end(), data->begin(), data->end());
 }
 
 template <typename T, BufferTarget Target>
 void BufferRAMPrecision<T, Target>::append(const std::vector<T>& data) {
-    data_.insert(data_.end(), data.begin(), data.end());
+    auto& container = getDataContainer();
+    container.insert(container.end(), data.begin(), data.end());
 }
 
 template <typename T, BufferTarget Target>
 void BufferRAMPrecision<T, Target>::set(size_t index, const T& item) {
-    data_[index] = item;
+    getDataContainer()[index] = item;
 }
 
 template <typename T, BufferTarget Target>
 T BufferRAMPrecision<T, Target>::get(size_t index) const {
-    return data_[index];
+    return (*data_)[index];
 }
 
 template <typename T, BufferTarget Target>
 T& BufferRAMPrecision<T, Target>::get(size_t index) {
-    return data_[index];
+    return getDataContainer()[index];
 }
 
 template <typename T, BufferTarget Target>
 void BufferRAMPrecision<T, Target>::clear() {
-    data_.clear();
+    std::scoped_lock lock{mutex_};
+    if (isShared()) {
+        data_ = std::make_shared<std::vector<T>>();
+    } else {
+        data_->clear();
+    }
+}
+
+template <typename T, BufferTarget Target>
+bool BufferRAMPrecision<T, Target>::isShared() const {
+    return data_.use_count() > 1;
+}
+
+template <typename T, BufferTarget Target>
+void BufferRAMPrecision<T, Target>::detach() {
+    // exclusive_ is cleared whenever the data is shared, see cloneShared
+    if (exclusive_.load(std::memory_order_acquire)) return;
+
+    std::scoped_lock lock{mutex_};
+    if (isShared()) data_ = std::make_shared<std::vector<T>>(*data_);
+    exclusive_.store(true, std::memory_order_release);
 }
 
 }  // namespace inviwo
@@ -246,9 +246,10 @@ const T* Data<Self, Repr>::getValidRepresentation() const {
 template <typename Self, typename Repr>
 template <typename T>
 T* Data<Self, Repr>::getEditableRepresentation() {
-    auto repr = getRepresentation<T>();
+    auto repr = const_cast<T*>(getRepresentation<T>());
     invalidateAllOther(repr);
-    return const_cast<T*>(repr);
+    repr->detach();
+    return repr;
 }
 
 template <typename Self, typename Repr>
@@ -285,7 +286,8 @@ void Data<Self, Repr>::copyRepresentationsTo(Data<Self, Repr>* targetData) const
     targetData->clearRepresentations();
 
     if (lastValidRepresentation_) {
-        auto rep = std::shared_ptr<Repr>(lastValidRepresentation_->clone());
+        auto rep =
+            std::shared_ptr<Repr>(static_cast<Repr*>(lastValidRepresentation_->cloneShared()));
         targetData->addRepresentation(rep);
     }
 }
@@ -54,6 +54,19 @@ public:
     virtual DataRepresentation* clone() const = 0;
     virtual ~DataRepresentation() = default;
 
+    /**
+     * Copy made when the owning Data object is copied. Representations with copy-on-write storage
+     * share their data with the copy until detach() is called on either. Defaults to clone().
+     */
+    virtual DataRepresentation* cloneShared() const { return clone(); }
+
+    /**
+     * Called by Data::getEditableRepresentation before write access is granted. Representations
+     * sharing their data with copies make a private copy here. Pointers to the data obtained for
+     * writing are invalid after the representation has been copied.
+     */
+    virtual void detach() {}
+
     const DataFormatBase* getDataFormat() const;
     std::string getDataFormatString() const;
     DataFormatId getDataFormatId() const;
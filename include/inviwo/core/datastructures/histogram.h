@@ -31,8 +31,14 @@
 
 #include <inviwo/core/common/inviwocoredefine.h>
 #include <inviwo/core/util/glm.h>
+#include <inviwo/core/util/parallelfor.h>
 
+#include <algorithm>
+#include <array>
+#include <functional>
 #include <iterator>
+#include <limits>
+#include <type_traits>
 #include <vector>
 
 namespace inviwo {
@@ -111,39 +117,81 @@ HistogramContainer::HistogramContainer(dvec2 dataRange, size_t bins, FirstIter b
         bins = std::min(bins, static_cast<std::size_t>(dataRange.y - dataRange.x + 1));
     }
 
-    std::array<std::vector<double>, extent> histData;
-    for (size_t i = 0; i < extent; ++i) {
-        histData[i].resize(bins, 0.0);
-    }
-
-    D min(std::numeric_limits<double>::max());
-    D max(std::numeric_limits<double>::lowest());
-    D sum(0);
-    D sum2(0);
-    size_t count(0);
+    struct Partial {
+        std::array<std::vector<size_t>, extent> counts;
+        D min{std::numeric_limits<double>::max()};
+        D max{std::numeric_limits<double>::lowest()};
+        D sum{0};
+        D sum2{0};
+        size_t count{0};
+    };
 
     const D rangeMin(dataRange.x);
     const D rangeScaleFactor(static_cast<double>(bins - 1) / (dataRange.y - dataRange.x));
 
-    for (; begin != end; ++begin) {
-
-        const auto val = static_cast<D>(*begin);
-
-        min = glm::min(min, val);
-        max = glm::max(max, val);
-        sum += val;
-        sum2 += val * val;
-        count++;
-
-        const auto ind = static_cast<I>((val - rangeMin) * rangeScaleFactor);
-
+    const auto accumulate = [&](auto first, auto last) {
+        Partial p;
         for (size_t i = 0; i < extent; ++i) {
-            const auto v = util::glmcomp(ind, i);
-            if (v < bins) {
-                histData[i][v]++;
+            p.counts[i].resize(bins, 0);
+        }
+        for (; first != last; ++first) {
+            const auto val = static_cast<D>(*first);
+
+            p.min = glm::min(p.min, val);
+            p.max = glm::max(p.max, val);
+            p.sum += val;
+            p.sum2 += val * val;
+            p.count++;
+
+            const auto ind = static_cast<I>((val - rangeMin) * rangeScaleFactor);
+
+            for (size_t i = 0; i < extent; ++i) {
+                const auto v = util::glmcomp(ind, i);
+                if (v < bins) {
+                    p.counts[i][v]++;
+                }
             }
         }
+        return p;
+    };
+
+    Partial total;
+    if constexpr (std::is_same_v<FirstIter, LastIter> &&
+                  std::is_base_of_v<std::random_access_iterator_tag,
+                                    typename std::iterator_traits<FirstIter>::iterator_category>) {
+        // Split large ranges into blocks with their own counts, and merge those at the end
+        const auto merge = [](Partial a, const Partial& b) {
+            if (b.count == 0) return a;
+            if (a.count == 0) return b;
+            for (size_t i = 0; i < extent; ++i) {
+                std::transform(a.counts[i].begin(), a.counts[i].end(), b.counts[i].begin(),
+                               a.counts[i].begin(), std::plus<>{});
+            }
+            a.min = glm::min(a.min, b.min);
+            a.max = glm::max(a.max, b.max);
+            a.sum += b.sum;
+            a.sum2 += b.sum2;
+            a.count += b.count;
+            return a;
+        };
+        total = util::parallelReduce(
+            static_cast<size_t>(std::distance(begin, end)), Partial{},
+            [&](size_t first, size_t last) { return accumulate(begin + first, begin + last); },
+            merge, 64 * 1024);
+    } else {
+        total = accumulate(begin, end);
+    }
+
+    std::array<std::vector<double>, extent> histData;
+    for (size_t i = 0; i < extent; ++i) {
+        histData[i].resize(bins, 0.0);
+        std::copy(total.counts[i].begin(), total.counts[i].end(), histData[i].begin());
     }
+    const D min = total.min;
+    const D max = total.max;
+    const D sum = total.sum;
+    const D sum2 = total.sum2;
+    const size_t count = total.count;
 
     const auto dcount = static_cast<double>(count);
     const auto mean = sum / dcount;
@@ -32,11 +32,18 @@
 #include <inviwo/core/datastructures/image/layerram.h>
 
 #include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <mutex>
 
 namespace inviwo {
 
 /**
  * \ingroup datastructures
+ * Copies of a Layer share the pixel data of their LayerRAMPrecision until
+ * Layer::getEditableRepresentation or the non-const getData()/getDataTyped() is called on one of
+ * them, see VolumeRAMPrecision. The single element setters require that write access was granted.
  */
 template <typename T>
 class LayerRAMPrecision : public LayerRAM {
@@ -52,9 +59,20 @@ public:
                       const SwizzleMask& swizzleMask = swizzlemasks::rgba,
                       InterpolationType interpolation = InterpolationType::Linear,
                       const Wrapping2D& wrap = wrapping2d::clampAll);
+    /**
+     * Create a layer that reads its values from \p data, kept alive by \p owner, for example a
+     * NumPy array. The data is copied into memory owned by the layer only when it is accessed
+     * for writing.
+     */
+    LayerRAMPrecision(std::shared_ptr<const void> owner, const T* data, size2_t dimensions,
+                      LayerType type = LayerType::Color,
+                      const SwizzleMask& swizzleMask = swizzlemasks::rgba,
+                      InterpolationType interpolation = InterpolationType::Linear,
+                      const Wrapping2D& wrap = wrapping2d::clampAll);
     LayerRAMPrecision(const LayerRAMPrecision<T>& rhs);
     LayerRAMPrecision<T>& operator=(const LayerRAMPrecision<T>& that);
     virtual LayerRAMPrecision<T>* clone() const override;
+    virtual LayerRAMPrecision<T>* cloneShared() const override;
     virtual ~LayerRAMPrecision() = default;
 
     T* getDataTyped();
@@ -100,12 +118,32 @@ public:
     virtual void setFromNormalizedDVec3(const size2_t& pos, dvec3 val) override;
     virtual void setFromNormalizedDVec4(const size2_t& pos, dvec4 val) override;
 
+    /**
+     * Returns true if the layer shares its data with copies of the layer or reads it from
+     * memory owned by someone else, i.e. the next modification will copy the data.
+     */
+    bool isShared() const;
+
+    /**
+     * Copy shared data into memory owned only by this layer. Called before any write access,
+     * safe to call concurrently. Pointers returned by the non-const getDataTyped() are invalid
+     * after the layer has been copied, write access has to be requested again.
+     */
+    virtual void detach() override;
+
 private:
+    struct ShareData {};
+    LayerRAMPrecision(const LayerRAMPrecision<T>& rhs, ShareData);
+
     size2_t dimensions_;
-    std::unique_ptr<T[]> data_;
+    std::shared_ptr<T[]> data_;
+    std::shared_ptr<const void> sharedOwner_;
+    const T* sharedData_ = nullptr;
     SwizzleMask swizzleMask_;
     InterpolationType interpolation_;
     Wrapping2D wrapping_;
+    mutable std::atomic<bool> exclusive_{false};  //< data not shared since the last detach
+    mutable std::mutex mutex_;
 };
 
 /**
@@ -156,6 +194,20 @@ LayerRAMPrecision<T>::LayerRAMPrecision(T* data, size2_t dimensions, LayerType t
     }
 }
 
+template <typename T>
+LayerRAMPrecision<T>::LayerRAMPrecision(std::shared_ptr<const void> owner, const T* data,
+                                        size2_t dimensions, LayerType type,
+                                        const SwizzleMask& swizzleMask,
+                                        InterpolationType interpolation, const Wrapping2D& wrapping)
+    : LayerRAM(type, DataFormat<T>::get())
+    , dimensions_(dimensions)
+    , data_()
+    , sharedOwner_(std::move(owner))
+    , sharedData_(data)
+    , swizzleMask_(swizzleMask)
+    , interpolation_{interpolation}
+    , wrapping_{wrapping} {}
+
 template <typename T>
 LayerRAMPrecision<T>::LayerRAMPrecision(const LayerRAMPrecision<T>& rhs)
     : LayerRAM(rhs)
@@ -164,19 +216,31 @@ LayerRAMPrecision<T>::LayerRAMPrecision(const LayerRAMPrecision<T>& rhs)
     , swizzleMask_(rhs.swizzleMask_)
     , interpolation_{rhs.interpolation_}
     , wrapping_{rhs.wrapping_} {
-    std::memcpy(data_.get(), rhs.data_.get(), dimensions_.x * dimensions_.y * sizeof(T));
+    std::memcpy(data_.get(), rhs.getDataTyped(), dimensions_.x * dimensions_.y * sizeof(T));
 }
 
+template <typename T>
+LayerRAMPrecision<T>::LayerRAMPrecision(const LayerRAMPrecision<T>& rhs, ShareData)
+    : LayerRAM(rhs)
+    , dimensions_(rhs.dimensions_)
+    , data_(rhs.data_)
+    , sharedOwner_(rhs.sharedOwner_)
+    , sharedData_(rhs.sharedData_)
+    , swizzleMask_(rhs.swizzleMask_)
+    , interpolation_{rhs.interpolation_}
+    , wrapping_{rhs.wrapping_} {}
+
 template <typename T>
 LayerRAMPrecision<T>& LayerRAMPrecision<T>::operator=(const LayerRAMPrecision<T>& that) {
     if (this != &that) {
         LayerRAM::operator=(that);
 
-        const auto dim = that.dimensions_;
-        auto data = std::make_unique<T[]>(dim.x * dim.y);
-        std::memcpy(data.get(), that.data_.get(), dim.x * dim.y * sizeof(T));
-        data_.swap(data);
-
+        const auto size = that.dimensions_.x * that.dimensions_.y;
+        std::shared_ptr<T[]> data(new T[size]);
+        std::memcpy(data.get(), that.getDataTyped(), size * sizeof(T));
+        data_ = std::move(data);
+        sharedOwner_.reset();
+        sharedData_ = nullptr;
         dimensions_ = that.dimensions_;
         swizzleMask_ = that.swizzleMask_;
         interpolation_ = that.interpolation_;
@@ -190,39 +254,74 @@ LayerRAMPrecision<T>* LayerRAMPrecision<T>::clone() const {
     return new LayerRAMPrecision<T>(*this);
 }
 
+template <typename T>
+LayerRAMPrecision<T>* LayerRAMPrecision<T>::cloneShared() const {
+    std::scoped_lock lock{mutex_};
+    // both layers copy the data on their next write
+    exclusive_.store(false, std::memory_order_release);
+    return new LayerRAMPrecision<T>(*this, ShareData{});
+}
+
 template <typename T>
 T* inviwo::LayerRAMPrecision<T>::getDataTyped() {
+    detach();
     return data_.get();
 }
 
 template <typename T>
 const T* inviwo::LayerRAMPrecision<T>::getDataTyped() const {
-    return data_.get();
+    return sharedData_ ? sharedData_ : data_.get();
 }
 
 template <typename T>
 void* LayerRAMPrecision<T>::getData() {
-    return data_.get();
+    return getDataTyped();
 }
 template <typename T>
 const void* LayerRAMPrecision<T>::getData() const {
-    return const_cast<const T*>(data_.get());
+    return getDataTyped();
 }
 
 template <typename T>
 void inviwo::LayerRAMPrecision<T>::setData(void* d, size2_t dimensions) {
-    std::unique_ptr<T[]> data(static_cast<T*>(d));
-    data_.swap(data);
-    std::swap(dimensions_, dimensions);
+    std::scoped_lock lock{mutex_};
+    data_ = std::shared_ptr<T[]>(static_cast<T*>(d));
+    dimensions_ = dimensions;
+    sharedOwner_.reset();
+    sharedData_ = nullptr;
 }
 
 template <typename T>
 void LayerRAMPrecision<T>::setDimensions(size2_t dimensions) {
     if (dimensions != dimensions_) {
-        auto data = std::make_unique<T[]>(dimensions.x * dimensions.y);
-        data_.swap(data);
-        std::swap(dimensions, dimensions_);
+        std::scoped_lock lock{mutex_};
+        data_ = std::shared_ptr<T[]>(new T[dimensions.x * dimensions.y]());
+        dimensions_ = dimensions;
+        sharedOwner_.reset();
+        sharedData_ = nullptr;
+    }
+}
+
+template <typename T>
+bool LayerRAMPrecision<T>::isShared() const {
+    return sharedData_ != nullptr || data_.use_count() > 1;
+}
+
+template <typename T>
+void LayerRAMPrecision<T>::detach() {
+    // exclusive_ is cleared whenever the data is shared, see cloneShared
+    if (exclusive_.load(std::memory_order_acquire)) return;
+
+    std::scoped_lock lock{mutex_};
+    if (isShared()) {
+        const auto size = dimensions_.x * dimensions_.y;
+        std::shared_ptr<T[]> data(new T[size]);
+        std::memcpy(data.get(), sharedData_ ? sharedData_ : data_.get(), size * sizeof(T));
+        data_ = std::move(data);
+        sharedOwner_.reset();
+        sharedData_ = nullptr;
     }
+    exclusive_.store(true, std::memory_order_release);
 }
 
 template <typename T>
@@ -262,82 +361,82 @@ Wrapping2D LayerRAMPrecision<T>::getWrapping() const {
 
 template <typename T>
 double LayerRAMPrecision<T>::getAsDouble(const size2_t& pos) const {
-    return util::glm_convert<double>(data_[posToIndex(pos, dimensions_)]);
+    return util::glm_convert<double>(getDataTyped()[posToIndex(pos, dimensions_)]);
 }
 
 template <typename T>
 dvec2 LayerRAMPrecision<T>::getAsDVec2(const size2_t& pos) const {
-    return util::glm_convert<dvec2>(data_[posToIndex(pos, dimensions_)]);
+    return util::glm_convert<dvec2>(getDataTyped()[posToIndex(pos, dimensions_)]);
 }
 
 template <typename T>
 dvec3 LayerRAMPrecision<T>::getAsDVec3(const size2_t& pos) const {
-    return util::glm_convert<dvec3>(data_[posToIndex(pos, dimensions_)]);
+    return util::glm_convert<dvec3>(getDataTyped()[posToIndex(pos, dimensions_)]);
 }
 
 template <typename T>
 dvec4 LayerRAMPrecision<T>::getAsDVec4(const size2_t& pos) const {
-    return util::glm_convert<dvec4>(data_[posToIndex(pos, dimensions_)]);
+    return util::glm_convert<dvec4>(getDataTyped()[posToIndex(pos, dimensions_)]);
 }
 
 template <typename T>
 void LayerRAMPrecision<T>::setFromDouble(const size2_t& pos, double val) {
-    data_[posToIndex(pos, dimensions_)] = util::glm_convert<T>(val);
+    getDataTyped()[posToIndex(pos, dimensions_)] = util::glm_convert<T>(val);
 }
 
 template <typename T>
 void LayerRAMPrecision<T>::setFromDVec2(const size2_t& pos, dvec2 val) {
-    data_[posToIndex(pos, dimensions_)] = util::glm_convert<T>(val);
+    getDataTyped()[posToIndex(pos, dimensions_)] = util::glm_convert<T>(val);
 }
 
 template <typename T>
 void LayerRAMPrecision<T>::setFromDVec3(const size2_t& pos, dvec3 val) {
-    data_[posToIndex(pos, dimensions_)] = util::glm_convert<T>(val);
+    getDataTyped()[posToIndex(pos, dimensions_)] = util::glm_convert<T>(val);
 }
 
 template <typename T>
 void LayerRAMPrecision<T>::setFromDVec4(const size2_t& pos, dvec4 val) {
-    data_[posToIndex(pos, dimensions_)] = util::glm_convert<T>(val);
+    getDataTyped()[posToIndex(pos, dimensions_)] = util::glm_convert<T>(val);
 }
 
 template <typename T>
 double LayerRAMPrecision<T>::getAsNormalizedDouble(const size2_t& pos) const {
-    return util::glm_convert_normalized<double>(data_[posToIndex(pos, dimensions_)]);
+    return util::glm_convert_normalized<double>(getDataTyped()[posToIndex(pos, dimensions_)]);
 }
 
 template <typename T>
 dvec2 LayerRAMPrecision<T>::getAsNormalizedDVec2(const size2_t& pos) const {
-    return util::glm_convert_normalized<dvec2>(data_[posToIndex(pos, dimensions_)]);
+    return util::glm_convert_normalized<dvec2>(getDataTyped()[posToIndex(pos, dimensions_)]);
 }
 
 template <typename T>
 dvec3 LayerRAMPrecision<T>::getAsNormalizedDVec3(const size2_t& pos) const {
-    return util::glm_convert_normalized<dvec3>(data_[posToIndex(pos, dimensions_)]);
+    return util::glm_convert_normalized<dvec3>(getDataTyped()[posToIndex(pos, dimensions_)]);
 }
 
 template <typename T>
 dvec4 LayerRAMPrecision<T>::getAsNormalizedDVec4(const size2_t& pos) const {
-    return util::glm_convert_normalized<dvec4>(data_[posToIndex(pos, dimensions_)]);
+    return util::glm_convert_normalized<dvec4>(getDataTyped()[posToIndex(pos, dimensions_)]);
 }
 
 template <typename T>
 void LayerRAMPrecision<T>::setFromNormalizedDouble(const size2_t& pos, double val) {
-    data_[posToIndex(pos, dimensions_)] = util::glm_convert_normalized<T>(val);
+    getDataTyped()[posToIndex(pos, dimensions_)] = util::glm_convert_normalized<T>(val);
 }
 
 template <typename T>
 void LayerRAMPrecision<T>::setFromNormalizedDVec2(const size2_t& pos, dvec2 val) {
-    data_[posToIndex(pos, dimensions_)] = util::glm_convert_normalized<T>(val);
+    getDataTyped()[posToIndex(pos, dimensions_)] = util::glm_convert_normalized<T>(val);
 }
 
 template <typename T>
 void LayerRAMPrecision<T>::setFromNormalizedDVec3(const size2_t& pos, dvec3 val) {
-    data_[posToIndex(pos, dimensions_)] = util::glm_convert_normalized<T>(val);
+    getDataTyped()[posToIndex(pos, dimensions_)] = util::glm_convert_normalized<T>(val);
 }
 
 template <typename T>
 void LayerRAMPrecision<T>::setFromNormalizedDVec4(const size2_t& pos, dvec4 val) {
-    data_[posToIndex(pos, dimensions_)] = util::glm_convert_normalized<T>(val);
+    getDataTyped()[posToIndex(pos, dimensions_)] = util::glm_convert_normalized<T>(val);
 }
 
 }  // namespace inviwo
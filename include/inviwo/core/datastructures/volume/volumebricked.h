@@ -0,0 +1,177 @@
+/*********************************************************************************
+ *
+ * Inviwo - Interactive Visualization Workshop
+ *
+ * Copyright (c) 2021 Inviwo Foundation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************************/
+
+#pragma once
+
+#include <inviwo/core/common/inviwocoredefine.h>
+#include <inviwo/core/datastructures/volume/volumerepresentation.h>
+#include <inviwo/core/datastructures/volume/volumeram.h>
+#include <inviwo/core/util/cloneableptr.h>
+
+#include <memory>
+
+namespace inviwo {
+
+class Volume;
+
+/**
+ * \ingroup datastructures
+ * Interface for loading a sub region of a volume, used by VolumeBricked to load one brick at a
+ * time. DiskRepresentationLoaders that can read parts of their source implement this interface
+ * as well, which lets a VolumeDisk be converted into a VolumeBricked without reading the whole
+ * file. \see RawVolumeRAMLoader
+ */
+class IVW_CORE_API VolumeBrickLoader {
+public:
+    virtual ~VolumeBrickLoader() = default;
+    virtual VolumeBrickLoader* clone() const = 0;
+
+    /**
+     * Read the voxels [offset, offset + extent) of the volume described by src into dest. dest
+     * has room for glm::compMul(extent) voxels of the format of src, stored x fastest then y
+     * and z.
+     */
+    virtual void loadBrick(const VolumeRepresentation& src, const size3_t& offset,
+                           const size3_t& extent, void* dest) const = 0;
+};
+
+/**
+ * \ingroup datastructures
+ * \brief A read-only volume representation that keeps the volume as fixed-size bricks.
+ *
+ * The volume is divided into bricks of getBrickSize() voxels, the bricks along the upper
+ * boundaries might be smaller. Bricks are only loaded, using a VolumeBrickLoader, when they are
+ * requested, and are then kept in a least recently used cache of getCacheCapacity() bytes.
+ * Consumers that only need parts of a volume, like a sampler or a sub set, can thereby work on
+ * volumes that are larger than the available memory. Every brick is a VolumeRAM of its own,
+ * util::BrickIterator can be used to address a region within it. Clones share the brick cache.
+ *
+ * All const member functions are thread safe.
+ *
+ * \see util::getBrickedRepresentation
+ */
+class IVW_CORE_API VolumeBricked : public VolumeRepresentation {
+public:
+    static constexpr size_t defaultBrickSize = 64;
+    static constexpr size_t defaultCacheCapacity = size_t{512} << 20;
+
+    struct Brick {
+        std::shared_ptr<const VolumeRAM> data;
+        size3_t offset;  //< position of the first voxel of the brick in the volume
+    };
+
+    VolumeBricked(std::unique_ptr<VolumeBrickLoader> loader, size3_t dimensions,
+                  const DataFormatBase* format, size3_t brickSize = size3_t(defaultBrickSize),
+                  const SwizzleMask& swizzleMask = swizzlemasks::rgba,
+                  InterpolationType interpolation = InterpolationType::Linear,
+                  const Wrapping3D& wrapping = wrapping3d::clampAll);
+    VolumeBricked(const VolumeBricked& rhs) = default;
+    VolumeBricked& operator=(const VolumeBricked& that) = default;
+    virtual VolumeBricked* clone() const override;
+    virtual ~VolumeBricked() = default;
+
+    virtual std::type_index getTypeIndex() const override final;
+
+    virtual void setDimensions(size3_t dimensions) override;
+    virtual const size3_t& getDimensions() const override;
+
+    virtual void setSwizzleMask(const SwizzleMask& mask) override;
+    virtual SwizzleMask getSwizzleMask() const override;
+
+    virtual void setInterpolation(InterpolationType interpolation) override;
+    virtual InterpolationType getInterpolation() const override;
+
+    virtual void setWrapping(const Wrapping3D& wrapping) override;
+    virtual Wrapping3D getWrapping() const override;
+
+    /**
+     * Replace the loader, this drops all cached bricks.
+     */
+    void setLoader(std::unique_ptr<VolumeBrickLoader> loader);
+
+    const size3_t& getBrickSize() const;
+    /**
+     * The number of bricks along each axis
+     */
+    size3_t getBrickCount() const;
+
+    /**
+     * Get the brick with the brick index \p brick, loading it if it is not in the cache.
+     * @throw RangeException if the index is outside of getBrickCount()
+     */
+    Brick getBrick(const size3_t& brick) const;
+    /**
+     * Get the brick that contains the voxel \p pos, loading it if it is not in the cache.
+     * @throw RangeException if pos is outside of the volume
+     */
+    Brick getBrickContaining(const size3_t& pos) const;
+
+    /**
+     * Copy the voxels [offset, offset + extent) into dest, which has room for
+     * glm::compMul(extent) voxels. Only the bricks overlapping the region are loaded.
+     * @throw RangeException if the region is not within the volume
+     */
+    void readRegion(const size3_t& offset, const size3_t& extent, void* dest) const;
+    /**
+     * Create a VolumeRAM of the voxels [offset, offset + extent), \see readRegion
+     */
+    std::shared_ptr<VolumeRAM> getSubVolume(const size3_t& offset, const size3_t& extent) const;
+
+    void setCacheCapacity(size_t bytes);
+    size_t getCacheCapacity() const;
+    /**
+     * The number of bytes of the bricks currently in the cache
+     */
+    size_t getCacheSize() const;
+
+private:
+    class Cache;
+
+    size3_t dimensions_;
+    size3_t brickSize_;
+    SwizzleMask swizzleMask_;
+    InterpolationType interpolation_;
+    Wrapping3D wrapping_;
+    util::cloneable_ptr<VolumeBrickLoader> loader_;
+    std::shared_ptr<Cache> cache_;
+};
+
+namespace util {
+
+/**
+ * Get a bricked representation of \p volume for consumers that only access parts of it. This
+ * is the case when the volume has not been loaded into RAM, and either already has a
+ * VolumeBricked or has a VolumeDisk with a loader that can load bricks. Otherwise nullptr is
+ * returned and the caller should use the VolumeRAM.
+ */
+IVW_CORE_API const VolumeBricked* getBrickedRepresentation(const Volume& volume);
+
+}  // namespace util
+
+}  // namespace inviwo
@@ -33,10 +33,19 @@
 #include <inviwo/core/util/glm.h>
 #include <inviwo/core/util/stdextensions.h>
 
+#include <atomic>
+#include <cstring>
+#include <mutex>
+
 namespace inviwo {
 
 /**
  * \ingroup datastructures
+ * Copies of a Volume share the voxel data of their VolumeRAMPrecision until
+ * Volume::getEditableRepresentation or the non-const getData()/getDataTyped() is called on one of
+ * them, which then makes a private copy. Once write access has been handed out that way, further
+ * copies of the representation copy the data directly, so pointers kept by the writer never reach
+ * a copy. The single element setters do not copy, they require that write access was granted.
  */
 template <typename T>
 class VolumeRAMPrecision : public VolumeRAM {
@@ -51,9 +60,19 @@ public:
                        const SwizzleMask& swizzleMask = swizzlemasks::rgba,
                        InterpolationType interpolation = InterpolationType::Linear,
                        const Wrapping3D& wrapping = wrapping3d::clampAll);
+    /**
+     * Create a volume that reads its values from \p data, kept alive by \p owner, for example a
+     * MemoryMappedFile. The data is copied into memory owned by the volume only when it is
+     * accessed for writing.
+     */
+    VolumeRAMPrecision(std::shared_ptr<const void> owner, const T* data, size3_t dimensions,
+                       const SwizzleMask& swizzleMask = swizzlemasks::rgba,
+                       InterpolationType interpolation = InterpolationType::Linear,
+                       const Wrapping3D& wrapping = wrapping3d::clampAll);
     VolumeRAMPrecision(const VolumeRAMPrecision<T>& rhs);
     VolumeRAMPrecision<T>& operator=(const VolumeRAMPrecision<T>& that);
     virtual VolumeRAMPrecision<T>* clone() const override;
+    virtual VolumeRAMPrecision<T>* cloneShared() const override;
     virtual ~VolumeRAMPrecision();
 
     T* getDataTyped();
@@ -108,13 +127,42 @@ public:
 
     virtual size_t getNumberOfBytes() const override;
 
+    /**
+     * Returns true if the volume reads its values from data shared with an owner or with copies
+     * of the volume, i.e. the next modification will copy the data.
+     */
+    bool isShared() const;
+
+    /**
+     * Copy shared data into memory owned only by this volume. Called before any write access,
+     * safe to call concurrently. Pointers returned by the non-const getDataTyped() are invalid
+     * after the volume has been copied, write access has to be requested again.
+     */
+    virtual void detach() override;
+
 private:
+    struct ShareData {};
+    VolumeRAMPrecision(const VolumeRAMPrecision<T>& rhs, ShareData);
+
+    /**
+     * Deletes the data unless the ownership has been removed, @see removeDataOwnership
+     */
+    struct Deleter {
+        void operator()(T* data) const {
+            if (owns) delete[] data;
+        }
+        bool owns = true;
+    };
+
     size3_t dimensions_;
-    bool ownsDataPtr_;
-    std::unique_ptr<T[]> data_;
+    std::shared_ptr<T[]> data_;
+    std::shared_ptr<const void> sharedOwner_;
+    const T* sharedData_ = nullptr;
     SwizzleMask swizzleMask_;
     InterpolationType interpolation_;
     Wrapping3D wrapping_;
+    mutable std::atomic<bool> exclusive_{false};  //< data not shared since the last detach
+    mutable std::mutex mutex_;
 };
 
 /**
@@ -135,14 +183,25 @@ IVW_CORE_API std::shared_ptr<VolumeRAM> createVolumeRAM(
     InterpolationType interpolation = InterpolationType::Linear,
     const Wrapping3D& wrapping = wrapping3d::clampAll);
 
+/**
+ * Factory for volumes reading their values from shared data.
+ * Creates an VolumeRAM with data type specified by format that uses \p data, kept alive by
+ * \p owner, until it is modified.
+ * @see VolumeRAMPrecision(std::shared_ptr<const void>, const T*, size3_t, ...)
+ */
+IVW_CORE_API std::shared_ptr<VolumeRAM> createVolumeRAM(
+    const size3_t& dimensions, const DataFormatBase* format, std::shared_ptr<const void> owner,
+    const void* data, const SwizzleMask& swizzleMask = swizzlemasks::rgba,
+    InterpolationType interpolation = InterpolationType::Linear,
+    const Wrapping3D& wrapping = wrapping3d::clampAll);
+
 template <typename T>
 VolumeRAMPrecision<T>::VolumeRAMPrecision(size3_t dimensions, const SwizzleMask& swizzleMask,
                                           InterpolationType interpolation,
                                           const Wrapping3D& wrapping)
     : VolumeRAM(DataFormat<T>::get())
     , dimensions_(dimensions)
-    , ownsDataPtr_(true)
-    , data_(new T[dimensions_.x * dimensions_.y * dimensions_.z]())
+    , data_(new T[dimensions_.x * dimensions_.y * dimensions_.z](), Deleter{})
     , swizzleMask_(swizzleMask)
     , interpolation_{interpolation}
     , wrapping_{wrapping} {}
@@ -154,8 +213,21 @@ VolumeRAMPrecision<T>::VolumeRAMPrecision(T* data, size3_t dimensions,
                                           const Wrapping3D& wrapping)
     : VolumeRAM(DataFormat<T>::get())
     , dimensions_(dimensions)
-    , ownsDataPtr_(true)
-    , data_(data ? data : new T[dimensions_.x * dimensions_.y * dimensions_.z]())
+    , data_(data ? data : new T[dimensions_.x * dimensions_.y * dimensions_.z](), Deleter{})
+    , swizzleMask_(swizzleMask)
+    , interpolation_{interpolation}
+    , wrapping_{wrapping} {}
+
+template <typename T>
+VolumeRAMPrecision<T>::VolumeRAMPrecision(std::shared_ptr<const void> owner, const T* data,
+                                          size3_t dimensions, const SwizzleMask& swizzleMask,
+                                          InterpolationType interpolation,
+                                          const Wrapping3D& wrapping)
+    : VolumeRAM(DataFormat<T>::get())
+    , dimensions_(dimensions)
+    , data_()
+    , sharedOwner_(std::move(owner))
+    , sharedData_(data)
     , swizzleMask_(swizzleMask)
     , interpolation_{interpolation}
     , wrapping_{wrapping} {}
@@ -164,25 +236,35 @@ template <typename T>
 VolumeRAMPrecision<T>::VolumeRAMPrecision(const VolumeRAMPrecision<T>& rhs)
     : VolumeRAM(rhs)
     , dimensions_(rhs.dimensions_)
-    , ownsDataPtr_(true)
-    , data_(new T[dimensions_.x * dimensions_.y * dimensions_.z])
+    , data_(new T[dimensions_.x * dimensions_.y * dimensions_.z], Deleter{})
     , swizzleMask_(rhs.swizzleMask_)
     , interpolation_{rhs.interpolation_}
     , wrapping_{rhs.wrapping_} {
-    std::memcpy(data_.get(), rhs.data_.get(),
-                dimensions_.x * dimensions_.y * dimensions_.z * sizeof(T));
+    std::memcpy(data_.get(), rhs.getDataTyped(), getNumberOfBytes());
 }
 
+template <typename T>
+VolumeRAMPrecision<T>::VolumeRAMPrecision(const VolumeRAMPrecision<T>& rhs, ShareData)
+    : VolumeRAM(rhs)
+    , dimensions_(rhs.dimensions_)
+    , data_(rhs.data_)
+    , sharedOwner_(rhs.sharedOwner_)
+    , sharedData_(rhs.sharedData_)
+    , swizzleMask_(rhs.swizzleMask_)
+    , interpolation_{rhs.interpolation_}
+    , wrapping_{rhs.wrapping_} {}
+
 template <typename T>
 VolumeRAMPrecision<T>& VolumeRAMPrecision<T>::operator=(const VolumeRAMPrecision<T>& that) {
     if (this != &that) {
         VolumeRAM::operator=(that);
-        auto dim = that.dimensions_;
-        auto data = std::make_unique<T[]>(dim.x * dim.y * dim.z);
-        std::memcpy(data.get(), that.data_.get(), dim.x * dim.y * dim.z * sizeof(T));
-        data_.swap(data);
-        std::swap(dim, dimensions_);
-        ownsDataPtr_ = true;
+        const auto size = that.dimensions_.x * that.dimensions_.y * that.dimensions_.z;
+        std::shared_ptr<T[]> data(new T[size], Deleter{});
+        std::memcpy(data.get(), that.getDataTyped(), size * sizeof(T));
+        data_ = std::move(data);
+        dimensions_ = that.dimensions_;
+        sharedOwner_.reset();
+        sharedData_ = nullptr;
         swizzleMask_ = that.swizzleMask_;
         interpolation_ = that.interpolation_;
         wrapping_ = that.wrapping_;
@@ -191,57 +273,89 @@ VolumeRAMPrecision<T>& VolumeRAMPrecision<T>::operator=(const VolumeRAMPrecision
 }
 
 template <typename T>
-VolumeRAMPrecision<T>::~VolumeRAMPrecision() {
-    if (!ownsDataPtr_) data_.release();
-}
+VolumeRAMPrecision<T>::~VolumeRAMPrecision() = default;
 
 template <typename T>
 VolumeRAMPrecision<T>* VolumeRAMPrecision<T>::clone() const {
     return new VolumeRAMPrecision<T>(*this);
 }
 
+template <typename T>
+VolumeRAMPrecision<T>* VolumeRAMPrecision<T>::cloneShared() const {
+    std::scoped_lock lock{mutex_};
+    // Data we do not own might be deleted while we use it, take a copy
+    const auto deleter = std::get_deleter<Deleter>(data_);
+    if (deleter && !deleter->owns) return new VolumeRAMPrecision<T>(*this);
+    // both volumes copy the data on their next write
+    exclusive_.store(false, std::memory_order_release);
+    return new VolumeRAMPrecision<T>(*this, ShareData{});
+}
+
 template <typename T>
 const T* inviwo::VolumeRAMPrecision<T>::getDataTyped() const {
-    return data_.get();
+    return sharedData_ ? sharedData_ : data_.get();
 }
 
 template <typename T>
 T* inviwo::VolumeRAMPrecision<T>::getDataTyped() {
+    detach();
     return data_.get();
 }
 
 template <typename T>
 void* VolumeRAMPrecision<T>::getData() {
-    return data_.get();
+    return getDataTyped();
 }
 template <typename T>
 const void* VolumeRAMPrecision<T>::getData() const {
-    return const_cast<const T*>(data_.get());
+    return getDataTyped();
 }
 
 template <typename T>
 void* VolumeRAMPrecision<T>::getData(size_t pos) {
-    return data_.get() + pos;
+    return getDataTyped() + pos;
 }
 
 template <typename T>
 const void* VolumeRAMPrecision<T>::getData(size_t pos) const {
-    return const_cast<const T*>(data_.get()) + pos;
+    return getDataTyped() + pos;
 }
 
 template <typename T>
 void VolumeRAMPrecision<T>::setData(void* d, size3_t dimensions) {
-    std::unique_ptr<T[]> data(static_cast<T*>(d));
-    data_.swap(data);
-    std::swap(dimensions_, dimensions);
-
-    if (!ownsDataPtr_) data.release();
-    ownsDataPtr_ = true;
+    std::scoped_lock lock{mutex_};
+    data_ = std::shared_ptr<T[]>(static_cast<T*>(d), Deleter{});
+    dimensions_ = dimensions;
+    sharedOwner_.reset();
+    sharedData_ = nullptr;
 }
 
 template <typename T>
 void VolumeRAMPrecision<T>::removeDataOwnership() {
-    ownsDataPtr_ = false;
+    detach();
+    if (auto deleter = std::get_deleter<Deleter>(data_)) deleter->owns = false;
+}
+
+template <typename T>
+bool VolumeRAMPrecision<T>::isShared() const {
+    return sharedData_ != nullptr || data_.use_count() > 1;
+}
+
+template <typename T>
+void VolumeRAMPrecision<T>::detach() {
+    // exclusive_ is cleared whenever the data is shared, see cloneShared
+    if (exclusive_.load(std::memory_order_acquire)) return;
+
+    std::scoped_lock lock{mutex_};
+    if (isShared()) {
+        const auto size = dimensions_.x * dimensions_.y * dimensions_.z;
+        std::shared_ptr<T[]> data(new T[size], Deleter{});
+        std::memcpy(data.get(), sharedData_ ? sharedData_ : data_.get(), size * sizeof(T));
+        data_ = std::move(data);
+        sharedOwner_.reset();
+        sharedData_ = nullptr;
+    }
+    exclusive_.store(true, std::memory_order_release);
 }
 
 template <typename T>
@@ -257,11 +371,12 @@ size_t VolumeRAMPrecision<T>::getNumberOfBytes() const {
 template <typename T>
 void VolumeRAMPrecision<T>::setDimensions(size3_t dimensions) {
     if (dimensions_ != dimensions) {
-        auto data = std::make_unique<T[]>(dimensions.x * dimensions.y * dimensions.z);
-        data_.swap(data);
+        std::scoped_lock lock{mutex_};
+        data_ = std::shared_ptr<T[]>(new T[dimensions.x * dimensions.y * dimensions.z](),
+                                     Deleter{});
         dimensions_ = dimensions;
-        if (!ownsDataPtr_) data.release();
-        ownsDataPtr_ = true;
+        sharedOwner_.reset();
+        sharedData_ = nullptr;
     }
 }
 
@@ -297,82 +412,82 @@ Wrapping3D VolumeRAMPrecision<T>::getWrapping() const {
 
 template <typename T>
 double VolumeRAMPrecision<T>::getAsDouble(const size3_t& pos) const {
-    return util::glm_convert<double>(data_[posToIndex(pos, dimensions_)]);
+    return util::glm_convert<double>(getDataTyped()[posToIndex(pos, dimensions_)]);
 }
 
 template <typename T>
 dvec2 VolumeRAMPrecision<T>::getAsDVec2(const size3_t& pos) const {
-    return util::glm_convert<dvec2>(data_[posToIndex(pos, dimensions_)]);
+    return util::glm_convert<dvec2>(getDataTyped()[posToIndex(pos, dimensions_)]);
 }
 
 template <typename T>
 dvec3 VolumeRAMPrecision<T>::getAsDVec3(const size3_t& pos) const {
-    return util::glm_convert<dvec3>(data_[posToIndex(pos, dimensions_)]);
+    return util::glm_convert<dvec3>(getDataTyped()[posToIndex(pos, dimensions_)]);
 }
 
 template <typename T>
 dvec4 VolumeRAMPrecision<T>::getAsDVec4(const size3_t& pos) const {
-    return util::glm_convert<dvec4>(data_[posToIndex(pos, dimensions_)]);
+    return util::glm_convert<dvec4>(getDataTyped()[posToIndex(pos, dimensions_)]);
 }
 
 template <typename T>
 void VolumeRAMPrecision<T>::setFromDouble(const size3_t& pos, double val) {
-    data_[posToIndex(pos, dimensions_)] = util::glm_convert<T>(val);
+    getDataTyped()[posToIndex(pos, dimensions_)] = util::glm_convert<T>(val);
 }
 
 template <typename T>
 void VolumeRAMPrecision<T>::setFromDVec2(const size3_t& pos, dvec2 val) {
-    data_[posToIndex(pos, dimensions_)] = util::glm_convert<T>(val);
+    getDataTyped()[posToIndex(pos, dimensions_)] = util::glm_convert<T>(val);
 }
 
 template <typename T>
 void VolumeRAMPrecision<T>::setFromDVec3(const size3_t& pos, dvec3 val) {
-    data_[posToIndex(pos, dimensions_)] = util::glm_convert<T>(val);
+    getDataTyped()[posToIndex(pos, dimensions_)] = util::glm_convert<T>(val);
 }
 
 template <typename T>
 void VolumeRAMPrecision<T>::setFromDVec4(const size3_t& pos, dvec4 val) {
-    data_[posToIndex(pos, dimensions_)] = util::glm_convert<T>(val);
+    getDataTyped()[posToIndex(pos, dimensions_)] = util::glm_convert<T>(val);
 }
 
 template <typename T>
 double VolumeRAMPrecision<T>::getAsNormalizedDouble(const size3_t& pos) const {
-    return util::glm_convert_normalized<double>(data_[posToIndex(pos, dimensions_)]);
+    return util::glm_convert_normalized<double>(getDataTyped()[posToIndex(pos, dimensions_)]);
 }
 
 template <typename T>
 dvec2 VolumeRAMPrecision<T>::getAsNormalizedDVec2(const size3_t& pos) const {
-    return util::glm_convert_normalized<dvec2>(data_[posToIndex(pos, dimensions_)]);
+    return util::glm_convert_normalized<dvec2>(getDataTyped()[posToIndex(pos, dimensions_)]);
 }
 
 template <typename T>
 dvec3 VolumeRAMPrecision<T>::getAsNormalizedDVec3(const size3_t& pos) const {
-    return util::glm_convert_normalized<dvec3>(data_[posToIndex(pos, dimensions_)]);
+    return util::glm_convert_normalized<dvec3>(getDataTyped()[posToIndex(pos, dimensions_)]);
 }
 
 template <typename T>
 dvec4 VolumeRAMPrecision<T>::getAsNormalizedDVec4(const size3_t& pos) const {
-    return util::glm_convert_normalized<dvec4>(data_[posToIndex(pos, dimensions_)]);
+    return util::glm_convert_normalized<dvec4>(getDataTyped()[posToIndex(pos, dimensions_)]);
 }
 
 template <typename T>
 void VolumeRAMPrecision<T>::setFromNormalizedDouble(const size3_t& pos, double val) {
-    data_[posToIndex(pos, dimensions_)] = util::glm_convert_normalized<T>(val);
+    getDataTyped()[posToIndex(pos, dimensions_)] = util::glm_convert_normalized<T>(val);
 }
 
 template <typename T>
 void VolumeRAMPrecision<T>::setFromNormalizedDVec2(const size3_t& pos, dvec2 val) {
-    data_[posToIndex(pos, dimensions_)] = util::glm_convert_normalized<T>(val);
+    getDataTyped()[posToIndex(pos, dimensions_)] = util::glm_convert_normalized<T>(val);
 }
 
 template <typename T>
 void VolumeRAMPrecision<T>::setFromNormalizedDVec3(const size3_t& pos, dvec3 val) {
-    data_[posToIndex(pos, dimensions_)] = util::glm_convert_normalized<T>(val);
+    getDataTyped()[posToIndex(pos, dimensions_)] = util::glm_convert_normalized<T>(val);
 }
 
 template <typename T>
 void VolumeRAMPrecision<T>::setFromNormalizedDVec4(const size3_t& pos, dvec4 val) {
-    data_[posToIndex(pos, dimensions_)] = util::glm_convert_normalized<T>(val);
+    getDataTyped()[posToIndex(pos, dimensions_)] = util::glm_convert_normalized<T>(val);
 }
 
 }  // namespace inviwo
@@ -36,6 +36,10 @@ namespace inviwo {
 
 namespace util {
 
+/**
+ * Read \p bytes bytes starting at \p offset in \p file into \p dest. If the data is not stored in
+ * little endian byte order, the bytes of every \p elementSize large element are reversed.
+ */
 void IVW_CORE_API readBytesIntoBuffer(const std::string& file, size_t offset, size_t bytes,
                                       bool littleEndian, size_t elementSize, void* dest);
 }  // namespace util
@@ -0,0 +1,76 @@
+/*********************************************************************************
+ *
+ * Inviwo - Interactive Visualization Workshop
+ *
+ * Copyright (c) 2021 Inviwo Foundation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************************/
+
+#pragma once
+
+#include <inviwo/core/common/inviwocoredefine.h>
+
+#include <cstddef>
+#include <string>
+
+namespace inviwo {
+
+/**
+ * \class MemoryMappedFile
+ * \brief A read-only memory mapping of a range of bytes in a file.
+ * The pages of the mapping are only read from disk when they are accessed, and the operating
+ * system can evict them again under memory pressure.
+ */
+class IVW_CORE_API MemoryMappedFile {
+public:
+    /**
+     * Map the bytes [offset, offset + size) of file.
+     * @throw FileException if the file cannot be opened or mapped, or is smaller than
+     * offset + size.
+     */
+    MemoryMappedFile(const std::string& file, size_t offset, size_t size);
+    MemoryMappedFile(const MemoryMappedFile&) = delete;
+    MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+    ~MemoryMappedFile();
+
+    /**
+     * Pointer to the first mapped byte, i.e. the byte at offset in the file.
+     */
+    const void* data() const;
+    size_t size() const;
+    const std::string& getFile() const;
+
+private:
+    std::string file_;
+    size_t size_;
+    void* view_;  //< Start of the mapping, aligned to the allocation granularity.
+    size_t viewSize_;
+    const void* data_;
+#ifdef WIN32
+    void* fileHandle_;
+    void* mappingHandle_;
+#endif
+};
+
+}  // namespace inviwo
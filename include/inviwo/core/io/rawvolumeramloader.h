@@ -35,6 +35,7 @@
 #include <inviwo/core/io/datareaderexception.h>
 #include <inviwo/core/datastructures/diskrepresentation.h>
 #include <inviwo/core/datastructures/volume/volumerepresentation.h>
+#include <inviwo/core/datastructures/volume/volumebricked.h>
 
 #include <string>
 #include <memory>
@@ -45,9 +46,13 @@ namespace inviwo {
  * \class RawVolumeRAMLoader
  * \brief A loader of raw files. Used to create VolumeRAM representations.
  * This class us used by the DatVolumeSequenceReader, IvfVolumeReader and RawVolumeReader.
+ * Files in little endian byte order are memory mapped, and the VolumeRAM only copies the data
+ * when it is modified. Other files are read into memory.
+ * The loader can also read single bricks of the volume, \see VolumeBricked.
  */
 
-class IVW_CORE_API RawVolumeRAMLoader : public DiskRepresentationLoader<VolumeRepresentation> {
+class IVW_CORE_API RawVolumeRAMLoader : public DiskRepresentationLoader<VolumeRepresentation>,
+                                        public VolumeBrickLoader {
 public:
     RawVolumeRAMLoader(const std::string& rawFile, size_t offset, bool littleEndian);
     virtual RawVolumeRAMLoader* clone() const override;
@@ -55,6 +60,8 @@ public:
         const VolumeRepresentation& src) const override;
     virtual void updateRepresentation(std::shared_ptr<VolumeRepresentation> dest,
                                       const VolumeRepresentation& src) const override;
+    virtual void loadBrick(const VolumeRepresentation& src, const size3_t& offset,
+                           const size3_t& extent, void* dest) const override;
 
 private:
     std::string rawFile_;
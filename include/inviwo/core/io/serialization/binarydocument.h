@@ -0,0 +1,82 @@
+/*********************************************************************************
+ *
+ * Inviwo - Interactive Visualization Workshop
+ *
+ * Copyright (c) 2021 Inviwo Foundation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************************/
+
+#pragma once
+
+#include <inviwo/core/common/inviwocoredefine.h>
+
+#include <iosfwd>
+#include <fstream>
+#include <string_view>
+
+namespace ticpp {
+class Document;
+}  // namespace ticpp
+
+namespace inviwo {
+using TxDocument = ticpp::Document;
+
+/**
+ * The encodings a serialized document can be written in.
+ * Xml is the regular human readable format. Binary stores the same document tree with all
+ * element names, attribute keys and values collected in a string table, which makes it both
+ * smaller and faster to read since no text has to be tokenized or unescaped.
+ */
+enum class DocumentFormat { Xml, Binary };
+
+namespace util {
+
+/**
+ * Checks if the next bytes in the stream are the header of a binary document, without
+ * consuming any of them.
+ */
+IVW_CORE_API bool isBinaryDocument(std::istream& stream);
+
+/**
+ * Writes the document tree in the binary format. The stream should be opened in binary mode.
+ * @throws SerializationException if the stream could not be written
+ */
+IVW_CORE_API void writeBinaryDocument(const TxDocument& doc, std::ostream& stream);
+
+/**
+ * Reads a binary document from the stream and appends its nodes to the given document.
+ * @throws SerializationException if the stream does not contain a valid binary document
+ */
+IVW_CORE_API void readBinaryDocument(std::istream& stream, TxDocument& doc);
+
+/**
+ * Opens a file containing either an xml or a binary document. Binary documents are opened in
+ * binary mode and xml documents in text mode, to keep the platform line ending conversion.
+ * The caller has to check that the returned stream is open.
+ */
+IVW_CORE_API std::ifstream openDocument(std::string_view path);
+
+}  // namespace util
+
+}  // namespace inviwo
@@ -35,6 +35,7 @@
 #include <inviwo/core/util/stdextensions.h>
 #include <inviwo/core/util/glm.h>
 #include <inviwo/core/io/serialization/serializationexception.h>
+#include <inviwo/core/io/serialization/binarydocument.h>
 
 #include <flags/flags.h>
 
@@ -79,6 +80,17 @@ public:
      */
     virtual void writeFile(std::ostream& stream, bool format = false);
 
+    /**
+     * \brief Writes serialized data to stream in the given document format.
+     *
+     * Xml output is formatted. Binary output can be read back by the Deserializer just like
+     * xml, the stream should then be opened in binary mode.
+     * @param stream Stream to be written to.
+     * @param format Document format to write.
+     * @throws SerializationException
+     */
+    void writeFile(std::ostream& stream, DocumentFormat format);
+
     // std containers
     template <typename T, typename Pred = util::alwaysTrue, typename Proj = util::identity>
     void serialize(std::string_view key, const std::vector<T>& sVector,
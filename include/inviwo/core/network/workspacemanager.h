@@ -34,6 +34,7 @@
 #include <inviwo/core/util/exception.h>
 #include <inviwo/core/util/logcentral.h>
 #include <inviwo/core/io/serialization/serializable.h>
+#include <inviwo/core/io/serialization/binarydocument.h>
 
 #include <flags/flags.h>
 
@@ -76,6 +77,9 @@ public:
     using DeserializationCallback = std::function<void(Deserializer&)>;
     using DeserializationHandle = typename DeserializationDispatcher::Handle;
 
+    /// File extension of workspaces saved in the binary document format
+    static constexpr std::string_view binaryExtension = "invb";
+
     WorkspaceManager(InviwoApplication* app);
     ~WorkspaceManager();
 
@@ -92,13 +96,17 @@ public:
      *      saved file.
      * \param exceptionHandler A callback for handling errors.
      * \param mode to indicate if we are saving to disk or undo-stack
+     * \param format the document format to write, the stream should be opened in binary mode for
+     *      DocumentFormat::Binary.
      */
     void save(std::ostream& stream, std::string_view refPath,
               const ExceptionHandler& exceptionHandler = StandardExceptionHandler(),
-              WorkspaceSaveMode mode = WorkspaceSaveMode::Disk);
+              WorkspaceSaveMode mode = WorkspaceSaveMode::Disk,
+              DocumentFormat format = DocumentFormat::Xml);
 
     /**
-     * Save the current workspace to a file
+     * Save the current workspace to a file. Files with the binaryExtension are written using
+     * the binary document format, all others as xml.
      * \param path the file to save into.
      * \param exceptionHandler A callback for handling errors.
      * \param mode to indicate if we are saving to disk or undo-stack
@@ -108,7 +116,7 @@ public:
               WorkspaceSaveMode mode = WorkspaceSaveMode::Disk);
 
     /**
-     * Load a workspace from a stream
+     * Load a workspace from a stream, both xml and binary documents are accepted.
      * \param stream the stream to read from.
      * \param refPath a reference that that can be use by the deserializer to calculate relative
      *      paths. The same refPath should be given when loading. Most often this should be the
@@ -119,7 +127,8 @@ public:
               const ExceptionHandler& exceptionHandler = StandardExceptionHandler());
 
     /**
-     * Load a workspace from a file
+     * Load a workspace from a file, both xml and binary documents are accepted regardless of
+     * the file extension.
      * \param path the file to read from.
      * \param exceptionHandler A callback for handling errors.
      */
@@ -35,6 +35,7 @@
 
 #include <iterator>
 #include <algorithm>
+#include <memory>
 
 namespace inviwo {
 
@@ -151,8 +152,8 @@ public:
         return it;
     }
 
-    reference operator*() const { return (iterator_ + im_(start_ + current_)).operator*(); }
-    pointer operator->() const { return (iterator_ + im_(start_ + current_)).operator->(); }
+    reference operator*() const { return *(iterator_ + im_(start_ + current_)); }
+    pointer operator->() const { return std::addressof(operator*()); }
 
     bool operator==(const BrickIterator& rhs) const { return current_ == rhs.current_; }
     bool operator!=(const BrickIterator& rhs) const { return current_ != rhs.current_; }
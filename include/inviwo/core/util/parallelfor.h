@@ -0,0 +1,247 @@
+/*********************************************************************************
+ *
+ * Inviwo - Interactive Visualization Workshop
+ *
+ * Copyright (c) 2021 Inviwo Foundation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************************/
+#pragma once
+
+#include <inviwo/core/common/inviwocoredefine.h>
+#include <inviwo/core/util/glm.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace inviwo::util {
+
+/**
+ * Split the index range [0, count) into blocks of at least \p grain indices and call
+ * `func(begin, end)` for each block using the application thread pool.
+ *
+ * The calling thread takes part in the work and only waits for blocks that have already been
+ * started by a worker, hence it is safe to call from within a job running on the pool. If there
+ * is no application or the pool is empty, \p func is called once with the whole range.
+ * If \p func throws, the remaining blocks are skipped and the first exception is rethrown once the
+ * running blocks have finished.
+ *
+ * \code{.cpp}
+ * util::parallelFor(data.size(), [&](size_t begin, size_t end) {
+ *     for (size_t i = begin; i < end; ++i) data[i] = f(i);
+ * });
+ * \endcode
+ */
+IVW_CORE_API void parallelFor(size_t count, const std::function<void(size_t, size_t)>& func,
+                              size_t grain = 1);
+
+/**
+ * The number of blocks parallelFor splits \p count indices with a grain of \p grain into.
+ */
+IVW_CORE_API size_t parallelBlockCount(size_t count, size_t grain = 1);
+
+/**
+ * Split the index range [0, count) into blocks like parallelFor, compute `func(begin, end)` for
+ * every block and combine the results with `reduce(a, b)`, starting from \p identity. The results
+ * are combined in block order.
+ */
+template <typename T, typename F, typename R>
+T parallelReduce(size_t count, T identity, F&& func, R&& reduce, size_t grain = 1) {
+    const auto blocks = parallelBlockCount(count, grain);
+    std::vector<T> partial(blocks, identity);
+    parallelFor(blocks, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            partial[i] = func(i * count / blocks, (i + 1) * count / blocks);
+        }
+    });
+    for (auto& value : partial) identity = reduce(identity, value);
+    return identity;
+}
+
+/**
+ * How a volume index space is split into blocks.
+ */
+enum class Blocking {
+    Slabs,  //!< Consecutive rows of voxels, i.e. z-slabs split along y. Best for linear access.
+    Bricks  //!< Boxes of a fixed size. Best for neighborhood access like filters and gradients.
+};
+
+namespace detail {
+
+// Blocks of consecutive rows have at least this many voxels
+constexpr size_t minBlockVoxels = 16 * 1024;
+
+/**
+ * Call func(begin, end) for the boxes covering the rows [rowBegin, rowEnd) of a volume of size
+ * dims, where row r is the row y = r % dims.y in slice z = r / dims.y. That is at most three
+ * boxes: the rest of the first slice, the full slices, and the start of the last slice.
+ */
+template <typename F>
+void forEachRowBox(const size3_t& dims, size_t rowBegin, size_t rowEnd, F&& func) {
+    while (rowBegin < rowEnd) {
+        const size_t z = rowBegin / dims.y;
+        const size_t y = rowBegin % dims.y;
+        if (y != 0 || rowEnd - rowBegin < dims.y) {
+            const size_t yEnd = std::min(dims.y, y + rowEnd - rowBegin);
+            func(size3_t{0, y, z}, size3_t{dims.x, yEnd, z + 1});
+            rowBegin += yEnd - y;
+        } else {
+            const size_t zEnd = z + (rowEnd - rowBegin) / dims.y;
+            func(size3_t{0, 0, z}, size3_t{dims.x, dims.y, zEnd});
+            rowBegin += (zEnd - z) * dims.y;
+        }
+    }
+}
+
+/**
+ * The number of blocks forEachBlock splits dims into.
+ */
+inline size_t blockCount(const size3_t& dims, Blocking blocking, const size3_t& brickSize) {
+    if (glm::compMul(dims) == 0) return 0;
+    if (blocking == Blocking::Bricks) {
+        const auto brick = glm::max(brickSize, size3_t{1});
+        return glm::compMul((dims + brick - size3_t{1}) / brick);
+    } else {
+        return parallelBlockCount(dims.y * dims.z, std::max<size_t>(1, minBlockVoxels / dims.x));
+    }
+}
+
+/**
+ * Split dims into the given number of blocks and call func(block, begin, end) in parallel for
+ * each box of each block, where block is in [0, blocks).
+ * @see blockCount
+ */
+template <typename F>
+void forEachBlock(const size3_t& dims, Blocking blocking, const size3_t& brickSize, size_t blocks,
+                  F&& func) {
+    if (blocks == 0) return;
+
+    if (blocking == Blocking::Bricks) {
+        const auto brick = glm::max(brickSize, size3_t{1});
+        const size3_t bricks = (dims + brick - size3_t{1}) / brick;
+        parallelFor(blocks, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                const size3_t pos{i % bricks.x, (i / bricks.x) % bricks.y,
+                                  i / (bricks.x * bricks.y)};
+                const size3_t first = pos * brick;
+                func(i, first, glm::min(first + brick, dims));
+            }
+        });
+    } else {
+        const size_t rows = dims.y * dims.z;
+        parallelFor(blocks, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                forEachRowBox(dims, i * rows / blocks, (i + 1) * rows / blocks,
+                              [&](const size3_t& first, const size3_t& last) {
+                                  func(i, first, last);
+                              });
+            }
+        });
+    }
+}
+
+}  // namespace detail
+
+/**
+ * Split the volume index space [0, dims) into blocks and call `func(begin, end)` for every box
+ * [begin, end) in parallel on the application thread pool, see parallelFor(size_t, ...).
+ * With Blocking::Slabs the boxes are consecutive rows of at least detail::minBlockVoxels voxels,
+ * with Blocking::Bricks they are bricks of \p brickSize voxels, smaller at the upper borders.
+ *
+ * \code{.cpp}
+ * util::parallelFor(dims, [&](const size3_t& begin, const size3_t& end) {
+ *     util::forEachVoxel(begin, end, [&](const size3_t& pos) { data[im(pos)] = f(pos); });
+ * });
+ * \endcode
+ */
+template <typename F>
+void parallelFor(const size3_t& dims, F&& func, Blocking blocking = Blocking::Slabs,
+                 const size3_t& brickSize = size3_t{32}) {
+    detail::forEachBlock(dims, blocking, brickSize, detail::blockCount(dims, blocking, brickSize),
+                         [&](size_t, const size3_t& begin, const size3_t& end) {
+                             func(begin, end);
+                         });
+}
+
+/**
+ * Split the layer index space [0, dims) into blocks of rows, or into tiles of \p tileSize with
+ * Blocking::Bricks, and call `func(begin, end)` for every box in parallel.
+ * @see parallelFor(const size3_t&, F&&, Blocking, const size3_t&)
+ */
+template <typename F>
+void parallelFor(const size2_t& dims, F&& func, Blocking blocking = Blocking::Slabs,
+                 const size2_t& tileSize = size2_t{64}) {
+    parallelFor(
+        size3_t{dims, 1},
+        [&](const size3_t& begin, const size3_t& end) { func(size2_t{begin}, size2_t{end}); },
+        blocking, size3_t{tileSize, 1});
+}
+
+/**
+ * Split the volume index space [0, dims) into blocks like parallelFor, compute `func(begin, end)`
+ * for every box and combine the results with `reduce(a, b)`, starting from \p identity. The
+ * results are combined in the same order for the same pool size, hence floating point sums are
+ * reproducible.
+ *
+ * \code{.cpp}
+ * const auto sum = util::parallelReduce(
+ *     dims, 0.0,
+ *     [&](const size3_t& begin, const size3_t& end) {
+ *         double res = 0.0;
+ *         util::forEachVoxel(begin, end, [&](const size3_t& pos) { res += data[im(pos)]; });
+ *         return res;
+ *     },
+ *     std::plus<>{});
+ * \endcode
+ */
+template <typename T, typename F, typename R>
+T parallelReduce(const size3_t& dims, T identity, F&& func, R&& reduce,
+                 Blocking blocking = Blocking::Slabs, const size3_t& brickSize = size3_t{32}) {
+    const auto blocks = detail::blockCount(dims, blocking, brickSize);
+
+    std::vector<T> partial(blocks, identity);
+    detail::forEachBlock(dims, blocking, brickSize, blocks,
+                         [&](size_t block, const size3_t& begin, const size3_t& end) {
+                             partial[block] = reduce(partial[block], func(begin, end));
+                         });
+
+    for (auto& value : partial) identity = reduce(identity, value);
+    return identity;
+}
+
+/**
+ * Two dimensional version of parallelReduce.
+ * @see parallelReduce(const size3_t&, T, F&&, R&&, Blocking, const size3_t&)
+ */
+template <typename T, typename F, typename R>
+T parallelReduce(const size2_t& dims, T identity, F&& func, R&& reduce,
+                 Blocking blocking = Blocking::Slabs, const size2_t& tileSize = size2_t{64}) {
+    return parallelReduce(
+        size3_t{dims, 1}, std::move(identity),
+        [&](const size3_t& begin, const size3_t& end) { return func(size2_t{begin}, size2_t{end}); },
+        reduce, blocking, size3_t{tileSize, 1});
+}
+
+}  // namespace inviwo::util
@@ -34,6 +34,11 @@
 #include <inviwo/core/datastructures/coordinatetransformer.h>
 #include <inviwo/core/datastructures/datatraits.h>
 
+#include <tcb/span.hpp>
+
+#include <algorithm>
+#include <array>
+
 namespace inviwo {
 
 class IVW_CORE_API Spatial4DSamplerBase {
@@ -59,6 +64,19 @@ public:
     virtual bool withinBounds(const dvec4& pos, Space space = Space::Data) const;
     virtual bool withinBounds(const vec4& pos, Space space = Space::Data) const;
 
+    /**
+     * Sample at each of \p positions and write the samples to \p results, which has to be at
+     * least as large as \p positions. \see SpatialSampler::sample
+     */
+    void sample(util::span<const dvec4> positions, util::span<Vector<DataDims, T>> results,
+                Space space = Space::Data) const;
+    /**
+     * Test each of \p positions and write the results to \p results, which has to be at least
+     * as large as \p positions. \see SpatialSampler::withinBounds
+     */
+    void withinBounds(util::span<const dvec4> positions, util::span<bool> results,
+                      Space space = Space::Data) const;
+
     const SpatialCoordinateTransformer<3>& getCoordinateTransformer() const;
     mat4 getModelMatrix() const;
     mat4 getWorldMatrix() const;
@@ -67,6 +85,18 @@ protected:
     virtual Vector<DataDims, T> sampleDataSpace(const dvec4& pos) const = 0;
     virtual bool withinBoundsDataSpace(const dvec4& pos) const = 0;
 
+    virtual void sampleDataSpaceBatch(util::span<const dvec4> positions,
+                                      util::span<Vector<DataDims, T>> results) const;
+    virtual void withinBoundsDataSpaceBatch(util::span<const dvec4> positions,
+                                            util::span<bool> results) const;
+
+    /**
+     * Call \p func with chunks of \p positions transformed to data space and the offset of
+     * each chunk
+     */
+    template <typename Func>
+    void forEachDataSpaceChunk(util::span<const dvec4> positions, Space space, Func&& func) const;
+
     std::shared_ptr<const SpatialEntity<3>> spatialEntity_;
 };
 
@@ -134,6 +164,61 @@ bool Spatial4DSampler<DataDims, T>::withinBounds(const vec4& pos, Space space) c
     return withinBounds(static_cast<dvec4>(pos), space);
 }
 
+template <unsigned DataDims, typename T>
+template <typename Func>
+void Spatial4DSampler<DataDims, T>::forEachDataSpaceChunk(util::span<const dvec4> positions,
+                                                          Space space, Func&& func) const {
+    if (space == Space::Data) {
+        func(positions, size_t{0});
+        return;
+    }
+    const auto m = spatialEntity_->getCoordinateTransformer().getMatrix(space, Space::Data);
+    constexpr size_t chunkSize = 64;
+    std::array<dvec4, chunkSize> dataPos;
+    for (size_t first = 0; first < positions.size(); first += chunkSize) {
+        const size_t count = std::min(chunkSize, positions.size() - first);
+        for (size_t i = 0; i < count; ++i) {
+            const auto& pos = positions[first + i];
+            const auto p = m * vec4(static_cast<vec3>(pos), 1.0f);
+            dataPos[i] = dvec4(dvec3(vec3(p) / p.w), pos.w);
+        }
+        func(util::span<const dvec4>(dataPos.data(), count), first);
+    }
+}
+
+template <unsigned DataDims, typename T>
+void Spatial4DSampler<DataDims, T>::sample(util::span<const dvec4> positions,
+                                           util::span<Vector<DataDims, T>> results,
+                                           Space space) const {
+    forEachDataSpaceChunk(positions, space, [&](auto dataPos, size_t offset) {
+        sampleDataSpaceBatch(dataPos, results.subspan(offset, dataPos.size()));
+    });
+}
+
+template <unsigned DataDims, typename T>
+void Spatial4DSampler<DataDims, T>::withinBounds(util::span<const dvec4> positions,
+                                                 util::span<bool> results, Space space) const {
+    forEachDataSpaceChunk(positions, space, [&](auto dataPos, size_t offset) {
+        withinBoundsDataSpaceBatch(dataPos, results.subspan(offset, dataPos.size()));
+    });
+}
+
+template <unsigned DataDims, typename T>
+void Spatial4DSampler<DataDims, T>::sampleDataSpaceBatch(
+    util::span<const dvec4> positions, util::span<Vector<DataDims, T>> results) const {
+    for (size_t i = 0; i < positions.size(); ++i) {
+        results[i] = sampleDataSpace(positions[i]);
+    }
+}
+
+template <unsigned DataDims, typename T>
+void Spatial4DSampler<DataDims, T>::withinBoundsDataSpaceBatch(util::span<const dvec4> positions,
+                                                               util::span<bool> results) const {
+    for (size_t i = 0; i < positions.size(); ++i) {
+        results[i] = withinBoundsDataSpace(positions[i]);
+    }
+}
+
 template <unsigned DataDims, typename T>
 const SpatialCoordinateTransformer<3>& Spatial4DSampler<DataDims, T>::getCoordinateTransformer()
     const {
@@ -32,10 +32,19 @@
 #include <inviwo/core/datastructures/spatialdata.h>
 #include <inviwo/core/datastructures/datatraits.h>
 
+#include <tcb/span.hpp>
+
+#include <algorithm>
+#include <array>
+
 namespace inviwo {
 
 /**
  * \class SpatialSampler
+ * Samples a spatial entity at a position. Besides sampling one position at a time, a sampler can
+ * sample a batch of positions with a single call. The batch versions transform the positions to
+ * data space once per batch and make a single virtual call, which lets samplers with a known data
+ * format sample without any per sample virtual calls.
  */
 template <unsigned int SpatialDims, unsigned int DataDims, typename T>
 class SpatialSampler {
@@ -60,6 +69,24 @@ public:
     virtual bool withinBounds(const Vector<SpatialDims, double>& pos, Space space) const;
     virtual bool withinBounds(const Vector<SpatialDims, float>& pos, Space space) const;
 
+    /**
+     * Sample at each of \p positions and write the samples to \p results, which has to be at
+     * least as large as \p positions. Equivalent to calling sample(pos) for each position.
+     */
+    void sample(util::span<const Vector<SpatialDims, double>> positions,
+                util::span<Vector<DataDims, T>> results) const;
+    void sample(util::span<const Vector<SpatialDims, double>> positions,
+                util::span<Vector<DataDims, T>> results, Space space) const;
+
+    /**
+     * Test each of \p positions and write the results to \p results, which has to be at least
+     * as large as \p positions. Equivalent to calling withinBounds(pos) for each position.
+     */
+    void withinBounds(util::span<const Vector<SpatialDims, double>> positions,
+                      util::span<bool> results) const;
+    void withinBounds(util::span<const Vector<SpatialDims, double>> positions,
+                      util::span<bool> results, Space space) const;
+
     Matrix<SpatialDims, float> getBasis() const;
     Matrix<SpatialDims + 1, float> getModelMatrix() const;
     Matrix<SpatialDims + 1, float> getWorldMatrix() const;
@@ -70,6 +97,26 @@ protected:
     virtual Vector<DataDims, T> sampleDataSpace(const Vector<SpatialDims, double>& pos) const = 0;
     virtual bool withinBoundsDataSpace(const Vector<SpatialDims, double>& pos) const = 0;
 
+    /**
+     * Batch versions of sampleDataSpace and withinBoundsDataSpace. The default implementations
+     * call the single position versions, derived samplers can override them to avoid the virtual
+     * call per position.
+     */
+    virtual void sampleDataSpaceBatch(util::span<const Vector<SpatialDims, double>> positions,
+                                      util::span<Vector<DataDims, T>> results) const;
+    virtual void withinBoundsDataSpaceBatch(
+        util::span<const Vector<SpatialDims, double>> positions, util::span<bool> results) const;
+
+    /**
+     * Transform \p positions using \p m in chunks and call \p func with each chunk of data space
+     * positions and the offset of the chunk. Positions are passed through as is if \p m is
+     * not needed, i.e. if \p space is Data.
+     */
+    template <typename Func>
+    static void forEachDataSpaceChunk(util::span<const Vector<SpatialDims, double>> positions,
+                                      Space space, const Matrix<SpatialDims + 1, double>& m,
+                                      Func&& func);
+
     Space space_;
     const SpatialEntity<SpatialDims>& spatialEntity_;
     Matrix<SpatialDims + 1, double> transform_;
@@ -171,6 +218,83 @@ bool SpatialSampler<SpatialDims, DataDims, T>::withinBounds(const Vector<Spatial
     }
 }
 
+template <unsigned int SpatialDims, unsigned int DataDims, typename T>
+template <typename Func>
+void SpatialSampler<SpatialDims, DataDims, T>::forEachDataSpaceChunk(
+    util::span<const Vector<SpatialDims, double>> positions, Space space,
+    const Matrix<SpatialDims + 1, double>& m, Func&& func) {
+    if (space == Space::Data) {
+        func(positions, size_t{0});
+        return;
+    }
+    constexpr size_t chunkSize = 64;
+    std::array<Vector<SpatialDims, double>, chunkSize> dataPos;
+    for (size_t first = 0; first < positions.size(); first += chunkSize) {
+        const size_t count = std::min(chunkSize, positions.size() - first);
+        for (size_t i = 0; i < count; ++i) {
+            const auto p = m * Vector<SpatialDims + 1, double>(positions[first + i], 1.0);
+            dataPos[i] = Vector<SpatialDims, double>(p) / p[SpatialDims];
+        }
+        func(util::span<const Vector<SpatialDims, double>>(dataPos.data(), count), first);
+    }
+}
+
+template <unsigned int SpatialDims, unsigned int DataDims, typename T>
+void SpatialSampler<SpatialDims, DataDims, T>::sample(
+    util::span<const Vector<SpatialDims, double>> positions,
+    util::span<Vector<DataDims, T>> results) const {
+    forEachDataSpaceChunk(positions, space_, transform_, [&](auto dataPos, size_t offset) {
+        sampleDataSpaceBatch(dataPos, results.subspan(offset, dataPos.size()));
+    });
+}
+
+template <unsigned int SpatialDims, unsigned int DataDims, typename T>
+void SpatialSampler<SpatialDims, DataDims, T>::sample(
+    util::span<const Vector<SpatialDims, double>> positions,
+    util::span<Vector<DataDims, T>> results, Space space) const {
+    const Matrix<SpatialDims + 1, double> m{
+        spatialEntity_.getCoordinateTransformer().getMatrix(space, Space::Data)};
+    forEachDataSpaceChunk(positions, space, m, [&](auto dataPos, size_t offset) {
+        sampleDataSpaceBatch(dataPos, results.subspan(offset, dataPos.size()));
+    });
+}
+
+template <unsigned int SpatialDims, unsigned int DataDims, typename T>
+void SpatialSampler<SpatialDims, DataDims, T>::withinBounds(
+    util::span<const Vector<SpatialDims, double>> positions, util::span<bool> results) const {
+    forEachDataSpaceChunk(positions, space_, transform_, [&](auto dataPos, size_t offset) {
+        withinBoundsDataSpaceBatch(dataPos, results.subspan(offset, dataPos.size()));
+    });
+}
+
+template <unsigned int SpatialDims, unsigned int DataDims, typename T>
+void SpatialSampler<SpatialDims, DataDims, T>::withinBounds(
+    util::span<const Vector<SpatialDims, double>> positions, util::span<bool> results,
+    Space space) const {
+    const Matrix<SpatialDims + 1, double> m{
+        spatialEntity_.getCoordinateTransformer().getMatrix(space, Space::Data)};
+    forEachDataSpaceChunk(positions, space, m, [&](auto dataPos, size_t offset) {
+        withinBoundsDataSpaceBatch(dataPos, results.subspan(offset, dataPos.size()));
+    });
+}
+
+template <unsigned int SpatialDims, unsigned int DataDims, typename T>
+void SpatialSampler<SpatialDims, DataDims, T>::sampleDataSpaceBatch(
+    util::span<const Vector<SpatialDims, double>> positions,
+    util::span<Vector<DataDims, T>> results) const {
+    for (size_t i = 0; i < positions.size(); ++i) {
+        results[i] = sampleDataSpace(positions[i]);
+    }
+}
+
+template <unsigned int SpatialDims, unsigned int DataDims, typename T>
+void SpatialSampler<SpatialDims, DataDims, T>::withinBoundsDataSpaceBatch(
+    util::span<const Vector<SpatialDims, double>> positions, util::span<bool> results) const {
+    for (size_t i = 0; i < positions.size(); ++i) {
+        results[i] = withinBoundsDataSpace(positions[i]);
+    }
+}
+
 template <unsigned int SpatialDims, unsigned int DataDims, typename T>
 const SpatialCoordinateTransformer<SpatialDims>&
 SpatialSampler<SpatialDims, DataDims, T>::getCoordinateTransformer() const {
@@ -55,6 +55,11 @@ using componentType =
 
 }  // namespace detail
 
+/**
+ * \class TemplateVolumeSampler
+ * Samples a VolumeRAM of a known data type \p DataType using interpolation in precision \p P.
+ * Since both are known at compile time, batches of positions are sampled without virtual calls.
+ */
 template <typename DataType, typename P, typename T = detail::componentType<DataType>,
           unsigned int DataDims = detail::components<DataType>()>
 class TemplateVolumeSampler : public SpatialSampler<3, DataDims, T> {
@@ -70,6 +75,12 @@ public:
 
     virtual Vector<DataDims, T> sampleDataSpace(const dvec3& pos) const override;
 
+protected:
+    virtual void sampleDataSpaceBatch(util::span<const dvec3> positions,
+                                      util::span<Vector<DataDims, T>> results) const override;
+    virtual void withinBoundsDataSpaceBatch(util::span<const dvec3> positions,
+                                            util::span<bool> results) const override;
+
 private:
     Vector<DataDims, T> getVoxel(const size3_t& pos) const;
     virtual bool withinBoundsDataSpace(const dvec3& pos) const override;
@@ -135,6 +146,22 @@ Vector<DataDims, T> TemplateVolumeSampler<DataType, P, T, DataDims>::sampleDataS
     return Interpolation<Vector<DataDims, T>, P>::trilinear(samples, interpolants);
 }
 
+template <typename DataType, typename P, typename T, unsigned int DataDims>
+void TemplateVolumeSampler<DataType, P, T, DataDims>::sampleDataSpaceBatch(
+    util::span<const dvec3> positions, util::span<Vector<DataDims, T>> results) const {
+    for (size_t i = 0; i < positions.size(); ++i) {
+        results[i] = TemplateVolumeSampler::sampleDataSpace(positions[i]);
+    }
+}
+
+template <typename DataType, typename P, typename T, unsigned int DataDims>
+void TemplateVolumeSampler<DataType, P, T, DataDims>::withinBoundsDataSpaceBatch(
+    util::span<const dvec3> positions, util::span<bool> results) const {
+    for (size_t i = 0; i < positions.size(); ++i) {
+        results[i] = TemplateVolumeSampler::withinBoundsDataSpace(positions[i]);
+    }
+}
+
 template <typename DataType, typename P, typename T, unsigned int DataDims>
 Vector<DataDims, T> TemplateVolumeSampler<DataType, P, T, DataDims>::getVoxel(
     const size3_t& pos) const {
@@ -61,21 +61,68 @@
 #include <warn/push>
 #include <warn/ignore/all>
 #include <vector>
-#include <queue>
+#include <deque>
 #include <memory>
 #include <thread>
 #include <mutex>
+#include <shared_mutex>
 #include <condition_variable>
 #include <future>
 #include <functional>
 #include <stdexcept>
 #include <atomic>
+#include <type_traits>
+#include <cstddef>
+#include <new>
 #include <warn/pop>
 
 namespace inviwo {
 
+/**
+ * A pool of worker threads with work stealing. Every worker has its own task queue. Tasks
+ * enqueued from a worker thread go to the queue of that worker, other tasks are distributed over
+ * all queues. A worker runs the tasks of its own queue in order, and when that is empty it steals
+ * tasks from the other workers.
+ */
 class IVW_CORE_API ThreadPool {
 public:
+    /**
+     * A move only void() functor. Small functors are stored inline without any allocation.
+     */
+    class Task {
+    public:
+        Task() noexcept = default;
+        template <class F, class = std::enable_if_t<!std::is_same_v<std::decay_t<F>, Task> &&
+                                                    std::is_invocable_v<std::decay_t<F>&>>>
+        Task(F&& f);
+        Task(const Task&) = delete;
+        Task(Task&& rhs) noexcept;
+        Task& operator=(const Task&) = delete;
+        Task& operator=(Task&& rhs) noexcept;
+        ~Task();
+
+        explicit operator bool() const noexcept { return ops_ != nullptr; }
+        void operator()() { ops_->invoke(buffer_); }
+
+    private:
+        struct Ops {
+            void (*invoke)(void* buffer);
+            void (*move)(void* src, void* dst) noexcept;
+            void (*destroy)(void* buffer) noexcept;
+        };
+        static constexpr size_t bufferSize = 64 - sizeof(const Ops*);
+        template <class F>
+        static constexpr bool isInline = sizeof(F) <= bufferSize &&
+                                         alignof(F) <= alignof(std::max_align_t) &&
+                                         std::is_nothrow_move_constructible_v<F>;
+        template <class F>
+        static const Ops* ops();
+        void reset() noexcept;
+
+        alignas(std::max_align_t) unsigned char buffer_[bufferSize];
+        const Ops* ops_ = nullptr;
+    };
+
     ThreadPool(
         size_t threads, std::function<void()> onThreadStart = []() {},
         std::function<void()> onThreadStop = []() {});
@@ -91,7 +138,13 @@ public:
     /**
      * Enqueue a plain functor. The functor may not throw exceptions.
      */
-    void enqueueRaw(std::function<void()> f);
+    void enqueueRaw(Task task);
+
+    /**
+     * Enqueue several plain functors at once. The tasks are spread over the worker queues with a
+     * single lock per queue. The functors may not throw exceptions.
+     */
+    void enqueueBatch(std::vector<Task> tasks);
 
     size_t trySetSize(size_t size);
     size_t getSize() const;
@@ -102,7 +155,7 @@ private:
     enum class State {
         Free,     //< Worker is waiting for tasks.
         Working,  //< Worker is running a task.
-        Stop,     //< Stop after all tasks are done.
+        Stop,     //< Stop after all tasks in the queue of the worker are done.
         Abort,    //< Stop as soon as possible, no matter if there are more tasks.
         Done      //< Worker is waiting to be joined.
     };
@@ -115,17 +168,37 @@ private:
         Worker& operator=(Worker&& rhs) = delete;
         ~Worker();
 
+        ThreadPool& pool;
         std::atomic<State> state;  //< State of the worker
+
+        // the task queue of this worker, the owner takes from the front, thieves from the back
+        std::mutex queue_mutex;
+        std::deque<Task> tasks;
+        size_t stealIndex = 0;
+
         std::thread thread;
     };
-    // need to keep track of threads so we can join them
+
+    /**
+     * Take a task from the queue of worker, or if that is empty and steal is true, from any other
+     * worker. Returns an empty task if nothing was found.
+     */
+    Task take(Worker& worker, bool steal);
+    void push(Worker& worker, Task task);
+    void wake(size_t count);
+    Worker* currentWorker();
+
+    // need to keep track of threads so we can join them, guarded by workers_mutex
     std::vector<std::unique_ptr<Worker>> workers;
+    mutable std::shared_mutex workers_mutex;
+    std::atomic<size_t> next{0};
 
-    // the task queue
-    std::queue<std::function<void()>> tasks;
+    // number of tasks in all queues
+    std::atomic<size_t> pending{0};
 
-    // synchronization
-    std::mutex queue_mutex;
+    // synchronization for sleeping workers
+    std::atomic<size_t> sleepers{0};
+    std::mutex sleep_mutex;
     std::condition_variable condition;
 
     // Thread start end exit actions
@@ -133,23 +206,76 @@ private:
     std::function<void()> onThreadStop_;
 };
 
+template <class F>
+auto ThreadPool::Task::ops() -> const Ops* {
+    if constexpr (isInline<F>) {
+        static constexpr Ops ops{
+            [](void* buffer) { (*std::launder(reinterpret_cast<F*>(buffer)))(); },
+            [](void* src, void* dst) noexcept {
+                auto f = std::launder(reinterpret_cast<F*>(src));
+                new (dst) F(std::move(*f));
+                f->~F();
+            },
+            [](void* buffer) noexcept { std::launder(reinterpret_cast<F*>(buffer))->~F(); }};
+        return &ops;
+    } else {
+        static constexpr Ops ops{
+            [](void* buffer) { (**reinterpret_cast<F**>(buffer))(); },
+            [](void* src, void* dst) noexcept { new (dst) F*(*reinterpret_cast<F**>(src)); },
+            [](void* buffer) noexcept { delete *reinterpret_cast<F**>(buffer); }};
+        return &ops;
+    }
+}
+
+template <class F, class>
+ThreadPool::Task::Task(F&& f) {
+    using Functor = std::decay_t<F>;
+    if constexpr (isInline<Functor>) {
+        new (buffer_) Functor(std::forward<F>(f));
+    } else {
+        new (buffer_) Functor*(new Functor(std::forward<F>(f)));
+    }
+    ops_ = ops<Functor>();
+}
+
+inline ThreadPool::Task::Task(Task&& rhs) noexcept : ops_{rhs.ops_} {
+    if (ops_) {
+        ops_->move(rhs.buffer_, buffer_);
+        rhs.ops_ = nullptr;
+    }
+}
+
+inline auto ThreadPool::Task::operator=(Task&& rhs) noexcept -> Task& {
+    if (this != &rhs) {
+        reset();
+        if (rhs.ops_) {
+            rhs.ops_->move(rhs.buffer_, buffer_);
+            ops_ = rhs.ops_;
+            rhs.ops_ = nullptr;
+        }
+    }
+    return *this;
+}
+
+inline ThreadPool::Task::~Task() { reset(); }
+
+inline void ThreadPool::Task::reset() noexcept {
+    if (ops_) {
+        ops_->destroy(buffer_);
+        ops_ = nullptr;
+    }
+}
+
 // add new work item to the pool
 template <class F, class... Args>
 auto ThreadPool::enqueue(F&& f, Args&&... args) -> std::future<std::invoke_result_t<F, Args...>> {
     using return_type = std::invoke_result_t<F, Args...>;
 
-    auto task = std::make_shared<std::packaged_task<return_type()>>(
+    std::packaged_task<return_type()> task(
         std::bind(std::forward<F>(f), std::forward<Args>(args)...));
 
-    std::future<return_type> res = task->get_future();
-
-    if (workers.empty()) {
-        (*task)();  // No worker threads, just run the task.
-    } else {
-        std::unique_lock<std::mutex> lock(queue_mutex);
-        tasks.emplace([task]() { (*task)(); });
-    }
-    condition.notify_one();
+    std::future<return_type> res = task.get_future();
+    enqueueRaw([task = std::move(task)]() mutable { task(); });
     return res;
 }
 
@@ -49,6 +49,21 @@ void forEachVoxel(const size3_t dims, C callback) {
     }
 }
 
+/**
+ * Call callback for every voxel position in the box [begin, end).
+ */
+template <typename C>
+void forEachVoxel(const size3_t& begin, const size3_t& end, C callback) {
+    size3_t pos;
+    for (pos.z = begin.z; pos.z < end.z; ++pos.z) {
+        for (pos.y = begin.y; pos.y < end.y; ++pos.y) {
+            for (pos.x = begin.x; pos.x < end.x; ++pos.x) {
+                callback(pos);
+            }
+        }
+    }
+}
+
 template <typename C>
 void forEachVoxel(const VolumeRAM& v, C callback) {
     forEachVoxel(v.getDimensions(), callback);
@@ -35,20 +35,44 @@
 #include <inviwo/core/util/interpolation.h>
 #include <inviwo/core/datastructures/volume/volume.h>
 #include <inviwo/core/datastructures/volume/volumeram.h>
+#include <inviwo/core/datastructures/volume/volumeramprecision.h>
+#include <inviwo/core/datastructures/volume/volumebricked.h>
 
 #include <inviwo/core/util/spatialsampler.h>
 
+#include <array>
+
 namespace inviwo {
 
+/**
+ * The representation a VolumeDoubleSampler reads the voxels from.
+ */
+enum class VolumeSamplerSource {
+    RAM,    //< Sample the VolumeRAM, the whole volume is loaded into memory
+    Bricks  //< Sample through the VolumeBricked if the volume is not in RAM but can be loaded in
+            //< bricks, \see util::getBrickedRepresentation. Otherwise the VolumeRAM is used.
+};
+
 /**
  * \class VolumeDoubleSampler
+ * Samples a volume using trilinear interpolation. By default the VolumeRAM is sampled. Samplers
+ * created with VolumeSamplerSource::Bricks sample volumes that are not in RAM through their
+ * VolumeBricked representation, such that only the bricks that are sampled are loaded. Every
+ * brick lookup goes through the brick cache, which is synchronized, hence the RAM is faster
+ * when the volume fits into memory.
+ *
+ * Batches of positions in a VolumeRAM are sampled with a single dispatch on the data format,
+ * instead of a virtual call per voxel. Batches sampled through bricks reuse the brick of the
+ * previous position when possible.
  */
 template <unsigned int DataDims>
 class VolumeDoubleSampler : public SpatialSampler<3, DataDims, double> {
 public:
     VolumeDoubleSampler(std::shared_ptr<const Volume> vol,
-                        CoordinateSpace space = CoordinateSpace::Data);
-    VolumeDoubleSampler(const Volume& vol, CoordinateSpace space = CoordinateSpace::Data);
+                        CoordinateSpace space = CoordinateSpace::Data,
+                        VolumeSamplerSource source = VolumeSamplerSource::RAM);
+    VolumeDoubleSampler(const Volume& vol, CoordinateSpace space = CoordinateSpace::Data,
+                        VolumeSamplerSource source = VolumeSamplerSource::RAM);
     virtual ~VolumeDoubleSampler() = default;
 
     VolumeDoubleSampler& operator=(const VolumeDoubleSampler&) = default;
@@ -57,9 +81,16 @@ public:
     virtual bool withinBoundsDataSpace(const dvec3& pos) const override;
 
 protected:
+    virtual void sampleDataSpaceBatch(util::span<const dvec3> positions,
+                                      util::span<Vector<DataDims, double>> results) const override;
+    virtual void withinBoundsDataSpaceBatch(util::span<const dvec3> positions,
+                                            util::span<bool> results) const override;
+
     Vector<DataDims, double> getVoxel(const size3_t& pos) const;
+    static Vector<DataDims, double> getVoxel(const VolumeRAM* ram, const size3_t& pos);
 
     std::shared_ptr<const Volume> volume_;
+    const VolumeBricked* bricked_;
     const VolumeRAM* ram_;
     size3_t dims_;
 };
@@ -68,15 +99,19 @@ using VolumeSampler = VolumeDoubleSampler<4>;
 
 template <unsigned int DataDims>
 VolumeDoubleSampler<DataDims>::VolumeDoubleSampler(std::shared_ptr<const Volume> vol,
-                                                   CoordinateSpace space)
-    : VolumeDoubleSampler(*vol, space) {
+                                                   CoordinateSpace space,
+                                                   VolumeSamplerSource source)
+    : VolumeDoubleSampler(*vol, space, source) {
     volume_ = vol;
 }
 
 template <unsigned int DataDims>
-VolumeDoubleSampler<DataDims>::VolumeDoubleSampler(const Volume& vol, CoordinateSpace space)
+VolumeDoubleSampler<DataDims>::VolumeDoubleSampler(const Volume& vol, CoordinateSpace space,
+                                                   VolumeSamplerSource source)
     : SpatialSampler<3, DataDims, double>(vol, space)
-    , ram_(vol.getRepresentation<VolumeRAM>())
+    , bricked_(source == VolumeSamplerSource::Bricks ? util::getBrickedRepresentation(vol)
+                                                     : nullptr)
+    , ram_(bricked_ ? nullptr : vol.getRepresentation<VolumeRAM>())
     , dims_(vol.getDimensions()) {}
 
 template <unsigned int DataDims>
@@ -88,42 +123,147 @@ Vector<DataDims, double> VolumeDoubleSampler<DataDims>::sampleDataSpace(const dv
     const size3_t indexPos = size3_t(samplePos);
     const dvec3 interpolants = samplePos - dvec3(indexPos);
 
+    static const std::array<size3_t, 8> corners{{{0, 0, 0},
+                                                 {1, 0, 0},
+                                                 {0, 1, 0},
+                                                 {1, 1, 0},
+                                                 {0, 0, 1},
+                                                 {1, 0, 1},
+                                                 {0, 1, 1},
+                                                 {1, 1, 1}}};
+
     Vector<DataDims, double> samples[8];
-    samples[0] = getVoxel(indexPos);
-    samples[1] = getVoxel(indexPos + size3_t(1, 0, 0));
-    samples[2] = getVoxel(indexPos + size3_t(0, 1, 0));
-    samples[3] = getVoxel(indexPos + size3_t(1, 1, 0));
+    if (bricked_) {
+        // Usually all corners are within the same brick, then it is only looked up once
+        const auto brick = bricked_->getBrickContaining(indexPos);
+        const auto last = glm::min(indexPos + size3_t(1), dims_ - size3_t(1));
+        if (glm::all(glm::lessThan(last - brick.offset, brick.data->getDimensions()))) {
+            for (size_t i = 0; i < 8; ++i) {
+                const auto p = glm::min(indexPos + corners[i], dims_ - size3_t(1));
+                samples[i] = getVoxel(brick.data.get(), p - brick.offset);
+            }
+            return Interpolation<Vector<DataDims, double>>::trilinear(samples, interpolants);
+        }
+    }
+    for (size_t i = 0; i < 8; ++i) {
+        samples[i] = getVoxel(indexPos + corners[i]);
+    }
+    return Interpolation<Vector<DataDims, double>>::trilinear(samples, interpolants);
+}
 
-    samples[4] = getVoxel(indexPos + size3_t(0, 0, 1));
-    samples[5] = getVoxel(indexPos + size3_t(1, 0, 1));
-    samples[6] = getVoxel(indexPos + size3_t(0, 1, 1));
-    samples[7] = getVoxel(indexPos + size3_t(1, 1, 1));
+template <unsigned int DataDims>
+void VolumeDoubleSampler<DataDims>::sampleDataSpaceBatch(
+    util::span<const dvec3> positions, util::span<Vector<DataDims, double>> results) const {
+    if (bricked_) {
+        const auto last = dims_ - size3_t(1);
+        const auto inBrick = [](const VolumeBricked::Brick& brick, const size3_t& p) {
+            return brick.data && glm::all(glm::greaterThanEqual(p, brick.offset)) &&
+                   glm::all(glm::lessThan(p - brick.offset, brick.data->getDimensions()));
+        };
 
-    return Interpolation<Vector<DataDims, double>>::trilinear(samples, interpolants);
+        // Consecutive positions are usually within the same brick, only look up a new brick
+        // when a position leaves the current one.
+        VolumeBricked::Brick brick;
+        for (size_t i = 0; i < positions.size(); ++i) {
+            const auto& pos = positions[i];
+            if (!VolumeDoubleSampler::withinBoundsDataSpace(pos)) {
+                results[i] = Vector<DataDims, double>(0.0);
+                continue;
+            }
+            const dvec3 samplePos = pos * dvec3(last);
+            const size3_t indexPos = size3_t(samplePos);
+            const dvec3 interpolants = samplePos - dvec3(indexPos);
+
+            if (!inBrick(brick, indexPos)) brick = bricked_->getBrickContaining(indexPos);
+            Vector<DataDims, double> samples[8];
+            if (inBrick(brick, glm::min(indexPos + size3_t(1), last))) {
+                for (size_t c = 0; c < 8; ++c) {
+                    const auto p = glm::min(indexPos + size3_t{c & 1, (c >> 1) & 1, c >> 2}, last);
+                    samples[c] = getVoxel(brick.data.get(), p - brick.offset);
+                }
+            } else {
+                for (size_t c = 0; c < 8; ++c) {
+                    samples[c] = getVoxel(indexPos + size3_t{c & 1, (c >> 1) & 1, c >> 2});
+                }
+            }
+            results[i] = Interpolation<Vector<DataDims, double>>::trilinear(samples, interpolants);
+        }
+        return;
+    }
+
+    ram_->dispatch<void>([&](auto vrprecision) {
+        using ValueType = util::PrecisionValueType<decltype(vrprecision)>;
+        const ValueType* data = vrprecision->getDataTyped();
+        const util::IndexMapper3D im(dims_);
+        const auto last = dims_ - size3_t(1);
+        const auto voxel = [&](const size3_t& p) {
+            return util::glm_convert<Vector<DataDims, double>>(data[im(glm::min(p, last))]);
+        };
+
+        for (size_t i = 0; i < positions.size(); ++i) {
+            const auto& pos = positions[i];
+            if (!VolumeDoubleSampler::withinBoundsDataSpace(pos)) {
+                results[i] = Vector<DataDims, double>(0.0);
+                continue;
+            }
+            const dvec3 samplePos = pos * dvec3(last);
+            const size3_t indexPos = size3_t(samplePos);
+            const dvec3 interpolants = samplePos - dvec3(indexPos);
+
+            const Vector<DataDims, double> samples[8] = {
+                voxel(indexPos),
+                voxel(indexPos + size3_t(1, 0, 0)),
+                voxel(indexPos + size3_t(0, 1, 0)),
+                voxel(indexPos + size3_t(1, 1, 0)),
+                voxel(indexPos + size3_t(0, 0, 1)),
+                voxel(indexPos + size3_t(1, 0, 1)),
+                voxel(indexPos + size3_t(0, 1, 1)),
+                voxel(indexPos + size3_t(1, 1, 1))};
+            results[i] = Interpolation<Vector<DataDims, double>>::trilinear(samples, interpolants);
+        }
+    });
 }
 
-template <>
-inline Vector<1, double> VolumeDoubleSampler<1>::getVoxel(const size3_t& pos) const {
+template <unsigned int DataDims>
+void VolumeDoubleSampler<DataDims>::withinBoundsDataSpaceBatch(util::span<const dvec3> positions,
+                                                               util::span<bool> results) const {
+    for (size_t i = 0; i < positions.size(); ++i) {
+        results[i] = VolumeDoubleSampler::withinBoundsDataSpace(positions[i]);
+    }
+}
+
+template <unsigned int DataDims>
+Vector<DataDims, double> VolumeDoubleSampler<DataDims>::getVoxel(const size3_t& pos) const {
     const auto p = glm::clamp(pos, size3_t(0), dims_ - size3_t(1));
-    return ram_->getAsDouble(p);
+    if (bricked_) {
+        const auto brick = bricked_->getBrickContaining(p);
+        return getVoxel(brick.data.get(), p - brick.offset);
+    }
+    return getVoxel(ram_, p);
 }
 
 template <>
-inline Vector<2, double> VolumeDoubleSampler<2>::getVoxel(const size3_t& pos) const {
-    const auto p = glm::clamp(pos, size3_t(0), dims_ - size3_t(1));
-    return ram_->getAsDVec2(p);
+inline Vector<1, double> VolumeDoubleSampler<1>::getVoxel(const VolumeRAM* ram,
+                                                          const size3_t& pos) {
+    return ram->getAsDouble(pos);
 }
 
 template <>
-inline Vector<3, double> VolumeDoubleSampler<3>::getVoxel(const size3_t& pos) const {
-    const auto p = glm::clamp(pos, size3_t(0), dims_ - size3_t(1));
-    return ram_->getAsDVec3(p);
+inline Vector<2, double> VolumeDoubleSampler<2>::getVoxel(const VolumeRAM* ram,
+                                                          const size3_t& pos) {
+    return ram->getAsDVec2(pos);
 }
 
 template <>
-inline Vector<4, double> VolumeDoubleSampler<4>::getVoxel(const size3_t& pos) const {
-    const auto p = glm::clamp(pos, size3_t(0), dims_ - size3_t(1));
-    return ram_->getAsDVec4(p);
+inline Vector<3, double> VolumeDoubleSampler<3>::getVoxel(const VolumeRAM* ram,
+                                                          const size3_t& pos) {
+    return ram->getAsDVec3(pos);
+}
+
+template <>
+inline Vector<4, double> VolumeDoubleSampler<4>::getVoxel(const VolumeRAM* ram,
+                                                          const size3_t& pos) {
+    return ram->getAsDVec4(pos);
 }
 
 template <unsigned int DataDims>
@@ -33,6 +33,10 @@
 #include <modules/base/basemoduledefine.h>
 #include <inviwo/core/common/inviwo.h>
 #include <modules/base/algorithm/algorithmoptions.h>
+#include <inviwo/core/util/parallelfor.h>
+
+#include <array>
+#include <utility>
 
 namespace inviwo {
 
@@ -66,66 +70,112 @@ IVW_MODULE_BASE_API std::pair<dvec4, dvec4> bufferMinMax(
 
 namespace detail {
 
-// Specialization for double, float, half
-template <typename ValueType,
-          typename std::enable_if<util::is_floating_point<ValueType>::value, int>::type = 0>
-std::pair<dvec4, dvec4> dataMinMax(const ValueType* data, size_t size,
-                                   IgnoreSpecialValues ignore = IgnoreSpecialValues::No) {
-    using Res = std::pair<ValueType, ValueType>;
-    Res minmax{DataFormat<ValueType>::max(), DataFormat<ValueType>::lowest()};
-
-    if (ignore == IgnoreSpecialValues::Yes) {
-        minmax = std::accumulate(
-            data, data + size, minmax, [](const Res& mm, const ValueType& v) -> Res {
-                Res res(mm);
-                for (size_t i = 0; i < util::flat_extent<ValueType>::value; ++i) {
-                    if (util::isfinite(util::glmcomp(v, i))) {
-                        util::glmcomp(res.first, i) =
-                            std::min(util::glmcomp(mm.first, i), util::glmcomp(v, i));
-                        util::glmcomp(res.second, i) =
-                            std::max(util::glmcomp(mm.second, i), util::glmcomp(v, i));
-                    }
-                }
-                return res;
-            });
-    } else {
-        minmax = std::accumulate(data, data + size, minmax,
-                                 [](const Res& mm, const ValueType& v) -> Res {
-                                     return {glm::min(mm.first, v), glm::max(mm.second, v)};
-                                 });
-    }
+// Number of independent accumulators per component. Enough to fill a 256 bit SIMD register with
+// every component type, the loops below are written such that the compiler can vectorize them.
+template <typename C>
+constexpr size_t minMaxLanes = 32 / sizeof(C) > 0 ? 32 / sizeof(C) : 1;
 
-    return {util::glm_convert<dvec4>(minmax.first), util::glm_convert<dvec4>(minmax.second)};
+// Number of values handled by one task
+constexpr size_t minMaxGrain = 64 * 1024;
+
+template <typename C, size_t Extent>
+using MinMax = std::pair<std::array<C, Extent>, std::array<C, Extent>>;
+
+template <typename C, size_t Extent>
+MinMax<C, Extent> emptyMinMax() {
+    MinMax<C, Extent> res;
+    res.first.fill(DataFormat<C>::max());
+    res.second.fill(DataFormat<C>::lowest());
+    return res;
 }
-// Specialization for integer types. They do not have special values
-template <typename ValueType,
-          typename std::enable_if<!util::is_floating_point<ValueType>::value, int>::type = 0>
-std::pair<dvec4, dvec4> dataMinMax(const ValueType* data, size_t size,
-                                   IgnoreSpecialValues = IgnoreSpecialValues::No) {
-    using Res = std::pair<ValueType, ValueType>;
-    Res minmax{DataFormat<ValueType>::max(), DataFormat<ValueType>::lowest()};
-    minmax =
-        std::accumulate(data, data + size, minmax, [](const Res& mm, const ValueType& v) -> Res {
-            return {glm::min(mm.first, v), glm::max(mm.second, v)};
-        });
-
-    return {util::glm_convert<dvec4>(minmax.first), util::glm_convert<dvec4>(minmax.second)};
+
+/**
+ * Component-wise minimum and maximum of \p size values with \p Extent components each, stored as
+ * a flat array of components.
+ */
+template <typename C, size_t Extent, bool IgnoreSpecial>
+MinMax<C, Extent> minMaxBlock(const C* data, size_t size) {
+    // a multiple of Extent, hence lane l always holds component l % Extent
+    constexpr size_t lanes = minMaxLanes<C> * Extent;
+    std::array<C, lanes> mins;
+    std::array<C, lanes> maxs;
+    mins.fill(DataFormat<C>::max());
+    maxs.fill(DataFormat<C>::lowest());
+
+    const auto update = [&](size_t lane, const C v) {
+        if constexpr (IgnoreSpecial) {
+            const bool finite = util::isfinite(v);
+            mins[lane] = finite && v < mins[lane] ? v : mins[lane];
+            maxs[lane] = finite && maxs[lane] < v ? v : maxs[lane];
+        } else {
+            mins[lane] = v < mins[lane] ? v : mins[lane];
+            maxs[lane] = maxs[lane] < v ? v : maxs[lane];
+        }
+    };
+
+    const size_t count = size * Extent;
+    size_t i = 0;
+    for (; i + lanes <= count; i += lanes) {
+        for (size_t lane = 0; lane < lanes; ++lane) update(lane, data[i + lane]);
+    }
+    for (size_t lane = 0; i < count; ++i, ++lane) update(lane, data[i]);
+
+    auto res = emptyMinMax<C, Extent>();
+    for (size_t lane = 0; lane < lanes; ++lane) {
+        auto& mn = res.first[lane % Extent];
+        auto& mx = res.second[lane % Extent];
+        mn = mins[lane] < mn ? mins[lane] : mn;
+        mx = mx < maxs[lane] ? maxs[lane] : mx;
+    }
+    return res;
 }
 
 }  // namespace detail
 
 /**
  * Compute component-wise minimum and maximum values scalar and glm::vec types.
+ * Large arrays are split into blocks that are processed in parallel on the thread pool.
  *
  * @param data pointer to values
  * @param size of data
- * @param ignore infinite and NaN
+ * @param ignore infinite and NaN, only relevant for floating point types
  * @return minimum and maximum values of each component and zero for non-existing components
  */
 template <typename ValueType>
 std::pair<dvec4, dvec4> dataMinMax(const ValueType* data, size_t size,
                                    IgnoreSpecialValues ignore = IgnoreSpecialValues::No) {
-    return detail::dataMinMax<ValueType>(data, size, ignore);
+    using C = typename util::value_type<ValueType>::type;
+    constexpr size_t extent = util::flat_extent<ValueType>::value;
+    using Res = detail::MinMax<C, extent>;
+
+    const auto components = reinterpret_cast<const C*>(data);
+    const auto block = [&](size_t begin, size_t end) -> Res {
+        if constexpr (util::is_floating_point<C>::value) {
+            if (ignore == IgnoreSpecialValues::Yes) {
+                return detail::minMaxBlock<C, extent, true>(components + begin * extent,
+                                                            end - begin);
+            }
+        }
+        return detail::minMaxBlock<C, extent, false>(components + begin * extent, end - begin);
+    };
+    const auto combine = [](const Res& a, const Res& b) {
+        Res res;
+        for (size_t i = 0; i < extent; ++i) {
+            res.first[i] = b.first[i] < a.first[i] ? b.first[i] : a.first[i];
+            res.second[i] = a.second[i] < b.second[i] ? b.second[i] : a.second[i];
+        }
+        return res;
+    };
+    const auto minmax = util::parallelReduce(size, detail::emptyMinMax<C, extent>(), block,
+                                             combine, detail::minMaxGrain);
+
+    ValueType min{};
+    ValueType max{};
+    for (size_t i = 0; i < extent; ++i) {
+        util::glmcomp(min, i) = minmax.first[i];
+        util::glmcomp(max, i) = minmax.second[i];
+    }
+    return {util::glm_convert<dvec4>(min), util::glm_convert<dvec4>(max)};
 }
 
 }  // namespace util
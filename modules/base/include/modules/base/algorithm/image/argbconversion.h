@@ -0,0 +1,89 @@
+/*********************************************************************************
+ *
+ * Inviwo - Interactive Visualization Workshop
+ *
+ * Copyright (c) 2021 Inviwo Foundation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************************/
+
+#pragma once
+
+#include <modules/base/basemoduledefine.h>
+
+#include <inviwo/core/datastructures/image/layerramprecision.h>
+#include <inviwo/core/util/glm.h>
+
+#include <cstdint>
+
+namespace inviwo {
+
+namespace util {
+
+/**
+ * \brief convert a row of packed ARGB pixels into RGB
+ *
+ * Each source pixel is a uint32_t with alpha in the most significant byte followed by red, green,
+ * and blue, as returned by OpenSlide and Cairo.
+ *
+ * @param src      source pixels
+ * @param dst      destination pixels
+ * @param count    number of pixels to convert
+ * @param unpremultiply   if true, the color channels of src are assumed to be premultiplied by
+ *                        alpha and are divided by alpha
+ */
+IVW_MODULE_BASE_API void argbToRGB(const uint32_t* src, glm::u8vec3* dst, size_t count,
+                                   bool unpremultiply = true);
+
+/**
+ * \brief convert a row of packed ARGB pixels into RGBA
+ * @see argbToRGB
+ */
+IVW_MODULE_BASE_API void argbToRGBA(const uint32_t* src, glm::u8vec4* dst, size_t count,
+                                    bool unpremultiply = true);
+
+/**
+ * \brief convert an image of packed ARGB pixels into a RGB layer representation
+ *
+ * The rows of \p src are stored from the top and are written bottom-up into \p dst to match the
+ * row order of Inviwo layers. The rows are split into blocks which are converted on the
+ * application thread pool, if available.
+ *
+ * @param src      source pixels, must hold the same number of pixels as \p dst
+ * @param dst      destination layer
+ * @param unpremultiply   if true, the color channels of src are divided by alpha
+ * @see argbToRGB
+ */
+IVW_MODULE_BASE_API void argbToLayer(const uint32_t* src, LayerRAMPrecision<glm::u8vec3>& dst,
+                                     bool unpremultiply = true);
+
+/**
+ * \brief convert an image of packed ARGB pixels into a RGBA layer representation
+ * @see argbToLayer
+ */
+IVW_MODULE_BASE_API void argbToLayer(const uint32_t* src, LayerRAMPrecision<glm::u8vec4>& dst,
+                                     bool unpremultiply = true);
+
+}  // namespace util
+
+}  // namespace inviwo
@@ -39,9 +39,14 @@
 #include <inviwo/core/util/exception.h>
 
 #include <array>
+#include <vector>
 
 namespace inviwo {
 
+namespace marching {
+class BrickRanges;
+}
+
 namespace util {
 
 /**
@@ -49,6 +54,10 @@ namespace util {
  *
  * Note: Shares interface with util::marchingcbes and util::marchingtetrahedron
  * This is an optimized version of util::marchingcubes
+ * Volumes that are not loaded into RAM but can be loaded in bricks are processed one layer of
+ * bricks at a time, unless enclose is set. \see util::getBrickedRepresentation
+ * Volumes in RAM are split into z-slabs that are processed in parallel on the thread pool, the
+ * resulting mesh is the same as for a serial run. \see marching::marchingCubesSlabs
  *
  * @param volume the scalar volume
  * @param iso iso-value for the extracted surface
@@ -60,12 +69,15 @@ namespace util {
  * interval [0,1], useful for progress bars
  * @param maskingCallback optional callback to test whether current cell should be evaluated or not
  * (return true to include current cell)
+ * @param ranges optional brick ranges of the volume, only the bricks that can intersect the iso
+ * surface are visited. The mesh is the same as without ranges. \see marching::BrickRanges
  */
 
 IVW_MODULE_BASE_API std::shared_ptr<Mesh> marchingCubesOpt(
     std::shared_ptr<const Volume> volume, double iso, const vec4& color, bool invert, bool enclose,
     std::function<void(float)> progressCallback = nullptr,
-    std::function<bool(const size3_t&)> maskingCallback = nullptr);
+    std::function<bool(const size3_t&)> maskingCallback = nullptr,
+    const marching::BrickRanges* ranges = nullptr);
 }  // namespace util
 
 namespace marching {
@@ -161,6 +173,61 @@ struct IVW_MODULE_BASE_API Config {
     const std::array<std::array<size_t, 8>, 256> caseIncrements;
 };
 
+/**
+ * Same as util::marchingCubesOpt but with the cells of the volume split into \p slabs z-slabs
+ * that are marched in parallel on the thread pool. Each slab deduplicates its own vertices and the
+ * vertices on the planes between slabs are welded when the slabs are merged, hence without a
+ * masking callback the mesh is identical for any number of slabs. util::marchingCubesOpt uses
+ * one slab per block of util::parallelBlockCount for volumes in RAM.
+ */
+IVW_MODULE_BASE_API std::shared_ptr<Mesh> marchingCubesSlabs(
+    std::shared_ptr<const Volume> volume, double iso, const vec4& color, bool invert, bool enclose,
+    size_t slabs, std::function<void(float)> progressCallback = nullptr,
+    std::function<bool(const size3_t&)> maskingCallback = nullptr,
+    const BrickRanges* ranges = nullptr);
+
+/**
+ * The value range of bricks of cells of a scalar volume. A cell only intersects an iso surface if
+ * the iso value is within the range of its brick, hence marching cubes can skip all other bricks.
+ * Build it once per volume and reuse it for extractions where only the iso value changes.
+ * Bricks of a volume that is not in RAM are read one layer of bricks at a time.
+ * \see util::marchingCubesOpt
+ */
+class IVW_MODULE_BASE_API BrickRanges {
+public:
+    /// The number of cells along each side of a brick
+    static constexpr size_t brickSize = 8;
+
+    explicit BrickRanges(const Volume& volume);
+
+    /// The dimensions of the volume in voxels
+    const size3_t& getDimensions() const { return dims_; }
+    /// The number of bricks along each axis
+    const size3_t& getBrickCount() const { return bricks_; }
+
+    /**
+     * The min and max value of the voxels at the corners of the cells of \p brick. Bricks with
+     * NaN values have the range [-inf, inf].
+     */
+    const dvec2& getRange(const size3_t& brick) const {
+        return ranges_[brick.x + bricks_.x * (brick.y + bricks_.y * brick.z)];
+    }
+
+    /// Whether \p iso is within the range of \p brick
+    bool contains(const size3_t& brick, double iso) const {
+        const auto& range = getRange(brick);
+        return range.x <= iso && iso <= range.y;
+    }
+
+    /// The number of bricks with \p iso within their range
+    size_t count(double iso) const;
+
+private:
+    size3_t dims_;
+    size3_t bricks_;
+    std::vector<dvec2> ranges_;
+};
+
 }  // namespace marching
 
 }  // namespace inviwo
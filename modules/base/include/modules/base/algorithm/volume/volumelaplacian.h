@@ -34,6 +34,7 @@
 #include <inviwo/core/common/inviwo.h>
 #include <inviwo/core/datastructures/volume/volume.h>
 #include <inviwo/core/util/volumeramutils.h>
+#include <inviwo/core/util/parallelfor.h>
 #include <inviwo/core/util/indexmapper.h>
 #include <inviwo/core/util/templatesampler.h>
 
@@ -86,10 +87,10 @@ std::shared_ptr<Volume> VolumeLaplacianDispatcher::operator()(
     const auto resDim = dvec3(1.0) / dvec3(volume->getDimensions() - size3_t(1));
     const auto resSpace2 = dvec3(1.0) / (spacing * spacing);
 
-    auto minval(std::numeric_limits<double>::max());
-    auto maxval(std::numeric_limits<double>::lowest());
+    const dvec2 emptyRange{std::numeric_limits<double>::max(),
+                           std::numeric_limits<double>::lowest()};
 
-    auto func = [&](const size3_t& pos) {
+    auto func = [&](const size3_t& pos, dvec2& range) {
         const dvec3 world{m * dvec4((dvec3(pos) + dvec3(0.5)) * resDim, 1.0)};
 
         const auto center = 2.0 * s.sample(world);
@@ -99,42 +100,54 @@ std::shared_ptr<Volume> VolumeLaplacianDispatcher::operator()(
         const auto laplacian = center + D2x + D2y + D2z;
 
         for (size_t i = 0; i < comp; ++i) {
-            minval = glm::min(minval, util::glmcomp(laplacian, i));
-            maxval = glm::max(maxval, util::glmcomp(laplacian, i));
+            range.x = glm::min(range.x, util::glmcomp(laplacian, i));
+            range.y = glm::max(range.y, util::glmcomp(laplacian, i));
         }
         newData[index(pos)] = static_cast<R>(laplacian);
     };
 
-    util::forEachVoxelParallel(*volume->getRepresentation<VolumeRAM>(), func);
+    const auto minMax = util::parallelReduce(
+        volume->getDimensions(), emptyRange,
+        [&](const size3_t& begin, const size3_t& end) {
+            dvec2 range = emptyRange;
+            util::forEachVoxel(begin, end, [&](const size3_t& pos) { func(pos, range); });
+            return range;
+        },
+        [](const dvec2& r1, const dvec2& r2) {
+            return dvec2{std::min(r1.x, r2.x), std::max(r1.y, r2.y)};
+        },
+        util::Blocking::Bricks);
 
     // Make range symmetric
-    auto rangemax = std::max(std::abs(minval), std::abs(maxval));
+    auto rangemax = std::max(std::abs(minMax.x), std::abs(minMax.y));
+
+    const auto transform = [&](auto op) {
+        util::parallelFor(volume->getDimensions(), [&](const size3_t& begin, const size3_t& end) {
+            util::forEachVoxel(begin, end, [&](const size3_t& pos) {
+                newData[index(pos)] = op(newData[index(pos)]);
+            });
+        });
+    };
 
     switch (postProcessing) {
         case VolumeLaplacianPostProcessing::Normalized:
-            util::forEachVoxelParallel(
-                *volume->getRepresentation<VolumeRAM>(), [&](const size3_t& pos) {
-                    newData[index(pos)] = (newData[index(pos)] + R{static_cast<float>(rangemax)}) /
-                                          R{static_cast<float>(2.0 * rangemax)};
-                });
+            transform([&](const R& v) {
+                return (v + R{static_cast<float>(rangemax)}) /
+                       R{static_cast<float>(2.0 * rangemax)};
+            });
             newVolume->dataMap_.dataRange = dvec2(0.0, 1.0);
             newVolume->dataMap_.valueRange = dvec2(0.0, 1.0);
             break;
         case VolumeLaplacianPostProcessing::SignNormalized:
-            util::forEachVoxelParallel(
-                *volume->getRepresentation<VolumeRAM>(), [&](const size3_t& pos) {
-                    newData[index(pos)] = (newData[index(pos)] + R{static_cast<float>(rangemax)}) /
-                                              R{static_cast<float>(rangemax)} -
-                                          R{1.0f};
-                });
+            transform([&](const R& v) {
+                return (v + R{static_cast<float>(rangemax)}) / R{static_cast<float>(rangemax)} -
+                       R{1.0f};
+            });
             newVolume->dataMap_.dataRange = dvec2(-1.0, 1.0);
             newVolume->dataMap_.valueRange = dvec2(-1.0, 1.0);
             break;
         case VolumeLaplacianPostProcessing::Scaled:
-            util::forEachVoxelParallel(
-                *volume->getRepresentation<VolumeRAM>(), [&](const size3_t& pos) {
-                    newData[index(pos)] = newData[index(pos)] * R{static_cast<float>(scale)};
-                });
+            transform([&](const R& v) { return v * R{static_cast<float>(scale)}; });
             newVolume->dataMap_.dataRange = dvec2(-rangemax * scale, rangemax * scale);
             newVolume->dataMap_.valueRange = dvec2(-rangemax * scale, rangemax * scale);
             break;
@@ -37,6 +37,11 @@ namespace inviwo {
 
 class IVW_MODULE_BASE_API VolumeRAMSubSet {
 public:
+    /**
+     * Extract the sub volume [offset, offset + dim) with the given borders from \p in, which can
+     * be a VolumeRAM or a VolumeBricked. For a VolumeBricked only the overlapping bricks are
+     * loaded.
+     */
     static std::shared_ptr<VolumeRAM> apply(const VolumeRepresentation* in, size3_t dim,
                                             size3_t offset,
                                             const VolumeBorders& border = VolumeBorders(),
@@ -0,0 +1,117 @@
+/*********************************************************************************
+ *
+ * Inviwo - Interactive Visualization Workshop
+ *
+ * Copyright (c) 2021 Inviwo Foundation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************************/
+
+#pragma once
+
+#include <modules/base/basemoduledefine.h>
+#include <inviwo/core/datastructures/volume/volumeramprecision.h>
+#include <inviwo/core/util/glm.h>
+#include <inviwo/core/util/parallelfor.h>
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace inviwo {
+
+namespace util {
+
+/**
+ * \brief find files with identical content
+ *
+ * Files are first compared by path and size. Files with equal size are then compared by a 64-bit
+ * hash of their content, which is computed in parallel. Files with matching hashes are compared
+ * byte by byte before they are considered identical.
+ *
+ * @param files   list of file paths
+ * @return for each file the index of the first file with identical content, i.e. `result[i] == i`
+ *         for every distinct file
+ */
+IVW_MODULE_BASE_API std::vector<size_t> findDuplicateFiles(const std::vector<std::string>& files);
+
+/**
+ * \brief assemble a volume from a stack of slices, decoding each distinct source once
+ *
+ * The volume is allocated up front and the distinct sources are decoded in parallel directly into
+ * their z-slice. Slices that share a source are copied from the decoded slice afterwards.
+ *
+ * @param sliceDims    dimensions of each slice
+ * @param sliceSources the source index of each slice, see findDuplicateFiles. The number of
+ *                     slices in the volume equals the size of this vector.
+ * @param decode       `bool(size_t source, T* dst)`, writes the slice of \p source into \p dst
+ *                     which holds `sliceDims.x * sliceDims.y` values. Returning false leaves an
+ *                     empty slice.
+ */
+template <typename T>
+std::shared_ptr<VolumeRAMPrecision<T>> stackSlices(
+    size2_t sliceDims, const std::vector<size_t>& sliceSources,
+    const std::function<bool(size_t source, T* dst)>& decode) {
+
+    const size_t sliceSize = glm::compMul(sliceDims);
+    auto volumeRAM =
+        std::make_shared<VolumeRAMPrecision<T>>(size3_t{sliceDims, sliceSources.size()});
+    T* data = volumeRAM->getDataTyped();
+
+    // the first slice referring to each distinct source
+    std::vector<size_t> firstSlice;
+    for (size_t z = 0; z < sliceSources.size(); ++z) {
+        const auto first = std::find(sliceSources.begin(), sliceSources.end(), sliceSources[z]);
+        if (static_cast<size_t>(first - sliceSources.begin()) == z) firstSlice.push_back(z);
+    }
+
+    util::parallelFor(firstSlice.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const auto z = firstSlice[i];
+            T* dst = data + z * sliceSize;
+            if (!decode(sliceSources[z], dst)) {
+                std::fill(dst, dst + sliceSize, T{0});
+            }
+        }
+    });
+
+    util::parallelFor(sliceSources.size(), [&](size_t begin, size_t end) {
+        for (size_t z = begin; z < end; ++z) {
+            const auto first =
+                std::find(sliceSources.begin(), sliceSources.end(), sliceSources[z]) -
+                sliceSources.begin();
+            if (static_cast<size_t>(first) != z) {
+                std::memcpy(data + z * sliceSize, data + first * sliceSize, sliceSize * sizeof(T));
+            }
+        }
+    });
+
+    return volumeRAM;
+}
+
+}  // namespace util
+
+}  // namespace inviwo
@@ -43,6 +43,19 @@
 namespace inviwo {
 namespace util {
 
+/**
+ * Strategy used by voronoiSegmentation to find the closest seed point of each voxel.
+ */
+enum class VoronoiMethod {
+    /// Finds the closest seed point through a uniform grid over the seed points. The result is
+    /// identical to comparing each voxel against every seed point.
+    Exact,
+    /// Propagates the closest seed points over the voxel grid using jump flooding. The cost does
+    /// not depend on the number of seed points or on their weights, but voxels close to the
+    /// border between two cells might get the index of a neighboring seed point.
+    JumpFlooding
+};
+
 /**
  * Implementation of Voronoi segmentation.
  *
@@ -58,12 +71,13 @@ namespace util {
  *     * wrapping the wrapping mode of the volume, @see Wrapping3D.
  *     * weigths is an optional vector containing the weights for each seed point. If set the
  *       weighted version of voronoi should be used.
+ *     * method the strategy used to find the closest seed point, @see VoronoiMethod.
  */
 
 IVW_MODULE_BASE_API std::shared_ptr<Volume> voronoiSegmentation(
     const size3_t volumeDimensions, const mat4& indexToModelMatrix,
     const std::vector<std::pair<uint32_t, vec3>>& seedPointsWithIndices, const Wrapping3D& wrapping,
-    const std::optional<std::vector<float>>& weights);
+    const std::optional<std::vector<float>>& weights, VoronoiMethod method = VoronoiMethod::Exact);
 
 }  // namespace util
 }  // namespace inviwo
@@ -0,0 +1,351 @@
+/*********************************************************************************
+ *
+ * Inviwo - Interactive Visualization Workshop
+ *
+ * Copyright (c) 2021 Inviwo Foundation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************************/
+
+#pragma once
+
+#include <modules/base/basemoduledefine.h>
+
+#include <inviwo/core/util/glm.h>
+#include <inviwo/core/util/exception.h>
+#include <inviwo/core/util/parallelfor.h>
+
+#include <tcb/span.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+namespace inviwo {
+
+/**
+ * \class FlatKDTree
+ * A static kd-tree built in bulk from a set of points. Unlike KDTree, which allocates a node per
+ * inserted point, the tree is stored implicitly in two flat arrays: the points are reordered such
+ * that the node of the range [begin, end) is the median at begin + (end - begin) / 2, split along
+ * the dimension of the largest extent of the range. The points before the median are in the
+ * left subtree and the points after it in the right subtree. Ranges of at most LeafSize points
+ * are leafs that are searched linearly.
+ *
+ * The tree is built in parallel using the application thread pool. The queries do not allocate,
+ * the results are written to buffers provided by the caller. Results are indices into the
+ * reordered points, use getPosition and getData to look up the point and its data. By default the
+ * data is the index of the point in the input.
+ *
+ * \code{.cpp}
+ * FlatKDTree<3> tree{points};
+ * std::array<size_t, 8> nearest;
+ * std::array<double, 8> sqDist;
+ * const auto found = tree.findNNearest(pos, nearest, sqDist);
+ * for (size_t i = 0; i < found; ++i) {
+ *     const auto inputIndex = tree.getData(nearest[i]);
+ * }
+ * \endcode
+ */
+template <unsigned int N, typename T = size_t, typename P = double>
+class FlatKDTree {
+public:
+    using Point = Vector<N, P>;
+    static constexpr size_t LeafSize = 8;
+    static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+    FlatKDTree() = default;
+    /**
+     * Build a tree from \p points, where the data of each point is its index in \p points
+     */
+    explicit FlatKDTree(std::vector<Point> points);
+    /**
+     * Build a tree from \p points with the corresponding \p data
+     * @throw RangeException if \p points and \p data differ in size
+     */
+    FlatKDTree(std::vector<Point> points, std::vector<T> data);
+
+    size_t size() const { return points_.size(); }
+    bool empty() const { return points_.empty(); }
+
+    const Point& getPosition(size_t index) const { return points_[index]; }
+    const T& getData(size_t index) const { return data_[index]; }
+    /**
+     * The points in tree order, the index of a point in this vector is its index in the tree
+     */
+    const std::vector<Point>& getPositions() const { return points_; }
+    const std::vector<T>& getData() const { return data_; }
+
+    /**
+     * Find the point closest to \p pos
+     * @return the index of the closest point, or npos if the tree is empty
+     */
+    size_t findNearest(const Point& pos) const;
+
+    /**
+     * Find the indices.size() points closest to \p pos, sorted by increasing distance.
+     * @param pos          the query position
+     * @param indices      receives the indices of the closest points
+     * @param sqDistances  receives the squared distances of the points, has to be at least as
+     *                     large as \p indices
+     * @return the number of points found, the smaller of indices.size() and size()
+     */
+    size_t findNNearest(const Point& pos, util::span<size_t> indices,
+                        util::span<P> sqDistances) const;
+
+    /**
+     * Call `callback(index, sqDistance)` for each point within \p radius of \p pos, in no
+     * particular order
+     */
+    template <typename Callback>
+    void forEachWithinRadius(const Point& pos, P radius, Callback&& callback) const;
+
+    /**
+     * Replace the contents of \p indices with the indices of the points within \p radius of
+     * \p pos, in no particular order. Reuse \p indices between queries to avoid allocations.
+     */
+    void findWithinRadius(const Point& pos, P radius, std::vector<size_t>& indices) const;
+
+private:
+    static P sqDistance(const Point& a, const Point& b);
+    static size_t median(size_t begin, size_t end) { return begin + (end - begin) / 2; }
+
+    struct Entry {
+        Point pos;
+        size_t index;
+    };
+    /**
+     * Split the range [begin, end) of \p entries at its median, along its widest dimension
+     */
+    void build(const std::vector<Point>& points, std::vector<T>& data);
+    void partition(std::vector<Entry>& entries, size_t begin, size_t end);
+    void buildSubtree(std::vector<Entry>& entries, size_t begin, size_t end);
+
+    struct Neighbors {
+        util::span<size_t> indices;
+        util::span<P> sqDistances;
+        size_t count;
+        P worst() const {
+            return count < indices.size() ? std::numeric_limits<P>::max() : sqDistances[count - 1];
+        }
+        void add(size_t index, P sqDist);
+    };
+    void findNNearest(const Point& pos, size_t begin, size_t end, Neighbors& neighbors) const;
+
+    template <typename Callback>
+    void forEachWithinRadius(const Point& pos, P sqRadius, size_t begin, size_t end,
+                             Callback& callback) const;
+
+    std::vector<Point> points_;
+    std::vector<T> data_;
+    std::vector<unsigned char> splitDims_;  //!< the split dimension of each median
+};
+
+template <unsigned int N, typename T, typename P>
+FlatKDTree<N, T, P>::FlatKDTree(std::vector<Point> points) {
+    std::vector<T> data(points.size());
+    std::iota(data.begin(), data.end(), T{0});
+    build(points, data);
+}
+
+template <unsigned int N, typename T, typename P>
+FlatKDTree<N, T, P>::FlatKDTree(std::vector<Point> points, std::vector<T> data) {
+    if (points.size() != data.size()) {
+        throw RangeException("FlatKDTree: points and data differ in size", IVW_CONTEXT);
+    }
+    build(points, data);
+}
+
+template <unsigned int N, typename T, typename P>
+void FlatKDTree<N, T, P>::build(const std::vector<Point>& points, std::vector<T>& data) {
+    splitDims_.assign(points.size(), 0);
+    std::vector<Entry> entries(points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+        entries[i] = Entry{points[i], i};
+    }
+
+    // Split the top levels one level at a time, with the ranges of each level in parallel, until
+    // there are enough independent subtrees to build them in parallel.
+    std::vector<std::pair<size_t, size_t>> ranges{{0, entries.size()}};
+    std::vector<std::pair<size_t, size_t>> next;
+    const size_t tasks = util::parallelBlockCount(entries.size() / LeafSize + 1);
+    while (!ranges.empty() && ranges.size() < tasks) {
+        util::parallelFor(ranges.size(), [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                partition(entries, ranges[i].first, ranges[i].second);
+            }
+        });
+        next.clear();
+        for (const auto& [begin, end] : ranges) {
+            if (end - begin <= LeafSize) continue;
+            next.emplace_back(begin, median(begin, end));
+            next.emplace_back(median(begin, end) + 1, end);
+        }
+        std::swap(ranges, next);
+    }
+    util::parallelFor(ranges.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            buildSubtree(entries, ranges[i].first, ranges[i].second);
+        }
+    });
+
+    points_.resize(entries.size());
+    data_.resize(entries.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        points_[i] = entries[i].pos;
+        data_[i] = std::move(data[entries[i].index]);
+    }
+}
+
+template <unsigned int N, typename T, typename P>
+void FlatKDTree<N, T, P>::partition(std::vector<Entry>& entries, size_t begin, size_t end) {
+    if (end - begin <= LeafSize) return;
+
+    Point min{entries[begin].pos};
+    Point max{entries[begin].pos};
+    for (size_t i = begin + 1; i < end; ++i) {
+        min = glm::min(min, entries[i].pos);
+        max = glm::max(max, entries[i].pos);
+    }
+    const auto extent = max - min;
+    unsigned char dim = 0;
+    for (unsigned char d = 1; d < N; ++d) {
+        if (extent[d] > extent[dim]) dim = d;
+    }
+
+    const auto mid = median(begin, end);
+    std::nth_element(entries.begin() + begin, entries.begin() + mid, entries.begin() + end,
+                     [dim](const Entry& a, const Entry& b) { return a.pos[dim] < b.pos[dim]; });
+    splitDims_[mid] = dim;
+}
+
+template <unsigned int N, typename T, typename P>
+void FlatKDTree<N, T, P>::buildSubtree(std::vector<Entry>& entries, size_t begin, size_t end) {
+    if (end - begin <= LeafSize) return;
+    partition(entries, begin, end);
+    const auto mid = median(begin, end);
+    buildSubtree(entries, begin, mid);
+    buildSubtree(entries, mid + 1, end);
+}
+
+template <unsigned int N, typename T, typename P>
+P FlatKDTree<N, T, P>::sqDistance(const Point& a, const Point& b) {
+    const auto d = a - b;
+    return glm::dot(d, d);
+}
+
+template <unsigned int N, typename T, typename P>
+size_t FlatKDTree<N, T, P>::findNearest(const Point& pos) const {
+    size_t index = npos;
+    P sqDist = 0;
+    findNNearest(pos, util::span<size_t>(&index, 1), util::span<P>(&sqDist, 1));
+    return index;
+}
+
+template <unsigned int N, typename T, typename P>
+size_t FlatKDTree<N, T, P>::findNNearest(const Point& pos, util::span<size_t> indices,
+                                         util::span<P> sqDistances) const {
+    Neighbors neighbors{indices, sqDistances, 0};
+    if (!indices.empty()) findNNearest(pos, 0, points_.size(), neighbors);
+    return neighbors.count;
+}
+
+template <unsigned int N, typename T, typename P>
+void FlatKDTree<N, T, P>::Neighbors::add(size_t index, P sqDist) {
+    if (sqDist >= worst()) return;
+    // Insertion sort into the sorted buffer, dropping the farthest point when it is full
+    size_t i = count < indices.size() ? count++ : count - 1;
+    for (; i > 0 && sqDistances[i - 1] > sqDist; --i) {
+        indices[i] = indices[i - 1];
+        sqDistances[i] = sqDistances[i - 1];
+    }
+    indices[i] = index;
+    sqDistances[i] = sqDist;
+}
+
+template <unsigned int N, typename T, typename P>
+void FlatKDTree<N, T, P>::findNNearest(const Point& pos, size_t begin, size_t end,
+                                       Neighbors& neighbors) const {
+    if (end - begin <= LeafSize) {
+        for (size_t i = begin; i < end; ++i) {
+            neighbors.add(i, sqDistance(pos, points_[i]));
+        }
+        return;
+    }
+    const auto mid = median(begin, end);
+    const auto dim = splitDims_[mid];
+    const P diff = pos[dim] - points_[mid][dim];
+    neighbors.add(mid, sqDistance(pos, points_[mid]));
+
+    if (diff < 0) {
+        findNNearest(pos, begin, mid, neighbors);
+        if (diff * diff < neighbors.worst()) findNNearest(pos, mid + 1, end, neighbors);
+    } else {
+        findNNearest(pos, mid + 1, end, neighbors);
+        if (diff * diff < neighbors.worst()) findNNearest(pos, begin, mid, neighbors);
+    }
+}
+
+template <unsigned int N, typename T, typename P>
+template <typename Callback>
+void FlatKDTree<N, T, P>::forEachWithinRadius(const Point& pos, P radius,
+                                              Callback&& callback) const {
+    if (points_.empty()) return;
+    forEachWithinRadius(pos, radius * radius, 0, points_.size(), callback);
+}
+
+template <unsigned int N, typename T, typename P>
+template <typename Callback>
+void FlatKDTree<N, T, P>::forEachWithinRadius(const Point& pos, P sqRadius, size_t begin,
+                                              size_t end, Callback& callback) const {
+    if (end - begin <= LeafSize) {
+        for (size_t i = begin; i < end; ++i) {
+            const auto sqDist = sqDistance(pos, points_[i]);
+            if (sqDist <= sqRadius) callback(i, sqDist);
+        }
+        return;
+    }
+    const auto mid = median(begin, end);
+    const auto dim = splitDims_[mid];
+    const P diff = pos[dim] - points_[mid][dim];
+    const auto sqDist = sqDistance(pos, points_[mid]);
+    if (sqDist <= sqRadius) callback(mid, sqDist);
+
+    if (diff <= 0 || diff * diff <= sqRadius) {
+        forEachWithinRadius(pos, sqRadius, begin, mid, callback);
+    }
+    if (diff >= 0 || diff * diff <= sqRadius) {
+        forEachWithinRadius(pos, sqRadius, mid + 1, end, callback);
+    }
+}
+
+template <unsigned int N, typename T, typename P>
+void FlatKDTree<N, T, P>::findWithinRadius(const Point& pos, P radius,
+                                           std::vector<size_t>& indices) const {
+    indices.clear();
+    forEachWithinRadius(pos, radius, [&](size_t index, P) { indices.push_back(index); });
+}
+
+}  // namespace inviwo
@@ -0,0 +1,150 @@
+/*********************************************************************************
+ *
+ * Inviwo - Interactive Visualization Workshop
+ *
+ * Copyright (c) 2021 Inviwo Foundation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************************/
+
+#pragma once
+
+#include <modules/base/basemoduledefine.h>
+#include <inviwo/core/common/inviwo.h>
+#include <inviwo/core/util/glm.h>
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+typedef struct _openslide openslide_t;
+
+namespace inviwo {
+
+/**
+ * \ingroup datastructures
+ * A tiled, multi-resolution cache in front of OpenSlide. Regions of a whole-slide image are
+ * assembled from fixed-size tiles keyed by (slide, level, tileX, tileY). Tiles are kept in
+ * least-recently-used order and evicted once the total size exceeds the memory budget, hence
+ * panning or resizing a region only reads the tiles that are not already cached. Open slide
+ * handles are kept for the lifetime of the cache.
+ *
+ * All functions are thread safe.
+ */
+class IVW_MODULE_BASE_API SlideTileCache {
+public:
+    static constexpr size_t defaultMemoryBudget = 256 * 1024 * 1024;
+    static constexpr int64_t defaultTileSize = 512;
+
+    struct SlideInfo {
+        std::vector<i64vec2> levelDimensions;
+        std::vector<double> levelDownsamples;
+
+        int32_t getLevelCount() const { return static_cast<int32_t>(levelDimensions.size()); }
+    };
+
+    explicit SlideTileCache(size_t memoryBudget = defaultMemoryBudget,
+                            int64_t tileSize = defaultTileSize);
+    SlideTileCache(const SlideTileCache&) = delete;
+    SlideTileCache& operator=(const SlideTileCache&) = delete;
+    ~SlideTileCache();
+
+    /**
+     * Level count, dimensions, and downsample factors of \p slide. Opens the slide if needed.
+     * @throw Exception if the slide cannot be opened
+     */
+    SlideInfo getSlideInfo(const std::string& slide);
+
+    /**
+     * Fill \p dest with a \p size region of \p slide at \p level, same as openslide_read_region.
+     * The pixels are premultiplied ARGB, stored row by row from the top. \p dest must hold
+     * size.x * size.y values.
+     * @param slide    path of the slide
+     * @param origin   top left corner of the region in level 0 coordinates
+     * @param level    pyramid level to read from
+     * @param size     region size in pixels of \p level
+     * @param dest     output buffer
+     * @param stop     optional callback, checked before each tile is read. If it returns true the
+     *                 read is aborted and the content of \p dest is undefined.
+     * @return false if the read was aborted, true otherwise
+     * @throw Exception if the slide cannot be opened or read
+     */
+    bool readRegion(const std::string& slide, i64vec2 origin, int32_t level, i64vec2 size,
+                    uint32_t* dest, const std::function<bool()>& stop = nullptr);
+
+    void setMemoryBudget(size_t bytes);
+    size_t getMemoryBudget() const;
+    size_t getMemoryUsage() const;
+    int64_t getTileSize() const;
+
+    /**
+     * Remove all tiles and close all slides
+     */
+    void clear();
+
+private:
+    struct TileKey {
+        std::string slide;
+        int32_t level;
+        i64vec2 tile;
+
+        bool operator==(const TileKey& rhs) const {
+            return level == rhs.level && tile == rhs.tile && slide == rhs.slide;
+        }
+    };
+    struct TileKeyHash {
+        size_t operator()(const TileKey& key) const;
+    };
+    using Tile = std::vector<uint32_t>;
+    using LRUList = std::list<std::pair<TileKey, std::shared_ptr<const Tile>>>;
+
+    struct Slide {
+        std::shared_ptr<openslide_t> handle;
+        SlideInfo info;
+    };
+
+    // Requires mutex_ to be locked
+    const Slide& getSlide(const std::string& slide);
+    void evict();
+
+    std::shared_ptr<const Tile> findTile(const TileKey& key);
+    std::shared_ptr<const Tile> readTile(openslide_t* handle, const TileKey& key,
+                                         double downsample) const;
+    std::shared_ptr<const Tile> insert(const TileKey& key, std::shared_ptr<const Tile> tile);
+
+    mutable std::mutex mutex_;
+    int64_t tileSize_;
+    size_t memoryBudget_;
+    size_t memoryUsage_ = 0;
+
+    std::unordered_map<std::string, Slide> slides_;
+    LRUList lru_;  // most recently used first
+    std::unordered_map<TileKey, LRUList::iterator, TileKeyHash> tiles_;
+};
+
+}  // namespace inviwo
@@ -34,7 +34,7 @@
 #include <inviwo/core/ports/datainport.h>
 #include <inviwo/core/datastructures/volume/volume.h>
 
-#include <inviwo/core/processors/processor.h>
+#include <inviwo/core/processors/poolprocessor.h>
 #include <inviwo/core/ports/volumeport.h>
 
 #include <inviwo/core/properties/boolproperty.h>
@@ -44,7 +44,7 @@
 #include <inviwo/core/properties/ordinalproperty.h>
 #include <modules/base/properties/basisproperty.h>
 #include <modules/base/properties/volumeinformationproperty.h>
-#include <modules/base/properties/toojpeg.h>
+#include <modules/base/datastructures/slidetilecache.h>
 #include <inviwo/core/util/glm.h>
 
 #include <vector>
@@ -62,20 +62,17 @@ class DataReaderFactory;
  * Refer to the supporting documentation for more information : https://agam-kashyap.notion.site/3D-Histopathology-using-Inviwo-and-OpenSlide-253b21f7f66a47e786ab83b2630f23d8
  * ![](org.inviwo.ImageStackVolumeSource.png?classIdentifier=org.inviwo.ImageStackVolumeSource)
  *
- * The format of the volume will be equivalent to the first input image. The volume resolution
- * will be equal to the size of the first image times the number of images. The physical size of the
- * volume is determined by the the voxel spacing property.
- *
- * The input images are converted to a volume representation based on the input channel selection.
- * Single channels, i.e. red, green, blue, alpha, and grayscale, will result in a scalar volume
- * whereas rgb and rgba will yield a vec3 or vec4 volume, respectively.
+ * The same region is read from every slide matching the file pattern and each slide becomes one
+ * slice of the volume. Slides with identical content are read only once. A single slide is
+ * repeated to give the volume some depth. The volume resolution is equal to the size of the region
+ * times the number of slices.
  *
  * ### Outports
  *   * __volume__ Volume generated from a stack of input images.
  *
  * ### Properties
  *   * __File Pattern__           Pattern used for multi-file matching of images
- *   * __Skip Unsupported Files__   If true, matching files with unsupported image formats are
+ *   * __Skip Unsupported Files__   If true, matching files that cannot be opened as slides are
  *                                not considered. Otherwise an empty volume slice will be inserted
  *                               for each file.
  *   * __Voxel Spacing__          Used to match the sampling distance of the acquired data and
@@ -83,7 +80,7 @@ class DataReaderFactory;
  *   * __Data Information__       Metadata of the generated volume data set.
  *
  */
-class IVW_MODULE_BASE_API CustomImageStackVolumeProcessorMulti : public Processor {
+class IVW_MODULE_BASE_API CustomImageStackVolumeProcessorMulti : public PoolProcessor {
 public:
     CustomImageStackVolumeProcessorMulti(InviwoApplication* app);
     void addFileNameFilters();
@@ -93,12 +90,51 @@ public:
 
     virtual const ProcessorInfo getProcessorInfo() const override;
     static const ProcessorInfo processorInfo_;
-    void slide_processing(std::string);
-    static void k_img_write_out(unsigned char);
-    static void low_img_write_out(unsigned char);
+
+    /**
+     * Selection of a slide region, captured on the main thread and handed to the background job
+     */
+    struct RegionRequest {
+        std::vector<std::string> paths;  ///< one slide per slice, the first defines the region
+        std::shared_ptr<const std::vector<vec2>> rectangle;  ///< optional, from the inport
+        size2_t coordinates;
+        int32_t level;
+    };
+
+    /**
+     * Region of a slide in the arguments of SlideTileCache::readRegion
+     */
+    struct Region {
+        i64vec2 origin;  ///< in level 0 coordinates
+        int32_t level;
+        i64vec2 size;  ///< in pixels of level
+    };
+
+    /**
+     * Determine the region selected by \p request in the first slide of the request
+     * @throw Exception if the slide cannot be opened or the region is empty
+     */
+    static Region computeRegion(SlideTileCache& cache, const RegionRequest& request);
+
+    /**
+     * Check if \p path can be opened as a slide
+     */
+    static bool isSupportedSlide(SlideTileCache& cache, const std::string& path);
 
 protected:
-    std::shared_ptr<Volume> load();
+    /**
+     * Create a volume by reading the selected region of every distinct slide and stacking the
+     * regions along z. The rows of each region are flipped to match the bottom-up row order of
+     * Inviwo layers.
+     * @param cache          tile cache used for reading
+     * @param request        the selection
+     * @param sliceSources   for each slice the index of the slide in the request,
+     *                       see util::findDuplicateFiles
+     * @param stop           checked while reading
+     * @return the volume, or nullptr if \p stop was signaled
+     */
+    static std::shared_ptr<Volume> load(SlideTileCache& cache, const RegionRequest& request,
+                                        const std::vector<size_t>& sliceSources, pool::Stop stop);
     bool isValidImageFile(std::string);
 
     virtual void deserialize(Deserializer& d) override;
@@ -120,7 +156,10 @@ private:
 
     IntSizeTProperty level_;
     IntSize2Property coordinates_;
-    
+
+    std::shared_ptr<SlideTileCache> tileCache_;
+    std::vector<std::string> sliceFiles_;  ///< files that sliceSources_ was computed for
+    std::vector<size_t> sliceSources_;
 };
 
 }  // namespace inviwo
\ No newline at end of file
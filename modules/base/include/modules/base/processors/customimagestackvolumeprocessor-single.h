@@ -33,8 +33,9 @@
 #include <inviwo/core/common/inviwo.h>
 #include <inviwo/core/ports/datainport.h>
 #include <inviwo/core/datastructures/volume/volume.h>
+#include <inviwo/core/datastructures/image/layerramprecision.h>
 
-#include <inviwo/core/processors/processor.h>
+#include <inviwo/core/processors/poolprocessor.h>
 #include <inviwo/core/ports/volumeport.h>
 
 #include <inviwo/core/properties/boolproperty.h>
@@ -44,7 +45,7 @@
 #include <inviwo/core/properties/ordinalproperty.h>
 #include <modules/base/properties/basisproperty.h>
 #include <modules/base/properties/volumeinformationproperty.h>
-#include <modules/base/properties/toojpeg.h>
+#include <modules/base/datastructures/slidetilecache.h>
 #include <inviwo/core/util/glm.h>
 
 #include <vector>
@@ -83,7 +84,7 @@ class DataReaderFactory;
  *   * __Data Information__       Metadata of the generated volume data set.
  *
  */
-class IVW_MODULE_BASE_API CustomImageStackVolumeProcessorSingle : public Processor {
+class IVW_MODULE_BASE_API CustomImageStackVolumeProcessorSingle : public PoolProcessor {
 public:
     CustomImageStackVolumeProcessorSingle(InviwoApplication* app);
     void addFileNameFilters();
@@ -93,13 +94,42 @@ public:
 
     virtual const ProcessorInfo getProcessorInfo() const override;
     static const ProcessorInfo processorInfo_;
-    void SlideExtractor(std::string);
-    static void ImgOutput(unsigned char);
-    std::string IMG_PATH = "../level2.jpg";
-    std::string IMAGES_LOC = "../output.txt";
+
+    /**
+     * Selection of a slide region, captured on the main thread and handed to the background job
+     */
+    struct RegionRequest {
+        std::string path;
+        std::shared_ptr<const std::vector<vec2>> rectangle;  ///< optional, from the inport
+        size2_t coordinates;                                 ///< in pixels of \p level
+        int32_t level;
+    };
+
+    /**
+     * Read the region given by \p request directly into a RGB layer representation. The region
+     * is flipped vertically to match the bottom-up row order of Inviwo layers.
+     * @return the layer, or nullptr if \p stop was signaled
+     * @throw Exception if the slide cannot be opened or read
+     */
+    static std::shared_ptr<LayerRAMPrecision<glm::u8vec3>> SlideExtractor(
+        SlideTileCache& cache, const RegionRequest& request, pool::Stop stop);
 
 protected:
-    std::shared_ptr<Volume> load();
+    /**
+     * Create a volume by stacking the given slice along z
+     */
+    static std::shared_ptr<Volume> load(const LayerRAMPrecision<glm::u8vec3>& slice);
+
+    /**
+     * Fetch the info of the slide in a background job, and apply it with applySlideLimits once it
+     * is available.
+     */
+    void updateSlideLimits();
+    /**
+     * Update the level and coordinate ranges to match the slide, and keep the same region in view
+     * when the level changes.
+     */
+    void applySlideLimits(const SlideTileCache::SlideInfo& info);
     bool isValidImageFile(std::string);
 
     virtual void deserialize(Deserializer& d) override;
@@ -124,7 +154,9 @@ private:
     int zoom_in;
     IntSizeTProperty coordinateX_;
     IntSizeTProperty coordinateY_;
-    int modified;
+
+    std::shared_ptr<SlideTileCache> tileCache_;
+    std::shared_ptr<const std::string> slideInfoRequest_;  ///< slide of the pending info request
 };
 
 }  // namespace inviwo
\ No newline at end of file
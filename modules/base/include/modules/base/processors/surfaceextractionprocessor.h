@@ -40,6 +40,7 @@
 #include <inviwo/core/properties/optionproperty.h>
 #include <inviwo/core/properties/compositeproperty.h>
 #include <inviwo/core/properties/boolproperty.h>
+#include <modules/base/algorithm/volume/marchingcubesopt.h>
 
 #include <future>
 
@@ -85,6 +86,9 @@ protected:
     DataInport<Volume, 0, true> volume_;
     DataOutport<std::vector<std::shared_ptr<Mesh>>> outport_;
     std::vector<std::shared_ptr<Mesh>> meshes_;
+    // Brick ranges of each volume, built by the first extraction that uses them and kept until
+    // the volume changes, such that changing the iso value only visits the active bricks.
+    std::vector<std::shared_future<std::shared_ptr<const marching::BrickRanges>>> ranges_;
 
     TemplateOptionProperty<Method> method_;
     FloatProperty isoValue_;
@@ -0,0 +1,117 @@
+/*********************************************************************************
+ *
+ * Inviwo - Interactive Visualization Workshop
+ *
+ * Copyright (c) 2021 Inviwo Foundation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************************/
+
+#include <modules/base/algorithm/image/argbconversion.h>
+#include <inviwo/core/util/parallelfor.h>
+
+#include <algorithm>
+
+namespace inviwo {
+
+namespace util {
+
+namespace {
+
+template <typename T>
+void convertRow(const uint32_t* src, T* dst, size_t count, bool unpremultiply) {
+    constexpr bool hasAlpha = T::length() == 4;
+
+    // Fully opaque rows are the common case for whole-slide images, there premultiplied and
+    // straight alpha are identical and the conversion reduces to shifts and masks.
+    bool opaque = true;
+    if (unpremultiply) {
+        uint32_t alpha = 0xffffffff;
+        for (size_t i = 0; i < count; ++i) {
+            alpha &= src[i];
+        }
+        opaque = (alpha >> 24) == 0xff;
+    }
+
+    if (!unpremultiply || opaque) {
+        for (size_t i = 0; i < count; ++i) {
+            const uint32_t p = src[i];
+            dst[i].r = static_cast<glm::u8>(p >> 16);
+            dst[i].g = static_cast<glm::u8>(p >> 8);
+            dst[i].b = static_cast<glm::u8>(p);
+            if constexpr (hasAlpha) dst[i].a = static_cast<glm::u8>(p >> 24);
+        }
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            const uint32_t p = src[i];
+            const float a = static_cast<float>(p >> 24);
+            const float scale = a > 0.0f ? 255.0f / a : 0.0f;
+            const auto channel = [scale](uint32_t c) {
+                return static_cast<glm::u8>(
+                    std::min(static_cast<float>(c & 0xff) * scale + 0.5f, 255.0f));
+            };
+            dst[i].r = channel(p >> 16);
+            dst[i].g = channel(p >> 8);
+            dst[i].b = channel(p);
+            if constexpr (hasAlpha) dst[i].a = static_cast<glm::u8>(p >> 24);
+        }
+    }
+}
+
+template <typename T>
+void convertLayer(const uint32_t* src, LayerRAMPrecision<T>& dst, bool unpremultiply) {
+    const size2_t dims = dst.getDimensions();
+    T* data = dst.getDataTyped();
+    constexpr size_t minPixelsPerBlock = 64 * 1024;
+    util::parallelFor(
+        dims.y,
+        [&](size_t begin, size_t end) {
+            for (size_t y = begin; y < end; ++y) {
+                convertRow(src + y * dims.x, data + (dims.y - 1 - y) * dims.x, dims.x,
+                           unpremultiply);
+            }
+        },
+        minPixelsPerBlock / std::max<size_t>(dims.x, 1));
+}
+
+}  // namespace
+
+void argbToRGB(const uint32_t* src, glm::u8vec3* dst, size_t count, bool unpremultiply) {
+    convertRow(src, dst, count, unpremultiply);
+}
+
+void argbToRGBA(const uint32_t* src, glm::u8vec4* dst, size_t count, bool unpremultiply) {
+    convertRow(src, dst, count, unpremultiply);
+}
+
+void argbToLayer(const uint32_t* src, LayerRAMPrecision<glm::u8vec3>& dst, bool unpremultiply) {
+    convertLayer(src, dst, unpremultiply);
+}
+
+void argbToLayer(const uint32_t* src, LayerRAMPrecision<glm::u8vec4>& dst, bool unpremultiply) {
+    convertLayer(src, dst, unpremultiply);
+}
+
+}  // namespace util
+
+}  // namespace inviwo
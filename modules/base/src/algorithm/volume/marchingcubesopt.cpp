@@ -30,13 +30,21 @@
 #include <modules/base/algorithm/volume/marchingcubesopt.h>
 #include <modules/base/algorithm/volume/surfaceextraction.h>
 #include <inviwo/core/util/indexmapper.h>
+#include <inviwo/core/datastructures/volume/volumebricked.h>
+#include <inviwo/core/util/parallelfor.h>
 
 #include <modules/base/datastructures/disjointsets.h>
 #include <glm/gtx/normal.hpp>
 
 #include <algorithm>
+#include <cmath>
 #include <limits>
 #include <bitset>
+#include <mutex>
+#include <optional>
+
+#include <fmt/format.h>
+#include <fmt/ostream.h>
 
 namespace inviwo {
 
@@ -429,13 +437,39 @@ template <typename T, typename IsoTest>
 const std::array<OffsetIndexMasks, 4> Index<T, IsoTest>::oim_ = {
     {{0, 1, {0, 0, 0}}, {3, 2, {0, 1, 0}}, {4, 5, {0, 0, 1}}, {7, 6, {0, 1, 1}}}};
 
-}  // namespace
+// The vertices of a z-slab of cells, with the bookkeeping needed to weld the vertices on the
+// planes shared with the neighboring slabs.
+struct Slab {
+    std::vector<vec3> positions;
+    std::vector<vec3> normals;
+    std::vector<uint32_t> indices;
+    // (vertex, plane edge) of the vertices on the bottom and top planes of the slab
+    std::vector<std::pair<uint32_t, size_t>> bottom;
+    std::vector<std::pair<uint32_t, size_t>> top;
+    // Normal contributions to the bottom vertices in the order they were made
+    std::vector<std::pair<uint32_t, vec3>> bottomNormals;
+};
 
-namespace util {
-std::shared_ptr<Mesh> marchingCubesOpt(std::shared_ptr<const Volume> volume, double iso,
-                                       const vec4& color, bool invert, bool enclose,
-                                       std::function<void(float)> progressCallback,
-                                       std::function<bool(const size3_t&)> maskingCallback) {
+// The index of the x or y edge of a cube edge on the bottom (0-3) or top (8-11) face of the cell
+// at ind, among the 2 * dim.x * dim.y edges of a z-plane.
+size_t planeEdge(const size3_t& ind, int edge, const size3_t& dim) {
+    static constexpr std::array<std::array<size_t, 3>, 4> axisOffset{
+        {{0, 0, 0}, {1, 1, 0}, {0, 0, 1}, {1, 0, 0}}};
+    const auto& [axis, dx, dy] = axisOffset[edge & 3];
+    return axis * dim.x * dim.y + ind.x + dx + (ind.y + dy) * dim.x;
+}
+
+// The smallest slabs marched in parallel, the vertices on the bottom plane of every slab but the
+// first are computed twice.
+constexpr size_t minSlabLayers = 8;
+constexpr size_t minSlabCells = 64 * 1024;
+
+std::shared_ptr<Mesh> marchingCubes(std::shared_ptr<const Volume> volume, double iso,
+                                    const vec4& color, bool invert, bool enclose,
+                                    std::optional<size_t> slabCount,
+                                    std::function<void(float)> progressCallback,
+                                    std::function<bool(const size3_t&)> maskingCallback,
+                                    const marching::BrickRanges* ranges) {
 
     auto indexBuffer = std::make_shared<IndexBuffer>();
     auto vertexBuffer = std::make_shared<Buffer<vec3>>();
@@ -452,14 +486,38 @@ std::shared_ptr<Mesh> marchingCubesOpt(std::shared_ptr<const Volume> volume, dou
 
     if (progressCallback) progressCallback(0.0f);
 
+    // Volumes that are not in RAM are processed in slabs of one brick layer at a time, then only
+    // one slab has to be kept in memory. Enclosing needs the whole boundary and uses the RAM.
+    const VolumeBricked* bricked =
+        enclose || slabCount ? nullptr : util::getBrickedRepresentation(*volume);
+    const size3_t dim{volume->getDimensions()};
+    const size3_t dim1 = dim - size3_t{1, 1, 1};
+    if (ranges && ranges->getDimensions() != dim) {
+        throw Exception(fmt::format("Brick ranges for dimensions {} do not match the volume {}",
+                                    ranges->getDimensions(), dim),
+                        IVW_CONTEXT_CUSTOM("marchingCubesOpt"));
+    }
+    const size_t brickCells = bricked ? bricked->getBrickSize().z : 0;
+    const auto loadSlab = [&](size_t z0) -> std::shared_ptr<const VolumeRAM> {
+        const auto z1 = std::min(z0 + brickCells, dim1.z);
+        return bricked->getSubVolume(size3_t{0, 0, z0}, size3_t{dim.x, dim.y, z1 - z0 + 1});
+    };
+
+    std::mutex progressMutex;
+    size_t layersDone = 0;
+    const auto layerDone = [&]() {
+        if (!progressCallback) return;
+        std::scoped_lock lock{progressMutex};
+        ++layersDone;
+        progressCallback(static_cast<float>(layersDone) / static_cast<float>(dim.z - 1));
+    };
+
     const auto mc = [&](auto ram, auto isoTest, auto mapValue) {
         using T = util::PrecisionValueType<decltype(ram)>;
+        using RAM = util::PrecisionType<decltype(ram)>;
         static const marching::Config cube{};
 
-        const T* src = ram->getDataTyped();
-        const size3_t dim{volume->getDimensions()};
-        const size3_t dim1 = dim - size3_t{1, 1, 1};
-        const util::IndexMapper3D im(dim);
+        const util::IndexMapper3D im(ram->getDimensions());
 
         const auto dr = dvec3(1.0) / dvec3{glm::max(size3_t{1}, (dim - size3_t{1}))};
         const auto doffs = [&]() {
@@ -469,69 +527,243 @@ std::shared_ptr<Mesh> marchingCubesOpt(std::shared_ptr<const Volume> volume, dou
             return tmp;
         }();
 
-        const auto interpolate = [src, im, &mapValue, &doffs](const size3_t& ind, const dvec3& pos,
-                                                              marching::Config::EdgeId e) {
-            const auto a = cube.edges[e][0];
-            const auto b = cube.edges[e][1];
-            const auto tv0 = src[im(ind + cube.vertices[a])];
-            const auto v0 = mapValue(tv0);
-            const auto tv1 = src[im(ind + cube.vertices[b])];
-            const auto v1 = mapValue(tv1);
-
-            const auto t = v0 / (v0 - v1);
-            const auto r0 = pos + doffs[a];
-            const auto r1 = pos + doffs[b];
-            return r0 + t * (r1 - r0);
-        };
-
-        VCache vcache(size2_t{dim.x, dim.y});
-        Index<T, decltype(isoTest)> index(src, im, isoTest);
-        size3_t ind;
-        dvec3 pos;
-
         const float err =
             static_cast<float>(4.0 * glm::epsilon<double>() * glm::epsilon<double>() * dr.x * dr.y);
 
-        for (ind.z = 0, pos.z = 0.0; ind.z < dim1.z; ++ind.z, pos.z += dr.z) {
-            vcache.incZ();
-            for (ind.y = 0, pos.y = 0.0; ind.y < dim1.y; ++ind.y, pos.y += dr.y) {
-                ind.x = 0;
-                const auto cInd = im(ind);
-                vcache.incY();
-                index.init(cInd);
-                for (pos.x = 0.0; ind.x < dim1.x; ++ind.x, pos.x += dr.x) {
-                    index.update(cInd + ind.x);
-                    if (index == 0 || index == 255) continue;
-                    if (maskingCallback && !maskingCallback(ind)) continue;
-
-                    std::array<size_t, 12> inds;
-                    for (const auto edge : cube.caseEdges[index]) {
-                        const auto c = vcache.find(ind, edge, positions.size());
-                        inds[edge] = c.first;
-                        if (c.second) {
-                            const auto vertex = interpolate(ind, pos, edge);
-                            positions.emplace_back(vertex);
-                            normals.emplace_back(0.0f, 0.0f, 0.0f);
+        // Accumulate the z position like a serial march does, to get bitwise identical vertices
+        const auto layerPos = [&](size_t z) {
+            double pos = 0.0;
+            for (size_t i = 0; i < z; ++i) pos += dr.z;
+            return pos;
+        };
+        const auto xPos = [&]() {
+            std::vector<double> tmp(dim1.x);
+            double pos = 0.0;
+            for (auto& x : tmp) {
+                x = pos;
+                pos += dr.x;
+            }
+            return tmp;
+        }();
+
+        // The runs [begin, end) of cells along x to visit, for each row of bricks. Without ranges
+        // there is one run of all cells for every row. Skipped cells have no edge crossings, hence
+        // the vertex cache is the same as if they had been visited.
+        constexpr size_t bs = marching::BrickRanges::brickSize;
+        std::vector<size2_t> runs;
+        std::vector<size_t> rowRuns{0};
+        if (ranges) {
+            const auto brickIso = util::glm_convert<double>(util::glm_convert<T>(iso));
+            const auto& bricks = ranges->getBrickCount();
+            for (size_t bz = 0; bz < bricks.z; ++bz) {
+                for (size_t by = 0; by < bricks.y; ++by) {
+                    const auto rowBegin = runs.size();
+                    for (size_t bx = 0; bx < bricks.x; ++bx) {
+                        if (!ranges->contains(size3_t{bx, by, bz}, brickIso)) continue;
+                        const size_t end = std::min((bx + 1) * bs, dim1.x);
+                        if (runs.size() > rowBegin && runs.back().y == bx * bs) {
+                            runs.back().y = end;
+                        } else {
+                            runs.emplace_back(bx * bs, end);
                         }
                     }
-                    for (const auto& tri : cube.caseTriangles[index]) {
-                        const auto side0 = positions[inds[tri[1]]] - positions[inds[tri[0]]];
-                        const auto side1 = positions[inds[tri[2]]] - positions[inds[tri[0]]];
-                        auto n = glm::cross(side0, side1);
-                        if (glm::length2(n) < err) {
-                            continue;  // triangle is so small area is 0.
-                        }
-                        n = glm::normalize(n);
-                        for (int v = 0; v < 3; ++v) {
-                            indices.push_back(static_cast<uint32_t>(inds[tri[v]]));
-                            normals[inds[tri[v]]] += n;
+                    rowRuns.push_back(runs.size());
+                }
+            }
+        } else {
+            runs.emplace_back(0, dim1.x);
+            rowRuns.push_back(runs.size());
+        }
+        const auto brickRow = [&](size_t y, size_t z) {
+            return ranges ? y / bs + ranges->getBrickCount().y * (z / bs) : size_t{0};
+        };
+        const auto layerActive = [&](size_t z) {
+            if (!ranges) return true;
+            const auto row = brickRow(0, z);
+            return rowRuns[row + ranges->getBrickCount().y] != rowRuns[row];
+        };
+
+        // March the cells [z0, z1) where plane 0 of data is plane srcZ0 of the volume. With weld
+        // the vertex cache restarts at z0 and the vertices on the bottom and top planes are
+        // recorded, otherwise the vertex cache continues from the previous call.
+        const auto march = [&](const T* data, size_t srcZ0, size_t z0, size_t z1, double zPos,
+                               VCache& vcache, bool weld, Slab& out) {
+            const auto interpolate = [data, im, &mapValue, &doffs](const size3_t& ind,
+                                                                   const dvec3& pos,
+                                                                   marching::Config::EdgeId e) {
+                const auto a = cube.edges[e][0];
+                const auto b = cube.edges[e][1];
+                const auto tv0 = data[im(ind + cube.vertices[a])];
+                const auto v0 = mapValue(tv0);
+                const auto tv1 = data[im(ind + cube.vertices[b])];
+                const auto v1 = mapValue(tv1);
+
+                const auto t = v0 / (v0 - v1);
+                const auto r0 = pos + doffs[a];
+                const auto r1 = pos + doffs[b];
+                return r0 + t * (r1 - r0);
+            };
+
+            auto& slabPositions = out.positions;
+            auto& slabNormals = out.normals;
+            auto& slabIndices = out.indices;
+            const bool weldBottom = weld && z0 != 0;
+            const bool weldTop = weld && z1 != dim1.z;
+            std::vector<char> onBottom;
+
+            Index<T, decltype(isoTest)> index(data, im, isoTest);
+            size3_t ind;
+            dvec3 pos;
+            for (ind.z = z0, pos.z = zPos; ind.z < z1; ++ind.z, pos.z += dr.z) {
+                vcache.incZ();
+                if (!layerActive(ind.z)) {
+                    layerDone();
+                    continue;
+                }
+                for (ind.y = 0, pos.y = 0.0; ind.y < dim1.y; ++ind.y, pos.y += dr.y) {
+                    const auto cInd = im(size3_t{0, ind.y, ind.z - srcZ0});
+                    vcache.incY();
+                    const auto row = brickRow(ind.y, ind.z);
+                    for (auto run = rowRuns[row]; run < rowRuns[row + 1]; ++run) {
+                        ind.x = runs[run].x;
+                        index.init(cInd + ind.x);
+                        for (; ind.x < runs[run].y; ++ind.x) {
+                            pos.x = xPos[ind.x];
+                            index.update(cInd + ind.x);
+                            if (index == 0 || index == 255) continue;
+                            if (maskingCallback && !maskingCallback(ind)) continue;
+
+                            const size3_t srcInd{ind.x, ind.y, ind.z - srcZ0};
+                            const size3_t cacheInd{ind.x, ind.y, weld ? ind.z - z0 : ind.z};
+                            std::array<size_t, 12> inds;
+                            for (const auto edge : cube.caseEdges[index]) {
+                                const auto c = vcache.find(cacheInd, edge, slabPositions.size());
+                                inds[edge] = c.first;
+                                if (c.second) {
+                                    const auto vertex = interpolate(srcInd, pos, edge);
+                                    slabPositions.emplace_back(vertex);
+                                    slabNormals.emplace_back(0.0f, 0.0f, 0.0f);
+                                    if (!weld) continue;
+
+                                    const auto v = static_cast<uint32_t>(c.first);
+                                    const bool bottom = weldBottom && ind.z == z0 && edge < 4;
+                                    if (weldBottom) onBottom.push_back(bottom);
+                                    if (bottom) {
+                                        out.bottom.emplace_back(v, planeEdge(ind, edge, dim));
+                                    } else if (weldTop && ind.z + 1 == z1 && edge >= 8) {
+                                        out.top.emplace_back(v, planeEdge(ind, edge, dim));
+                                    }
+                                }
+                            }
+                            for (const auto& tri : cube.caseTriangles[index]) {
+                                const auto side0 =
+                                    slabPositions[inds[tri[1]]] - slabPositions[inds[tri[0]]];
+                                const auto side1 =
+                                    slabPositions[inds[tri[2]]] - slabPositions[inds[tri[0]]];
+                                auto n = glm::cross(side0, side1);
+                                if (glm::length2(n) < err) {
+                                    continue;  // triangle is so small area is 0.
+                                }
+                                n = glm::normalize(n);
+                                for (int v = 0; v < 3; ++v) {
+                                    const auto vi = inds[tri[v]];
+                                    slabIndices.push_back(static_cast<uint32_t>(vi));
+                                    if (weldBottom && onBottom[vi]) {
+                                        out.bottomNormals.emplace_back(
+                                            static_cast<uint32_t>(vi), n);
+                                    } else {
+                                        slabNormals[vi] += n;
+                                    }
+                                }
+                            }
+                            vcache.incX(cube.caseIncrements[index]);
                         }
                     }
-                    vcache.incX(cube.caseIncrements[index]);
                 }
+                layerDone();
             }
-            if (progressCallback) {
-                progressCallback(static_cast<float>(ind.z + 1) / static_cast<float>(dim.z - 1));
+        };
+
+        const T* src = ram->getDataTyped();
+
+        if (bricked) {
+            // Brick layers are marched in order with one vertex cache, straight into the mesh
+            Slab mesh;
+            std::swap(mesh.positions, positions);
+            std::swap(mesh.normals, normals);
+            std::swap(mesh.indices, indices);
+            VCache vcache(size2_t{dim.x, dim.y});
+            double zPos = 0.0;
+            // The slab holds the planes [z0, z1] of the volume
+            std::shared_ptr<const VolumeRAM> slab;
+            for (size_t z0 = 0; z0 < dim1.z; z0 += brickCells) {
+                const auto z1 = std::min(z0 + brickCells, dim1.z);
+                bool active = false;
+                for (size_t z = z0; z < z1 && !active; z += bs) active = layerActive(z);
+                if (z0 != 0 && active) {
+                    slab = loadSlab(z0);
+                    src = static_cast<const RAM*>(slab.get())->getDataTyped();
+                }
+                if (active) {
+                    march(src, z0, z0, z1, zPos, vcache, false, mesh);
+                } else {
+                    for (size_t z = z0; z < z1; ++z) layerDone();
+                }
+                for (size_t z = z0; z < z1; ++z) zPos += dr.z;
+            }
+            std::swap(mesh.positions, positions);
+            std::swap(mesh.normals, normals);
+            std::swap(mesh.indices, indices);
+            return;
+        }
+
+        // Split the cells into z-slabs and march them in parallel, each with its own vertex
+        // cache. The vertices on the plane between two slabs are computed in both, which gives
+        // the same positions, and welded when the slabs are merged in order.
+        const size_t layerCells = std::max<size_t>(dim1.x * dim1.y, 1);
+        const size_t slabs =
+            slabCount ? std::clamp<size_t>(*slabCount, std::min<size_t>(dim1.z, 1), dim1.z)
+                      : util::parallelBlockCount(
+                            dim1.z, std::max(minSlabLayers, minSlabCells / layerCells));
+        std::vector<Slab> slabData(slabs);
+        util::parallelFor(slabs, [&](size_t begin, size_t end) {
+            VCache vcache(size2_t{dim.x, dim.y});
+            for (size_t i = begin; i < end; ++i) {
+                const size_t z0 = i * dim1.z / slabs;
+                const size_t z1 = (i + 1) * dim1.z / slabs;
+                march(src, 0, z0, z1, layerPos(z0), vcache, true, slabData[i]);
+            }
+        });
+
+        if (slabs == 1) {
+            std::swap(slabData.front().positions, positions);
+            std::swap(slabData.front().normals, normals);
+            std::swap(slabData.front().indices, indices);
+        } else {
+            constexpr auto none = std::numeric_limits<uint32_t>::max();
+            // The mesh vertex of each edge of the top plane of the previous slab
+            std::vector<uint32_t> planeVertices(2 * dim.x * dim.y, none);
+            std::vector<uint32_t> vertexMap;
+            for (size_t i = 0; i < slabs; ++i) {
+                auto& slab = slabData[i];
+                vertexMap.assign(slab.positions.size(), none);
+                for (const auto& [v, edge] : slab.bottom) vertexMap[v] = planeVertices[edge];
+                if (i != 0) {
+                    for (const auto& [v, edge] : slabData[i - 1].top) planeVertices[edge] = none;
+                    slabData[i - 1] = Slab{};
+                }
+
+                // Bottom vertices without a match, i.e. with a masked cell below, are kept
+                for (size_t v = 0; v < slab.positions.size(); ++v) {
+                    if (vertexMap[v] != none) continue;
+                    vertexMap[v] = static_cast<uint32_t>(positions.size());
+                    positions.push_back(slab.positions[v]);
+                    normals.push_back(slab.normals[v]);
+                }
+                for (const auto& [v, n] : slab.bottomNormals) normals[vertexMap[v]] += n;
+                for (const auto& v : slab.top) planeVertices[v.second] = vertexMap[v.first];
+                indices.reserve(indices.size() + slab.indices.size());
+                for (const auto v : slab.indices) indices.push_back(vertexMap[v]);
             }
         }
 
@@ -540,8 +772,11 @@ std::shared_ptr<Mesh> marchingCubesOpt(std::shared_ptr<const Volume> volume, dou
                                     dr.z);
         }
     };
+
+    const auto firstSlab = bricked ? loadSlab(0) : nullptr;
+    const auto volumeRAM = bricked ? firstSlab.get() : volume->getRepresentation<VolumeRAM>();
     if (invert) {
-        volume->getRepresentation<VolumeRAM>()->dispatch<void, dispatching::filter::Scalars>(
+        volumeRAM->dispatch<void, dispatching::filter::Scalars>(
             [&](auto ram) {
                 using ValueType = util::PrecisionValueType<decltype(ram)>;
                 mc(
@@ -550,7 +785,7 @@ std::shared_ptr<Mesh> marchingCubesOpt(std::shared_ptr<const Volume> volume, dou
                     [iso](auto&& val) { return util::glm_convert<double>(val) - iso; });
             });
     } else {
-        volume->getRepresentation<VolumeRAM>()->dispatch<void, dispatching::filter::Scalars>(
+        volumeRAM->dispatch<void, dispatching::filter::Scalars>(
             [&](auto ram) {
                 using ValueType = util::PrecisionValueType<decltype(ram)>;
                 mc(
@@ -581,6 +816,93 @@ std::shared_ptr<Mesh> marchingCubesOpt(std::shared_ptr<const Volume> volume, dou
 
     return mesh;
 }
+
+}  // namespace
+
+namespace util {
+std::shared_ptr<Mesh> marchingCubesOpt(std::shared_ptr<const Volume> volume, double iso,
+                                       const vec4& color, bool invert, bool enclose,
+                                       std::function<void(float)> progressCallback,
+                                       std::function<bool(const size3_t&)> maskingCallback,
+                                       const marching::BrickRanges* ranges) {
+    return marchingCubes(volume, iso, color, invert, enclose, std::nullopt, progressCallback,
+                         maskingCallback, ranges);
+}
 }  // namespace util
 
+std::shared_ptr<Mesh> marching::marchingCubesSlabs(
+    std::shared_ptr<const Volume> volume, double iso, const vec4& color, bool invert, bool enclose,
+    size_t slabs, std::function<void(float)> progressCallback,
+    std::function<bool(const size3_t&)> maskingCallback, const BrickRanges* ranges) {
+    return marchingCubes(volume, iso, color, invert, enclose, slabs, progressCallback,
+                         maskingCallback, ranges);
+}
+
+marching::BrickRanges::BrickRanges(const Volume& volume)
+    : dims_{volume.getDimensions()}
+    , bricks_{(glm::max(dims_, size3_t{1}) - size3_t{1} + size3_t{brickSize - 1}) / brickSize}
+    , ranges_(glm::compMul(bricks_)) {
+
+    const size3_t cells = glm::max(dims_, size3_t{1}) - size3_t{1};
+
+    // Compute the ranges of the brick layers [bz0, bz1) from a volume holding the planes from
+    // bz0 * brickSize and up
+    const auto compute = [&](const VolumeRAM& ram, size_t bz0, size_t bz1) {
+        ram.dispatch<void, dispatching::filter::Scalars>([&](auto vrprecision) {
+            const auto data = vrprecision->getDataTyped();
+            const util::IndexMapper3D im(vrprecision->getDimensions());
+            const size_t z0 = bz0 * brickSize;
+
+            util::parallelFor((bz1 - bz0) * bricks_.y, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    const size_t by = i % bricks_.y;
+                    const size_t bz = bz0 + i / bricks_.y;
+                    for (size_t bx = 0; bx < bricks_.x; ++bx) {
+                        const size3_t first = size3_t{bx, by, bz} * brickSize;
+                        const size3_t last = glm::min(first + size3_t{brickSize}, cells);
+                        dvec2 range{std::numeric_limits<double>::max(),
+                                    std::numeric_limits<double>::lowest()};
+                        bool nan = false;
+                        for (size_t z = first.z; z <= last.z; ++z) {
+                            for (size_t y = first.y; y <= last.y; ++y) {
+                                const auto row = im(size3_t{0, y, z - z0});
+                                for (size_t x = first.x; x <= last.x; ++x) {
+                                    const auto v = util::glm_convert<double>(data[row + x]);
+                                    nan |= std::isnan(v);
+                                    range.x = std::min(range.x, v);
+                                    range.y = std::max(range.y, v);
+                                }
+                            }
+                        }
+                        if (nan) {
+                            range = dvec2{-std::numeric_limits<double>::infinity(),
+                                          std::numeric_limits<double>::infinity()};
+                        }
+                        ranges_[bx + bricks_.x * (by + bricks_.y * bz)] = range;
+                    }
+                }
+            });
+        });
+    };
+
+    if (const auto bricked = util::getBrickedRepresentation(volume)) {
+        // Read one layer of bricks at a time
+        for (size_t bz = 0; bz < bricks_.z; ++bz) {
+            const size_t z0 = bz * brickSize;
+            const size_t z1 = std::min(z0 + brickSize, cells.z);
+            const auto slab =
+                bricked->getSubVolume(size3_t{0, 0, z0}, size3_t{dims_.x, dims_.y, z1 - z0 + 1});
+            compute(*slab, bz, bz + 1);
+        }
+    } else if (glm::compMul(bricks_) != 0) {
+        compute(*volume.getRepresentation<VolumeRAM>(), 0, bricks_.z);
+    }
+}
+
+size_t marching::BrickRanges::count(double iso) const {
+    return std::count_if(ranges_.begin(), ranges_.end(), [iso](const dvec2& range) {
+        return range.x <= iso && iso <= range.y;
+    });
+}
+
 }  // namespace inviwo
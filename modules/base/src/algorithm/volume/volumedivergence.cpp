@@ -30,6 +30,7 @@
 #include <modules/base/algorithm/volume/volumedivergence.h>
 
 #include <inviwo/core/util/volumeramutils.h>
+#include <inviwo/core/util/parallelfor.h>
 #include <inviwo/core/util/indexmapper.h>
 #include <inviwo/core/util/templatesampler.h>
 #include <inviwo/core/datastructures/volume/volume.h>
@@ -70,37 +71,48 @@ std::unique_ptr<Volume> divergenceVolume(const Volume& volume) {
 
         util::IndexMapper3D index(volume.getDimensions());
         auto data = newVolumeRep->getDataTyped();
-        float minV = std::numeric_limits<float>::max();
-        float maxV = std::numeric_limits<float>::lowest();
+        const vec2 emptyRange{std::numeric_limits<float>::max(),
+                              std::numeric_limits<float>::lowest()};
 
         const auto worldSpace = Sampler::Space::World;
         const Sampler sampler(volume, worldSpace);
 
-        util::forEachVoxel(*vol, [&](const size3_t& pos) {
-            const vec3 world{m * vec4(vec3(pos) / vec3(volume.getDimensions() - size3_t(1)), 1)};
-
-            const auto Fxp = static_cast<vec3>(sampler.sample(world + ox));
-            const auto Fxm = static_cast<vec3>(sampler.sample(world - ox));
-            const auto Fyp = static_cast<vec3>(sampler.sample(world + oy));
-            const auto Fym = static_cast<vec3>(sampler.sample(world - oy));
-            const auto Fzp = static_cast<vec3>(sampler.sample(world + oz));
-            const auto Fzm = static_cast<vec3>(sampler.sample(world - oz));
-
-            const vec3 Fx = (Fxp - Fxm) / (2.0f * spacing.x);
-            const vec3 Fy = (Fyp - Fym) / (2.0f * spacing.y);
-            const vec3 Fz = (Fzp - Fzm) / (2.0f * spacing.z);
-
-            const float d = Fx.x + Fy.y + Fz.z;
-
-            minV = std::min(minV, d);
-            maxV = std::max(maxV, d);
-
-            data[index(pos)] = d;
-        });
-
-        auto range = std::max(std::abs(minV), std::abs(maxV));
+        const auto minMax = util::parallelReduce(
+            volume.getDimensions(), emptyRange,
+            [&](const size3_t& begin, const size3_t& end) {
+                vec2 range = emptyRange;
+                util::forEachVoxel(begin, end, [&](const size3_t& pos) {
+                    const vec3 world{
+                        m * vec4(vec3(pos) / vec3(volume.getDimensions() - size3_t(1)), 1)};
+
+                    const auto Fxp = static_cast<vec3>(sampler.sample(world + ox));
+                    const auto Fxm = static_cast<vec3>(sampler.sample(world - ox));
+                    const auto Fyp = static_cast<vec3>(sampler.sample(world + oy));
+                    const auto Fym = static_cast<vec3>(sampler.sample(world - oy));
+                    const auto Fzp = static_cast<vec3>(sampler.sample(world + oz));
+                    const auto Fzm = static_cast<vec3>(sampler.sample(world - oz));
+
+                    const vec3 Fx = (Fxp - Fxm) / (2.0f * spacing.x);
+                    const vec3 Fy = (Fyp - Fym) / (2.0f * spacing.y);
+                    const vec3 Fz = (Fzp - Fzm) / (2.0f * spacing.z);
+
+                    const float d = Fx.x + Fy.y + Fz.z;
+
+                    range.x = std::min(range.x, d);
+                    range.y = std::max(range.y, d);
+
+                    data[index(pos)] = d;
+                });
+                return range;
+            },
+            [](const vec2& r1, const vec2& r2) {
+                return vec2{std::min(r1.x, r2.x), std::max(r1.y, r2.y)};
+            },
+            util::Blocking::Bricks);
+
+        auto range = std::max(std::abs(minMax.x), std::abs(minMax.y));
         newVolume->dataMap_.dataRange = dvec2(-range, range);
-        newVolume->dataMap_.valueRange = dvec2(minV, maxV);
+        newVolume->dataMap_.valueRange = dvec2(minMax);
     });
 
     return newVolume;
@@ -30,6 +30,7 @@
 #include <modules/base/algorithm/volume/volumegradient.h>
 
 #include <inviwo/core/util/volumeramutils.h>
+#include <inviwo/core/util/parallelfor.h>
 #include <inviwo/core/util/indexmapper.h>
 #include <inviwo/core/util/volumesampler.h>
 #include <inviwo/core/datastructures/volume/volume.h>
@@ -75,7 +76,10 @@ std::shared_ptr<Volume> gradientVolume(std::shared_ptr<const Volume> volume, int
         data[index(pos)] = g;
     };
 
-    util::forEachVoxelParallel(*volume->getRepresentation<VolumeRAM>(), func);
+    util::parallelFor(
+        volume->getDimensions(),
+        [&](const size3_t& begin, const size3_t& end) { util::forEachVoxel(begin, end, func); },
+        util::Blocking::Bricks);
 
     return newVolume;
 }
@@ -28,6 +28,7 @@
  *********************************************************************************/
 
 #include <modules/base/algorithm/volume/volumeramsubset.h>
+#include <inviwo/core/datastructures/volume/volumebricked.h>
 
 #ifdef IVW_USE_OPENMP
 #include <omp.h>
@@ -122,6 +123,17 @@ std::shared_ptr<VolumeRAM> VolumeRAMSubSet::apply(const VolumeRepresentation* in
                                                   size3_t offset,
                                                   const VolumeBorders& border /*= VolumeBorders()*/,
                                                   bool clampBorderOutsideVolume /*= true*/) {
+    if (auto bricked = dynamic_cast<const VolumeBricked*>(in)) {
+        // Only read the bricks covering the subset including its borders, and extract the
+        // subset from that region. Where the region is cut by the volume boundary the region
+        // boundary coincides with it, hence the borders are handled the same way.
+        const auto dims = bricked->getDimensions();
+        const auto lo = glm::min(offset - glm::min(offset, border.llf), dims);
+        const auto hi = glm::max(glm::min(offset + dim + border.urb, dims), lo);
+        const auto region = bricked->getSubVolume(lo, hi - lo);
+        return apply(region.get(), dim, offset - lo, border, clampBorderOutsideVolume);
+    }
+
     detail::VolumeRAMSubSetDispatcher disp;
     return dispatching::dispatch<std::shared_ptr<VolumeRAM>, dispatching::filter::All>(
         in->getDataFormat()->getId(), disp, in, dim, offset, border, clampBorderOutsideVolume);
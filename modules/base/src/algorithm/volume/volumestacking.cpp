@@ -0,0 +1,166 @@
+/*********************************************************************************
+ *
+ * Inviwo - Interactive Visualization Workshop
+ *
+ * Copyright (c) 2021 Inviwo Foundation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************************/
+
+#include <modules/base/algorithm/volume/volumestacking.h>
+#include <inviwo/core/util/filesystem.h>
+#include <inviwo/core/util/hashcombine.h>
+
+#include <algorithm>
+#include <fstream>
+#include <string_view>
+#include <unordered_map>
+
+namespace inviwo {
+
+namespace {
+
+constexpr size_t noHash = 0;
+
+std::streamoff fileSize(const std::string& file) {
+    auto in = filesystem::ifstream(file, std::ios::in | std::ios::binary | std::ios::ate);
+    return in ? static_cast<std::streamoff>(in.tellg()) : -1;
+}
+
+size_t hashFileContent(const std::string& file) {
+    auto in = filesystem::ifstream(file, std::ios::in | std::ios::binary);
+    if (!in) return noHash;
+
+    std::vector<char> buffer(1 << 20);
+    size_t hash = 0;
+    while (in) {
+        in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        const auto count = static_cast<size_t>(in.gcount());
+        if (count == 0) break;
+        util::hash_combine(hash, std::string_view{buffer.data(), count});
+    }
+    return hash;
+}
+
+bool sameFileContent(const std::string& a, const std::string& b) {
+    auto inA = filesystem::ifstream(a, std::ios::in | std::ios::binary);
+    auto inB = filesystem::ifstream(b, std::ios::in | std::ios::binary);
+    if (!inA || !inB) return false;
+
+    std::vector<char> bufferA(1 << 20);
+    std::vector<char> bufferB(1 << 20);
+    while (true) {
+        inA.read(bufferA.data(), static_cast<std::streamsize>(bufferA.size()));
+        inB.read(bufferB.data(), static_cast<std::streamsize>(bufferB.size()));
+        const auto count = inA.gcount();
+        if (count != inB.gcount()) return false;
+        if (count == 0) return true;
+        if (!std::equal(bufferA.begin(), bufferA.begin() + count, bufferB.begin())) return false;
+    }
+}
+
+}  // namespace
+
+std::vector<size_t> util::findDuplicateFiles(const std::vector<std::string>& files) {
+    std::vector<size_t> result(files.size());
+    std::vector<std::string> paths(files.size());
+    std::vector<std::streamoff> sizes(files.size(), -1);
+    for (size_t i = 0; i < files.size(); ++i) {
+        result[i] = i;
+        paths[i] = filesystem::cleanupPath(files[i]);
+        sizes[i] = fileSize(paths[i]);
+    }
+
+    // identical paths, and candidates sharing their size with a file of another path
+    std::unordered_map<std::string, size_t> firstPath;
+    std::unordered_map<std::streamoff, size_t> sizeCount;
+    for (size_t i = 0; i < files.size(); ++i) {
+        const auto [it, inserted] = firstPath.emplace(paths[i], i);
+        if (!inserted) {
+            result[i] = it->second;
+        } else {
+            ++sizeCount[sizes[i]];
+        }
+    }
+
+    std::vector<size_t> candidates;
+    for (size_t i = 0; i < files.size(); ++i) {
+        if (result[i] == i && sizes[i] >= 0 && sizeCount[sizes[i]] > 1) candidates.push_back(i);
+    }
+
+    std::vector<size_t> hashes(files.size(), noHash);
+    util::parallelFor(candidates.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            hashes[candidates[i]] = hashFileContent(paths[candidates[i]]);
+        }
+    });
+
+    // a matching hash is verified by comparing the content with the first file of that hash
+    std::unordered_map<size_t, std::vector<size_t>> distinct;
+    std::vector<size_t> matches;
+    std::vector<size_t> first(files.size());
+    for (auto i : candidates) {
+        if (hashes[i] == noHash) continue;
+        auto& group = distinct[hashes[i]];
+        if (group.empty()) {
+            group.push_back(i);
+        } else {
+            first[i] = group.front();
+            matches.push_back(i);
+        }
+    }
+
+    std::vector<char> equal(matches.size(), 0);
+    util::parallelFor(matches.size(), [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; ++k) {
+            const auto i = matches[k];
+            equal[k] = sizes[i] == sizes[first[i]] && sameFileContent(paths[i], paths[first[i]]);
+        }
+    });
+
+    // hash collisions, compare against the other distinct files of the same hash
+    for (size_t k = 0; k < matches.size(); ++k) {
+        const auto i = matches[k];
+        if (equal[k]) {
+            result[i] = first[i];
+            continue;
+        }
+        auto& group = distinct[hashes[i]];
+        const auto it = std::find_if(group.begin() + 1, group.end(), [&](size_t j) {
+            return sizes[i] == sizes[j] && sameFileContent(paths[i], paths[j]);
+        });
+        if (it != group.end()) {
+            result[i] = *it;
+        } else {
+            group.push_back(i);
+        }
+    }
+
+    // files with the same path as a duplicate refer to the first file as well
+    for (size_t i = 0; i < files.size(); ++i) {
+        result[i] = result[result[i]];
+    }
+    return result;
+}
+
+}  // namespace inviwo
@@ -28,8 +28,12 @@
  *********************************************************************************/
 
 #include <modules/base/algorithm/volume/volumevoronoi.h>
+#include <inviwo/core/util/parallelfor.h>
 
+#include <algorithm>
 #include <array>
+#include <cmath>
+#include <limits>
 
 namespace inviwo {
 namespace util {
@@ -69,62 +73,467 @@ constexpr auto build_array(Functor&& func) noexcept {
                                    std::make_integer_sequence<Index, N>());
 }
 
-}  // namespace detail
+/**
+ * The (power) distance from a seed point to a voxel position. All search strategies evaluate
+ * the distance through this functor such that they agree on the closest seed point.
+ */
+template <Wrapping X, Wrapping Y, Wrapping Z, bool Weighted>
+struct SeedDistance {
+    float operator()(uint32_t seed, const vec3& pos) const {
+        if constexpr (Weighted) {
+            const float w = (*weights)[seed];
+            return distance2<X, Y, Z>(seeds[seed].second, pos, size) - w * w;
+        } else {
+            return distance2<X, Y, Z>(seeds[seed].second, pos, size);
+        }
+    }
+    /**
+     * Returns true if seed a with distance da is closer than seed b with distance db. Ties go to
+     * the seed that comes first in the list of seed points.
+     */
+    static bool closer(float da, uint32_t a, float db, uint32_t b) {
+        return da < db || (da == db && a < b);
+    }
 
-template <Wrapping X, Wrapping Y, Wrapping Z>
-void voronoiSegmentationImpl(const size3_t volumeDimensions, const mat4& indexToModelMatrix,
-                             const std::vector<std::pair<uint32_t, vec3>>& seedPointsWithIndices,
-                             VolumeRAMPrecision<unsigned short>& voronoiVolumeRep) {
+    const std::vector<std::pair<uint32_t, vec3>>& seeds;
+    const std::vector<float>* weights;
+    vec3 size;
+};
+
+/**
+ * A uniform grid over the seed points used to find the closest seed point of a position. Along
+ * repeating axes the grid also contains the images of the seed points shifted by plus and minus
+ * the volume size, which covers every shift that distance2 can apply. Cells are visited in
+ * rings around the cell of the query position and skipped when a conservative lower bound of
+ * the distance shows that they can not contain a seed that is closer, or equally close, than the
+ * best one found so far. The candidates themselves are compared using SeedDistance, hence the
+ * result is the same as when comparing against all seed points.
+ */
+template <Wrapping X, Wrapping Y, Wrapping Z, bool Weighted>
+class SeedGrid {
+public:
+    SeedGrid(const SeedDistance<X, Y, Z, Weighted>& dist, double scale)
+        : dist_{dist}, delta_{2.0e-6 * scale} {
+        constexpr std::array<bool, 3> repeat{X == Wrapping::Repeat, Y == Wrapping::Repeat,
+                                             Z == Wrapping::Repeat};
+        const dvec3 size{dist.size};
+
+        std::vector<std::pair<dvec3, uint32_t>> points;
+        const auto nSeeds = static_cast<uint32_t>(dist.seeds.size());
+        for (uint32_t seed = 0; seed < nSeeds; ++seed) {
+            const dvec3 pos{dist.seeds[seed].second};
+            for (int z = repeat[2] ? -1 : 0; z <= (repeat[2] ? 1 : 0); ++z) {
+                for (int y = repeat[1] ? -1 : 0; y <= (repeat[1] ? 1 : 0); ++y) {
+                    for (int x = repeat[0] ? -1 : 0; x <= (repeat[0] ? 1 : 0); ++x) {
+                        points.emplace_back(pos + dvec3{x, y, z} * size, seed);
+                    }
+                }
+            }
+        }
+
+        lo_ = points.front().first;
+        dvec3 hi = lo_;
+        for (const auto& point : points) {
+            lo_ = glm::min(lo_, point.first);
+            hi = glm::max(hi, point.first);
+        }
+        const dvec3 extent = hi - lo_;
+
+        // Aim for about two points per cell, axes shorter than a cell get a single cell.
+        const double target = std::max(1.0, static_cast<double>(points.size()) / 2.0);
+        std::array<bool, 3> active{extent.x > 0.0, extent.y > 0.0, extent.z > 0.0};
+        double side = 0.0;
+        for (int iteration = 0; iteration < 3; ++iteration) {
+            double volume = 1.0;
+            int axes = 0;
+            for (int i = 0; i < 3; ++i) {
+                if (active[i]) {
+                    volume *= extent[i];
+                    ++axes;
+                }
+            }
+            if (axes == 0) break;
+            side = std::pow(volume / target, 1.0 / axes);
+            bool changed = false;
+            for (int i = 0; i < 3; ++i) {
+                if (active[i] && extent[i] < side) {
+                    active[i] = false;
+                    changed = true;
+                }
+            }
+            if (!changed) break;
+        }
+        for (int i = 0; i < 3; ++i) {
+            counts_[i] =
+                active[i] ? std::max<size_t>(1, static_cast<size_t>(std::ceil(extent[i] / side)))
+                          : 1;
+            cellSize_[i] = extent[i] / static_cast<double>(counts_[i]);
+            invCellSize_[i] = active[i] ? static_cast<double>(counts_[i]) / extent[i] : 0.0;
+        }
+
+        const size_t nCells = glm::compMul(counts_);
+        std::vector<size_t> cells(points.size());
+        cellStart_.assign(nCells + 1, 0);
+        for (size_t i = 0; i < points.size(); ++i) {
+            cells[i] = cellIndex(cellCoord(points[i].first));
+            ++cellStart_[cells[i] + 1];
+        }
+        for (size_t i = 0; i < nCells; ++i) cellStart_[i + 1] += cellStart_[i];
+
+        cellSeeds_.resize(points.size());
+        auto next = cellStart_;
+        for (size_t i = 0; i < points.size(); ++i) {
+            cellSeeds_[next[cells[i]]++] = points[i].second;
+        }
+
+        if constexpr (Weighted) {
+            cellMaxWeight2_.assign(nCells, 0.0);
+            for (size_t cell = 0; cell < nCells; ++cell) {
+                for (size_t i = cellStart_[cell]; i < cellStart_[cell + 1]; ++i) {
+                    const double w = (*dist.weights)[cellSeeds_[i]];
+                    cellMaxWeight2_[cell] = std::max(cellMaxWeight2_[cell], w * w);
+                }
+                maxWeight2_ = std::max(maxWeight2_, cellMaxWeight2_[cell]);
+            }
+        }
+    }
 
-    auto volumeIndices = voronoiVolumeRep.getDataTyped();
-    util::IndexMapper3D index(volumeDimensions);
+    /**
+     * Returns the index into the list of seed points of the closest seed point to pos. The seed
+     * \p hint, typically the result of a neighboring position, is used as the initial candidate.
+     */
+    uint32_t nearest(const vec3& pos, uint32_t hint) const {
+        uint32_t best = hint;
+        float bestDist = dist_(hint, pos);
+        double bestLimit2 = limit2(0.0, bestDist);
+
+        const auto visit = [&](size_t cell) {
+            for (size_t i = cellStart_[cell]; i < cellStart_[cell + 1]; ++i) {
+                const auto seed = cellSeeds_[i];
+                const auto d = dist_(seed, pos);
+                if (SeedDistance<X, Y, Z, Weighted>::closer(d, seed, bestDist, best)) {
+                    best = seed;
+                    bestDist = d;
+                    bestLimit2 = limit2(0.0, bestDist);
+                }
+            }
+        };
+        // Squared distance beyond which seeds with at most the given squared weight are skipped
+        const auto limit = [&](double weight2) {
+            return weight2 > 0.0 ? limit2(weight2, bestDist) : bestLimit2;
+        };
+
+        const dvec3 q{pos};
+        const size3_t center = cellCoord(q);
+        const size3_t lastCell = counts_ - size3_t{1};
+        for (size_t r = 0;; ++r) {
+            const size3_t first = center - glm::min(center, size3_t{r});
+            const size3_t last = glm::min(center + size3_t{r}, lastCell);
+
+            for (size_t z = first.z; z <= last.z; ++z) {
+                const bool zShell = z + r == center.z || z == center.z + r;
+                for (size_t y = first.y; y <= last.y; ++y) {
+                    const bool shell = zShell || y + r == center.y || y == center.y + r;
+                    const auto test = [&](size_t x) {
+                        const size3_t cell{x, y, z};
+                        const auto index = cellIndex(cell);
+                        if (cellStart_[index] == cellStart_[index + 1]) return;
+                        const auto lower2 =
+                            boxDistance2(q, cellLo(cell), cellLo(cell + size3_t{1}));
+                        if (!(lower2 > limit(cellMaxWeight2(index)))) visit(index);
+                    };
+                    if (shell) {
+                        for (size_t x = first.x; x <= last.x; ++x) test(x);
+                    } else {
+                        if (center.x >= r) test(center.x - r);
+                        if (center.x + r <= lastCell.x) test(center.x + r);
+                    }
+                }
+            }
+
+            // All cells not visited yet lie outside of the block [first, last].
+            if (first == size3_t{0} && last == lastCell) break;
+            const dvec3 gridHi = cellLo(counts_);
+            double outside2 = std::numeric_limits<double>::infinity();
+            for (int i = 0; i < 3; ++i) {
+                if (first[i] > 0) {
+                    auto hi = gridHi;
+                    hi[i] = cellLo(first)[i];
+                    outside2 = std::min(outside2, boxDistance2(q, lo_, hi));
+                }
+                if (last[i] < lastCell[i]) {
+                    auto lo = lo_;
+                    lo[i] = cellLo(last + size3_t{1})[i];
+                    outside2 = std::min(outside2, boxDistance2(q, lo, gridHi));
+                }
+            }
+            if (outside2 > limit(maxWeight2_)) break;
+        }
+        return best;
+    }
 
-    const auto size = vec3{indexToModelMatrix * vec4{volumeDimensions, 1.0f}} -
-                      vec3{indexToModelMatrix * vec4{0.0f, 0.0f, 0.0f, 1.0f}};
+private:
+    size3_t cellCoord(const dvec3& pos) const {
+        size3_t res{0};
+        for (int i = 0; i < 3; ++i) {
+            const double c = (pos[i] - lo_[i]) * invCellSize_[i];
+            if (!(c >= 1.0)) {
+                res[i] = 0;
+            } else if (c >= static_cast<double>(counts_[i] - 1)) {
+                res[i] = counts_[i] - 1;
+            } else {
+                res[i] = static_cast<size_t>(c);
+            }
+        }
+        return res;
+    }
+    size_t cellIndex(const size3_t& cell) const {
+        return cell.x + counts_.x * (cell.y + counts_.y * cell.z);
+    }
+    dvec3 cellLo(const size3_t& cell) const { return lo_ + dvec3{cell} * cellSize_; }
+    double cellMaxWeight2([[maybe_unused]] size_t cell) const {
+        if constexpr (Weighted) {
+            return cellMaxWeight2_[cell];
+        } else {
+            return 0.0;
+        }
+    }
 
-    util::forEachVoxelParallel(volumeDimensions, [&](const size3_t& voxelPos) {
-        const auto transformedVoxelPos = vec3{indexToModelMatrix * vec4{voxelPos, 1.0f}};
-        auto it = std::min_element(
-            seedPointsWithIndices.cbegin(), seedPointsWithIndices.cend(),
-            [&](const auto& p1, const auto& p2) {
-                return detail::distance2<X, Y, Z>(p1.second, transformedVoxelPos, size) <
-                       detail::distance2<X, Y, Z>(p2.second, transformedVoxelPos, size);
-            });
-        volumeIndices[index(voxelPos)] = static_cast<unsigned short>(it->first);
-    });
+    static double boxDistance2(const dvec3& pos, const dvec3& lo, const dvec3& hi) {
+        const dvec3 d = glm::max(glm::max(lo - pos, pos - hi), dvec3{0.0});
+        return glm::length2(d);
+    }
+
+    /**
+     * Returns the squared distance beyond which every seed with a squared weight of at most
+     * \p weight2 is further away than \p bestDist. The margins cover the rounding errors of the
+     * single precision evaluation in SeedDistance. Comparisons against a NaN limit fail, which
+     * means that nothing is skipped.
+     */
+    double limit2(double weight2, float bestDist) const {
+        constexpr double eps = 1.0e-5;
+        const double best = bestDist;
+        const double minDist2 = (best + eps * std::abs(best) + weight2 * (1.0 + eps)) / (1.0 - eps);
+        if (minDist2 < 0.0) return -1.0;
+        const double radius = std::sqrt(minDist2) + delta_;
+        return radius * radius;
+    }
+
+    const SeedDistance<X, Y, Z, Weighted>& dist_;
+    double delta_;
+    dvec3 lo_{0.0};
+    size3_t counts_{1};
+    dvec3 cellSize_{0.0};
+    dvec3 invCellSize_{0.0};
+    std::vector<size_t> cellStart_;
+    std::vector<uint32_t> cellSeeds_;
+    std::vector<double> cellMaxWeight2_;
+    double maxWeight2_ = 0.0;
+};
+
+template <Wrapping X, Wrapping Y, Wrapping Z, bool Weighted>
+void exactVoronoi(const SeedDistance<X, Y, Z, Weighted>& dist, const size3_t dims,
+                  const mat4& indexToModelMatrix, unsigned short* volumeIndices) {
+    const auto& seeds = dist.seeds;
+
+    // Largest coordinate involved in the distance computations, sets the rounding margins.
+    double scale = glm::compMax(glm::abs(dvec3{dist.size}));
+    bool finite = true;
+    for (const auto& seed : seeds) {
+        scale = std::max(scale, glm::compMax(glm::abs(dvec3{seed.second})));
+        finite &= std::isfinite(seed.second.x) && std::isfinite(seed.second.y) &&
+                  std::isfinite(seed.second.z);
+    }
+    if constexpr (Weighted) {
+        for (auto w : *dist.weights) finite &= std::isfinite(w);
+    }
+    for (int corner = 0; corner < 8; ++corner) {
+        const vec3 pos{corner & 1 ? dims.x : 0, corner & 2 ? dims.y : 0, corner & 4 ? dims.z : 0};
+        scale = std::max(scale,
+                         glm::compMax(glm::abs(dvec3{vec3{indexToModelMatrix * vec4{pos, 1.0f}}})));
+    }
+    finite &= std::isfinite(scale);
+
+    std::optional<SeedGrid<X, Y, Z, Weighted>> grid;
+    if (finite) grid.emplace(dist, scale);
+
+    const auto nSeeds = static_cast<uint32_t>(seeds.size());
+    const util::IndexMapper3D index(dims);
+    const size_t rows = dims.y * dims.z;
+    util::parallelFor(
+        rows,
+        [&](size_t begin, size_t end) {
+            uint32_t hint = 0;
+            for (size_t row = begin; row < end; ++row) {
+                const size_t y = row % dims.y;
+                const size_t z = row / dims.y;
+                for (size_t x = 0; x < dims.x; ++x) {
+                    const size3_t voxelPos{x, y, z};
+                    const auto transformedVoxelPos =
+                        vec3{indexToModelMatrix * vec4{voxelPos, 1.0f}};
+                    if (grid) {
+                        hint = grid->nearest(transformedVoxelPos, hint);
+                    } else {
+                        // Non finite input, compare against all seed points
+                        float best = dist(0, transformedVoxelPos);
+                        hint = 0;
+                        for (uint32_t seed = 1; seed < nSeeds; ++seed) {
+                            const auto d = dist(seed, transformedVoxelPos);
+                            if (d < best) {
+                                best = d;
+                                hint = seed;
+                            }
+                        }
+                    }
+                    volumeIndices[index(voxelPos)] = static_cast<unsigned short>(seeds[hint].first);
+                }
+            }
+        },
+        std::max<size_t>(1, 4096 / std::max<size_t>(1, dims.x)));
 }
 
-template <Wrapping X, Wrapping Y, Wrapping Z>
-void weightedVoronoiSegmentationImpl(
-    const size3_t volumeDimensions, const mat4& indexToModelMatrix,
-    const std::vector<std::pair<uint32_t, vec3>>& seedPointsWithIndices,
-    const std::vector<float>& weights, VolumeRAMPrecision<unsigned short>& voronoiVolumeRep) {
+template <Wrapping X, Wrapping Y, Wrapping Z, bool Weighted>
+void jumpFloodingVoronoi(const SeedDistance<X, Y, Z, Weighted>& dist, const size3_t dims,
+                         const mat4& indexToModelMatrix, unsigned short* volumeIndices) {
+    constexpr std::array<bool, 3> repeat{X == Wrapping::Repeat, Y == Wrapping::Repeat,
+                                         Z == Wrapping::Repeat};
+    constexpr auto none = std::numeric_limits<uint32_t>::max();
+
+    const auto& seeds = dist.seeds;
+    const util::IndexMapper3D index(dims);
+    const auto voxelPosition = [&](const size3_t& voxelPos) {
+        return vec3{indexToModelMatrix * vec4{voxelPos, 1.0f}};
+    };
+
+    std::vector<uint32_t> current(glm::compMul(dims), none);
+    std::vector<uint32_t> next(current.size(), none);
+
+    // Put every seed into the voxel containing it, the closest seed wins if several share one.
+    const auto modelToIndex = glm::inverse(indexToModelMatrix);
+    const auto nSeeds = static_cast<uint32_t>(seeds.size());
+    bool placed = false;
+    for (uint32_t seed = 0; seed < nSeeds; ++seed) {
+        const auto indexPos = vec3{modelToIndex * vec4{seeds[seed].second, 1.0f}};
+        size3_t voxelPos{0};
+        bool valid = true;
+        for (int i = 0; i < 3; ++i) {
+            const double c = std::round(static_cast<double>(indexPos[i]));
+            const auto dim = static_cast<double>(dims[i]);
+            if (!std::isfinite(c)) {
+                valid = false;
+            } else if (repeat[i]) {
+                voxelPos[i] = static_cast<size_t>(c - dim * std::floor(c / dim));
+                voxelPos[i] = std::min(voxelPos[i], dims[i] - 1);
+            } else {
+                voxelPos[i] = static_cast<size_t>(std::clamp(c, 0.0, dim - 1.0));
+            }
+        }
+        if (!valid) continue;
+        placed = true;
+        auto& voxel = current[index(voxelPos)];
+        const auto pos = voxelPosition(voxelPos);
+        if (voxel == none || SeedDistance<X, Y, Z, Weighted>::closer(dist(seed, pos), seed,
+                                                                      dist(voxel, pos), voxel)) {
+            voxel = seed;
+        }
+    }
+    if (!placed) current[0] = 0;
+
+    const auto pass = [&](size_t step) {
+        // The three neighbors at -step, 0, and +step of each coordinate along each axis,
+        // invalid for neighbors outside of a non-repeating axis
+        constexpr auto invalid = std::numeric_limits<size_t>::max();
+        std::array<std::vector<std::array<size_t, 3>>, 3> neighbors;
+        for (int axis = 0; axis < 3; ++axis) {
+            const auto dim = static_cast<std::ptrdiff_t>(dims[axis]);
+            for (std::ptrdiff_t i = 0; i < dim; ++i) {
+                auto& ns = neighbors[axis].emplace_back();
+                for (std::ptrdiff_t j = 0; j < 3; ++j) {
+                    auto n = i + (j - 1) * static_cast<std::ptrdiff_t>(step);
+                    if (repeat[axis]) n = ((n % dim) + dim) % dim;
+                    ns[j] = n >= 0 && n < dim ? static_cast<size_t>(n) : invalid;
+                }
+            }
+        }
+
+        const size_t rows = dims.y * dims.z;
+        util::parallelFor(
+            rows,
+            [&](size_t begin, size_t end) {
+                for (size_t row = begin; row < end; ++row) {
+                    const size_t y = row % dims.y;
+                    const size_t z = row / dims.y;
+                    for (size_t x = 0; x < dims.x; ++x) {
+                        const size3_t voxelPos{x, y, z};
+                        const auto pos = voxelPosition(voxelPos);
+                        auto best = current[index(voxelPos)];
+                        float bestDist = best == none ? std::numeric_limits<float>::infinity()
+                                                      : dist(best, pos);
+                        for (auto nz : neighbors[2][z]) {
+                            if (nz == invalid) continue;
+                            for (auto ny : neighbors[1][y]) {
+                                if (ny == invalid) continue;
+                                for (auto nx : neighbors[0][x]) {
+                                    if (nx == invalid) continue;
+                                    const auto seed = current[index(size3_t{nx, ny, nz})];
+                                    if (seed == none || seed == best) continue;
+                                    const auto d = dist(seed, pos);
+                                    if (best == none || SeedDistance<X, Y, Z, Weighted>::closer(
+                                                            d, seed, bestDist, best)) {
+                                        best = seed;
+                                        bestDist = d;
+                                    }
+                                }
+                            }
+                        }
+                        next[index(voxelPos)] = best;
+                    }
+                }
+            },
+            std::max<size_t>(1, 4096 / std::max<size_t>(1, dims.x)));
+        std::swap(current, next);
+    };
+
+    size_t step = 1;
+    while (step < glm::compMax(dims)) step *= 2;
+    for (step /= 2; step >= 1; step /= 2) pass(step);
+    // An additional pass with step one fixes most of the remaining errors
+    pass(1);
+
+    for (size_t i = 0; i < current.size(); ++i) {
+        volumeIndices[i] = static_cast<unsigned short>(seeds[current[i]].first);
+    }
+}
 
-    auto volumeIndices = voronoiVolumeRep.getDataTyped();
-    util::IndexMapper3D index(volumeDimensions);
+template <Wrapping X, Wrapping Y, Wrapping Z, bool Weighted>
+void voronoiSegmentationImpl(const size3_t volumeDimensions, const mat4& indexToModelMatrix,
+                             const std::vector<std::pair<uint32_t, vec3>>& seedPointsWithIndices,
+                             const std::vector<float>* weights, VoronoiMethod method,
+                             VolumeRAMPrecision<unsigned short>& voronoiVolumeRep) {
 
     const auto size = vec3{indexToModelMatrix * vec4{volumeDimensions, 1.0f}} -
                       vec3{indexToModelMatrix * vec4{0.0f, 0.0f, 0.0f, 1.0f}};
-
-    util::forEachVoxelParallel(volumeDimensions, [&](const size3_t& voxelPos) {
-        const auto transformedVoxelPos = vec3{indexToModelMatrix * vec4{voxelPos, 1.0f}};
-        auto zipped = util::zip(seedPointsWithIndices, weights);
-
-        auto&& [posWithIndex, weight] =
-            *std::min_element(zipped.begin(), zipped.end(), [&](auto&& i1, auto&& i2) {
-                auto&& [p1, w1] = i1;
-                auto&& [p2, w2] = i2;
-                return detail::distance2<X, Y, Z>(p1.second, transformedVoxelPos, size) - w1 * w1 <
-                       detail::distance2<X, Y, Z>(p2.second, transformedVoxelPos, size) - w2 * w2;
-            });
-        volumeIndices[index(voxelPos)] = static_cast<unsigned short>(posWithIndex.first);
-    });
+    const SeedDistance<X, Y, Z, Weighted> dist{seedPointsWithIndices, weights, size};
+
+    switch (method) {
+        case VoronoiMethod::JumpFlooding:
+            jumpFloodingVoronoi(dist, volumeDimensions, indexToModelMatrix,
+                                voronoiVolumeRep.getDataTyped());
+            break;
+        case VoronoiMethod::Exact:
+        default:
+            exactVoronoi(dist, volumeDimensions, indexToModelMatrix,
+                         voronoiVolumeRep.getDataTyped());
+            break;
+    }
 }
 
+}  // namespace detail
+
 std::shared_ptr<Volume> voronoiSegmentation(
     const size3_t volumeDimensions, const mat4& indexToModelMatrix,
     const std::vector<std::pair<uint32_t, vec3>>& seedPointsWithIndices, const Wrapping3D& wrapping,
-    const std::optional<std::vector<float>>& weights) {
+    const std::optional<std::vector<float>>& weights, VoronoiMethod method) {
 
     if (seedPointsWithIndices.size() == 0) {
         throw Exception("No seed points, cannot create volume voronoi segmentation",
@@ -150,40 +559,13 @@ std::shared_ptr<Volume> voronoiSegmentation(
     voronoiVolume->dataMap_.dataRange = dvec2{0.0, static_cast<double>(imax->first)};
     voronoiVolume->dataMap_.valueRange = voronoiVolume->dataMap_.dataRange;
 
-    if (weights.has_value()) {
-        using Functor =
-            void (*)(const size3_t, const mat4&, const std::vector<std::pair<uint32_t, vec3>>&,
-                     const std::vector<float>&, VolumeRAMPrecision<unsigned short>&);
-
-        constexpr auto table = detail::build_array<3>([&](auto x) constexpr {
-            using XT = decltype(x);
-            return detail::build_array<3>([&](auto y) constexpr {
-                using YT = decltype(y);
-                return detail::build_array<3>([&](auto z) constexpr->Functor {
-                    using ZT = decltype(z);
-                    return [](const size3_t dim, const mat4& matrix,
-                              const std::vector<std::pair<uint32_t, vec3>>& sp,
-                              const std::vector<float>& w,
-                              VolumeRAMPrecision<unsigned short>& volRep) {
-                        constexpr auto X = static_cast<Wrapping>(XT::value);
-                        constexpr auto Y = static_cast<Wrapping>(YT::value);
-                        constexpr auto Z = static_cast<Wrapping>(ZT::value);
-                        weightedVoronoiSegmentationImpl<X, Y, Z>(dim, matrix, sp, w, volRep);
-                    };
-                });
-            });
-        });
-
-        table[static_cast<size_t>(wrapping[0])][static_cast<size_t>(wrapping[1])]
-             [static_cast<size_t>(wrapping[2])](volumeDimensions, indexToModelMatrix,
-                                                seedPointsWithIndices, *weights, *voronoiVolumeRep);
+    using Functor =
+        void (*)(const size3_t, const mat4&, const std::vector<std::pair<uint32_t, vec3>>&,
+                 const std::vector<float>*, VoronoiMethod, VolumeRAMPrecision<unsigned short>&);
 
-    } else {
-        using Functor =
-            void (*)(const size3_t, const mat4&, const std::vector<std::pair<uint32_t, vec3>>&,
-                     VolumeRAMPrecision<unsigned short>&);
-
-        constexpr auto table = detail::build_array<3>([&](auto x) constexpr {
+    constexpr auto table = detail::build_array<2>([&](auto weighted) constexpr {
+        using WT = decltype(weighted);
+        return detail::build_array<3>([&](auto x) constexpr {
             using XT = decltype(x);
             return detail::build_array<3>([&](auto y) constexpr {
                 using YT = decltype(y);
@@ -191,20 +573,23 @@ std::shared_ptr<Volume> voronoiSegmentation(
                     using ZT = decltype(z);
                     return [](const size3_t dim, const mat4& matrix,
                               const std::vector<std::pair<uint32_t, vec3>>& sp,
+                              const std::vector<float>* w, VoronoiMethod m,
                               VolumeRAMPrecision<unsigned short>& volRep) {
                         constexpr auto X = static_cast<Wrapping>(XT::value);
                         constexpr auto Y = static_cast<Wrapping>(YT::value);
                         constexpr auto Z = static_cast<Wrapping>(ZT::value);
-                        voronoiSegmentationImpl<X, Y, Z>(dim, matrix, sp, volRep);
+                        constexpr bool W = WT::value == 1;
+                        detail::voronoiSegmentationImpl<X, Y, Z, W>(dim, matrix, sp, w, m, volRep);
                     };
                 });
             });
         });
+    });
 
-        table[static_cast<size_t>(wrapping[0])][static_cast<size_t>(wrapping[1])]
-             [static_cast<size_t>(wrapping[2])](volumeDimensions, indexToModelMatrix,
-                                                seedPointsWithIndices, *voronoiVolumeRep);
-    }
+    table[weights.has_value() ? 1 : 0][static_cast<size_t>(wrapping[0])]
+         [static_cast<size_t>(wrapping[1])][static_cast<size_t>(wrapping[2])](
+             volumeDimensions, indexToModelMatrix, seedPointsWithIndices,
+             weights ? &*weights : nullptr, method, *voronoiVolumeRep);
 
     return voronoiVolume;
 }
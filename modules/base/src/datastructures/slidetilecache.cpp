@@ -0,0 +1,222 @@
+/*********************************************************************************
+ *
+ * Inviwo - Interactive Visualization Workshop
+ *
+ * Copyright (c) 2021 Inviwo Foundation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************************/
+
+#include <modules/base/datastructures/slidetilecache.h>
+#include <inviwo/core/util/exception.h>
+#include <inviwo/core/util/hashcombine.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include <fmt/format.h>
+
+#include <openslide/openslide.h>
+
+namespace inviwo {
+
+namespace {
+
+int64_t floorDiv(int64_t a, int64_t b) { return a / b - ((a % b != 0) && ((a < 0) != (b < 0))); }
+
+i64vec2 floorDiv(i64vec2 a, int64_t b) { return i64vec2{floorDiv(a.x, b), floorDiv(a.y, b)}; }
+
+}  // namespace
+
+size_t SlideTileCache::TileKeyHash::operator()(const TileKey& key) const {
+    size_t h = 0;
+    util::hash_combine(h, key.slide);
+    util::hash_combine(h, key.level);
+    util::hash_combine(h, key.tile.x);
+    util::hash_combine(h, key.tile.y);
+    return h;
+}
+
+SlideTileCache::SlideTileCache(size_t memoryBudget, int64_t tileSize)
+    : tileSize_{tileSize}, memoryBudget_{memoryBudget} {
+    if (tileSize_ <= 0) {
+        throw Exception(fmt::format("Invalid tile size {}", tileSize_), IVW_CONTEXT);
+    }
+}
+
+SlideTileCache::~SlideTileCache() = default;
+
+SlideTileCache::SlideInfo SlideTileCache::getSlideInfo(const std::string& slide) {
+    std::scoped_lock lock{mutex_};
+    return getSlide(slide).info;
+}
+
+bool SlideTileCache::readRegion(const std::string& slide, i64vec2 origin, int32_t level,
+                                i64vec2 size, uint32_t* dest, const std::function<bool()>& stop) {
+    if (size.x <= 0 || size.y <= 0) return true;
+
+    std::shared_ptr<openslide_t> handle;
+    double downsample = 1.0;
+    {
+        std::scoped_lock lock{mutex_};
+        const auto& s = getSlide(slide);
+        if (level < 0 || level >= s.info.getLevelCount()) {
+            throw Exception(fmt::format("Invalid level {} for slide '{}' with {} levels", level,
+                                        slide, s.info.getLevelCount()),
+                            IVW_CONTEXT);
+        }
+        handle = s.handle;
+        downsample = s.info.levelDownsamples[level];
+    }
+
+    // region in pixels of the requested level
+    const i64vec2 start{static_cast<int64_t>(std::floor(origin.x / downsample)),
+                        static_cast<int64_t>(std::floor(origin.y / downsample))};
+    const i64vec2 end = start + size;
+
+    const auto firstTile = floorDiv(start, tileSize_);
+    const auto lastTile = floorDiv(end - i64vec2{1}, tileSize_);
+
+    TileKey key{slide, level, i64vec2{0}};
+    for (int64_t ty = firstTile.y; ty <= lastTile.y; ++ty) {
+        for (int64_t tx = firstTile.x; tx <= lastTile.x; ++tx) {
+            if (stop && stop()) return false;
+
+            key.tile = i64vec2{tx, ty};
+            auto tile = findTile(key);
+            if (!tile) {
+                tile = insert(key, readTile(handle.get(), key, downsample));
+            }
+
+            const i64vec2 tileOrigin = key.tile * tileSize_;
+            const i64vec2 lo = glm::max(start, tileOrigin);
+            const i64vec2 hi = glm::min(end, tileOrigin + tileSize_);
+            for (int64_t y = lo.y; y < hi.y; ++y) {
+                std::copy_n(tile->data() + (y - tileOrigin.y) * tileSize_ + (lo.x - tileOrigin.x),
+                            hi.x - lo.x, dest + (y - start.y) * size.x + (lo.x - start.x));
+            }
+        }
+    }
+    return true;
+}
+
+void SlideTileCache::setMemoryBudget(size_t bytes) {
+    std::scoped_lock lock{mutex_};
+    memoryBudget_ = bytes;
+    evict();
+}
+
+size_t SlideTileCache::getMemoryBudget() const {
+    std::scoped_lock lock{mutex_};
+    return memoryBudget_;
+}
+
+size_t SlideTileCache::getMemoryUsage() const {
+    std::scoped_lock lock{mutex_};
+    return memoryUsage_;
+}
+
+int64_t SlideTileCache::getTileSize() const { return tileSize_; }
+
+void SlideTileCache::clear() {
+    std::scoped_lock lock{mutex_};
+    tiles_.clear();
+    lru_.clear();
+    slides_.clear();
+    memoryUsage_ = 0;
+}
+
+const SlideTileCache::Slide& SlideTileCache::getSlide(const std::string& slide) {
+    auto it = slides_.find(slide);
+    if (it != slides_.end()) return it->second;
+
+    std::shared_ptr<openslide_t> handle{openslide_open(slide.c_str()),
+                                        [](openslide_t* s) { openslide_close(s); }};
+    if (!handle) {
+        throw Exception(fmt::format("Could not open slide '{}'", slide), IVW_CONTEXT);
+    }
+    if (const char* error = openslide_get_error(handle.get())) {
+        throw Exception(fmt::format("Could not open slide '{}': {}", slide, error), IVW_CONTEXT);
+    }
+
+    SlideInfo info;
+    const int32_t levels = openslide_get_level_count(handle.get());
+    for (int32_t level = 0; level < levels; ++level) {
+        i64vec2 dims{0};
+        openslide_get_level_dimensions(handle.get(), level, &dims.x, &dims.y);
+        info.levelDimensions.push_back(dims);
+        info.levelDownsamples.push_back(openslide_get_level_downsample(handle.get(), level));
+    }
+
+    return slides_.emplace(slide, Slide{std::move(handle), std::move(info)}).first->second;
+}
+
+void SlideTileCache::evict() {
+    while (memoryUsage_ > memoryBudget_ && !lru_.empty()) {
+        const auto& [key, tile] = lru_.back();
+        memoryUsage_ -= tile->size() * sizeof(uint32_t);
+        tiles_.erase(key);
+        lru_.pop_back();
+    }
+}
+
+std::shared_ptr<const SlideTileCache::Tile> SlideTileCache::findTile(const TileKey& key) {
+    std::scoped_lock lock{mutex_};
+    auto it = tiles_.find(key);
+    if (it == tiles_.end()) return nullptr;
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return it->second->second;
+}
+
+std::shared_ptr<const SlideTileCache::Tile> SlideTileCache::readTile(openslide_t* handle,
+                                                                     const TileKey& key,
+                                                                     double downsample) const {
+    auto tile = std::make_shared<Tile>(static_cast<size_t>(tileSize_ * tileSize_));
+    const auto origin = key.tile * tileSize_;
+    openslide_read_region(handle, tile->data(), std::llround(origin.x * downsample),
+                          std::llround(origin.y * downsample), key.level, tileSize_, tileSize_);
+    if (const char* error = openslide_get_error(handle)) {
+        throw Exception(fmt::format("Could not read tile ({}, {}) at level {} from '{}': {}",
+                                    key.tile.x, key.tile.y, key.level, key.slide, error),
+                        IVW_CONTEXT);
+    }
+    return tile;
+}
+
+std::shared_ptr<const SlideTileCache::Tile> SlideTileCache::insert(
+    const TileKey& key, std::shared_ptr<const Tile> tile) {
+    std::scoped_lock lock{mutex_};
+    // another thread might have read the same tile in the meantime
+    auto it = tiles_.find(key);
+    if (it != tiles_.end()) {
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return it->second->second;
+    }
+    lru_.emplace_front(key, tile);
+    tiles_.emplace(key, lru_.begin());
+    memoryUsage_ += tile->size() * sizeof(uint32_t);
+    evict();
+    return tile;
+}
+
+}  // namespace inviwo
@@ -99,22 +99,22 @@ void SingleVoxel::process() {
     dvec4Property_.setVisible(comps == 4);
 
     if (comps == 1) {
-        VolumeDoubleSampler<1> sampler(vol);
+        VolumeDoubleSampler<1> sampler(vol, CoordinateSpace::Data, VolumeSamplerSource::Bricks);
         auto sample = sampler.sample(position_, space_.get());
         doubleProperty_.set(sample);
     }
     if (comps == 2) {
-        VolumeDoubleSampler<2> sampler(vol);
+        VolumeDoubleSampler<2> sampler(vol, CoordinateSpace::Data, VolumeSamplerSource::Bricks);
         auto sample = sampler.sample(position_, space_.get());
         dvec2Property_.set(sample);
     }
     if (comps == 3) {
-        VolumeDoubleSampler<3> sampler(vol);
+        VolumeDoubleSampler<3> sampler(vol, CoordinateSpace::Data, VolumeSamplerSource::Bricks);
         auto sample = sampler.sample(position_, space_.get());
         dvec3Property_.set(sample);
     }
     if (comps == 4) {
-        VolumeDoubleSampler<4> sampler(vol);
+        VolumeDoubleSampler<4> sampler(vol, CoordinateSpace::Data, VolumeSamplerSource::Bricks);
         auto sample = sampler.sample(position_, space_.get());
         dvec4Property_.set(sample);
     }
@@ -38,6 +38,7 @@
 #include <inviwo/core/datastructures/buffer/bufferramprecision.h>
 #include <inviwo/core/util/stdextensions.h>
 #include <inviwo/core/util/zip.h>
+#include <future>
 #include <numeric>
 
 #include <inviwo/core/util/rendercontext.h>
@@ -99,8 +100,9 @@ SurfaceExtraction::~SurfaceExtraction() = default;
 
 void SurfaceExtraction::process() {
 
-    const auto computeSurface = [this](vec4 color, std::shared_ptr<const Volume> vol) {
-        return [vol, color, method = method_.get(), iso = isoValue_.get(),
+    const auto computeSurface = [this](vec4 color, std::shared_ptr<const Volume> vol,
+                                       decltype(ranges_)::value_type ranges) {
+        return [vol, color, ranges, method = method_.get(), iso = isoValue_.get(),
                 invert = invertIso_.get(),
                 enclose = encloseSurface_.get()](pool::Progress progress) -> std::shared_ptr<Mesh> {
             RenderContext::getPtr()->activateLocalRenderContext();
@@ -109,7 +111,8 @@ void SurfaceExtraction::process() {
                 case Method::MarchingCubes:
                     return util::marchingcubes(vol, iso, color, invert, enclose, progress);
                 case Method::MarchingCubesOpt:
-                    return util::marchingCubesOpt(vol, iso, color, invert, enclose, progress);
+                    return util::marchingCubesOpt(vol, iso, color, invert, enclose, progress,
+                                                  nullptr, ranges.get().get());
                 case Method::MarchingTetrahedron:
                 default:
                     return util::marchingtetrahedron(vol, iso, color, invert, enclose, progress);
@@ -154,10 +157,27 @@ void SurfaceExtraction::process() {
     const bool stateChange = method_.isModified() || isoValue_.isModified() ||
                              invertIso_.isModified() || encloseSurface_.isModified();
 
+    // The brick ranges are built by the first job that gets them
+    const auto makeRanges = [](std::weak_ptr<const Volume> volume) {
+        return std::async(std::launch::deferred,
+                          [volume]() -> std::shared_ptr<const marching::BrickRanges> {
+                              if (auto vol = volume.lock()) {
+                                  return std::make_shared<marching::BrickRanges>(*vol);
+                              }
+                              return nullptr;
+                          })
+            .share();
+    };
+    if (size != meshes_.size()) ranges_.clear();
+    ranges_.resize(size);
+    for (auto [i, item] : util::enumerate(volume_.changedAndData())) {
+        if (item.first || !ranges_[i].valid()) ranges_[i] = makeRanges(item.second);
+    }
+
     if (stateChange || size != meshes_.size()) {  // Need to recompute all...
-        std::vector<decltype(computeSurface(vec4{}, std::shared_ptr<const Volume>{}))> jobs;
+        std::vector<decltype(computeSurface(vec4{}, std::shared_ptr<const Volume>{}, {}))> jobs;
         for (auto [i, vol] : util::enumerate(volume_)) {
-            jobs.push_back(computeSurface(getColor(i), vol));
+            jobs.push_back(computeSurface(getColor(i), vol, ranges_[i]));
         }
         dispatchMany(jobs, [this](std::vector<std::shared_ptr<Mesh>> result) {
             meshes_ = result;
@@ -172,7 +192,7 @@ void SurfaceExtraction::process() {
             const auto data = item.second;
 
             if (portChanged) {
-                jobs.push_back(computeSurface(getColor(i), data));
+                jobs.push_back(computeSurface(getColor(i), data, ranges_[i]));
                 inds.push_back(i);
             } else if (colors_[i]->isModified()) {
                 jobs.push_back(changeColor(getColor(i), meshes_[i]));
@@ -30,6 +30,7 @@
 #include <modules/base/processors/volumesubset.h>
 #include <modules/base/algorithm/volume/volumeramsubset.h>
 #include <inviwo/core/network/networklock.h>
+#include <inviwo/core/datastructures/volume/volumebricked.h>
 #include <glm/gtx/vector_angle.hpp>
 
 namespace inviwo {
@@ -88,7 +89,8 @@ VolumeSubset::~VolumeSubset() = default;
 
 void VolumeSubset::process() {
     if (enabled_.get()) {
-        const auto vol = inport_.getData()->getRepresentation<VolumeRAM>();
+        const VolumeRepresentation* vol = util::getBrickedRepresentation(*inport_.getData());
+        if (!vol) vol = inport_.getData()->getRepresentation<VolumeRAM>();
         const size3_t offset{rangeX_.get().x, rangeY_.get().x, rangeZ_.get().x};
         const size3_t dim = size3_t{rangeX_.get().y, rangeY_.get().y, rangeZ_.get().y} - offset;
 
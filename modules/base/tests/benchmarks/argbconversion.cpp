@@ -0,0 +1,156 @@
+/*********************************************************************************
+ *
+ * Inviwo - Interactive Visualization Workshop
+ *
+ * Copyright (c) 2021 Inviwo Foundation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************************/
+
+#ifdef _MSC_VER
+#pragma comment(linker, "/SUBSYSTEM:CONSOLE")
+#endif
+
+#include <inviwo/core/common/inviwo.h>
+#include <inviwo/core/common/inviwoapplication.h>
+#include <inviwo/core/datastructures/image/layerramprecision.h>
+#include <modules/base/algorithm/image/argbconversion.h>
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <warn/push>
+#include <warn/ignore/unused-function>
+
+using namespace inviwo;
+
+namespace {
+
+std::vector<uint32_t> makeARGB(size2_t dims, bool opaque) {
+    std::mt19937 rand(0);
+    std::uniform_int_distribution<uint32_t> dist(0, 0xffffffff);
+    std::vector<uint32_t> argb(glm::compMul(dims));
+    for (auto& p : argb) {
+        // keep the color channels premultiplied, i.e. not larger than alpha
+        const uint32_t a = opaque ? 0xff : dist(rand) >> 24;
+        const uint32_t c = dist(rand);
+        const auto ch = [&](uint32_t v) { return ((v & 0xff) * a) / 0xff; };
+        p = (a << 24) | (ch(c >> 16) << 16) | (ch(c >> 8) << 8) | ch(c);
+    }
+    return argb;
+}
+
+size2_t dimsFromState(const benchmark::State& state) {
+    return size2_t{static_cast<size_t>(state.range(0)), static_cast<size_t>(state.range(1))};
+}
+
+}  // namespace
+
+// The per-pixel loop previously used in the image-stack processors
+static void Reference(benchmark::State& state) {
+    const auto dims = dimsFromState(state);
+    const auto argb = makeARGB(dims, true);
+    LayerRAMPrecision<glm::u8vec3> layer(dims);
+
+    for (auto _ : state) {
+        auto pixels = reinterpret_cast<unsigned char*>(layer.getDataTyped());
+        for (size_t y = 0; y < dims.y; y++) {
+            for (size_t x = 0; x < dims.x; x++) {
+                uint32_t p = argb[y * dims.x + x];
+                double red = (p >> 16) & 0xff;
+                double green = (p >> 8) & 0xff;
+                double blue = (p >> 0) & 0xff;
+                size_t offset = (y * dims.x + x) * 3;
+                pixels[offset] = static_cast<unsigned char>(red);
+                pixels[offset + 1] = static_cast<unsigned char>(green);
+                pixels[offset + 2] = static_cast<unsigned char>(blue);
+            }
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * glm::compMul(dims));
+}
+
+static void RowOpaqueRGB(benchmark::State& state) {
+    const auto dims = dimsFromState(state);
+    const auto argb = makeARGB(dims, true);
+    LayerRAMPrecision<glm::u8vec3> layer(dims);
+
+    for (auto _ : state) {
+        util::argbToRGB(argb.data(), layer.getDataTyped(), argb.size());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * glm::compMul(dims));
+}
+
+static void RowTranslucentRGBA(benchmark::State& state) {
+    const auto dims = dimsFromState(state);
+    const auto argb = makeARGB(dims, false);
+    LayerRAMPrecision<glm::u8vec4> layer(dims);
+
+    for (auto _ : state) {
+        util::argbToRGBA(argb.data(), layer.getDataTyped(), argb.size());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * glm::compMul(dims));
+}
+
+static void LayerRGB(benchmark::State& state) {
+    const auto dims = dimsFromState(state);
+    const auto argb = makeARGB(dims, true);
+    LayerRAMPrecision<glm::u8vec3> layer(dims);
+    InviwoApplication::getPtr()->resizePool(static_cast<size_t>(state.range(2)));
+
+    for (auto _ : state) {
+        util::argbToLayer(argb.data(), layer);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * glm::compMul(dims));
+    state.counters["Threads"] = static_cast<double>(state.range(2));
+}
+
+BENCHMARK(Reference)->Args({1920, 1080})->Args({4096, 4096});
+BENCHMARK(RowOpaqueRGB)->Args({1920, 1080})->Args({4096, 4096});
+BENCHMARK(RowTranslucentRGBA)->Args({1920, 1080})->Args({4096, 4096});
+static void LayerArgs(benchmark::internal::Benchmark* b) {
+    for (const auto& dims : {std::pair{1920, 1080}, std::pair{4096, 4096}}) {
+        for (int threads : {0, 2, 4, 8}) {
+            b->Args({dims.first, dims.second, threads});
+        }
+    }
+}
+BENCHMARK(LayerRGB)->Apply(LayerArgs)->UseRealTime();
+
+int main(int argc, char** argv) {
+    InviwoApplication app(argc, argv, "Inviwo-Benchmark-ARGBConversion");
+
+    benchmark::Initialize(&argc, argv);
+    benchmark::RunSpecifiedBenchmarks();
+
+    return 0;
+}
+
+#include <warn/pop>
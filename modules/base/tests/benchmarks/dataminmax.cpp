@@ -0,0 +1,182 @@
+/*********************************************************************************
+ *
+ * Inviwo - Interactive Visualization Workshop
+ *
+ * Copyright (c) 2021 Inviwo Foundation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************************/
+
+#ifdef _MSC_VER
+#pragma comment(linker, "/SUBSYSTEM:CONSOLE")
+#endif
+
+#include <inviwo/core/common/inviwo.h>
+#include <inviwo/core/common/inviwoapplication.h>
+#include <inviwo/core/datastructures/histogram.h>
+#include <modules/base/algorithm/dataminmax.h>
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <warn/push>
+#include <warn/ignore/unused-function>
+
+using namespace inviwo;
+
+namespace {
+
+template <typename T>
+std::vector<T> makeData(size_t size) {
+    using C = typename util::value_type<T>::type;
+    std::mt19937 rand(0);
+    std::uniform_real_distribution<double> dist(0.0, 255.0);
+    std::vector<T> data(size);
+    for (auto& v : data) {
+        for (size_t i = 0; i < util::flat_extent<T>::value; ++i) {
+            util::glmcomp(v, i) = static_cast<C>(dist(rand));
+        }
+    }
+    return data;
+}
+
+// The std::accumulate based min/max previously used by util::dataMinMax
+template <typename T>
+std::pair<dvec4, dvec4> referenceMinMax(const T* data, size_t size) {
+    using Res = std::pair<T, T>;
+    Res minmax{DataFormat<T>::max(), DataFormat<T>::lowest()};
+    minmax = std::accumulate(data, data + size, minmax, [](const Res& mm, const T& v) -> Res {
+        return {glm::min(mm.first, v), glm::max(mm.second, v)};
+    });
+    return {util::glm_convert<dvec4>(minmax.first), util::glm_convert<dvec4>(minmax.second)};
+}
+
+// The serial loop previously used by HistogramContainer, for scalar types
+template <typename T>
+std::vector<double> referenceHistogram(const T* data, size_t size, dvec2 range, size_t bins) {
+    std::vector<double> counts(bins, 0.0);
+    double min = std::numeric_limits<double>::max();
+    double max = std::numeric_limits<double>::lowest();
+    double sum = 0.0;
+    double sum2 = 0.0;
+    const double scale = static_cast<double>(bins - 1) / (range.y - range.x);
+    for (size_t i = 0; i < size; ++i) {
+        const auto val = static_cast<double>(data[i]);
+        min = std::min(min, val);
+        max = std::max(max, val);
+        sum += val;
+        sum2 += val * val;
+        const auto ind = static_cast<size_t>((val - range.x) * scale);
+        if (ind < bins) counts[ind]++;
+    }
+    // keep the statistics from being optimized away
+    counts.push_back(min + max + sum + sum2);
+    return counts;
+}
+
+size_t sizeFromState(const benchmark::State& state) {
+    const auto dim = static_cast<size_t>(state.range(0));
+    return dim * dim * dim;
+}
+
+void setThreads(benchmark::State& state) {
+    InviwoApplication::getPtr()->resizePool(static_cast<size_t>(state.range(1)));
+    state.counters["Threads"] = static_cast<double>(state.range(1));
+}
+
+}  // namespace
+
+template <typename T>
+static void ReferenceMinMax(benchmark::State& state) {
+    const auto data = makeData<T>(sizeFromState(state));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(referenceMinMax(data.data(), data.size()));
+    }
+    state.SetBytesProcessed(state.iterations() * data.size() * sizeof(T));
+}
+
+template <typename T>
+static void MinMax(benchmark::State& state) {
+    const auto data = makeData<T>(sizeFromState(state));
+    setThreads(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(util::dataMinMax(data.data(), data.size()));
+    }
+    state.SetBytesProcessed(state.iterations() * data.size() * sizeof(T));
+}
+
+template <typename T>
+static void ReferenceHistogram(benchmark::State& state) {
+    const auto data = makeData<T>(sizeFromState(state));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+            referenceHistogram(data.data(), data.size(), dvec2{0.0, 255.0}, 256));
+    }
+    state.SetBytesProcessed(state.iterations() * data.size() * sizeof(T));
+}
+
+template <typename T>
+static void Histogram(benchmark::State& state) {
+    const auto data = makeData<T>(sizeFromState(state));
+    setThreads(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(HistogramContainer(dvec2{0.0, 255.0}, 256, data.data(),
+                                                    data.data() + data.size()));
+    }
+    state.SetBytesProcessed(state.iterations() * data.size() * sizeof(T));
+}
+
+static void ThreadArgs(benchmark::internal::Benchmark* b) {
+    for (int dim : {128, 256}) {
+        for (int threads : {0, 2, 4, 8}) {
+            b->Args({dim, threads});
+        }
+    }
+}
+
+BENCHMARK_TEMPLATE(ReferenceMinMax, unsigned char)->Arg(128)->Arg(256);
+BENCHMARK_TEMPLATE(ReferenceMinMax, float)->Arg(128)->Arg(256);
+BENCHMARK_TEMPLATE(ReferenceMinMax, vec3)->Arg(128)->Arg(256);
+BENCHMARK_TEMPLATE(MinMax, unsigned char)->Apply(ThreadArgs)->UseRealTime();
+BENCHMARK_TEMPLATE(MinMax, float)->Apply(ThreadArgs)->UseRealTime();
+BENCHMARK_TEMPLATE(MinMax, vec3)->Apply(ThreadArgs)->UseRealTime();
+
+BENCHMARK_TEMPLATE(ReferenceHistogram, unsigned char)->Arg(128)->Arg(256);
+BENCHMARK_TEMPLATE(ReferenceHistogram, float)->Arg(128)->Arg(256);
+BENCHMARK_TEMPLATE(Histogram, unsigned char)->Apply(ThreadArgs)->UseRealTime();
+BENCHMARK_TEMPLATE(Histogram, float)->Apply(ThreadArgs)->UseRealTime();
+
+int main(int argc, char** argv) {
+    InviwoApplication app(argc, argv, "Inviwo-Benchmark-DataMinMax");
+
+    benchmark::Initialize(&argc, argv);
+    benchmark::RunSpecifiedBenchmarks();
+
+    return 0;
+}
+
+#include <warn/pop>
@@ -0,0 +1,167 @@
+/*********************************************************************************
+ *
+ * Inviwo - Interactive Visualization Workshop
+ *
+ * Copyright (c) 2021 Inviwo Foundation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************************/
+
+#ifdef _MSC_VER
+#pragma comment(linker, "/SUBSYSTEM:CONSOLE")
+#endif
+
+#include <inviwo/core/common/inviwo.h>
+#include <inviwo/core/common/inviwoapplication.h>
+#include <modules/base/datastructures/kdtree.h>
+#include <modules/base/datastructures/flatkdtree.h>
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <random>
+#include <vector>
+
+#include <warn/push>
+#include <warn/ignore/unused-function>
+
+using namespace inviwo;
+
+namespace {
+
+std::vector<dvec3> makePoints(size_t size, unsigned int seed) {
+    std::mt19937 rand(seed);
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+    std::vector<dvec3> points(size);
+    for (auto& p : points) p = dvec3(dist(rand), dist(rand), dist(rand));
+    return points;
+}
+
+constexpr size_t queries = 10000;
+
+}  // namespace
+
+static void BuildPointerTree(benchmark::State& state) {
+    const auto points = makePoints(static_cast<size_t>(state.range(0)), 0);
+    for (auto _ : state) {
+        K3DTree<size_t, double> tree;
+        for (size_t i = 0; i < points.size(); ++i) tree.insert(points[i], i);
+        benchmark::DoNotOptimize(tree.getRoot());
+    }
+    state.SetItemsProcessed(state.iterations() * points.size());
+}
+
+static void BuildFlatTree(benchmark::State& state) {
+    const auto points = makePoints(static_cast<size_t>(state.range(0)), 0);
+    InviwoApplication::getPtr()->resizePool(static_cast<size_t>(state.range(1)));
+    state.counters["Threads"] = static_cast<double>(state.range(1));
+    for (auto _ : state) {
+        FlatKDTree<3> tree(points);
+        benchmark::DoNotOptimize(tree.getPositions().data());
+    }
+    state.SetItemsProcessed(state.iterations() * points.size());
+}
+
+static void NNearestPointerTree(benchmark::State& state) {
+    const auto points = makePoints(static_cast<size_t>(state.range(0)), 0);
+    const auto query = makePoints(queries, 1);
+    K3DTree<size_t, double> tree;
+    for (size_t i = 0; i < points.size(); ++i) tree.insert(points[i], i);
+
+    for (auto _ : state) {
+        for (const auto& pos : query) {
+            benchmark::DoNotOptimize(tree.findNNearest(pos, 8));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * query.size());
+}
+
+static void NNearestFlatTree(benchmark::State& state) {
+    const auto points = makePoints(static_cast<size_t>(state.range(0)), 0);
+    const auto query = makePoints(queries, 1);
+    const FlatKDTree<3> tree(points);
+
+    std::array<size_t, 8> indices;
+    std::array<double, 8> sqDist;
+    for (auto _ : state) {
+        for (const auto& pos : query) {
+            benchmark::DoNotOptimize(tree.findNNearest(pos, indices, sqDist));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * query.size());
+}
+
+static void RadiusPointerTree(benchmark::State& state) {
+    const auto points = makePoints(static_cast<size_t>(state.range(0)), 0);
+    const auto query = makePoints(queries, 1);
+    K3DTree<size_t, double> tree;
+    for (size_t i = 0; i < points.size(); ++i) tree.insert(points[i], i);
+
+    for (auto _ : state) {
+        for (const auto& pos : query) {
+            benchmark::DoNotOptimize(tree.findCloseTo(pos, 0.01));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * query.size());
+}
+
+static void RadiusFlatTree(benchmark::State& state) {
+    const auto points = makePoints(static_cast<size_t>(state.range(0)), 0);
+    const auto query = makePoints(queries, 1);
+    const FlatKDTree<3> tree(points);
+
+    std::vector<size_t> close;
+    for (auto _ : state) {
+        for (const auto& pos : query) {
+            tree.findWithinRadius(pos, 0.01, close);
+            benchmark::DoNotOptimize(close.data());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * query.size());
+}
+
+static void ThreadArgs(benchmark::internal::Benchmark* b) {
+    for (int size : {100000, 1000000}) {
+        for (int threads : {0, 2, 4, 8}) {
+            b->Args({size, threads});
+        }
+    }
+}
+
+BENCHMARK(BuildPointerTree)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BuildFlatTree)->Apply(ThreadArgs)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(NNearestPointerTree)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMillisecond);
+BENCHMARK(NNearestFlatTree)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMillisecond);
+BENCHMARK(RadiusPointerTree)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMillisecond);
+BENCHMARK(RadiusFlatTree)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMillisecond);
+
+int main(int argc, char** argv) {
+    InviwoApplication app(argc, argv, "Inviwo-Benchmark-KDTree");
+
+    benchmark::Initialize(&argc, argv);
+    benchmark::RunSpecifiedBenchmarks();
+
+    return 0;
+}
+
+#include <warn/pop>
@@ -32,6 +32,7 @@
 #endif
 
 #include <inviwo/core/common/inviwo.h>
+#include <inviwo/core/common/inviwoapplication.h>
 #include <modules/base/algorithm/volume/volumegeneration.h>
 
 #include <modules/base/algorithm/volume/marchingcubes.h>
@@ -136,12 +137,100 @@ static void MiniNew(benchmark::State& state) {
         static_cast<double>(state.range(0) * state.range(0) * state.range(0));
 }
 
+namespace {
+
+void setThreads(benchmark::State& state) {
+    InviwoApplication::getPtr()->resizePool(static_cast<size_t>(state.range(1)));
+    state.counters["Threads"] = static_cast<double>(state.range(1));
+}
+
+}  // namespace
+
+static void SphereThreads(benchmark::State& state) {
+    auto v = std::shared_ptr<Volume>(
+        util::makeSphericalVolume(size3_t{static_cast<size_t>(state.range(0))}));
+    setThreads(state);
+
+    for (auto _ : state) {
+        auto mesh = util::marchingCubesOpt(v, 0.5, {0.5f, 0.0f, 0.0f, 1.0f}, false, false);
+        state.counters["Vertices"] = static_cast<double>(mesh->getBuffer(0)->getSize());
+        state.counters["Indices"] =
+            static_cast<double>(mesh->getIndexBuffers().front().second->getSize());
+        benchmark::ClobberMemory();
+    }
+    state.counters["Voxels"] =
+        static_cast<double>(state.range(0) * state.range(0) * state.range(0));
+}
+
+static void RippleThreads(benchmark::State& state) {
+    auto v = std::shared_ptr<Volume>(
+        util::makeRippleVolume(size3_t{static_cast<size_t>(state.range(0))}));
+    setThreads(state);
+
+    for (auto _ : state) {
+        auto mesh = util::marchingCubesOpt(v, 0.5, {0.5f, 0.0f, 0.0f, 1.0f}, false, false);
+        state.counters["Vertices"] = static_cast<double>(mesh->getBuffer(0)->getSize());
+        state.counters["Indices"] =
+            static_cast<double>(mesh->getIndexBuffers().front().second->getSize());
+        benchmark::ClobberMemory();
+    }
+    state.counters["Voxels"] =
+        static_cast<double>(state.range(0) * state.range(0) * state.range(0));
+}
+
+// Extraction when only the iso value changes, with the brick ranges built once up front
+static void SphereRanges(benchmark::State& state) {
+    auto v = std::shared_ptr<Volume>(
+        util::makeSphericalVolume(size3_t{static_cast<size_t>(state.range(0))}));
+    const marching::BrickRanges ranges(*v);
+
+    size_t step = 0;
+    for (auto _ : state) {
+        const double iso = 0.3 + 0.05 * static_cast<double>(step++ % 10);
+        auto mesh = util::marchingCubesOpt(v, iso, {0.5f, 0.0f, 0.0f, 1.0f}, false, false,
+                                           nullptr, nullptr, &ranges);
+        state.counters["Vertices"] = static_cast<double>(mesh->getBuffer(0)->getSize());
+        benchmark::ClobberMemory();
+    }
+    state.counters["Voxels"] =
+        static_cast<double>(state.range(0) * state.range(0) * state.range(0));
+}
+
+static void SphereNoRanges(benchmark::State& state) {
+    auto v = std::shared_ptr<Volume>(
+        util::makeSphericalVolume(size3_t{static_cast<size_t>(state.range(0))}));
+
+    size_t step = 0;
+    for (auto _ : state) {
+        const double iso = 0.3 + 0.05 * static_cast<double>(step++ % 10);
+        auto mesh = util::marchingCubesOpt(v, iso, {0.5f, 0.0f, 0.0f, 1.0f}, false, false);
+        state.counters["Vertices"] = static_cast<double>(mesh->getBuffer(0)->getSize());
+        benchmark::ClobberMemory();
+    }
+    state.counters["Voxels"] =
+        static_cast<double>(state.range(0) * state.range(0) * state.range(0));
+}
+
+static void ThreadArgs(benchmark::internal::Benchmark* b) {
+    for (int dim : {128, 256}) {
+        for (int threads : {0, 1, 2, 4, 8}) {
+            b->Args({dim, threads});
+        }
+    }
+}
+
 BENCHMARK(SphereOld)->RangeMultiplier(2)->Range(8, 8 << 5);
 BENCHMARK(SphereNew)->RangeMultiplier(2)->Range(8, 8 << 6);
 
 BENCHMARK(RippleOld)->RangeMultiplier(2)->Range(8, 8 << 4);
 BENCHMARK(RippleNew)->RangeMultiplier(2)->Range(8, 8 << 5);
 
+BENCHMARK(SphereThreads)->Apply(ThreadArgs)->UseRealTime();
+BENCHMARK(RippleThreads)->Apply(ThreadArgs)->UseRealTime();
+
+BENCHMARK(SphereNoRanges)->Arg(128)->Arg(256)->UseRealTime();
+BENCHMARK(SphereRanges)->Arg(128)->Arg(256)->UseRealTime();
+
 // BENCHMARK(MiniOld)->RangeMultiplier(2)->Range(8, 8 << 5);
 // BENCHMARK(MiniNew)->RangeMultiplier(2)->Range(8, 8 << 5);
 
@@ -151,6 +240,7 @@ BENCHMARK(RippleNew)->RangeMultiplier(2)->Range(8, 8 << 5);
 // BENCHMARK(SphereNew)->Arg(5);
 
 int main(int argc, char** argv) {
+    InviwoApplication app(argc, argv, "Inviwo-Benchmark-MarchingCubes");
 
     benchmark::Initialize(&argc, argv);
     benchmark::RunSpecifiedBenchmarks();
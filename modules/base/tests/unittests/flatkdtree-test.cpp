@@ -0,0 +1,157 @@
+/*********************************************************************************
+ *
+ * Inviwo - Interactive Visualization Workshop
+ *
+ * Copyright (c) 2021 Inviwo Foundation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************************/
+
+#include <warn/push>
+#include <warn/ignore/all>
+#include <gtest/gtest.h>
+#include <warn/pop>
+
+#include <modules/base/datastructures/flatkdtree.h>
+
+#include <glm/gtx/norm.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace inviwo {
+
+namespace {
+
+std::vector<dvec3> randomPoints(size_t count, unsigned int seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+    std::vector<dvec3> points(count);
+    for (auto& p : points) {
+        // Round z to get many points with equal coordinates
+        p = dvec3(dist(rng), 0.1 * dist(rng), std::floor(4.0 * dist(rng)));
+    }
+    return points;
+}
+
+// All points sorted by squared distance to pos
+std::vector<std::pair<double, size_t>> bruteForce(const std::vector<dvec3>& points,
+                                                  const dvec3& pos) {
+    std::vector<std::pair<double, size_t>> res;
+    for (size_t i = 0; i < points.size(); ++i) {
+        res.emplace_back(glm::distance2(points[i], pos), i);
+    }
+    std::sort(res.begin(), res.end());
+    return res;
+}
+
+}  // namespace
+
+TEST(FlatKDTreeTests, Empty) {
+    const FlatKDTree<3> tree;
+    EXPECT_TRUE(tree.empty());
+    EXPECT_EQ(FlatKDTree<3>::npos, tree.findNearest(dvec3(0.0)));
+
+    std::array<size_t, 4> indices;
+    std::array<double, 4> sqDist;
+    EXPECT_EQ(0, tree.findNNearest(dvec3(0.0), indices, sqDist));
+
+    std::vector<size_t> close;
+    tree.findWithinRadius(dvec3(0.0), 1.0, close);
+    EXPECT_TRUE(close.empty());
+}
+
+TEST(FlatKDTreeTests, KeepsPointsAndData) {
+    const auto points = randomPoints(1000, 1);
+    const FlatKDTree<3> tree(points);
+    ASSERT_EQ(points.size(), tree.size());
+
+    std::vector<int> seen(points.size(), 0);
+    for (size_t i = 0; i < tree.size(); ++i) {
+        ASSERT_LT(tree.getData(i), points.size());
+        EXPECT_EQ(points[tree.getData(i)], tree.getPosition(i));
+        ++seen[tree.getData(i)];
+    }
+    EXPECT_TRUE(std::all_of(seen.begin(), seen.end(), [](int s) { return s == 1; }));
+
+    EXPECT_THROW((FlatKDTree<3>(points, std::vector<size_t>(10))), RangeException);
+}
+
+TEST(FlatKDTreeTests, NearestNeighbors) {
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<double> dist(-0.1, 1.1);
+
+    for (size_t count : {1, 5, 9, 100, 2000}) {
+        const auto points = randomPoints(count, 2);
+        const FlatKDTree<3> tree(points);
+
+        std::array<size_t, 10> indices;
+        std::array<double, 10> sqDist;
+        for (size_t q = 0; q < 100; ++q) {
+            const dvec3 pos(dist(rng), 0.1 * dist(rng), 4.0 * dist(rng));
+            const auto expected = bruteForce(points, pos);
+
+            const auto nearest = tree.findNearest(pos);
+            ASSERT_NE(FlatKDTree<3>::npos, nearest);
+            EXPECT_EQ(expected[0].first, glm::distance2(pos, tree.getPosition(nearest)));
+
+            const size_t k = 1 + q % indices.size();
+            const auto found = tree.findNNearest(pos, util::span<size_t>(indices.data(), k),
+                                                 util::span<double>(sqDist.data(), k));
+            ASSERT_EQ(std::min(k, count), found);
+            for (size_t i = 0; i < found; ++i) {
+                EXPECT_EQ(expected[i].first, sqDist[i]);
+                EXPECT_EQ(sqDist[i], glm::distance2(pos, tree.getPosition(indices[i])));
+            }
+        }
+    }
+}
+
+TEST(FlatKDTreeTests, WithinRadius) {
+    std::mt19937 rng(4);
+    std::uniform_real_distribution<double> dist(-0.1, 1.1);
+    const auto points = randomPoints(2000, 5);
+    const FlatKDTree<3> tree(points);
+
+    std::vector<size_t> close;
+    for (size_t q = 0; q < 100; ++q) {
+        const dvec3 pos(dist(rng), 0.1 * dist(rng), 4.0 * dist(rng));
+        const double radius = 0.05 + 0.3 * (dist(rng) + 0.1);
+        const auto expected = bruteForce(points, pos);
+
+        tree.findWithinRadius(pos, radius, close);
+        const auto count = static_cast<size_t>(
+            std::count_if(expected.begin(), expected.end(),
+                          [&](const auto& e) { return e.first <= radius * radius; }));
+        EXPECT_EQ(count, close.size());
+        for (auto i : close) {
+            EXPECT_LE(glm::distance2(pos, tree.getPosition(i)), radius * radius);
+        }
+    }
+}
+
+}  // namespace inviwo
@@ -335,4 +335,50 @@ TEST(Marchingcubes, sphere) {
     */
 }
 
+
+TEST(Marchingcubes, slabs) {
+    for (auto v : {std::shared_ptr<Volume>(util::makeSphericalVolume(size3_t{33})),
+                   std::shared_ptr<Volume>(util::makeRippleVolume(size3_t{40, 23, 57}))}) {
+        for (bool invert : {false, true}) {
+            auto serial = marching::marchingCubesSlabs(v, 0.5, {0.5f, 0.0f, 0.0f, 1.0f}, invert,
+                                                       false, 1);
+            auto& pos = getBufferData<vec3>(*serial, 0);
+            auto& normals = getBufferData<vec3>(*serial, 3);
+            auto& ind = getBufferIndexData(*serial, 0);
+            ASSERT_FALSE(ind.empty());
+
+            for (size_t slabs : {2, 3, 7, 100}) {
+                auto mesh = marching::marchingCubesSlabs(v, 0.5, {0.5f, 0.0f, 0.0f, 1.0f}, invert,
+                                                         false, slabs);
+                EXPECT_EQ(pos, getBufferData<vec3>(*mesh, 0)) << slabs << " slabs";
+                EXPECT_EQ(normals, getBufferData<vec3>(*mesh, 3)) << slabs << " slabs";
+                EXPECT_EQ(ind, getBufferIndexData(*mesh, 0)) << slabs << " slabs";
+            }
+        }
+    }
+}
+
+
+TEST(Marchingcubes, brickRanges) {
+    auto v = std::shared_ptr<Volume>(util::makeSphericalVolume(size3_t{37, 30, 45}));
+    const marching::BrickRanges ranges(*v);
+
+    const auto& bricks = ranges.getBrickCount();
+    EXPECT_EQ(bricks, size3_t(5, 4, 6));
+
+    for (double iso : {0.3, 0.5, 0.7, 0.9}) {
+        EXPECT_LT(ranges.count(iso), glm::compMul(bricks));
+        for (bool invert : {false, true}) {
+            auto full = util::marchingCubesOpt(v, iso, {0.5f, 0.0f, 0.0f, 1.0f}, invert, false);
+            for (size_t slabs : {1, 3}) {
+                auto mesh = marching::marchingCubesSlabs(v, iso, {0.5f, 0.0f, 0.0f, 1.0f}, invert,
+                                                         false, slabs, nullptr, nullptr, &ranges);
+                EXPECT_EQ(getBufferData<vec3>(*full, 0), getBufferData<vec3>(*mesh, 0));
+                EXPECT_EQ(getBufferData<vec3>(*full, 3), getBufferData<vec3>(*mesh, 3));
+                EXPECT_EQ(getBufferIndexData(*full, 0), getBufferIndexData(*mesh, 0));
+            }
+        }
+    }
+}
+
 }  // namespace inviwo
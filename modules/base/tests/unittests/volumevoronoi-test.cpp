@@ -36,10 +36,60 @@
 #include <inviwo/core/datastructures/volume/volumeramprecision.h>
 #include <inviwo/core/util/indexmapper.h>
 
+#include <random>
+
 namespace inviwo {
 
 constexpr auto clamp3D = Wrapping3D{Wrapping::Clamp, Wrapping::Clamp, Wrapping::Clamp};
 
+namespace {
+
+std::vector<unsigned short> voronoiData(const Volume& volume) {
+    const auto ramtyped = dynamic_cast<const VolumeRAMPrecision<unsigned short>*>(
+        volume.getRepresentation<VolumeRAM>());
+    if (!ramtyped) return {};
+    const auto data = ramtyped->getDataTyped();
+    return std::vector<unsigned short>(data, data + glm::compMul(volume.getDimensions()));
+}
+
+// Compares every voxel against every seed point
+std::vector<unsigned short> bruteForceVoronoi(
+    const size3_t dims, const mat4& indexToModelMatrix,
+    const std::vector<std::pair<uint32_t, vec3>>& seedPoints, const Wrapping3D& wrapping,
+    const std::optional<std::vector<float>>& weights) {
+
+    const auto size = vec3{indexToModelMatrix * vec4{dims, 1.0f}} -
+                      vec3{indexToModelMatrix * vec4{0.0f, 0.0f, 0.0f, 1.0f}};
+    const auto dist = [&](size_t i, const vec3& pos) {
+        auto delta = pos - seedPoints[i].second;
+        for (int j = 0; j < 3; ++j) {
+            if (wrapping[j] != Wrapping::Repeat) continue;
+            if (delta[j] > 0.5 * size[j]) delta[j] -= size[j];
+            if (delta[j] < -0.5 * size[j]) delta[j] += size[j];
+        }
+        const float w = weights ? (*weights)[i] : 0.0f;
+        return weights ? glm::length2(delta) - w * w : glm::length2(delta);
+    };
+
+    std::vector<unsigned short> res(glm::compMul(dims));
+    const util::IndexMapper3D im(dims);
+    for (size_t z = 0; z < dims.z; z++) {
+        for (size_t y = 0; y < dims.y; y++) {
+            for (size_t x = 0; x < dims.x; x++) {
+                const auto pos = vec3{indexToModelMatrix * vec4{size3_t{x, y, z}, 1.0f}};
+                size_t best = 0;
+                for (size_t i = 1; i < seedPoints.size(); ++i) {
+                    if (dist(i, pos) < dist(best, pos)) best = i;
+                }
+                res[im(x, y, z)] = static_cast<unsigned short>(seedPoints[best].first);
+            }
+        }
+    }
+    return res;
+}
+
+}  // namespace
+
 TEST(VolumeVoronoi, Voronoi_NoSeedPoints_ThrowsException) {
     EXPECT_THROW(util::voronoiSegmentation(
                      /*volumeDimensions*/ size3_t{3, 3, 3},
@@ -206,4 +256,53 @@ TEST(VolumeVoronoi, Voronoi_ThreeSeedPoints_PartitionsVolumeInThree) {
     }
 }
 
+TEST(VolumeVoronoi, Voronoi_ManySeedPoints_MatchesBruteForce) {
+    const auto dimensions = size3_t{19, 16, 13};
+    const mat4 indexToModelMatrix{vec4{0.1, 0.02, 0.0, 0.0}, vec4{0.0, 0.12, 0.0, 0.0},
+                                  vec4{0.0, -0.03, 0.09, 0.0}, vec4{-0.5, 0.3, 2.0, 1.0}};
+    const auto lower = vec3{indexToModelMatrix * vec4{0.0f, 0.0f, 0.0f, 1.0f}};
+    const auto upper = vec3{indexToModelMatrix * vec4{dimensions, 1.0f}};
+
+    std::mt19937 rand(1234);
+    std::uniform_real_distribution<float> dist(-0.2f, 1.2f);
+    std::uniform_real_distribution<float> weightDist(0.0f, 0.15f);
+    std::vector<std::pair<uint32_t, vec3>> seedPoints;
+    std::vector<float> weights;
+    for (uint32_t i = 0; i < 300; ++i) {
+        const vec3 t{dist(rand), dist(rand), dist(rand)};
+        // Repeat some of the seed points to get equal distances
+        const auto pos = i % 10 == 9 ? seedPoints[i / 2].second : lower + t * (upper - lower);
+        seedPoints.emplace_back(i % 97, pos);
+        weights.push_back(weightDist(rand));
+    }
+
+    for (const auto& wrapping :
+         {clamp3D, Wrapping3D{Wrapping::Repeat, Wrapping::Repeat, Wrapping::Repeat},
+          Wrapping3D{Wrapping::Repeat, Wrapping::Clamp, Wrapping::Mirror}}) {
+        for (const auto& w : {std::optional<std::vector<float>>{}, std::optional{weights}}) {
+            const auto volumeVoronoi = util::voronoiSegmentation(
+                dimensions, indexToModelMatrix, seedPoints, wrapping, w);
+            EXPECT_EQ(voronoiData(*volumeVoronoi),
+                      bruteForceVoronoi(dimensions, indexToModelMatrix, seedPoints, wrapping, w));
+        }
+    }
+}
+
+TEST(VolumeVoronoi, Voronoi_JumpFlooding_MatchesExactForFewSeedPoints) {
+    const std::vector<std::pair<uint32_t, vec3>> seedPoints = {
+        {1, vec3{2.2, 3.1, 4.0}}, {2, vec3{12.5, 4.5, 3.3}}, {3, vec3{7.0, 14.2, 9.1}}};
+    const auto dimensions = size3_t{16, 16, 12};
+    const auto indexToModelMatrix = mat4{1.0f};
+
+    for (const auto& wrapping :
+         {clamp3D, Wrapping3D{Wrapping::Repeat, Wrapping::Repeat, Wrapping::Repeat}}) {
+        const auto exact = util::voronoiSegmentation(dimensions, indexToModelMatrix, seedPoints,
+                                                     wrapping, std::nullopt);
+        const auto jumpFlooding =
+            util::voronoiSegmentation(dimensions, indexToModelMatrix, seedPoints, wrapping,
+                                      std::nullopt, util::VoronoiMethod::JumpFlooding);
+        EXPECT_EQ(voronoiData(*exact), voronoiData(*jumpFlooding));
+    }
+}
+
 }  // namespace inviwo
@@ -189,6 +189,15 @@ protected:
 class IVW_MODULE_DATAFRAME_API CategoricalColumn : public TemplateColumn<std::uint32_t> {
 public:
     CategoricalColumn(const std::string& header, const std::vector<std::string>& values = {});
+    /**
+     * \brief create a column from category indices \p data referring to \p categories
+     *
+     * @param header      column header
+     * @param data        index into \p categories for each row
+     * @param categories  unique categorical values
+     */
+    CategoricalColumn(const std::string& header, std::vector<std::uint32_t> data,
+                      std::vector<std::string> categories);
     CategoricalColumn(const CategoricalColumn& rhs) = default;
     CategoricalColumn(CategoricalColumn&& rhs) = default;
 
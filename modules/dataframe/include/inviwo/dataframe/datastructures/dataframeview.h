@@ -0,0 +1,195 @@
+/*********************************************************************************
+ *
+ * Inviwo - Interactive Visualization Workshop
+ *
+ * Copyright (c) 2021 Inviwo Foundation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************************/
+
+#pragma once
+
+#include <inviwo/dataframe/dataframemoduledefine.h>
+#include <inviwo/dataframe/datastructures/column.h>
+#include <inviwo/dataframe/datastructures/dataframe.h>
+
+#include <inviwo/core/datastructures/buffer/bufferram.h>
+#include <inviwo/core/util/stdextensions.h>
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace inviwo {
+
+/**
+ * \class DataFrameView
+ * \brief A selection of rows of a DataFrame that does not copy any column data.
+ *
+ * The view shares the columns of its source DataFrame and only stores the indices of the selected
+ * rows, i.e. a selection vector. Filtering a view results in another view. The selected rows are
+ * only copied into contiguous columns when the view is materialized. The source DataFrame must not
+ * be modified while there are views of it.
+ *
+ * \code{.cpp}
+ * DataFrameView view{dataframe};
+ * auto subset = view.filter("x", util::overloaded{[](const float& x) { return x > 0.5f; },
+ *                                                 [](const auto&) { return false; }})
+ *                   .filter("category", util::overloaded{[](const std::string& cat) {
+ *                                                            return cat == "a";
+ *                                                        },
+ *                                                        [](const auto&) { return false; }});
+ * auto result = subset.materialize();
+ * \endcode
+ * @see dataframe::filteredRows
+ */
+class IVW_MODULE_DATAFRAME_API DataFrameView {
+public:
+    /**
+     * A view of all rows of \p dataframe.
+     */
+    explicit DataFrameView(std::shared_ptr<const DataFrame> dataframe);
+    /**
+     * A view of the rows \p rows of \p dataframe.
+     * @pre all entries in \p rows are smaller than the number of rows of \p dataframe
+     */
+    DataFrameView(std::shared_ptr<const DataFrame> dataframe, std::vector<size_t> rows);
+    /**
+     * A view of the rows of \p dataframe where \p mask is true.
+     * @throw Exception if the size of \p mask does not match the number of rows of \p dataframe
+     */
+    DataFrameView(std::shared_ptr<const DataFrame> dataframe, const std::vector<bool>& mask);
+
+    const std::shared_ptr<const DataFrame>& getDataFrame() const;
+
+    size_t getNumberOfRows() const;
+    size_t getNumberOfColumns() const;
+
+    /**
+     * Returns true if the view holds all rows of the source DataFrame in order.
+     */
+    bool isIdentity() const;
+    /**
+     * Returns the row index in the source DataFrame of row \p row of the view.
+     */
+    size_t getSourceRow(size_t row) const;
+    /**
+     * Returns the row indices in the source DataFrame of all rows of the view.
+     */
+    std::vector<size_t> getSelection() const;
+
+    std::shared_ptr<const Column> getColumn(size_t index) const;
+    std::shared_ptr<const Column> getColumn(const std::string& name) const;
+
+    double getAsDouble(size_t column, size_t row) const;
+    std::string getAsString(size_t column, size_t row) const;
+
+    /**
+     * \brief apply predicate \p pred to the values of column \p column in the rows of this view and
+     * return a view of the rows where the predicate evaluates to true.
+     *
+     * The predicate has to handle the different column types like in dataframe::filteredRows.
+     * For categorical columns, the predicate is evaluated once per category and not per row.
+     * @throw Exception if there is no column \p column
+     */
+    template <typename Pred>
+    DataFrameView filter(size_t column, Pred pred) const;
+    template <typename Pred>
+    DataFrameView filter(const std::string& column, Pred pred) const;
+
+    /**
+     * A view of the rows \p rows of this view.
+     * @pre all entries in \p rows are smaller than getNumberOfRows()
+     */
+    DataFrameView select(const std::vector<size_t>& rows) const;
+    /**
+     * A view of the rows of this view where \p mask is true.
+     * @throw Exception if the size of \p mask does not match getNumberOfRows()
+     */
+    DataFrameView select(const std::vector<bool>& mask) const;
+
+    /**
+     * Copy the rows of the view of column \p column into a new column. Categorical columns keep all
+     * categories of the source column.
+     */
+    std::shared_ptr<Column> materialize(size_t column) const;
+    /**
+     * Copy the rows of the view into a new DataFrame. The index column of the new DataFrame holds
+     * the index column values of the selected rows in the source DataFrame.
+     */
+    std::shared_ptr<DataFrame> materialize() const;
+
+private:
+    size_t findColumn(const std::string& name) const;
+    template <typename Accept>
+    std::vector<size_t> selectRows(Accept accept) const;
+
+    std::shared_ptr<const DataFrame> dataframe_;
+    std::optional<std::vector<size_t>> rows_;  //!< no value if all rows are selected
+};
+
+template <typename Accept>
+std::vector<size_t> DataFrameView::selectRows(Accept accept) const {
+    std::vector<size_t> rows;
+    if (rows_) {
+        for (auto row : *rows_) {
+            if (accept(row)) rows.push_back(row);
+        }
+    } else {
+        for (size_t row = 0; row < dataframe_->getNumberOfRows(); ++row) {
+            if (accept(row)) rows.push_back(row);
+        }
+    }
+    return rows;
+}
+
+#include <warn/push>
+#include <warn/ignore/conversion>
+template <typename Pred>
+DataFrameView DataFrameView::filter(size_t column, Pred pred) const {
+    auto col = getColumn(column);
+    if (auto catCol = dynamic_cast<const CategoricalColumn*>(col.get())) {
+        const auto accepted = util::transform(
+            catCol->getCategories(), [&](const std::string& cat) -> char { return pred(cat); });
+        const auto& ids = catCol->getTypedBuffer()->getRAMRepresentation()->getDataContainer();
+        return DataFrameView{dataframe_,
+                             selectRows([&](size_t row) { return accepted[ids[row]] != 0; })};
+    } else {
+        return col->getBuffer()->getRepresentation<BufferRAM>()->dispatch<DataFrameView>(
+            [&](auto typedBuf) {
+                const auto& data = typedBuf->getDataContainer();
+                return DataFrameView{dataframe_, selectRows([&](size_t row) -> bool {
+                                         return pred(data[row]);
+                                     })};
+            });
+    }
+}
+#include <warn/pop>
+
+template <typename Pred>
+DataFrameView DataFrameView::filter(const std::string& column, Pred pred) const {
+    return filter(findColumn(column), pred);
+}
+
+}  // namespace inviwo
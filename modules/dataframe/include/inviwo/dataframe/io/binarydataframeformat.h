@@ -0,0 +1,126 @@
+/*********************************************************************************
+ *
+ * Inviwo - Interactive Visualization Workshop
+ *
+ * Copyright (c) 2021 Inviwo Foundation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************************/
+
+#pragma once
+
+#include <inviwo/dataframe/dataframemoduledefine.h>
+#include <inviwo/core/util/formats.h>
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace inviwo {
+
+/**
+ * \brief Per chunk minimum and maximum values of a column in a binary DataFrame file.
+ * The rows of the column are split into chunks of rowsPerChunk rows, the last chunk might be
+ * smaller. NaN values are ignored, the range of a chunk with only NaN values is [NaN, NaN].
+ * @see BinaryDataFrameWriter, BinaryDataFrameReader::readStatistics
+ */
+struct IVW_MODULE_DATAFRAME_API DataFrameChunkStatistics {
+    std::string header;
+    size_t components = 0;
+    size_t rowsPerChunk = 0;
+    std::vector<double> min;  //!< min[chunk * components + component]
+    std::vector<double> max;  //!< max[chunk * components + component]
+
+    size_t getNumberOfChunks() const;
+    double getMin(size_t chunk, size_t component = 0) const;
+    double getMax(size_t chunk, size_t component = 0) const;
+};
+
+/**
+ * Layout of the binary columnar DataFrame format (.ivdf). All values are stored in the byte order
+ * of the writing machine, which is recorded in the file.
+ *
+ *     char[4]   magic "IVDF"
+ *     uint32    version
+ *     uint32    byte order mark 0x01020304
+ *     uint32    number of columns
+ *     uint64    number of rows
+ *     uint64    rows per statistics chunk, 0 if there are no statistics
+ *     for each column:
+ *         uint32    kind, see ColumnKind
+ *         string    data format name, i.e. DataFormatBase::getString()
+ *         string    header
+ *         uint64    offset of the column data, rows * DataFormatBase::getSize() bytes
+ *         uint64    offset of the statistics, 2 * chunks * components doubles (min then max)
+ *         uint32    number of categories, followed by the categories as strings
+ *
+ * Strings are stored as a uint32 length followed by the characters. The column data and the
+ * statistics start at offsets aligned to binarydataframe::alignment bytes from the beginning of
+ * the file.
+ */
+namespace binarydataframe {
+
+constexpr std::array<char, 4> magic{'I', 'V', 'D', 'F'};
+constexpr std::uint32_t version = 1;
+constexpr std::uint32_t byteOrderMark = 0x01020304;
+constexpr size_t alignment = 64;
+
+enum class ColumnKind : std::uint32_t { Index = 0, Plain = 1, Categorical = 2 };
+
+struct IVW_MODULE_DATAFRAME_API ColumnLayout {
+    ColumnKind kind = ColumnKind::Plain;
+    const DataFormatBase* format = nullptr;
+    std::string header;
+    std::vector<std::string> categories;
+    size_t dataOffset = 0;
+    size_t statsOffset = 0;
+};
+
+struct IVW_MODULE_DATAFRAME_API Layout {
+    size_t rows = 0;
+    size_t rowsPerChunk = 0;
+    std::vector<ColumnLayout> columns;
+
+    size_t getNumberOfChunks() const;
+    size_t getDataSize(const ColumnLayout& column) const;
+    size_t getStatisticsSize(const ColumnLayout& column) const;
+};
+
+/**
+ * Serialize the header of a file with the given \p layout. The size of the result does not depend
+ * on the offsets of the columns.
+ */
+IVW_MODULE_DATAFRAME_API std::string serialize(const Layout& layout);
+
+/**
+ * Deserialize the header of a file from \p file, which has to contain the whole file.
+ * @throw DataReaderException if the header is malformed, of an unsupported version or byte order,
+ * or if the data of a column does not fit within \p file.
+ */
+IVW_MODULE_DATAFRAME_API Layout deserialize(std::string_view file);
+
+}  // namespace binarydataframe
+
+}  // namespace inviwo
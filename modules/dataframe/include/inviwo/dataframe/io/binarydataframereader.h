@@ -0,0 +1,79 @@
+/*********************************************************************************
+ *
+ * Inviwo - Interactive Visualization Workshop
+ *
+ * Copyright (c) 2021 Inviwo Foundation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************************/
+
+#pragma once
+
+#include <inviwo/dataframe/dataframemoduledefine.h>
+#include <inviwo/dataframe/datastructures/dataframe.h>
+#include <inviwo/dataframe/io/binarydataframeformat.h>
+
+#include <inviwo/core/io/datareader.h>
+
+#include <vector>
+
+namespace inviwo {
+
+/**
+ * \class BinaryDataFrameReader
+ * \ingroup dataio
+ * \brief Reads a DataFrame from the binary columnar format (.ivdf).
+ *
+ * The file is memory mapped and the data of each column is copied in parallel straight into the
+ * buffer of the column, nothing is parsed besides the header. The index column is restored as
+ * well.
+ * @see binarydataframe::Layout, BinaryDataFrameWriter
+ */
+class IVW_MODULE_DATAFRAME_API BinaryDataFrameReader : public DataReaderType<DataFrame> {
+public:
+    BinaryDataFrameReader();
+    BinaryDataFrameReader(const BinaryDataFrameReader&) = default;
+    BinaryDataFrameReader(BinaryDataFrameReader&&) noexcept = default;
+    BinaryDataFrameReader& operator=(const BinaryDataFrameReader&) = default;
+    BinaryDataFrameReader& operator=(BinaryDataFrameReader&&) noexcept = default;
+    virtual BinaryDataFrameReader* clone() const override;
+    virtual ~BinaryDataFrameReader() = default;
+    using DataReaderType<DataFrame>::readData;
+
+    /**
+     * @throws FileException if the file cannot be accessed
+     * @throws DataReaderException if the file is not a valid binary DataFrame file
+     */
+    virtual std::shared_ptr<DataFrame> readData(const std::string& fileName) override;
+
+    /**
+     * Read the chunk statistics of all columns of \p fileName without reading the column data.
+     * Columns without statistics, i.e. categorical columns or all columns if the file was written
+     * without statistics, have no chunks.
+     * @throws FileException if the file cannot be accessed
+     * @throws DataReaderException if the file is not a valid binary DataFrame file
+     */
+    std::vector<DataFrameChunkStatistics> readStatistics(const std::string& fileName) const;
+};
+
+}  // namespace inviwo
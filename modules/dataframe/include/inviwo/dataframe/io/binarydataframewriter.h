@@ -0,0 +1,73 @@
+/*********************************************************************************
+ *
+ * Inviwo - Interactive Visualization Workshop
+ *
+ * Copyright (c) 2021 Inviwo Foundation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************************/
+
+#pragma once
+
+#include <inviwo/dataframe/dataframemoduledefine.h>
+#include <inviwo/dataframe/datastructures/dataframe.h>
+
+#include <inviwo/core/io/datawriter.h>
+
+namespace inviwo {
+
+/**
+ * \class BinaryDataFrameWriter
+ * \ingroup dataio
+ * \brief Writes a DataFrame into the binary columnar format (.ivdf).
+ *
+ * The raw data of each column is stored contiguously together with the categories of categorical
+ * columns. Optionally, the minimum and maximum values of each chunk of rows are stored for every
+ * column, which can be used to skip chunks without reading them.
+ * @see binarydataframe::Layout, BinaryDataFrameReader
+ */
+class IVW_MODULE_DATAFRAME_API BinaryDataFrameWriter : public DataWriterType<DataFrame> {
+public:
+    /**
+     * @param rowsPerChunk  number of rows per statistics chunk, 0 disables the statistics
+     */
+    BinaryDataFrameWriter(size_t rowsPerChunk = 64 * 1024);
+    BinaryDataFrameWriter(const BinaryDataFrameWriter&) = default;
+    BinaryDataFrameWriter& operator=(const BinaryDataFrameWriter&) = default;
+    virtual BinaryDataFrameWriter* clone() const override;
+    virtual ~BinaryDataFrameWriter() = default;
+
+    void setRowsPerChunk(size_t rowsPerChunk);
+    size_t getRowsPerChunk() const;
+
+    /**
+     * @throws DataWriterException if the file exists and overwrite is not set, if the file cannot
+     * be written, or if the columns of \p data differ in size
+     */
+    virtual void writeData(const DataFrame* data, const std::string filePath) const override;
+
+private:
+    size_t rowsPerChunk_;
+};
+
+}  // namespace inviwo
@@ -37,6 +37,8 @@
 #include <inviwo/core/io/datareaderexception.h>
 #include <inviwo/dataframe/datastructures/dataframe.h>
 
+#include <string_view>
+
 namespace inviwo {
 
 /**
@@ -59,6 +61,9 @@ public:
  * \brief A reader for comma separated value (CSV) files with customizable delimiters.
  * The default delimiter is ',' and headers are included. Floating point values are stored as
  * float32.
+ *
+ * The data is first indexed row by row, taking quotes into account. The first 50 rows determine
+ * the column types and the rows are then parsed in parallel directly into the columns.
  */
 class IVW_MODULE_DATAFRAME_API CSVReader : public DataReaderType<DataFrame> {
 public:
@@ -80,7 +85,7 @@ public:
     using DataReaderType<DataFrame>::readData;
 
     /**
-     * read a CSV file from a file
+     * read a CSV file from a file. The file is memory mapped instead of read, if possible.
      *
      * @param fileName   name of the input CSV file
      * @return a DataFrame containing the CSV data
@@ -105,6 +110,8 @@ public:
     std::shared_ptr<DataFrame> readData(std::istream& stream) const;
 
 private:
+    std::shared_ptr<DataFrame> parse(std::string_view data) const;
+
     std::string delimiters_;
     bool firstRowHeader_;
     bool doublePrecision_;
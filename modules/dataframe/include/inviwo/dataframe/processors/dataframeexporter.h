@@ -50,10 +50,10 @@ namespace inviwo {
 
 /** \docpage{org.inviwo.DataFrameExporter, DataFrame Exporter}
  * ![](org.inviwo.DataFrameExporter.png?classIdentifier=org.inviwo.DataFrameExporter)
- * This processor exports a DataFrame into a CSV or XML file.
+ * This processor exports a DataFrame into a CSV, XML, or binary DataFrame (ivdf) file.
  *
  * ### Inports
- *   * __<Inport>__ source DataFrame which is saved as CSV or XML file
+ *   * __<Inport>__ source DataFrame which is saved as CSV, XML, or binary DataFrame file
  *
  */
 
@@ -73,6 +73,7 @@ protected:
 private:
     void exportAsCSV(bool separateVectorTypesIntoColumns = true);
     void exportAsXML();
+    void exportAsBinary();
 
     DataInport<DataFrame> dataFrame_;
 
@@ -86,6 +87,7 @@ private:
 
     static FileExtension csvExtension_;
     static FileExtension xmlExtension_;
+    static FileExtension binaryExtension_;
 
     bool export_;
 };
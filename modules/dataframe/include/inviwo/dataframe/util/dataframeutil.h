@@ -81,7 +81,8 @@ std::shared_ptr<DataFrame> IVW_MODULE_DATAFRAME_API appendRows(const DataFrame&
  * \brief create a new DataFrame by using an inner join of DataFrame \p left and DataFrame \p right.
  * That is only rows with matching keys are kept.
  *
- * It is assumed that the entries in the key columns are unique. Otherwise results are undefined.
+ * It is assumed that the entries in the key columns are unique. Otherwise, each row of \p left is
+ * joined with the first matching row of \p right.
  * @param left
  * @param right
  * @param keyColumn   header of the column used as key for the join operation (default: index
@@ -100,8 +101,8 @@ std::shared_ptr<DataFrame> IVW_MODULE_DATAFRAME_API innerJoin(
  * \brief create a new DataFrame by using an outer left join of DataFrame \p left and DataFrame \p
  * right. That is all rows of \p left are augmented with matching rows from \p right.
  *
- * It is assumed that the entries in the key columns of \p right are unique. Otherwise results are
- * undefined.
+ * It is assumed that the entries in the key columns of \p right are unique. Otherwise, the first
+ * matching row of \p right is used.
  *
  * @param left
  * @param right
@@ -146,6 +147,7 @@ combineDataFrames(std::vector<std::shared_ptr<DataFrame>> dataframes, bool skipI
  * @param col   column containing data for filtering
  * @param pred  predicate to check values from \p col
  * @return list of row indices where rows fulfill the predicate
+ * @see DataFrameView::filter for filtering without copying the DataFrame
  */
 template <typename Pred>
 std::vector<size_t> filteredRows(std::shared_ptr<const Column> col, Pred pred);
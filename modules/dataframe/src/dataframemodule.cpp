@@ -40,6 +40,8 @@
 #include <inviwo/dataframe/processors/volumesequencetodataframe.h>
 #include <inviwo/dataframe/properties/colormapproperty.h>
 
+#include <inviwo/dataframe/io/binarydataframereader.h>
+#include <inviwo/dataframe/io/binarydataframewriter.h>
 #include <inviwo/dataframe/io/csvreader.h>
 #include <inviwo/dataframe/io/jsonreader.h>
 
@@ -71,6 +73,8 @@ DataFrameModule::DataFrameModule(InviwoApplication* app) : InviwoModule(app, "Da
     // Readers and writes
     registerDataReader(std::make_unique<CSVReader>());
     registerDataReader(std::make_unique<JSONDataFrameReader>());
+    registerDataReader(std::make_unique<BinaryDataFrameReader>());
+    registerDataWriter(std::make_unique<BinaryDataFrameWriter>());
 
     // Data converters
     registerPropertyConverter(std::make_unique<OptionToStringConverter<DataFrameColumnProperty>>());
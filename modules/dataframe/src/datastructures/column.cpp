@@ -42,6 +42,10 @@ CategoricalColumn::CategoricalColumn(const std::string& header,
     append(values);
 }
 
+CategoricalColumn::CategoricalColumn(const std::string& header, std::vector<std::uint32_t> data,
+                                     std::vector<std::string> categories)
+    : TemplateColumn<std::uint32_t>(header, std::move(data)), lookUpTable_(std::move(categories)) {}
+
 CategoricalColumn* CategoricalColumn::clone() const { return new CategoricalColumn(*this); }
 
 std::string CategoricalColumn::getAsString(size_t idx) const {
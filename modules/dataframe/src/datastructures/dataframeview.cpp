@@ -0,0 +1,172 @@
+/*********************************************************************************
+ *
+ * Inviwo - Interactive Visualization Workshop
+ *
+ * Copyright (c) 2021 Inviwo Foundation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************************/
+
+#include <inviwo/dataframe/datastructures/dataframeview.h>
+
+#include <inviwo/core/util/exception.h>
+#include <inviwo/core/util/formatdispatching.h>
+#include <inviwo/core/util/parallelfor.h>
+
+#include <numeric>
+
+#include <fmt/format.h>
+
+namespace inviwo {
+
+namespace {
+
+// Rows per block when gathering rows in parallel
+constexpr size_t minBlockRows = 16 * 1024;
+
+std::vector<size_t> maskToRows(const std::vector<bool>& mask, size_t expectedSize) {
+    if (mask.size() != expectedSize) {
+        throw Exception(fmt::format("Mask size ({}) does not match row count ({})", mask.size(),
+                                    expectedSize),
+                        IVW_CONTEXT_CUSTOM("DataFrameView"));
+    }
+    std::vector<size_t> rows;
+    for (size_t row = 0; row < mask.size(); ++row) {
+        if (mask[row]) rows.push_back(row);
+    }
+    return rows;
+}
+
+}  // namespace
+
+DataFrameView::DataFrameView(std::shared_ptr<const DataFrame> dataframe)
+    : dataframe_{std::move(dataframe)}, rows_{} {}
+
+DataFrameView::DataFrameView(std::shared_ptr<const DataFrame> dataframe, std::vector<size_t> rows)
+    : dataframe_{std::move(dataframe)}, rows_{std::move(rows)} {}
+
+DataFrameView::DataFrameView(std::shared_ptr<const DataFrame> dataframe,
+                             const std::vector<bool>& mask)
+    : dataframe_{std::move(dataframe)}
+    , rows_{maskToRows(mask, dataframe_->getNumberOfRows())} {}
+
+const std::shared_ptr<const DataFrame>& DataFrameView::getDataFrame() const { return dataframe_; }
+
+size_t DataFrameView::getNumberOfRows() const {
+    return rows_ ? rows_->size() : dataframe_->getNumberOfRows();
+}
+
+size_t DataFrameView::getNumberOfColumns() const { return dataframe_->getNumberOfColumns(); }
+
+bool DataFrameView::isIdentity() const { return !rows_; }
+
+size_t DataFrameView::getSourceRow(size_t row) const { return rows_ ? (*rows_)[row] : row; }
+
+std::vector<size_t> DataFrameView::getSelection() const {
+    if (rows_) return *rows_;
+    std::vector<size_t> rows(dataframe_->getNumberOfRows());
+    std::iota(rows.begin(), rows.end(), size_t{0});
+    return rows;
+}
+
+std::shared_ptr<const Column> DataFrameView::getColumn(size_t index) const {
+    if (index >= dataframe_->getNumberOfColumns()) {
+        throw Exception(fmt::format("Column {} out of range (DataFrame has {} columns)", index,
+                                    dataframe_->getNumberOfColumns()),
+                        IVW_CONTEXT);
+    }
+    return dataframe_->getColumn(index);
+}
+
+std::shared_ptr<const Column> DataFrameView::getColumn(const std::string& name) const {
+    return dataframe_->getColumn(name);
+}
+
+size_t DataFrameView::findColumn(const std::string& name) const {
+    for (size_t i = 0; i < dataframe_->getNumberOfColumns(); ++i) {
+        if (dataframe_->getColumn(i)->getHeader() == name) return i;
+    }
+    throw Exception(fmt::format("Column '{}' not found", name), IVW_CONTEXT);
+}
+
+double DataFrameView::getAsDouble(size_t column, size_t row) const {
+    return getColumn(column)->getAsDouble(getSourceRow(row));
+}
+
+std::string DataFrameView::getAsString(size_t column, size_t row) const {
+    return getColumn(column)->getAsString(getSourceRow(row));
+}
+
+DataFrameView DataFrameView::select(const std::vector<size_t>& rows) const {
+    if (!rows_) return DataFrameView{dataframe_, rows};
+    return DataFrameView{dataframe_,
+                         util::transform(rows, [&](size_t row) { return (*rows_)[row]; })};
+}
+
+DataFrameView DataFrameView::select(const std::vector<bool>& mask) const {
+    return select(maskToRows(mask, getNumberOfRows()));
+}
+
+std::shared_ptr<Column> DataFrameView::materialize(size_t column) const {
+    auto col = getColumn(column);
+    if (!rows_) return std::shared_ptr<Column>(col->clone());
+
+    const auto& rows = *rows_;
+    return col->getBuffer()->getRepresentation<BufferRAM>()->dispatch<std::shared_ptr<Column>>(
+        [&](auto typedBuf) -> std::shared_ptr<Column> {
+            using ValueType = util::PrecisionValueType<decltype(typedBuf)>;
+            const auto& src = typedBuf->getDataContainer();
+            std::vector<ValueType> data(rows.size());
+            util::parallelFor(
+                rows.size(),
+                [&](size_t begin, size_t end) {
+                    for (size_t i = begin; i < end; ++i) data[i] = src[rows[i]];
+                },
+                minBlockRows);
+
+            if constexpr (std::is_same_v<ValueType, CategoricalColumn::type>) {
+                if (auto catCol = dynamic_cast<const CategoricalColumn*>(col.get())) {
+                    return std::make_shared<CategoricalColumn>(
+                        catCol->getHeader(), std::move(data), catCol->getCategories());
+                }
+            }
+            return std::make_shared<TemplateColumn<ValueType>>(col->getHeader(), std::move(data));
+        });
+}
+
+std::shared_ptr<DataFrame> DataFrameView::materialize() const {
+    auto dataframe = std::make_shared<DataFrame>();
+    for (size_t i = 1; i < dataframe_->getNumberOfColumns(); ++i) {
+        dataframe->addColumn(materialize(i));
+    }
+    const auto& srcIndex =
+        dataframe_->getIndexColumn()->getTypedBuffer()->getRAMRepresentation()->getDataContainer();
+    auto& index = dataframe->getIndexColumn()
+                      ->getTypedBuffer()
+                      ->getEditableRAMRepresentation()
+                      ->getDataContainer();
+    index = util::transform(getSelection(), [&](size_t row) { return srcIndex[row]; });
+    return dataframe;
+}
+
+}  // namespace inviwo
@@ -0,0 +1,202 @@
+/*********************************************************************************
+ *
+ * Inviwo - Interactive Visualization Workshop
+ *
+ * Copyright (c) 2021 Inviwo Foundation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************************/
+
+#include <inviwo/dataframe/io/binarydataframeformat.h>
+
+#include <inviwo/core/io/datareaderexception.h>
+
+#include <cstring>
+#include <limits>
+
+#include <fmt/format.h>
+
+namespace inviwo {
+
+size_t DataFrameChunkStatistics::getNumberOfChunks() const {
+    return components == 0 ? 0 : min.size() / components;
+}
+
+double DataFrameChunkStatistics::getMin(size_t chunk, size_t component) const {
+    return min[chunk * components + component];
+}
+
+double DataFrameChunkStatistics::getMax(size_t chunk, size_t component) const {
+    return max[chunk * components + component];
+}
+
+namespace binarydataframe {
+
+size_t Layout::getNumberOfChunks() const {
+    return rowsPerChunk == 0 ? 0 : (rows + rowsPerChunk - 1) / rowsPerChunk;
+}
+
+size_t Layout::getDataSize(const ColumnLayout& column) const {
+    return rows * column.format->getSize();
+}
+
+size_t Layout::getStatisticsSize(const ColumnLayout& column) const {
+    return 2 * getNumberOfChunks() * column.format->getComponents() * sizeof(double);
+}
+
+namespace {
+
+template <typename T>
+void put(std::string& dst, T value) {
+    dst.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void put(std::string& dst, std::string_view str) {
+    put(dst, static_cast<std::uint32_t>(str.size()));
+    dst.append(str);
+}
+
+class Cursor {
+public:
+    explicit Cursor(std::string_view data) : data_{data} {}
+
+    template <typename T>
+    T get() {
+        T value;
+        std::memcpy(&value, take(sizeof(T)).data(), sizeof(T));
+        return value;
+    }
+
+    std::string getString() { return std::string{take(get<std::uint32_t>())}; }
+
+private:
+    std::string_view take(size_t size) {
+        if (size > data_.size() - pos_) {
+            throw DataReaderException("Binary DataFrame: Unexpected end of header",
+                                      IVW_CONTEXT_CUSTOM("binarydataframe::deserialize"));
+        }
+        auto res = data_.substr(pos_, size);
+        pos_ += size;
+        return res;
+    }
+
+    std::string_view data_;
+    size_t pos_ = 0;
+};
+
+}  // namespace
+
+std::string serialize(const Layout& layout) {
+    std::string dst;
+    dst.append(magic.data(), magic.size());
+    put(dst, version);
+    put(dst, byteOrderMark);
+    put(dst, static_cast<std::uint32_t>(layout.columns.size()));
+    put(dst, static_cast<std::uint64_t>(layout.rows));
+    put(dst, static_cast<std::uint64_t>(layout.rowsPerChunk));
+    for (const auto& column : layout.columns) {
+        put(dst, static_cast<std::uint32_t>(column.kind));
+        put(dst, std::string_view{column.format->getString()});
+        put(dst, std::string_view{column.header});
+        put(dst, static_cast<std::uint64_t>(column.dataOffset));
+        put(dst, static_cast<std::uint64_t>(column.statsOffset));
+        put(dst, static_cast<std::uint32_t>(column.categories.size()));
+        for (const auto& category : column.categories) {
+            put(dst, std::string_view{category});
+        }
+    }
+    return dst;
+}
+
+Layout deserialize(std::string_view file) {
+    const auto error = [](const std::string& message) {
+        return DataReaderException("Binary DataFrame: " + message,
+                                   IVW_CONTEXT_CUSTOM("binarydataframe::deserialize"));
+    };
+
+    Cursor cursor{file};
+    const auto fileMagic = cursor.get<std::array<char, 4>>();
+    if (fileMagic != magic) {
+        throw error("Not a binary DataFrame file");
+    }
+    if (const auto fileVersion = cursor.get<std::uint32_t>(); fileVersion != version) {
+        throw error(fmt::format("Unsupported version {}, expected {}", fileVersion, version));
+    }
+    if (cursor.get<std::uint32_t>() != byteOrderMark) {
+        throw error("File was written on a machine with a different byte order");
+    }
+
+    Layout layout;
+    const auto columns = cursor.get<std::uint32_t>();
+    layout.rows = static_cast<size_t>(cursor.get<std::uint64_t>());
+    layout.rowsPerChunk = static_cast<size_t>(cursor.get<std::uint64_t>());
+    if (layout.rows > std::numeric_limits<std::uint32_t>::max()) {
+        throw error(fmt::format("Too many rows ({})", layout.rows));
+    }
+
+    // check ranges without overflowing
+    const auto fits = [&](size_t offset, size_t size) {
+        return offset <= file.size() && size <= file.size() - offset;
+    };
+
+    for (std::uint32_t i = 0; i < columns; ++i) {
+        auto& column = layout.columns.emplace_back();
+        column.kind = static_cast<ColumnKind>(cursor.get<std::uint32_t>());
+        if (column.kind != ColumnKind::Index && column.kind != ColumnKind::Plain &&
+            column.kind != ColumnKind::Categorical) {
+            throw error(fmt::format("Invalid kind of column {}", i));
+        }
+        const auto formatName = cursor.getString();
+        try {
+            column.format = DataFormatBase::get(formatName);
+        } catch (const DataFormatException&) {
+            column.format = DataFormatBase::get();
+        }
+        if (column.format->getId() == DataFormatId::NotSpecialized) {
+            throw error(fmt::format("Invalid data format '{}'", formatName));
+        }
+        column.header = cursor.getString();
+        column.dataOffset = static_cast<size_t>(cursor.get<std::uint64_t>());
+        column.statsOffset = static_cast<size_t>(cursor.get<std::uint64_t>());
+        const auto categories = cursor.get<std::uint32_t>();
+        for (std::uint32_t j = 0; j < categories; ++j) {
+            column.categories.push_back(cursor.getString());
+        }
+
+        if (column.kind != ColumnKind::Plain &&
+            column.format->getId() != DataFormatId::UInt32) {
+            throw error(fmt::format("Invalid data format '{}' of column '{}'", formatName,
+                                    column.header));
+        }
+        if (!fits(column.dataOffset, layout.getDataSize(column)) ||
+            (column.statsOffset != 0 &&
+             !fits(column.statsOffset, layout.getStatisticsSize(column)))) {
+            throw error(fmt::format("Data of column '{}' exceeds the file size", column.header));
+        }
+    }
+    return layout;
+}
+
+}  // namespace binarydataframe
+
+}  // namespace inviwo
@@ -0,0 +1,171 @@
+/*********************************************************************************
+ *
+ * Inviwo - Interactive Visualization Workshop
+ *
+ * Copyright (c) 2021 Inviwo Foundation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************************/
+
+#include <inviwo/dataframe/io/binarydataframereader.h>
+#include <inviwo/dataframe/datastructures/column.h>
+
+#include <inviwo/core/datastructures/buffer/bufferram.h>
+#include <inviwo/core/io/datareaderexception.h>
+#include <inviwo/core/io/memorymappedfile.h>
+#include <inviwo/core/util/filesystem.h>
+#include <inviwo/core/util/formatdispatching.h>
+#include <inviwo/core/util/parallelfor.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <string_view>
+
+#include <fmt/format.h>
+
+namespace inviwo {
+
+namespace detail {
+
+// Copy in blocks of at least this many bytes
+constexpr size_t minBlockBytes = 4 * 1024 * 1024;
+
+std::unique_ptr<MemoryMappedFile> mapFile(const std::string& fileName) {
+    auto file = filesystem::ifstream(fileName, std::ios::in | std::ios::binary);
+    if (!file.is_open()) {
+        throw FileException(fmt::format("Could not open file '{}'", fileName),
+                            IVW_CONTEXT_CUSTOM("BinaryDataFrameReader"));
+    }
+    file.seekg(0, std::ios::end);
+    const auto size = static_cast<size_t>(file.tellg());
+    if (size == 0) {
+        throw DataReaderException(fmt::format("Empty file '{}'", fileName),
+                                  IVW_CONTEXT_CUSTOM("BinaryDataFrameReader"));
+    }
+    return std::make_unique<MemoryMappedFile>(fileName, 0, size);
+}
+
+void copyBytes(void* dst, const char* src, size_t size) {
+    util::parallelFor(
+        size,
+        [&](size_t begin, size_t end) {
+            std::memcpy(static_cast<char*>(dst) + begin, src + begin, end - begin);
+        },
+        minBlockBytes);
+}
+
+struct ColumnFromBytes {
+    template <typename Result, typename Format>
+    Result operator()(const std::string& header, const char* src, size_t rows) {
+        using T = typename Format::type;
+        std::vector<T> data(rows);
+        copyBytes(data.data(), src, rows * sizeof(T));
+        return std::make_shared<TemplateColumn<T>>(header, std::move(data));
+    }
+};
+
+}  // namespace detail
+
+BinaryDataFrameReader::BinaryDataFrameReader() : DataReaderType<DataFrame>() {
+    addExtension(FileExtension("ivdf", "Inviwo Binary DataFrame"));
+}
+
+BinaryDataFrameReader* BinaryDataFrameReader::clone() const {
+    return new BinaryDataFrameReader(*this);
+}
+
+std::shared_ptr<DataFrame> BinaryDataFrameReader::readData(const std::string& fileName) {
+    const auto mapped = detail::mapFile(fileName);
+    const std::string_view file{static_cast<const char*>(mapped->data()), mapped->size()};
+    const auto layout = binarydataframe::deserialize(file);
+
+    auto dataframe = std::make_shared<DataFrame>(0u);
+    bool hasIndex = false;
+    for (const auto& column : layout.columns) {
+        const char* src = file.data() + column.dataOffset;
+        switch (column.kind) {
+            case binarydataframe::ColumnKind::Index: {
+                auto& index = dataframe->getIndexColumn()
+                                  ->getTypedBuffer()
+                                  ->getEditableRAMRepresentation()
+                                  ->getDataContainer();
+                index.resize(layout.rows);
+                detail::copyBytes(index.data(), src, layout.getDataSize(column));
+                dataframe->getIndexColumn()->setHeader(column.header);
+                hasIndex = true;
+                break;
+            }
+            case binarydataframe::ColumnKind::Categorical: {
+                std::vector<std::uint32_t> ids(layout.rows);
+                detail::copyBytes(ids.data(), src, layout.getDataSize(column));
+                const auto categories = static_cast<std::uint32_t>(column.categories.size());
+                if (std::any_of(ids.begin(), ids.end(),
+                                [&](std::uint32_t id) { return id >= categories; })) {
+                    throw DataReaderException(
+                        fmt::format("Invalid category in column '{}'", column.header),
+                        IVW_CONTEXT);
+                }
+                dataframe->addColumn(std::make_shared<CategoricalColumn>(
+                    column.header, std::move(ids), column.categories));
+                break;
+            }
+            case binarydataframe::ColumnKind::Plain:
+                dataframe->addColumn(
+                    dispatching::dispatch<std::shared_ptr<Column>, dispatching::filter::All>(
+                        column.format->getId(), detail::ColumnFromBytes{}, column.header, src,
+                        layout.rows));
+                break;
+        }
+    }
+    if (!hasIndex) {
+        dataframe->updateIndexBuffer();
+    }
+    return dataframe;
+}
+
+std::vector<DataFrameChunkStatistics> BinaryDataFrameReader::readStatistics(
+    const std::string& fileName) const {
+    const auto mapped = detail::mapFile(fileName);
+    const std::string_view file{static_cast<const char*>(mapped->data()), mapped->size()};
+    const auto layout = binarydataframe::deserialize(file);
+
+    std::vector<DataFrameChunkStatistics> result;
+    for (const auto& column : layout.columns) {
+        auto& stats = result.emplace_back();
+        stats.header = column.header;
+        stats.components = column.format->getComponents();
+        if (column.statsOffset == 0) continue;
+
+        stats.rowsPerChunk = layout.rowsPerChunk;
+        const size_t count = layout.getNumberOfChunks() * stats.components;
+        stats.min.resize(count);
+        stats.max.resize(count);
+        const char* src = file.data() + column.statsOffset;
+        std::memcpy(stats.min.data(), src, count * sizeof(double));
+        std::memcpy(stats.max.data(), src + count * sizeof(double), count * sizeof(double));
+    }
+    return result;
+}
+
+}  // namespace inviwo
@@ -0,0 +1,188 @@
+/*********************************************************************************
+ *
+ * Inviwo - Interactive Visualization Workshop
+ *
+ * Copyright (c) 2021 Inviwo Foundation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************************/
+
+#include <inviwo/dataframe/io/binarydataframewriter.h>
+#include <inviwo/dataframe/io/binarydataframeformat.h>
+#include <inviwo/dataframe/datastructures/column.h>
+
+#include <inviwo/core/datastructures/buffer/bufferram.h>
+#include <inviwo/core/io/datawriterexception.h>
+#include <inviwo/core/util/filesystem.h>
+#include <inviwo/core/util/parallelfor.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <fstream>
+#include <limits>
+
+#include <fmt/format.h>
+
+namespace inviwo {
+
+namespace detail {
+
+/**
+ * Minimum values of all chunks and components followed by the maximum values, ignoring NaN
+ * @see DataFrameChunkStatistics
+ */
+std::vector<double> chunkStatistics(const BufferRAM* buffer, size_t rowsPerChunk) {
+    return buffer->dispatch<std::vector<double>>([&](auto br) {
+        using ValueType = util::PrecisionValueType<decltype(br)>;
+        constexpr size_t components = util::flat_extent<ValueType>::value;
+
+        const auto& data = br->getDataContainer();
+        const size_t chunks = (data.size() + rowsPerChunk - 1) / rowsPerChunk;
+        std::vector<double> stats(2 * chunks * components);
+        util::parallelFor(chunks, [&](size_t begin, size_t end) {
+            for (size_t chunk = begin; chunk < end; ++chunk) {
+                std::array<double, components> min;
+                std::array<double, components> max;
+                min.fill(std::numeric_limits<double>::infinity());
+                max.fill(-std::numeric_limits<double>::infinity());
+
+                const size_t rowEnd = std::min(data.size(), (chunk + 1) * rowsPerChunk);
+                for (size_t row = chunk * rowsPerChunk; row < rowEnd; ++row) {
+                    for (size_t c = 0; c < components; ++c) {
+                        const auto value = static_cast<double>(util::glmcomp(data[row], c));
+                        if (std::isnan(value)) continue;
+                        min[c] = std::min(min[c], value);
+                        max[c] = std::max(max[c], value);
+                    }
+                }
+                for (size_t c = 0; c < components; ++c) {
+                    const bool empty = min[c] > max[c];
+                    stats[chunk * components + c] =
+                        empty ? std::numeric_limits<double>::quiet_NaN() : min[c];
+                    stats[(chunks + chunk) * components + c] =
+                        empty ? std::numeric_limits<double>::quiet_NaN() : max[c];
+                }
+            }
+        });
+        return stats;
+    });
+}
+
+size_t alignOffset(size_t offset) {
+    return (offset + binarydataframe::alignment - 1) / binarydataframe::alignment *
+           binarydataframe::alignment;
+}
+
+}  // namespace detail
+
+BinaryDataFrameWriter::BinaryDataFrameWriter(size_t rowsPerChunk)
+    : DataWriterType<DataFrame>(), rowsPerChunk_{rowsPerChunk} {
+    addExtension(FileExtension("ivdf", "Inviwo Binary DataFrame"));
+}
+
+BinaryDataFrameWriter* BinaryDataFrameWriter::clone() const {
+    return new BinaryDataFrameWriter(*this);
+}
+
+void BinaryDataFrameWriter::setRowsPerChunk(size_t rowsPerChunk) { rowsPerChunk_ = rowsPerChunk; }
+
+size_t BinaryDataFrameWriter::getRowsPerChunk() const { return rowsPerChunk_; }
+
+void BinaryDataFrameWriter::writeData(const DataFrame* data, const std::string filePath) const {
+    if (filesystem::fileExists(filePath) && !overwrite_) {
+        throw DataWriterException(fmt::format("Output file '{}' already exists", filePath),
+                                  IVW_CONTEXT);
+    }
+
+    binarydataframe::Layout layout;
+    layout.rows = data->getNumberOfRows();
+    layout.rowsPerChunk = layout.rows > 0 ? rowsPerChunk_ : 0;
+
+    std::vector<const BufferRAM*> buffers;
+    for (const auto& col : *data) {
+        if (col->getSize() != layout.rows) {
+            throw DataWriterException(
+                fmt::format("Column '{}' has {} rows, expected {}", col->getHeader(),
+                            col->getSize(), layout.rows),
+                IVW_CONTEXT);
+        }
+        auto& column = layout.columns.emplace_back();
+        column.format = col->getBuffer()->getDataFormat();
+        column.header = col->getHeader();
+        if (col == data->getIndexColumn()) {
+            column.kind = binarydataframe::ColumnKind::Index;
+        } else if (auto cc = dynamic_cast<const CategoricalColumn*>(col.get())) {
+            column.kind = binarydataframe::ColumnKind::Categorical;
+            column.categories = cc->getCategories();
+        }
+        buffers.push_back(col->getBuffer()->getRepresentation<BufferRAM>());
+    }
+
+    // Categories are compared by id, their ranges are not stored.
+    const auto hasStatistics = [&](const binarydataframe::ColumnLayout& column) {
+        return layout.rowsPerChunk != 0 &&
+               column.kind != binarydataframe::ColumnKind::Categorical;
+    };
+
+    // The size of the header does not depend on the offsets
+    size_t offset = detail::alignOffset(binarydataframe::serialize(layout).size());
+    for (auto& column : layout.columns) {
+        column.dataOffset = offset;
+        offset = detail::alignOffset(offset + layout.getDataSize(column));
+        if (hasStatistics(column)) {
+            column.statsOffset = offset;
+            offset = detail::alignOffset(offset + layout.getStatisticsSize(column));
+        }
+    }
+
+    auto file = filesystem::ofstream(filePath, std::ios::out | std::ios::binary);
+    if (!file.is_open()) {
+        throw DataWriterException(fmt::format("Could not open file '{}'", filePath), IVW_CONTEXT);
+    }
+    const auto header = binarydataframe::serialize(layout);
+    file.write(header.data(), header.size());
+
+    size_t pos = header.size();
+    const auto writeAt = [&](size_t offset, const void* bytes, size_t size) {
+        static constexpr std::array<char, binarydataframe::alignment> padding{};
+        file.write(padding.data(), offset - pos);
+        file.write(static_cast<const char*>(bytes), size);
+        pos = offset + size;
+    };
+    for (size_t i = 0; i < layout.columns.size(); ++i) {
+        const auto& column = layout.columns[i];
+        writeAt(column.dataOffset, buffers[i]->getData(), layout.getDataSize(column));
+        if (hasStatistics(column)) {
+            const auto stats = detail::chunkStatistics(buffers[i], layout.rowsPerChunk);
+            writeAt(column.statsOffset, stats.data(), stats.size() * sizeof(double));
+        }
+    }
+
+    if (!file) {
+        throw DataWriterException(fmt::format("Could not write file '{}'", filePath),
+                                  IVW_CONTEXT);
+    }
+}
+
+}  // namespace inviwo
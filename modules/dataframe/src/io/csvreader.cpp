@@ -31,11 +31,24 @@
 
 #include <inviwo/dataframe/datastructures/column.h>
 #include <inviwo/dataframe/datastructures/dataframe.h>
+#include <inviwo/core/datastructures/buffer/bufferram.h>
+#include <inviwo/core/io/memorymappedfile.h>
 #include <inviwo/core/util/filesystem.h>
+#include <inviwo/core/util/parallelfor.h>
 #include <inviwo/core/util/stringconversion.h>
 
 #include <fstream>
 #include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <deque>
+#include <limits>
+#include <optional>
+#include <sstream>
+#include <unordered_map>
+
+#include <fmt/format.h>
 
 namespace inviwo {
 
@@ -73,25 +86,22 @@ std::shared_ptr<DataFrame> CSVReader::readData(const std::string& fileName) {
         throw CSVDataReaderException("Empty file, no data", IVW_CONTEXT);
     }
 
-    return readData(file);
-}
-
-namespace detail {
+    std::unique_ptr<MemoryMappedFile> mapped;
+    try {
+        mapped = std::make_unique<MemoryMappedFile>(fileName, 0, static_cast<size_t>(len));
+    } catch (const FileException&) {
+        // not every file can be mapped, fall back to reading it through the stream
+        return readData(file);
+    }
 
-bool isLineBreak(const char ch, std::istream& stream) {
-    if (ch == '\r') {
-        // consume potential LF (\n) following CR (\r)
-        if (stream.peek() == '\n') {
-            stream.get();
-        }
-        return true;
-    } else {
-        return (ch == '\n');
+    std::string_view data{static_cast<const char*>(mapped->data()), mapped->size()};
+    // Skip BOM if it exists. Added by for example Excel when saving csv files.
+    if (data.substr(0, 3) == "\xef\xbb\xbf") {
+        data.remove_prefix(3);
     }
+    return parse(data);
 }
 
-}  // namespace detail
-
 std::shared_ptr<DataFrame> CSVReader::readData(std::istream& stream) const {
     // Skip BOM if it exists. Added by for example Excel when saving csv files.
     filesystem::skipByteOrderMark(stream);
@@ -100,160 +110,433 @@ std::shared_ptr<DataFrame> CSVReader::readData(std::istream& stream) const {
         throw CSVDataReaderException("Input stream in a bad state", IVW_CONTEXT);
     }
 
-    // create a string stream from input stream for buffering
+    // the parser works on a contiguous buffer, read the remaining stream in one go
     std::stringstream in;
     in << stream.rdbuf();
     if (in.fail()) {
         throw CSVDataReaderException("No data", IVW_CONTEXT);
     }
+    const auto buffer = in.str();
+    return parse(buffer);
+}
 
-    // current line
-    size_t lineNumber = 1u;
+namespace detail {
+
+/**
+ * Location of a single field in the CSV data. The value of the field is [begin, end) except for
+ * the last field of the data, which is trimmed.
+ */
+struct CSVField {
+    size_t begin;
+    size_t end;
+    size_t next;     //!< start of the following field
+    bool lineBreak;  //!< the field is terminated by a line break
+    bool eof;        //!< the field is terminated by the end of the data
+    bool normalize;  //!< the field contains CR or CRLF line breaks which are read as LF
+};
+
+struct CSVRow {
+    size_t next;  //!< start of the following row
+    size_t fields = 0;
+    bool eof = false;    //!< no row, the end of the data was reached
+    bool empty = false;  //!< an empty line
+    bool lastEmpty = false;
+    bool hasValue = false;  //!< at least one field is not empty
+};
+
+/**
+ * Splits CSV data into fields and rows. Quotes are kept in the field values. Delimiters and line
+ * breaks are not considered separators if they are enclosed by quotes, i.e. a field only ends if
+ * its quote count is 0 or even with a quote as the previous character.
+ */
+class CSVScanner {
+public:
+    CSVScanner(std::string_view data, std::string_view delimiters) : data_{data}, types_{} {
+        for (auto ch : delimiters) types_[static_cast<unsigned char>(ch)] = Delimiter;
+        types_[static_cast<unsigned char>('"')] = Quote;
+        types_[static_cast<unsigned char>('\r')] = LineBreak;
+        types_[static_cast<unsigned char>('\n')] = LineBreak;
+    }
 
-    // extract exactly one field from the current stream position, the bool return value indicates
-    // whether a line break was detected following the field
-    auto extractField = [&in, &lineNumber, delims = delimiters_]() -> std::pair<std::string, bool> {
-        std::string value;
+    /**
+     * Extract exactly one field starting at \p pos. \p lineNumber is increased for each line
+     * break, a CR, LF, or CRLF.
+     * @throw CSVDataReaderException if the data ends within quotes
+     */
+    CSVField field(size_t pos, size_t& lineNumber) const {
+        const size_t size = data_.size();
         size_t quoteCount = 0;
         size_t quoteBeginLine = 0;
+        bool normalize = false;
         char prev = 0;
 
-        char ch;
-        while (in.get(ch) && in.good()) {
-            bool linebreak = detail::isLineBreak(ch, in);
-            if (linebreak) {
-                ++lineNumber;  // increase line counter
-                // ensure that ch is equal to '\n'
-                ch = '\n';
-                // consume line break, if inside quotes
-                if ((quoteCount & 1) != 0) {
-                    value += ch;
+        size_t i = pos;
+        while (i < size) {
+            const char ch = data_[i];
+            switch (types_[static_cast<unsigned char>(ch)]) {
+                case Other:
+                    do {
+                        ++i;
+                    } while (i < size && types_[static_cast<unsigned char>(data_[i])] == Other);
+                    prev = data_[i - 1];
+                    break;
+                case Quote:
+                    if (quoteCount == 0) quoteBeginLine = lineNumber;
+                    ++quoteCount;
                     prev = ch;
-                    continue;
-                }
-            }
-            if (ch == '"') {  // found a quote
-                if (quoteCount == 0) quoteBeginLine = lineNumber;
-                ++quoteCount;
-            } else if (util::contains(delims, ch) || linebreak) {
-                // found a delimiter/newline, ensure that it isn't enclosed by quotes,
-                // i.e. a quote count of 0 or an even count of quotes if the previous
-                // character was a quote
-                if ((quoteCount == 0) || ((prev == '"') && ((quoteCount & 1) == 0))) {
-                    return {value, linebreak};
+                    ++i;
+                    break;
+                case Delimiter:
+                    if (separates(quoteCount, prev)) {
+                        return {pos, i, i + 1, false, false, normalize};
+                    }
+                    prev = ch;
+                    ++i;
+                    break;
+                case LineBreak: {
+                    const size_t lineBreak = i;
+                    i += (ch == '\r' && i + 1 < size && data_[i + 1] == '\n') ? 2 : 1;
+                    ++lineNumber;
+                    if (separates(quoteCount, prev)) {
+                        return {pos, lineBreak, i, true, false, normalize};
+                    }
+                    normalize |= ch == '\r';
+                    prev = '\n';
+                    break;
                 }
             }
-            prev = ch;
-            value += ch;
         }
-        if (((quoteCount & 1) != 0) && in.eof()) {
+        if ((quoteCount & 1) != 0) {
             throw CSVDataReaderException("Unmatched quotes (starting in line " +
                                          std::to_string(quoteBeginLine) + ")");
         }
-        return {trim(value), false};
-    };
+        return {pos, size, size, false, true, normalize};
+    }
 
-    // extract one row from the current stream position, the bool return value indicates whether
-    // the end-of-file was detected
-    auto extractRow = [&in, extractField,
-                       &lineNumber](size_t maxColCount = std::numeric_limits<size_t>::max())
-        -> std::pair<std::vector<std::string>, bool> {
-        auto val = extractField();
-        if (in.eof() && val.first.empty()) {
-            // reached end of file, no more data
-            return {{}, true};
-        } else if (val.first.empty() && val.second) {
-            // empty line, ignore
-            return {{}, false};
+    /**
+     * The field value without normalized line breaks, only valid if !field.normalize.
+     */
+    std::string_view view(const CSVField& field) const {
+        const auto str = data_.substr(field.begin, field.end - field.begin);
+        return field.eof ? util::trim(str) : str;
+    }
+
+    std::string value(const CSVField& field) const {
+        const auto str = view(field);
+        if (!field.normalize) return std::string{str};
+
+        std::string result;
+        result.reserve(str.size());
+        for (size_t i = 0; i < str.size(); ++i) {
+            if (str[i] == '\r') {
+                result += '\n';
+                if (i + 1 < str.size() && str[i + 1] == '\n') ++i;
+            } else {
+                result += str[i];
+            }
         }
-        std::vector<std::string> values;
-        values.push_back(val.first);
-        while (!val.second && !in.eof()) {
-            val = extractField();
-            values.push_back(val.first);
+        return result;
+    }
+
+    /**
+     * Extract one row starting at \p pos. The field values are added to \p values if given.
+     */
+    CSVRow row(size_t pos, size_t& lineNumber, std::vector<std::string>* values = nullptr) const {
+        auto field = this->field(pos, lineNumber);
+        CSVRow row{field.next};
+        if (view(field).empty() && (field.eof || field.lineBreak)) {
+            // reached end of file or found an empty line
+            row.eof = field.eof;
+            row.empty = field.lineBreak;
+            return row;
+        }
+        while (true) {
+            const bool empty = view(field).empty();
+            ++row.fields;
+            row.lastEmpty = empty;
+            row.hasValue |= !empty;
+            if (values) values->push_back(value(field));
+            if (field.lineBreak || field.eof) break;
+            field = this->field(field.next, lineNumber);
         }
-        // ignore last field _if_ it is empty and would be inserted in the maxColCount+1 column
-        if (values.back().empty() && (values.size() - 1 == maxColCount)) {
-            values.resize(values.size() - 1);
-        } else if ((values.size() != maxColCount) &&
-                   (maxColCount != std::numeric_limits<size_t>::max())) {
-            // mismatch in the number of columns
-            throw CSVDataReaderException("Column counts do not match (line " +
-                                         std::to_string(lineNumber) + ": " +
-                                         std::to_string(values.size()) + " fields; DataFrame has " +
-                                         std::to_string(maxColCount) + " columns)");
+        row.next = field.next;
+        return row;
+    }
+
+private:
+    enum Type : char { Other = 0, Delimiter, Quote, LineBreak };
+
+    static bool separates(size_t quoteCount, char prev) {
+        return (quoteCount == 0) || ((prev == '"') && ((quoteCount & 1) == 0));
+    }
+
+    std::string_view data_;
+    std::array<Type, 256> types_;
+};
+
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+constexpr bool floatCharconv = true;
+#else
+constexpr bool floatCharconv = false;
+#endif
+
+/**
+ * Parse a number like `std::istream >> value` would, i.e. skipping leading white space and
+ * ignoring trailing characters.
+ */
+template <typename T>
+bool parseNumber(std::string_view str, T& value) {
+    const auto isSpace = [](char ch) { return std::isspace(static_cast<unsigned char>(ch)); };
+    auto first = std::find_if_not(str.begin(), str.end(), isSpace);
+    if (first != str.end() && *first == '+' && (first + 1 == str.end() || first[1] != '-')) {
+        ++first;
+    }
+    if constexpr (std::is_integral_v<T> || floatCharconv) {
+        const auto [ptr, ec] =
+            std::from_chars(str.data() + (first - str.begin()), str.data() + str.size(), value);
+        return ec == std::errc();
+    } else {
+        std::istringstream stream{std::string{first, str.end()}};
+        stream >> value;
+        return !stream.fail();
+    }
+}
+
+template <typename T>
+void parseColumn(const std::vector<std::string_view>& fields, size_t stride, size_t column,
+                 T* dest, const std::string& header) {
+    for (size_t row = 0, i = column; i < fields.size(); ++row, i += stride) {
+        if constexpr (std::is_integral_v<T>) {
+            // no special value indicating missing data for integral types
+            if (fields[i].empty()) {
+                dest[row] = T{0};
+            } else if (!parseNumber(fields[i], dest[row])) {
+                throw DataTypeMismatch(
+                    fmt::format("Data type mismatch for column {} (\"{}\"), cannot convert \"{}\"",
+                                column + 1, header, fields[i]),
+                    IVW_CONTEXT_CUSTOM("CSVReader"));
+            }
+        } else {
+            if (!parseNumber(fields[i], dest[row])) {
+                dest[row] = std::numeric_limits<T>::quiet_NaN();
+            }
         }
-        return {values, false};
+    }
+}
+
+// Rows per block when parsing in parallel
+constexpr size_t minBlockRows = 4096;
+
+/**
+ * Parse the rows starting at \p rows in parallel into the columns of \p dataFrame. The columns
+ * have to be empty and the rows have to contain at least one field per column.
+ */
+void parseRows(const CSVScanner& scanner, const std::vector<size_t>& rows, DataFrame& dataFrame) {
+    const size_t columnCount = dataFrame.getNumberOfColumns() - 1;
+    const size_t rowCount = rows.size();
+
+    // The rows are parsed straight into the storage of the columns
+    enum class Type { Categorical, Int, Float, Double };
+    std::vector<std::shared_ptr<Column>> columns;
+    std::vector<Type> types;
+    std::vector<void*> dest;
+    for (size_t col = 0; col < columnCount; ++col) {
+        auto column = dataFrame.getColumn(col + 1);
+        if (dynamic_cast<CategoricalColumn*>(column.get())) {
+            types.push_back(Type::Categorical);
+        } else if (dynamic_cast<TemplateColumn<int>*>(column.get())) {
+            types.push_back(Type::Int);
+        } else if (dynamic_cast<TemplateColumn<float>*>(column.get())) {
+            types.push_back(Type::Float);
+        } else if (dynamic_cast<TemplateColumn<double>*>(column.get())) {
+            types.push_back(Type::Double);
+        } else {
+            throw DataTypeMismatch(fmt::format("Unsupported data type for column {} (\"{}\")",
+                                               col + 1, column->getHeader()),
+                                   IVW_CONTEXT_CUSTOM("CSVReader"));
+        }
+        auto ram = column->getBuffer()->getEditableRepresentation<BufferRAM>();
+        ram->setSize(rowCount);
+        dest.push_back(ram->getData());
+        columns.push_back(std::move(column));
+    }
+
+    // Categorical columns are parsed into block local categories that are merged afterwards to
+    // keep the order in which the categories first appear.
+    struct Block {
+        std::deque<std::string> normalized;
+        std::vector<std::unordered_map<std::string_view, std::uint32_t>> categories;
+        std::vector<std::vector<std::string_view>> order;
+    };
+    const size_t blockCount = util::parallelBlockCount(rowCount, minBlockRows);
+    std::vector<Block> blocks(blockCount);
+
+    util::parallelFor(blockCount, [&](size_t blockBegin, size_t blockEnd) {
+        std::vector<std::string_view> fields;
+        for (size_t b = blockBegin; b < blockEnd; ++b) {
+            const size_t begin = b * rowCount / blockCount;
+            const size_t end = (b + 1) * rowCount / blockCount;
+            auto& block = blocks[b];
+            block.categories.resize(columnCount);
+            block.order.resize(columnCount);
+
+            fields.clear();
+            fields.reserve((end - begin) * columnCount);
+            size_t lineNumber = 0;
+            for (size_t row = begin; row < end; ++row) {
+                size_t pos = rows[row];
+                for (size_t col = 0; col < columnCount; ++col) {
+                    const auto field = scanner.field(pos, lineNumber);
+                    if (field.normalize) {
+                        fields.push_back(block.normalized.emplace_back(scanner.value(field)));
+                    } else {
+                        fields.push_back(scanner.view(field));
+                    }
+                    pos = field.next;
+                }
+            }
+
+            for (size_t col = 0; col < columnCount; ++col) {
+                const auto& header = columns[col]->getHeader();
+                switch (types[col]) {
+                    case Type::Categorical: {
+                        auto ids = static_cast<std::uint32_t*>(dest[col]) + begin;
+                        auto& categories = block.categories[col];
+                        auto& order = block.order[col];
+                        for (size_t row = 0, i = col; i < fields.size();
+                             ++row, i += columnCount) {
+                            auto [it, inserted] = categories.try_emplace(
+                                fields[i], static_cast<std::uint32_t>(order.size()));
+                            if (inserted) order.push_back(fields[i]);
+                            ids[row] = it->second;
+                        }
+                        break;
+                    }
+                    case Type::Int:
+                        parseColumn(fields, columnCount, col,
+                                    static_cast<int*>(dest[col]) + begin, header);
+                        break;
+                    case Type::Float:
+                        parseColumn(fields, columnCount, col,
+                                    static_cast<float*>(dest[col]) + begin, header);
+                        break;
+                    case Type::Double:
+                        parseColumn(fields, columnCount, col,
+                                    static_cast<double*>(dest[col]) + begin, header);
+                        break;
+                }
+            }
+        }
+    });
+
+    for (size_t col = 0; col < columnCount; ++col) {
+        if (types[col] != Type::Categorical) continue;
+        auto column = static_cast<CategoricalColumn*>(columns[col].get());
+
+        std::unordered_map<std::string_view, std::uint32_t> categories;
+        std::vector<std::vector<std::uint32_t>> mappings(blockCount);
+        for (size_t b = 0; b < blockCount; ++b) {
+            for (auto category : blocks[b].order[col]) {
+                auto it = categories.find(category);
+                if (it == categories.end()) {
+                    it = categories
+                             .emplace(category, column->addCategory(std::string{category}))
+                             .first;
+                }
+                mappings[b].push_back(it->second);
+            }
+        }
+        auto ids = static_cast<std::uint32_t*>(dest[col]);
+        util::parallelFor(blockCount, [&](size_t blockBegin, size_t blockEnd) {
+            for (size_t b = blockBegin; b < blockEnd; ++b) {
+                const auto& mapping = mappings[b];
+                for (size_t row = b * rowCount / blockCount;
+                     row < (b + 1) * rowCount / blockCount; ++row) {
+                    ids[row] = mapping[ids[row]];
+                }
+            }
+        });
+    }
+}
+
+}  // namespace detail
+
+std::shared_ptr<DataFrame> CSVReader::parse(std::string_view data) const {
+    const detail::CSVScanner scanner{data, delimiters_};
+
+    // current line
+    size_t lineNumber = 1u;
+    size_t pos = 0u;
+
+    auto mismatch = [](size_t line, size_t fields, size_t columns) {
+        return CSVDataReaderException("Column counts do not match (line " + std::to_string(line) +
+                                      ": " + std::to_string(fields) + " fields; DataFrame has " +
+                                      std::to_string(columns) + " columns)");
     };
 
     std::vector<std::string> headers;
     size_t maxColCount = std::numeric_limits<size_t>::max();
     if (firstRowHeader_) {
         // read headers
-        auto row = extractRow();
-        if (row.second || row.first.empty()) {
+        auto row = scanner.row(pos, lineNumber, &headers);
+        if (row.eof || row.empty) {
             throw CSVDataReaderException("Empty file, column headers not found");
         }
-        headers = row.first;
         maxColCount = headers.size();
+        pos = row.next;
     }
 
+    // Index all rows holding data, the first 50 rows are also used as examples to figure out
+    // the column types. Rows with only delimiters (,,,,) are ignored.
     std::vector<std::vector<std::string>> exampleRows;
-    std::vector<size_t> exampleLineNumbers;  // line numbers matching the example rows
-    std::streampos streamPos = in.tellg();
-    for (auto exampleRow = 0u; exampleRow < 50u; ++exampleRow) {
-        size_t currentLine = lineNumber;
-        auto row = extractRow(maxColCount);
-        if (row.second) {
-            // reached end-of-file
-            if (exampleRow == 0) {
-                throw CSVDataReaderException("Empty file, no data");
+    std::vector<size_t> rows;
+    // without headers, the column counts of the examples are checked once all are read
+    std::optional<CSVDataReaderException> exampleMismatch;
+    for (size_t rowIndex = 0;; ++rowIndex) {
+        const bool example = rowIndex < 50u;
+        if (!example && exampleMismatch) throw *exampleMismatch;
+        const size_t currentLine = lineNumber;
+        std::vector<std::string> values;
+        const auto row = scanner.row(pos, lineNumber, example ? &values : nullptr);
+        if (row.eof) break;
+        const size_t rowBegin = pos;
+        pos = row.next;
+        if (row.empty) continue;  // ignore empty lines
+
+        if (maxColCount == std::numeric_limits<size_t>::max()) {
+            // no headers, the column count is given by the first row
+            maxColCount = row.fields;
+        }
+        if (example && !firstRowHeader_) {
+            if (row.fields != maxColCount && !exampleMismatch) {
+                exampleMismatch = mismatch(currentLine, row.fields, maxColCount);
             }
-            in.clear();  // clear eof-bit
-            break;
-        } else if (!row.first.empty()) {  // ignore empty lines
-            exampleRows.emplace_back(row.first);
-            exampleLineNumbers.emplace_back(currentLine);
+        } else if (row.lastEmpty && (row.fields - 1 == maxColCount)) {
+            // ignore last field _if_ it is empty and would be inserted in the maxColCount+1 column
+            if (example) values.pop_back();
+        } else if (row.fields != maxColCount) {
+            throw mismatch(lineNumber, row.fields, maxColCount);
         }
+
+        if (example) exampleRows.push_back(std::move(values));
+        if (row.hasValue) rows.push_back(rowBegin);
     }
 
-    // Rewind to start position
-    in.seekg(streamPos, std::ios::beg);
+    if (exampleMismatch) throw *exampleMismatch;
+    if (exampleRows.empty()) {
+        throw CSVDataReaderException("Empty file, no data");
+    }
     if (!firstRowHeader_) {
         // assign default column headers
-        for (size_t i = 0; i < exampleRows.front().size(); ++i) {
+        for (size_t i = 0; i < maxColCount; ++i) {
             headers.push_back(std::string("Column ") + std::to_string(i + 1));
         }
-        // update column count
-        maxColCount = headers.size();
     }
 
-    // figure out column types
-    // but check for correct column counts first
-    for (size_t i = 0; i < exampleRows.size(); ++i) {
-        if (exampleRows[i].size() != maxColCount) {
-            throw CSVDataReaderException(
-                "Column counts do not match (line " + std::to_string(exampleLineNumbers[i]) + ": " +
-                std::to_string(exampleRows[i].size()) + " fields; DataFrame has " +
-                std::to_string(maxColCount) + " columns)");
-        }
-    }
-
-    auto dataFrame = createDataFrame(exampleRows, headers);
-
-    size_t rowIndex = firstRowHeader_ ? 1 : 0;
-    auto row = extractRow(maxColCount);
-    while (!row.second) {
-        // Do not add empty rows, i.e. rows with only delimiters (,,,,) or newline
-        if (std::any_of(std::begin(row.first), std::end(row.first),
-                        [](const auto& a) { return !a.empty(); })) {
-            // May throw DataTypeMismatch, but do not catch it here since it indicates
-            // that the DataFrame is in an invalid state
-            dataFrame->addRow(row.first);
-        }
-        row = extractRow(maxColCount);
-        ++rowIndex;
-    }
+    auto dataFrame = createDataFrame(exampleRows, headers, doublePrecision_);
+    // May throw DataTypeMismatch, but do not catch it here since it indicates
+    // that the DataFrame is in an invalid state
+    detail::parseRows(scanner, rows, *dataFrame);
     dataFrame->updateIndexBuffer();
     return dataFrame;
 }
@@ -28,6 +28,7 @@
  *********************************************************************************/
 
 #include <inviwo/dataframe/processors/dataframeexporter.h>
+#include <inviwo/dataframe/io/binarydataframewriter.h>
 
 #include <inviwo/core/util/filesystem.h>
 #include <inviwo/core/util/ostreamjoiner.h>
@@ -40,17 +41,19 @@ namespace inviwo {
 
 // The Class Identifier has to be globally unique. Use a reverse DNS naming scheme
 const ProcessorInfo DataFrameExporter::processorInfo_{
-    "org.inviwo.DataFrameExporter",      // Class identifier
-    "DataFrame Exporter",                // Display name
-    "Data Output",                       // Category
-    CodeState::Stable,                   // Code state
-    "CPU, DataFrame, Export, CSV, XML",  // Tags
+    "org.inviwo.DataFrameExporter",              // Class identifier
+    "DataFrame Exporter",                        // Display name
+    "Data Output",                               // Category
+    CodeState::Stable,                           // Code state
+    "CPU, DataFrame, Export, CSV, XML, Binary",  // Tags
 };
 
 const ProcessorInfo DataFrameExporter::getProcessorInfo() const { return processorInfo_; }
 
 FileExtension DataFrameExporter::csvExtension_ = FileExtension("csv", "CSV");
 FileExtension DataFrameExporter::xmlExtension_ = FileExtension("xml", "XML");
+FileExtension DataFrameExporter::binaryExtension_ =
+    FileExtension("ivdf", "Inviwo Binary DataFrame");
 
 DataFrameExporter::DataFrameExporter()
     : Processor()
@@ -68,6 +71,7 @@ DataFrameExporter::DataFrameExporter()
     exportFile_.clearNameFilters();
     exportFile_.addNameFilter(csvExtension_);
     exportFile_.addNameFilter(xmlExtension_);
+    exportFile_.addNameFilter(binaryExtension_);
 
     addPort(dataFrame_);
     addProperty(exportFile_);
@@ -80,8 +84,9 @@ DataFrameExporter::DataFrameExporter()
 
     exportFile_.setAcceptMode(AcceptMode::Save);
     exportFile_.onChange([this]() {
-        separateVectorTypesIntoColumns_.setReadOnly(exportFile_.getSelectedExtension().extension_ ==
-                                                    xmlExtension_.extension_);
+        const auto& ext = exportFile_.getSelectedExtension().extension_;
+        separateVectorTypesIntoColumns_.setReadOnly(ext == xmlExtension_.extension_ ||
+                                                    ext == binaryExtension_.extension_);
     });
     exportButton_.onChange([&]() { export_ = true; });
 
@@ -102,6 +107,8 @@ void DataFrameExporter::exportNow() {
         exportAsXML();
     } else if (exportFile_.getSelectedExtension() == csvExtension_) {
         exportAsCSV(separateVectorTypesIntoColumns_);
+    } else if (exportFile_.getSelectedExtension() == binaryExtension_) {
+        exportAsBinary();
     } else {
         // use CSV format as fallback
         LogWarn("Could not determine export format from extension '"
@@ -224,4 +231,12 @@ void DataFrameExporter::exportAsXML() {
     LogInfo("XML file exported to " << exportFile_);
 }
 
+void DataFrameExporter::exportAsBinary() {
+    // the binary format always includes the index column
+    BinaryDataFrameWriter writer;
+    writer.setOverwrite(true);
+    writer.writeData(dataFrame_.getData().get(), exportFile_.get());
+    LogInfo("Binary DataFrame exported to " << exportFile_);
+}
+
 }  // namespace inviwo
@@ -30,12 +30,18 @@
 #include <inviwo/dataframe/util/dataframeutil.h>
 
 #include <inviwo/core/util/document.h>
+#include <inviwo/core/util/hashcombine.h>
+#include <inviwo/core/util/parallelfor.h>
 #include <inviwo/core/util/stdextensions.h>
 #include <inviwo/core/util/assertion.h>
 
 #include <fmt/format.h>
 
-#include <optional>
+#include <array>
+#include <atomic>
+#include <limits>
+#include <string_view>
+#include <unordered_map>
 
 namespace inviwo {
 
@@ -191,95 +197,180 @@ void columnCheck(const DataFrame& left, const DataFrame& right,
     }
 }
 
+constexpr size_t noMatch = std::numeric_limits<size_t>::max();
+
+// Rows per block when hashing, probing, and gathering rows in parallel
+constexpr size_t minBlockRows = 16 * 1024;
+
+enum class Side { Left = 0, Right = 1 };
+
 /**
- * \brief for each row in leftCol return a list of matching row indices in rightCol
+ * A key column present in both DataFrames of a join.
  */
-template <bool firstMatchOnly = false>
-std::vector<std::vector<size_t>> getMatchingRows(std::shared_ptr<const Column> leftCol,
-                                                 std::shared_ptr<const Column> rightCol) {
-    std::vector<std::vector<size_t>> rows(leftCol->getSize());
-
-    if (auto catCol1 = dynamic_cast<const CategoricalColumn*>(leftCol.get())) {
-        // need to match values of categorical columns instead of indices stored in buffer
-        auto catCol2 = dynamic_cast<const CategoricalColumn*>(rightCol.get());
-        IVW_ASSERT(catCol2, "right column is not categorical");
-
-        auto valuesRight = catCol2->getValues();
-        for (auto&& [i, key] : util::enumerate(catCol1->getValues())) {
-            // find all matching rows in right column
-            std::vector<size_t> matches;
-            for (auto&& [r, value] : util::enumerate(valuesRight)) {
-                if (key == value) {
-                    matches.emplace_back(r);
-                    if constexpr (firstMatchOnly) break;
-                }
+class JoinKey {
+public:
+    virtual ~JoinKey() = default;
+    /**
+     * Combine the hashes of the key values in rows [begin, end) of \p side into \p hashes.
+     */
+    virtual void hash(Side side, size_t begin, size_t end, size_t* hashes) const = 0;
+    virtual bool equal(Side sideA, size_t rowA, Side sideB, size_t rowB) const = 0;
+};
+
+template <typename T>
+class TypedJoinKey : public JoinKey {
+public:
+    TypedJoinKey(const T* left, const T* right) : data_{left, right} {}
+    TypedJoinKey(const T* left, std::vector<T> right)
+        : storage_{std::move(right)}, data_{left, storage_.data()} {}
+
+    virtual void hash(Side side, size_t begin, size_t end, size_t* hashes) const override {
+        const T* data = data_[static_cast<size_t>(side)];
+        for (size_t row = begin; row < end; ++row) {
+            for (size_t i = 0; i < util::flat_extent<T>::value; ++i) {
+                // hash all types as double, -0 and +0 are equal and have to have the same hash
+                const auto value = static_cast<double>(util::glmcomp(data[row], i));
+                util::hash_combine(hashes[row], value == 0.0 ? 0.0 : value);
             }
-            rows[i] = std::move(matches);
         }
+    }
+    virtual bool equal(Side sideA, size_t rowA, Side sideB, size_t rowB) const override {
+        return data_[static_cast<size_t>(sideA)][rowA] == data_[static_cast<size_t>(sideB)][rowB];
+    }
+
+private:
+    std::vector<T> storage_;
+    std::array<const T*, 2> data_;
+};
+
+/**
+ * Categorical keys are compared by category id. The categories of the right column are mapped to
+ * the ids of the left column, categories only found on the right get new ids.
+ */
+std::unique_ptr<JoinKey> createJoinKey(const Column& left, const Column& right) {
+    if (auto catLeft = dynamic_cast<const CategoricalColumn*>(&left)) {
+        auto catRight = dynamic_cast<const CategoricalColumn*>(&right);
+        IVW_ASSERT(catRight, "right column is not categorical");
+
+        std::unordered_map<std::string_view, std::uint32_t> ids;
+        for (auto&& [id, category] : util::enumerate(catLeft->getCategories())) {
+            ids.emplace(category, static_cast<std::uint32_t>(id));
+        }
+        const auto mapping = util::transform(catRight->getCategories(), [&](const auto& category) {
+            return ids.emplace(category, static_cast<std::uint32_t>(ids.size())).first->second;
+        });
+        const auto& leftIds = catLeft->getTypedBuffer()->getRAMRepresentation()->getDataContainer();
+        auto rightIds =
+            util::transform(catRight->getTypedBuffer()->getRAMRepresentation()->getDataContainer(),
+                            [&](std::uint32_t id) { return mapping[id]; });
+        return std::make_unique<TypedJoinKey<std::uint32_t>>(leftIds.data(), std::move(rightIds));
     } else {
-        leftCol->getBuffer()->getRepresentation<BufferRAM>()->dispatch<void>(
-            [rightBuffer = rightCol->getBuffer(), &rows](auto typedBuf) {
+        return left.getBuffer()->getRepresentation<BufferRAM>()->dispatch<std::unique_ptr<JoinKey>>(
+            [&right](auto typedBuf) -> std::unique_ptr<JoinKey> {
                 using ValueType = util::PrecisionValueType<decltype(typedBuf)>;
-
-                const auto& left = typedBuf->getDataContainer();
-                const auto& right = static_cast<const BufferRAMPrecision<ValueType>*>(
-                                        rightBuffer->getRepresentation<BufferRAM>())
-                                        ->getDataContainer();
-
-                for (auto&& [i, key] : util::enumerate(left)) {
-                    // find all matching rows in right
-                    std::vector<size_t> matches;
-                    for (auto&& [r, value] : util::enumerate(right)) {
-                        if (key == value) {
-                            matches.emplace_back(r);
-                            if constexpr (firstMatchOnly) break;
-                        }
-                    }
-                    rows[i] = std::move(matches);
-                }
+                const auto& rightData = static_cast<const BufferRAMPrecision<ValueType>*>(
+                                            right.getBuffer()->getRepresentation<BufferRAM>())
+                                            ->getDataContainer();
+                return std::make_unique<TypedJoinKey<ValueType>>(
+                    typedBuf->getDataContainer().data(), rightData.data());
             });
     }
-    return rows;
 }
 
-std::vector<std::vector<size_t>> getMatchingRows(const DataFrame& left, const DataFrame& right,
-                                                 const std::vector<std::string>& keyColumns) {
-    auto indexCol1 = left.getColumn(keyColumns.front());
-    auto indexCol2 = right.getColumn(keyColumns.front());
-
-    auto rows = detail::getMatchingRows(indexCol1, indexCol2);
-    // narrow down row selection by filtering with remaining keys
-    for (auto keyColName : util::as_range(keyColumns.begin() + 1, keyColumns.end())) {
-        auto leftCol = left.getColumn(keyColName);
-        auto rightCol = right.getColumn(keyColName);
-
-        if (auto catCol1 = dynamic_cast<const CategoricalColumn*>(leftCol.get())) {
-            auto catCol2 = dynamic_cast<const CategoricalColumn*>(rightCol.get());
-            IVW_ASSERT(catCol2, "right column is not categorical");
-
-            auto valuesLeft = catCol1->getValues();
-            auto valuesRight = catCol2->getValues();
-            for (auto&& [i, rowMatches] : util::enumerate(rows)) {
-                util::erase_remove_if(rowMatches, [key = valuesLeft[i], &valuesRight](auto row) {
-                    return key != valuesRight[row];
-                });
-            }
-        } else {
-            leftCol->getBuffer()->getRepresentation<BufferRAM>()->dispatch<void>(
-                [&rows, rightBuffer = rightCol->getBuffer()](auto typedBuf) {
-                    using ValueType = util::PrecisionValueType<decltype(typedBuf)>;
-
-                    const auto& left = typedBuf->getDataContainer();
-                    const auto& right = static_cast<const BufferRAMPrecision<ValueType>*>(
-                                            rightBuffer->getRepresentation<BufferRAM>())
-                                            ->getDataContainer();
+/**
+ * \brief for each row in \p left return the first row in \p right with matching values in all key
+ * columns, or noMatch
+ *
+ * A hash table of the distinct keys is built for the smaller DataFrame and probed in parallel
+ * with the rows of the other one. The key columns of a row are hashed once.
+ */
+std::vector<size_t> getMatchingRows(const DataFrame& left, const DataFrame& right,
+                                    const std::vector<std::string>& keyColumns) {
+    const auto keys = util::transform(keyColumns, [&](const std::string& key) {
+        return createJoinKey(*left.getColumn(key), *right.getColumn(key));
+    });
+    const std::array<size_t, 2> rowCount = {left.getNumberOfRows(), right.getNumberOfRows()};
+
+    auto hashRows = [&](Side side) {
+        std::vector<size_t> hashes(rowCount[static_cast<size_t>(side)], 0);
+        util::parallelFor(
+            hashes.size(),
+            [&](size_t begin, size_t end) {
+                for (const auto& key : keys) key->hash(side, begin, end, hashes.data());
+                for (size_t row = begin; row < end; ++row) {
+                    // finalize with a mixing step, the hashes of integers are their values
+                    auto h = static_cast<std::uint64_t>(hashes[row]);
+                    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ull;
+                    h = (h ^ (h >> 27)) * 0x94d049bb133111ebull;
+                    hashes[row] = static_cast<size_t>(h ^ (h >> 31));
+                }
+            },
+            minBlockRows);
+        return hashes;
+    };
+    const std::array<std::vector<size_t>, 2> hashes = {hashRows(Side::Left),
+                                                       hashRows(Side::Right)};
+    auto equal = [&](Side sideA, size_t rowA, Side sideB, size_t rowB) {
+        return hashes[static_cast<size_t>(sideA)][rowA] ==
+                   hashes[static_cast<size_t>(sideB)][rowB] &&
+               std::all_of(keys.begin(), keys.end(), [&](const auto& key) {
+                   return key->equal(sideA, rowA, sideB, rowB);
+               });
+    };
+
+    const auto build = rowCount[1] <= rowCount[0] ? Side::Right : Side::Left;
+    const auto probe = build == Side::Right ? Side::Left : Side::Right;
+    const auto& buildHashes = hashes[static_cast<size_t>(build)];
+
+    // open addressing table holding the first row of the build side for each distinct key
+    size_t capacity = 1;
+    while (capacity < 2 * buildHashes.size()) capacity *= 2;
+    const size_t mask = capacity - 1;
+    std::vector<size_t> table(capacity, noMatch);
+    auto find = [&](Side side, size_t row) {
+        size_t slot = hashes[static_cast<size_t>(side)][row] & mask;
+        while (table[slot] != noMatch && !equal(build, table[slot], side, row)) {
+            slot = (slot + 1) & mask;
+        }
+        return slot;
+    };
+
+    // first row with the same key for each left row, only needed when building on the left
+    std::vector<size_t> firstRow(build == Side::Left ? buildHashes.size() : 0);
+    for (size_t row = 0; row < buildHashes.size(); ++row) {
+        auto& entry = table[find(build, row)];
+        if (entry == noMatch) entry = row;
+        if (build == Side::Left) firstRow[row] = entry;
+    }
 
-                    for (auto&& [i, rowMatches] : util::enumerate(rows)) {
-                        util::erase_remove_if(rowMatches, [key = left[i], &right](auto row) {
-                            return key != right[row];
-                        });
+    std::vector<size_t> rows(rowCount[0], noMatch);
+    if (build == Side::Right) {
+        util::parallelFor(
+            rows.size(),
+            [&](size_t begin, size_t end) {
+                for (size_t row = begin; row < end; ++row) rows[row] = table[find(probe, row)];
+            },
+            minBlockRows);
+    } else {
+        // the first matching right row for each distinct left key
+        std::vector<std::atomic<size_t>> firstMatch(rowCount[0]);
+        for (auto& match : firstMatch) match.store(noMatch, std::memory_order_relaxed);
+        util::parallelFor(
+            rowCount[1],
+            [&](size_t begin, size_t end) {
+                for (size_t row = begin; row < end; ++row) {
+                    const auto leftRow = table[find(probe, row)];
+                    if (leftRow == noMatch) continue;
+                    auto& match = firstMatch[leftRow];
+                    auto current = match.load(std::memory_order_relaxed);
+                    while (row < current &&
+                           !match.compare_exchange_weak(current, row, std::memory_order_relaxed)) {
                     }
-                });
+                }
+            },
+            minBlockRows);
+        for (size_t row = 0; row < rows.size(); ++row) {
+            rows[row] = firstMatch[firstRow[row]].load(std::memory_order_relaxed);
         }
     }
     return rows;
@@ -296,6 +387,10 @@ void addColumns(std::shared_ptr<DataFrame> dst, const DataFrame& srcDataFrame,
     }
 }
 
+/**
+ * Add the \p rows of the columns in \p srcDataFrame to \p dst. Rows equal to noMatch are filled
+ * with 0 or "undefined" for categorical columns.
+ */
 void addColumns(std::shared_ptr<DataFrame> dst, const DataFrame& srcDataFrame,
                 const std::vector<size_t>& rows, const std::vector<std::string>& keyColumns,
                 bool skipKeyCol) {
@@ -306,41 +401,42 @@ void addColumns(std::shared_ptr<DataFrame> dst, const DataFrame& srcDataFrame,
         }
 
         if (auto c = dynamic_cast<CategoricalColumn*>(srcCol.get())) {
-            auto data = util::transform(rows, [src = c->getValues()](size_t i) { return src[i]; });
-            dst->addCategoricalColumn(c->getHeader(), data);
-        } else {
-            srcCol->getBuffer()->getRepresentation<BufferRAM>()->dispatch<void>(
-                [dst, srcCol, header = srcCol->getHeader(), rows](auto typedBuf) {
-                    auto dstData = util::transform(
-                        rows, [&src = typedBuf->getDataContainer()](size_t i) { return src[i]; });
-                    dst->addColumn(header, std::move(dstData));
-                });
-        }
-    }
-}
-
-void addColumns(std::shared_ptr<DataFrame> dst, const DataFrame& srcDataFrame,
-                const std::vector<std::optional<size_t>>& rows,
-                const std::vector<std::string>& keyColumns, bool skipKeyCol) {
-    for (auto srcCol : srcDataFrame) {
-        if (srcCol == srcDataFrame.getIndexColumn()) continue;
-        if (skipKeyCol && util::contains(keyColumns, srcCol->getHeader())) {
-            continue;
-        }
-
-        if (auto c = dynamic_cast<CategoricalColumn*>(srcCol.get())) {
-            auto data = util::transform(rows, [src = c->getValues()](auto v) {
-                return v.has_value() ? src[v.value()] : "undefined";
-            });
-            dst->addCategoricalColumn(c->getHeader(), data);
+            // renumber the categories in order of appearance without looking at the strings
+            const auto& categories = c->getCategories();
+            const auto& src = c->getTypedBuffer()->getRAMRepresentation()->getDataContainer();
+            const auto undefined = static_cast<std::uint32_t>(std::distance(
+                categories.begin(), std::find(categories.begin(), categories.end(), "undefined")));
+            constexpr auto unused = std::numeric_limits<std::uint32_t>::max();
+
+            std::vector<std::uint32_t> ids(categories.size() + 1, unused);
+            std::vector<std::string> dstCategories;
+            std::vector<std::uint32_t> data(rows.size());
+            for (auto&& [i, row] : util::enumerate(rows)) {
+                const auto srcId = row != noMatch ? src[row] : undefined;
+                auto& id = ids[srcId];
+                if (id == unused) {
+                    id = static_cast<std::uint32_t>(dstCategories.size());
+                    dstCategories.push_back(srcId < categories.size() ? categories[srcId]
+                                                                      : "undefined");
+                }
+                data[i] = id;
+            }
+            dst->addColumn(std::make_shared<CategoricalColumn>(c->getHeader(), std::move(data),
+                                                               std::move(dstCategories)));
         } else {
             srcCol->getBuffer()->getRepresentation<BufferRAM>()->dispatch<void>(
-                [dst, srcCol, header = srcCol->getHeader(), rows](auto typedBuf) {
+                [dst, header = srcCol->getHeader(), &rows](auto typedBuf) {
                     using ValueType = util::PrecisionValueType<decltype(typedBuf)>;
-                    auto dstData =
-                        util::transform(rows, [&src = typedBuf->getDataContainer()](auto v) {
-                            return v.has_value() ? src[v.value()] : ValueType{0};
-                        });
+                    const auto& src = typedBuf->getDataContainer();
+                    std::vector<ValueType> dstData(rows.size());
+                    util::parallelFor(
+                        rows.size(),
+                        [&](size_t begin, size_t end) {
+                            for (size_t i = begin; i < end; ++i) {
+                                dstData[i] = rows[i] != noMatch ? src[rows[i]] : ValueType{0};
+                            }
+                        },
+                        minBlockRows);
                     dst->addColumn(header, std::move(dstData));
                 });
         }
@@ -351,29 +447,7 @@ void addColumns(std::shared_ptr<DataFrame> dst, const DataFrame& srcDataFrame,
 
 std::shared_ptr<DataFrame> innerJoin(const DataFrame& left, const DataFrame& right,
                                      const std::string& keyColumn) {
-    detail::columnCheck(left, right, {keyColumn}, "dataframe::innerJoin");
-
-    auto indexCol1 = left.getColumn(keyColumn);
-    auto indexCol2 = right.getColumn(keyColumn);
-
-    std::vector<size_t> rowsLeft;
-    std::vector<size_t> rowsRight;
-    for (auto&& [i, rowIndices] :
-         util::enumerate(detail::getMatchingRows<true>(indexCol1, indexCol2))) {
-        if (!rowIndices.empty()) {
-            rowsLeft.push_back(i);
-            rowsRight.push_back(rowIndices.front());
-        }
-    }
-
-    IVW_ASSERT(rowsLeft.size() == rowsRight.size(), "incorrect number of matching row indices");
-
-    auto dataframe = std::make_shared<DataFrame>();
-    detail::addColumns(dataframe, left, rowsLeft, {keyColumn}, false);
-    detail::addColumns(dataframe, right, rowsRight, {keyColumn}, true);
-
-    dataframe->updateIndexBuffer();
-    return dataframe;
+    return innerJoin(left, right, std::vector<std::string>{keyColumn});
 }
 
 std::shared_ptr<DataFrame> innerJoin(const DataFrame& left, const DataFrame& right,
@@ -386,11 +460,10 @@ std::shared_ptr<DataFrame> innerJoin(const DataFrame& left, const DataFrame& rig
 
     std::vector<size_t> rowsLeft;
     std::vector<size_t> rowsRight;
-    for (auto&& [i, rowIndices] :
-         util::enumerate(detail::getMatchingRows(left, right, keyColumns))) {
-        if (!rowIndices.empty()) {
+    for (auto&& [i, row] : util::enumerate(detail::getMatchingRows(left, right, keyColumns))) {
+        if (row != detail::noMatch) {
             rowsLeft.push_back(i);
-            rowsRight.push_back(rowIndices.front());
+            rowsRight.push_back(row);
         }
     }
 
@@ -406,28 +479,7 @@ std::shared_ptr<DataFrame> innerJoin(const DataFrame& left, const DataFrame& rig
 
 std::shared_ptr<DataFrame> leftJoin(const DataFrame& left, const DataFrame& right,
                                     const std::string& keyColumn) {
-    detail::columnCheck(left, right, {keyColumn}, "dataframe::leftJoin");
-
-    auto indexCol1 = left.getColumn(keyColumn);
-    auto indexCol2 = right.getColumn(keyColumn);
-
-    auto rows = util::transform(detail::getMatchingRows<true>(indexCol1, indexCol2),
-                                [](const std::vector<size_t>& rowIndices) -> std::optional<size_t> {
-                                    if (rowIndices.empty()) {
-                                        return {};
-                                    } else {
-                                        return rowIndices.front();
-                                    }
-                                });
-
-    IVW_ASSERT(indexCol1->getSize() == rows.size(), "incorrect number of matching row indices");
-
-    auto dataframe = std::make_shared<DataFrame>();
-    detail::addColumns(dataframe, left, {keyColumn}, false);
-    detail::addColumns(dataframe, right, rows, {keyColumn}, true);
-
-    dataframe->updateIndexBuffer();
-    return dataframe;
+    return leftJoin(left, right, std::vector<std::string>{keyColumn});
 }
 
 std::shared_ptr<DataFrame> leftJoin(const DataFrame& left, const DataFrame& right,
@@ -438,14 +490,9 @@ std::shared_ptr<DataFrame> leftJoin(const DataFrame& left, const DataFrame& righ
 
     detail::columnCheck(left, right, keyColumns, "dataframe::leftJoin");
 
-    auto rows = util::transform(detail::getMatchingRows(left, right, keyColumns),
-                                [](const std::vector<size_t>& rowIndices) -> std::optional<size_t> {
-                                    if (rowIndices.empty()) {
-                                        return {};
-                                    } else {
-                                        return rowIndices.front();
-                                    }
-                                });
+    const auto rows = detail::getMatchingRows(left, right, keyColumns);
+
+    IVW_ASSERT(left.getNumberOfRows() == rows.size(), "incorrect number of matching row indices");
 
     auto dataframe = std::make_shared<DataFrame>();
     detail::addColumns(dataframe, left, keyColumns, false);
@@ -0,0 +1,202 @@
+/*********************************************************************************
+ *
+ * Inviwo - Interactive Visualization Workshop
+ *
+ * Copyright (c) 2021 Inviwo Foundation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************************/
+
+#include <warn/push>
+#include <warn/ignore/all>
+#include <gtest/gtest.h>
+#include <warn/pop>
+
+#include <inviwo/dataframe/datastructures/column.h>
+#include <inviwo/dataframe/datastructures/dataframe.h>
+#include <inviwo/dataframe/io/binarydataframereader.h>
+#include <inviwo/dataframe/io/binarydataframewriter.h>
+
+#include <inviwo/core/io/datareaderexception.h>
+#include <inviwo/core/io/datawriterexception.h>
+#include <inviwo/core/io/tempfilehandle.h>
+#include <inviwo/core/util/filesystem.h>
+
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <numeric>
+
+namespace inviwo {
+
+namespace {
+
+std::shared_ptr<DataFrame> createDataFrame(size_t rows) {
+    std::vector<int> ints(rows);
+    std::vector<double> doubles(rows);
+    std::vector<vec3> vecs(rows);
+    std::vector<std::string> categories(rows);
+    for (size_t i = 0; i < rows; ++i) {
+        ints[i] = static_cast<int>(i) - 100;
+        doubles[i] = i % 7 == 0 ? std::numeric_limits<double>::quiet_NaN() : 0.5 * i;
+        vecs[i] = vec3{static_cast<float>(i), -static_cast<float>(i), 1.0f};
+        categories[i] = std::string(1, static_cast<char>('a' + i % 3));
+    }
+
+    auto dataframe = std::make_shared<DataFrame>();
+    dataframe->addColumn("int", std::move(ints));
+    dataframe->addColumn("double", std::move(doubles));
+    dataframe->addColumn("vec", std::move(vecs));
+    dataframe->addCategoricalColumn("cat", categories);
+    dataframe->updateIndexBuffer();
+    return dataframe;
+}
+
+}  // namespace
+
+TEST(BinaryDataFrame, RoundTrip) {
+    auto dataframe = createDataFrame(1000);
+    // the index column is stored, e.g. for a subset of another DataFrame
+    auto& index = dataframe->getIndexColumn()
+                      ->getTypedBuffer()
+                      ->getEditableRAMRepresentation()
+                      ->getDataContainer();
+    std::iota(index.begin(), index.end(), 42);
+
+    util::TempFileHandle tmpFile("", ".ivdf");
+    BinaryDataFrameWriter writer;
+    writer.setOverwrite(true);
+    writer.writeData(dataframe.get(), tmpFile.getFileName());
+
+    BinaryDataFrameReader reader;
+    auto result = reader.readData(tmpFile.getFileName());
+
+    ASSERT_EQ(dataframe->getNumberOfColumns(), result->getNumberOfColumns());
+    ASSERT_EQ(dataframe->getNumberOfRows(), result->getNumberOfRows());
+    for (size_t col = 0; col < dataframe->getNumberOfColumns(); ++col) {
+        const auto expected = dataframe->getColumn(col);
+        const auto actual = result->getColumn(col);
+        EXPECT_EQ(expected->getHeader(), actual->getHeader());
+        EXPECT_EQ(expected->getBuffer()->getDataFormat(), actual->getBuffer()->getDataFormat());
+        for (size_t row = 0; row < dataframe->getNumberOfRows(); ++row) {
+            EXPECT_EQ(expected->getAsString(row), actual->getAsString(row))
+                << "column " << col << ", row " << row;
+        }
+    }
+    EXPECT_EQ(42, result->getIndexColumn()->get(0));
+    auto cat = std::dynamic_pointer_cast<const CategoricalColumn>(result->getColumn("cat"));
+    ASSERT_TRUE(cat);
+    EXPECT_EQ((std::vector<std::string>{"a", "b", "c"}), cat->getCategories());
+}
+
+TEST(BinaryDataFrame, Empty) {
+    auto dataframe = createDataFrame(0);
+
+    util::TempFileHandle tmpFile("", ".ivdf");
+    BinaryDataFrameWriter writer;
+    writer.setOverwrite(true);
+    writer.writeData(dataframe.get(), tmpFile.getFileName());
+
+    BinaryDataFrameReader reader;
+    auto result = reader.readData(tmpFile.getFileName());
+    EXPECT_EQ(dataframe->getNumberOfColumns(), result->getNumberOfColumns());
+    EXPECT_EQ(0, result->getNumberOfRows());
+}
+
+TEST(BinaryDataFrame, Statistics) {
+    const size_t rows = 1000;
+    const size_t rowsPerChunk = 300;
+    auto dataframe = createDataFrame(rows);
+
+    util::TempFileHandle tmpFile("", ".ivdf");
+    BinaryDataFrameWriter writer{rowsPerChunk};
+    writer.setOverwrite(true);
+    writer.writeData(dataframe.get(), tmpFile.getFileName());
+
+    BinaryDataFrameReader reader;
+    const auto stats = reader.readStatistics(tmpFile.getFileName());
+    ASSERT_EQ(dataframe->getNumberOfColumns(), stats.size());
+
+    for (size_t col = 0; col < stats.size(); ++col) {
+        const auto column = dataframe->getColumn(col);
+        EXPECT_EQ(column->getHeader(), stats[col].header);
+        if (std::dynamic_pointer_cast<const CategoricalColumn>(column)) {
+            EXPECT_EQ(0, stats[col].getNumberOfChunks());
+            continue;
+        }
+        ASSERT_EQ(4, stats[col].getNumberOfChunks());
+        for (size_t chunk = 0; chunk < 4; ++chunk) {
+            for (size_t c = 0; c < stats[col].components; ++c) {
+                double min = std::numeric_limits<double>::infinity();
+                double max = -std::numeric_limits<double>::infinity();
+                for (size_t row = chunk * rowsPerChunk;
+                     row < std::min(rows, (chunk + 1) * rowsPerChunk); ++row) {
+                    const double value = column->getAsDVec4(row)[c];
+                    if (std::isnan(value)) continue;
+                    min = std::min(min, value);
+                    max = std::max(max, value);
+                }
+                EXPECT_EQ(min, stats[col].getMin(chunk, c));
+                EXPECT_EQ(max, stats[col].getMax(chunk, c));
+            }
+        }
+    }
+}
+
+TEST(BinaryDataFrame, NoOverwrite) {
+    auto dataframe = createDataFrame(10);
+
+    util::TempFileHandle tmpFile("", ".ivdf");
+    BinaryDataFrameWriter writer;
+    EXPECT_THROW(writer.writeData(dataframe.get(), tmpFile.getFileName()), DataWriterException);
+}
+
+TEST(BinaryDataFrame, Invalid) {
+    util::TempFileHandle tmpFile("", ".ivdf");
+    BinaryDataFrameReader reader;
+    EXPECT_THROW(reader.readData(tmpFile.getFileName()), DataReaderException);
+
+    {
+        auto file = filesystem::ofstream(tmpFile.getFileName(), std::ios::out | std::ios::binary);
+        file << "a,b,c\n1,2,3\n";
+    }
+    EXPECT_THROW(reader.readData(tmpFile.getFileName()), DataReaderException);
+
+    // truncated file
+    auto dataframe = createDataFrame(1000);
+    BinaryDataFrameWriter writer;
+    writer.setOverwrite(true);
+    writer.writeData(dataframe.get(), tmpFile.getFileName());
+    std::string content;
+    {
+        auto file = filesystem::ifstream(tmpFile.getFileName(), std::ios::in | std::ios::binary);
+        content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    {
+        auto file = filesystem::ofstream(tmpFile.getFileName(), std::ios::out | std::ios::binary);
+        file.write(content.data(), content.size() / 2);
+    }
+    EXPECT_THROW(reader.readData(tmpFile.getFileName()), DataReaderException);
+}
+
+}  // namespace inviwo
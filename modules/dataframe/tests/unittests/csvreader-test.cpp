@@ -34,7 +34,9 @@
 
 #include <inviwo/core/io/tempfilehandle.h>
 #include <inviwo/dataframe/io/csvreader.h>
+#include <inviwo/dataframe/datastructures/column.h>
 
+#include <cstdio>
 #include <sstream>
 
 namespace inviwo {
@@ -136,6 +138,78 @@ TEST(CSVdata, emptyFields) {
     EXPECT_EQ("", value) << "empty field in middle of row";
 }
 
+TEST(CSVdata, manyRows) {
+    // test rows that are parsed in several blocks
+    std::ostringstream oss;
+    oss << "Int,Float,Category\n";
+    const char* categories[] = {"c", "a", "b"};
+    for (int i = 0; i < 20000; ++i) {
+        oss << i << "," << (i * 0.5) << "," << categories[i % 3] << "\n";
+    }
+    std::istringstream ss(oss.str());
+
+    CSVReader reader;
+    auto dataframe = reader.readData(ss);
+    ASSERT_EQ(4, dataframe->getNumberOfColumns()) << "column count does not match";
+    ASSERT_EQ(20000, dataframe->getNumberOfRows()) << "row count does not match";
+
+    for (size_t i : {0u, 4095u, 4096u, 12345u, 19999u}) {
+        EXPECT_EQ(static_cast<double>(i), dataframe->getColumn(1)->getAsDouble(i)) << "row " << i;
+        EXPECT_EQ(i * 0.5, dataframe->getColumn(2)->getAsDouble(i)) << "row " << i;
+        EXPECT_EQ(categories[i % 3], dataframe->getColumn(3)->getAsString(i)) << "row " << i;
+    }
+    auto catCol = std::dynamic_pointer_cast<CategoricalColumn>(dataframe->getColumn(3));
+    ASSERT_TRUE(catCol) << "categorical column expected";
+    EXPECT_EQ(std::vector<std::string>({"c", "a", "b"}), catCol->getCategories())
+        << "categories not in order of appearance";
+}
+
+TEST(CSVdata, invalidIntegral) {
+    // test for a non-numeric value in an integral column after the example rows
+    std::ostringstream oss;
+    for (int i = 0; i < 100; ++i) {
+        oss << i << "\n";
+    }
+    oss << "abc\n";
+    std::istringstream ss(oss.str());
+
+    CSVReader reader;
+    reader.setFirstRowHeader(false);
+
+    EXPECT_THROW(reader.readData(ss), DataTypeMismatch);
+}
+
+TEST(CSVdata, doublePrecision) {
+    std::istringstream ss("A,B\n0.1,2");
+
+    CSVReader reader;
+    reader.setEnableDoublePrecision(true);
+    auto dataframe = reader.readData(ss);
+
+    ASSERT_EQ(3, dataframe->getNumberOfColumns()) << "column count does not match";
+    EXPECT_EQ(DataFormatId::Float64, dataframe->getColumn(1)->getBuffer()->getDataFormat()->getId())
+        << "double precision column expected";
+    EXPECT_EQ(0.1, dataframe->getColumn(1)->getAsDouble(0));
+    EXPECT_EQ(DataFormatId::Int32, dataframe->getColumn(2)->getBuffer()->getDataFormat()->getId())
+        << "integral column expected";
+}
+
+TEST(CSVdata, file) {
+    util::TempFileHandle tmpFile("", ".csv");
+    const std::string contents = "\xef\xbb\xbf"
+                                 "A,B\n1,\"x,y\"\r\n2,z";
+    std::fwrite(contents.data(), 1, contents.size(), tmpFile);
+    std::fflush(tmpFile);
+
+    CSVReader reader;
+    auto dataframe = reader.readData(tmpFile.getFileName());
+    ASSERT_EQ(3, dataframe->getNumberOfColumns()) << "column count does not match";
+    ASSERT_EQ(2, dataframe->getNumberOfRows()) << "row count does not match";
+    EXPECT_EQ("A", dataframe->getColumn(1)->getHeader()) << "BOM not skipped";
+    EXPECT_EQ("\"x,y\"", dataframe->getColumn(2)->getAsString(0));
+    EXPECT_EQ("z", dataframe->getColumn(2)->getAsString(1));
+}
+
 TEST(CSVdata, columnCountMismatch) {
     // test for rows with varying column counts
     std::istringstream ss("1,2,3\n4,5\n7,8,9");
@@ -0,0 +1,121 @@
+/*********************************************************************************
+ *
+ * Inviwo - Interactive Visualization Workshop
+ *
+ * Copyright (c) 2021 Inviwo Foundation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************************/
+
+#include <warn/push>
+#include <warn/ignore/all>
+#include <gtest/gtest.h>
+#include <warn/pop>
+
+#include <inviwo/dataframe/datastructures/column.h>
+#include <inviwo/dataframe/datastructures/dataframe.h>
+#include <inviwo/dataframe/datastructures/dataframeview.h>
+
+#include <inviwo/core/datastructures/buffer/buffer.h>
+#include <inviwo/core/util/exception.h>
+#include <inviwo/core/util/stdextensions.h>
+
+namespace inviwo {
+
+namespace {
+
+std::shared_ptr<DataFrame> createDataFrame() {
+    auto dataframe = std::make_shared<DataFrame>();
+    dataframe->addColumn("int", std::vector<int>{1, 2, 3, 4, 5, 6});
+    dataframe->addColumn("float", std::vector<float>{0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f});
+    dataframe->addCategoricalColumn("cat", {"a", "b", "a", "c", "b", "a"});
+    dataframe->updateIndexBuffer();
+    return dataframe;
+}
+
+}  // namespace
+
+TEST(DataFrameView, Identity) {
+    auto dataframe = createDataFrame();
+    DataFrameView view{dataframe};
+
+    EXPECT_TRUE(view.isIdentity());
+    EXPECT_EQ(6, view.getNumberOfRows());
+    EXPECT_EQ(4, view.getNumberOfColumns());
+    EXPECT_EQ(dataframe->getColumn(1), view.getColumn(1)) << "columns should be shared";
+    EXPECT_EQ(3.0, view.getAsDouble(1, 2));
+    EXPECT_EQ("c", view.getAsString(3, 3));
+}
+
+TEST(DataFrameView, Filter) {
+    auto dataframe = createDataFrame();
+    auto view = DataFrameView{dataframe}
+                    .filter("float", util::overloaded{[](const float& v) { return v > 1.0f; },
+                                                      [](const auto&) { return false; }})
+                    .filter("cat", util::overloaded{[](const std::string& v) { return v != "b"; },
+                                                    [](const auto&) { return false; }});
+
+    EXPECT_FALSE(view.isIdentity());
+    EXPECT_EQ(std::vector<size_t>({2, 3, 5}), view.getSelection());
+    EXPECT_EQ(4.0, view.getAsDouble(1, 1));
+    EXPECT_EQ("a", view.getAsString(3, 2));
+}
+
+TEST(DataFrameView, Select) {
+    auto dataframe = createDataFrame();
+    DataFrameView view{dataframe, std::vector<bool>{true, false, true, true, false, true}};
+    EXPECT_EQ(std::vector<size_t>({0, 2, 3, 5}), view.getSelection());
+
+    auto subset = view.select(std::vector<size_t>{1, 3});
+    EXPECT_EQ(std::vector<size_t>({2, 5}), subset.getSelection());
+    EXPECT_EQ(5, subset.getSourceRow(1));
+
+    EXPECT_THROW(view.select(std::vector<bool>{true}), Exception);
+}
+
+TEST(DataFrameView, Materialize) {
+    auto dataframe = createDataFrame();
+    auto view = DataFrameView{dataframe}.filter(
+        "int", util::overloaded{[](const int& v) { return v % 2 == 0; },
+                                [](const auto&) { return false; }});
+    auto result = view.materialize();
+
+    ASSERT_EQ(4, result->getNumberOfColumns());
+    ASSERT_EQ(3, result->getNumberOfRows());
+    EXPECT_NE(dataframe->getColumn(1), result->getColumn(1)) << "columns should be copied";
+
+    const auto& index =
+        result->getIndexColumn()->getTypedBuffer()->getRAMRepresentation()->getDataContainer();
+    EXPECT_EQ(std::vector<std::uint32_t>({1, 3, 5}), index) << "index should refer to the source";
+
+    auto intCol = std::dynamic_pointer_cast<TemplateColumn<int>>(result->getColumn("int"));
+    ASSERT_TRUE(intCol);
+    EXPECT_EQ(std::vector<int>({2, 4, 6}),
+              intCol->getTypedBuffer()->getRAMRepresentation()->getDataContainer());
+
+    auto catCol = std::dynamic_pointer_cast<CategoricalColumn>(result->getColumn("cat"));
+    ASSERT_TRUE(catCol) << "column 'cat' should be categorical";
+    EXPECT_EQ(std::vector<std::string>({"b", "c", "a"}), catCol->getValues());
+}
+
+}  // namespace inviwo
@@ -42,6 +42,9 @@
 
 #include <fmt/format.h>
 
+#include <algorithm>
+#include <numeric>
+
 namespace inviwo {
 
 namespace {
@@ -290,6 +293,43 @@ TEST(InnerJoin, ByCategoricalColumn) {
     checkColumnContents<int>(*dataframe->getColumn("int"), {1, 3, 2});
 }
 
+TEST(InnerJoin, ManyRows) {
+    // left is smaller than right and vice versa, i.e. the hash table is built on either side
+    const std::vector<std::pair<int, int>> sizes = {{1000, 50000}, {50000, 1000}};
+    for (auto [leftRows, rightRows] : sizes) {
+        std::vector<int> leftKeys(leftRows);
+        std::iota(leftKeys.begin(), leftKeys.end(), 0);
+        std::vector<int> rightKeys(rightRows);
+        std::vector<float> rightValues(rightRows);
+        for (int i = 0; i < rightRows; ++i) {
+            rightKeys[i] = (rightRows - 1 - i) * 2;
+            rightValues[i] = static_cast<float>(i);
+        }
+
+        DataFrame left;
+        left.addColumnFromBuffer("key", util::makeBuffer(std::move(leftKeys)));
+        left.updateIndexBuffer();
+        DataFrame right;
+        right.addColumnFromBuffer("key", util::makeBuffer(std::move(rightKeys)));
+        right.addColumnFromBuffer("value", util::makeBuffer(std::move(rightValues)));
+        right.updateIndexBuffer();
+
+        auto dataframe = dataframe::innerJoin(left, right, "key");
+        // even keys below min(leftRows, 2 * rightRows) match
+        const int matches = std::min(leftRows, 2 * rightRows) / 2;
+        ASSERT_EQ(matches, dataframe->getNumberOfRows()) << "inner join row count";
+
+        std::vector<int> expectedKeys(matches);
+        std::vector<float> expectedValues(matches);
+        for (int i = 0; i < matches; ++i) {
+            expectedKeys[i] = 2 * i;
+            expectedValues[i] = static_cast<float>(rightRows - 1 - i);
+        }
+        checkColumnContents<int>(*dataframe->getColumn("key"), expectedKeys);
+        checkColumnContents<float>(*dataframe->getColumn("value"), expectedValues);
+    }
+}
+
 TEST(LeftJoin, ByIndexColumn) {
     DataFrame left;
     left.addColumnFromBuffer("int", util::makeBuffer(std::vector<int>{1, 2, 3}));
@@ -385,4 +425,26 @@ TEST(LeftJoin, MultipleKeyColumns) {
                                {4.0f, 3.0f, 0.0f, 0.0f, 5.0f, 0.0f, 6.0f, 7.0f});
 }
 
+TEST(LeftJoin, DuplicateKeys) {
+    // the first matching row is used for duplicate keys
+    DataFrame left;
+    left.addCategoricalColumn("cat", {"b", "a", "x"});
+    left.updateIndexBuffer();
+
+    DataFrame right;
+    right.addCategoricalColumn("cat", {"a", "b", "a", "c", "b"});
+    right.addColumnFromBuffer("int", util::makeBuffer(std::vector<int>{1, 2, 3, 4, 5}));
+    right.addCategoricalColumn("cat2", {"one", "two", "three", "four", "five"});
+    right.updateIndexBuffer();
+
+    auto dataframe = dataframe::leftJoin(left, right, "cat");
+    EXPECT_EQ(3, dataframe->getNumberOfRows()) << "left join should result in 3 rows";
+    checkColumnContents<int>(*dataframe->getColumn("int"), {2, 1, 0});
+
+    auto catCol = dynamic_cast<CategoricalColumn*>(dataframe->getColumn("cat2").get());
+    ASSERT_TRUE(catCol != nullptr) << "column 'cat2' is not categorical after join";
+    const std::vector<std::string> expected = {"two", "one", "undefined"};
+    EXPECT_EQ(expected, catCol->getCategories()) << "categories after join are not correct";
+}
+
 }  // namespace inviwo
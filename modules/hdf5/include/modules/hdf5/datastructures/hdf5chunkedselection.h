@@ -0,0 +1,154 @@
+/*********************************************************************************
+ *
+ * Inviwo - Interactive Visualization Workshop
+ *
+ * Copyright (c) 2021 Inviwo Foundation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************************/
+
+#pragma once
+
+#include <modules/hdf5/hdf5moduledefine.h>
+
+#include <warn/push>
+#include <warn/ignore/all>
+#include <H5Cpp.h>
+#include <warn/pop>
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace inviwo {
+
+namespace hdf5 {
+
+/**
+ * The selected elements of one dimension that fall within one chunk
+ */
+struct ChunkRange {
+    hsize_t offset;  ///< The first element of the chunk in the dataset
+    hsize_t first;   ///< The index of the first element within the selection
+    hsize_t count;   ///< The number of selected elements within the chunk
+};
+
+/**
+ * A strided hyperslab selection split along the chunks of the dataset, all in row major order.
+ * The selection is read into memory of the size of the selection, in row major order.
+ */
+struct ChunkedSelection {
+    explicit ChunkedSelection(size_t rank)
+        : start(rank), count(rank), stride(rank), chunk(rank), ranges(rank) {}
+
+    /**
+     * Split the selection along chunks of size \p chunkDimensions. start, count and stride have
+     * to be set before.
+     */
+    void setChunk(const std::vector<hsize_t>& chunkDimensions) {
+        chunk = chunkDimensions;
+        chunks = 1;
+        for (size_t i = 0; i < chunk.size(); ++i) {
+            ranges[i].clear();
+            const hsize_t last = start[i] + (count[i] - 1) * stride[i];
+            for (hsize_t c = start[i] / chunk[i]; c <= last / chunk[i]; ++c) {
+                const hsize_t begin = c * chunk[i];
+                const hsize_t end = begin + chunk[i];
+                const hsize_t first =
+                    begin > start[i] ? (begin - start[i] + stride[i] - 1) / stride[i] : 0;
+                const hsize_t stop =
+                    std::min(count[i], (end - start[i] + stride[i] - 1) / stride[i]);
+                if (first < stop) ranges[i].push_back({begin, first, stop - first});
+            }
+            chunks *= ranges[i].size();
+        }
+    }
+
+    /**
+     * The ranges of the n:th chunk overlapping the selection
+     */
+    void getChunk(size_t n, std::vector<ChunkRange>& chunkRanges) const {
+        chunkRanges.resize(ranges.size());
+        for (size_t i = ranges.size(); i-- > 0;) {
+            chunkRanges[i] = ranges[i][n % ranges[i].size()];
+            n /= ranges[i].size();
+        }
+    }
+
+    std::vector<hsize_t> start;
+    std::vector<hsize_t> count;
+    std::vector<hsize_t> stride;
+    std::vector<hsize_t> chunk;
+    std::vector<std::vector<ChunkRange>> ranges;
+    size_t chunks = 0;
+};
+
+/**
+ * Copy the selected elements of a decoded chunk into the selection memory
+ * @param sel        the selection
+ * @param ranges     the ranges of the chunk, see ChunkedSelection::getChunk
+ * @param chunkData  all elements of the chunk, a full chunk also at the edges of the dataset
+ * @param data       memory of the whole selection
+ */
+template <typename T>
+void scatterChunk(const ChunkedSelection& sel, const std::vector<ChunkRange>& ranges,
+                  const T* chunkData, T* data) {
+    const size_t rank = ranges.size();
+    std::vector<size_t> srcBegin(rank);
+    std::vector<size_t> srcStep(rank);
+    std::vector<size_t> dstStep(rank);
+    for (size_t i = rank, chunkStride = 1, memoryStride = 1; i-- > 0;) {
+        srcBegin[i] =
+            (sel.start[i] + ranges[i].first * sel.stride[i] - ranges[i].offset) * chunkStride;
+        srcStep[i] = sel.stride[i] * chunkStride;
+        dstStep[i] = memoryStride;
+        chunkStride *= sel.chunk[i];
+        memoryStride *= sel.count[i];
+    }
+
+    std::vector<hsize_t> index(rank, 0);
+    const size_t inner = rank - 1;
+    for (;;) {
+        size_t src = 0;
+        size_t dst = 0;
+        for (size_t i = 0; i < rank; ++i) {
+            src += srcBegin[i] + index[i] * srcStep[i];
+            dst += (ranges[i].first + index[i]) * dstStep[i];
+        }
+        for (hsize_t k = 0; k < ranges[inner].count; ++k) {
+            data[dst + k * dstStep[inner]] = chunkData[src + k * srcStep[inner]];
+        }
+
+        size_t d = inner;
+        while (d-- > 0) {
+            if (++index[d] < ranges[d].count) break;
+            index[d] = 0;
+        }
+        if (d == std::numeric_limits<size_t>::max()) break;
+    }
+}
+
+}  // namespace hdf5
+
+}  // namespace inviwo
@@ -83,9 +83,15 @@ public:
 
     Handle* getHandleForPath(const std::string& path) const;
 
-    std::shared_ptr<Volume> getVolumeAtPathAsType(const Path& path,
-                                                  std::vector<Selection> selection,
-                                                  const DataFormatBase* type) const;
+    /**
+     * Read the \p selection of the dataset at \p path into a volume of format \p type, or of the
+     * dataset's own format if \p type is null. The data is read one dataset chunk at a time, and
+     * chunks compressed with deflate and/or shuffle filters are decompressed in parallel.
+     * \p progress, if given, is called with the fraction of read chunks from the calling thread.
+     */
+    std::shared_ptr<Volume> getVolumeAtPathAsType(
+        const Path& path, std::vector<Selection> selection, const DataFormatBase* type,
+        const std::function<void(double)>& progress = nullptr) const;
 
     template <typename T>
     std::vector<T> getVectorAtPath(const Path& path) const;
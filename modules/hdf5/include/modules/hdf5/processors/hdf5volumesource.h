@@ -31,6 +31,7 @@
 
 #include <modules/hdf5/hdf5moduledefine.h>
 #include <inviwo/core/processors/processor.h>
+#include <inviwo/core/processors/progressbarowner.h>
 #include <modules/hdf5/ports/hdf5port.h>
 #include <modules/hdf5/datastructures/hdf5metadata.h>
 #include <modules/hdf5/hdf5utils.h>
@@ -79,9 +80,11 @@ namespace hdf5 {
  *   * __Source__ ...
  *   * __Convert to type__ ...
  *   * __Volume__ ...
+ *   * __Preview__ Load only every n:th voxel along each dimension, given by Preview stride
+ *   * __Preview stride__ Additional stride applied to the selection when previewing
  *
  */
-class IVW_MODULE_HDF5_API HDF5ToVolume : public Processor {
+class IVW_MODULE_HDF5_API HDF5ToVolume : public Processor, public ProgressBarOwner {
 public:
     HDF5ToVolume();
     virtual ~HDF5ToVolume();
@@ -167,6 +170,10 @@ private:
 
     DimSelections selection_;
 
+    BoolProperty preview_;
+    IntProperty previewStride_;
+
+    std::vector<Handle::Selection> loadedSelection_;  //< the selection volume_ was read with
     bool dirty_;
 };
 
@@ -30,14 +30,28 @@
  *********************************************************************************/
 
 #include <modules/hdf5/datastructures/hdf5handle.h>
+#include <modules/hdf5/datastructures/hdf5chunkedselection.h>
 #include <inviwo/core/util/stdextensions.h>
 #include <inviwo/core/util/formatdispatching.h>
 #include <inviwo/core/util/raiiutils.h>
 #include <inviwo/core/datastructures/volume/volumeramprecision.h>
 
+#include <inviwo/core/util/parallelfor.h>
+
 #include <modules/base/algorithm/dataminmax.h>
 
 #include <algorithm>
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <thread>
+
+#if defined(IVW_HDF5_DECODE_CHUNKS)
+#include <zlib.h>
+#endif
 
 namespace inviwo {
 
@@ -48,6 +62,194 @@ H5::Group load(const std::string& filename, const std::string& path) {
     H5::H5File hdfFile(filename, H5F_ACC_RDONLY);
     return hdfFile.openGroup(path);
 }
+
+/*
+ * The HDF5 library is not thread safe, and even a thread safe build serializes all calls. Hence
+ * all library calls from the reading threads are made while holding this lock, while
+ * decompression and copying of chunks we can decode ourselves happens in parallel.
+ */
+std::mutex& libraryMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+/*
+ * Let the library read the part of the selection within one chunk, including any type conversion
+ * and filters.
+ */
+template <typename T>
+void readThroughLibrary(const H5::DataSet& dataset, const ChunkedSelection& sel,
+                        const std::vector<ChunkRange>& ranges, T* data) {
+    const size_t rank = ranges.size();
+    std::vector<hsize_t> fileStart(rank);
+    std::vector<hsize_t> memoryStart(rank);
+    std::vector<hsize_t> count(rank);
+    for (size_t i = 0; i < rank; ++i) {
+        fileStart[i] = sel.start[i] + ranges[i].first * sel.stride[i];
+        memoryStart[i] = ranges[i].first;
+        count[i] = ranges[i].count;
+    }
+
+    H5::DataSpace fileSpace = dataset.getSpace();
+    fileSpace.selectHyperslab(H5S_SELECT_SET, count.data(), fileStart.data(), sel.stride.data());
+    H5::DataSpace memorySpace(static_cast<int>(rank), sel.count.data());
+    memorySpace.selectHyperslab(H5S_SELECT_SET, count.data(), memoryStart.data());
+
+    dataset.read(data, TypeMap<T>::getType(), memorySpace, fileSpace);
+}
+
+#if defined(IVW_HDF5_DECODE_CHUNKS)
+
+struct Filter {
+    H5Z_filter_t id;
+    std::vector<unsigned int> values;
+};
+
+/*
+ * The filter pipeline of the dataset if we can decode it ourselves, i.e. if it only consists of
+ * deflate and shuffle filters.
+ */
+std::optional<std::vector<Filter>> getDecodableFilters(const H5::DSetCreatPropList& properties) {
+    const auto plist = properties.getId();
+    const int nfilters = H5Pget_nfilters(plist);
+    if (nfilters < 0) return std::nullopt;
+
+    std::vector<Filter> filters;
+    for (int i = 0; i < nfilters; ++i) {
+        unsigned int flags = 0;
+        unsigned int config = 0;
+        std::vector<unsigned int> values(8);
+        size_t nvalues = values.size();
+        const auto id = H5Pget_filter2(plist, static_cast<unsigned int>(i), &flags, &nvalues,
+                                       values.data(), 0, nullptr, &config);
+        if (id != H5Z_FILTER_DEFLATE && id != H5Z_FILTER_SHUFFLE) return std::nullopt;
+        values.resize(std::min(nvalues, values.size()));
+        filters.push_back({id, std::move(values)});
+    }
+    return filters;
+}
+
+/*
+ * Undo the filters in reverse order, skipping the ones the library did not apply to this chunk
+ * as given by the filter mask.
+ */
+void decodeChunk(const std::vector<Filter>& filters, uint32_t mask, size_t chunkBytes,
+                 size_t typeSize, std::vector<unsigned char>& data,
+                 std::vector<unsigned char>& buffer) {
+    for (size_t i = filters.size(); i-- > 0;) {
+        if (mask & (1u << i)) continue;
+
+        buffer.resize(chunkBytes);
+        if (filters[i].id == H5Z_FILTER_DEFLATE) {
+            auto size = static_cast<uLongf>(chunkBytes);
+            if (uncompress(buffer.data(), &size, data.data(), static_cast<uLong>(data.size())) !=
+                    Z_OK ||
+                size != chunkBytes) {
+                throw Exception("HDF: unable to inflate chunk", IVW_CONTEXT_CUSTOM("HDF5Handle"));
+            }
+        } else {  // H5Z_FILTER_SHUFFLE
+            if (data.size() != chunkBytes) {
+                throw Exception("HDF: invalid shuffled chunk", IVW_CONTEXT_CUSTOM("HDF5Handle"));
+            }
+            const size_t elementSize =
+                std::max<size_t>(1, filters[i].values.empty() ? typeSize : filters[i].values[0]);
+            const size_t elements = chunkBytes / elementSize;
+            for (size_t byte = 0; byte < elementSize; ++byte) {
+                const auto src = data.data() + byte * elements;
+                for (size_t e = 0; e < elements; ++e) buffer[e * elementSize + byte] = src[e];
+            }
+            std::copy(data.begin() + elements * elementSize, data.end(),
+                      buffer.begin() + elements * elementSize);
+        }
+        std::swap(data, buffer);
+    }
+    if (data.size() != chunkBytes) {
+        throw Exception("HDF: invalid chunk size", IVW_CONTEXT_CUSTOM("HDF5Handle"));
+    }
+}
+
+#endif
+
+/*
+ * Read the selection chunk by chunk into data. If the chunks are stored with filters we can
+ * decode and in the requested type, the raw chunks are read by the library and decoded in
+ * parallel, otherwise the library reads one chunk at a time. Progress is reported from the
+ * calling thread. Decoding chunks ourselves requires H5Dread_chunk from HDF5 1.10.3 and zlib,
+ * see IVW_HDF5_DECODE_CHUNKS in CMakeLists.txt.
+ */
+template <typename T>
+void readChunks(const H5::DataSet& dataset, const H5::DSetCreatPropList& properties, bool chunked,
+                const ChunkedSelection& sel, T* data,
+                const std::function<void(double)>& progress) {
+    const auto caller = std::this_thread::get_id();
+    std::atomic<size_t> done{0};
+    auto report = [&]() {
+        const auto count = ++done;
+        if (progress && std::this_thread::get_id() == caller) {
+            progress(static_cast<double>(count) / static_cast<double>(sel.chunks));
+        }
+    };
+
+#if defined(IVW_HDF5_DECODE_CHUNKS)
+    const auto filters =
+        chunked && dataset.getDataType() == TypeMap<T>::getType() ? getDecodableFilters(properties)
+                                                                  : std::nullopt;
+    if (filters) {
+        const auto id = dataset.getId();
+        const size_t chunkElements = std::accumulate(sel.chunk.begin(), sel.chunk.end(), size_t{1},
+                                                     std::multiplies<size_t>());
+        const size_t chunkBytes = chunkElements * sizeof(T);
+
+        ::inviwo::util::parallelFor(sel.chunks, [&](size_t begin, size_t end) {
+            std::vector<ChunkRange> ranges;
+            std::vector<hsize_t> offset(sel.chunk.size());
+            std::vector<unsigned char> raw;
+            std::vector<unsigned char> buffer;
+            for (size_t n = begin; n < end; ++n) {
+                sel.getChunk(n, ranges);
+                for (size_t i = 0; i < ranges.size(); ++i) offset[i] = ranges[i].offset;
+
+                std::unique_lock<std::mutex> lock{libraryMutex()};
+                hsize_t size = 0;
+                herr_t status = -1;
+                H5E_BEGIN_TRY { status = H5Dget_chunk_storage_size(id, offset.data(), &size); }
+                H5E_END_TRY;
+                if (status < 0 || size == 0) {
+                    // Not allocated, let the library fill in the fill value
+                    readThroughLibrary(dataset, sel, ranges, data);
+                    lock.unlock();
+                    report();
+                    continue;
+                }
+                raw.resize(size);
+                uint32_t mask = 0;
+                if (H5Dread_chunk(id, H5P_DEFAULT, offset.data(), &mask, raw.data()) < 0) {
+                    throw Exception("HDF: unable to read chunk", IVW_CONTEXT_CUSTOM("HDF5Handle"));
+                }
+                lock.unlock();
+
+                decodeChunk(*filters, mask, chunkBytes, sizeof(T), raw, buffer);
+                scatterChunk(sel, ranges, reinterpret_cast<const T*>(raw.data()), data);
+                report();
+            }
+        });
+        return;
+    }
+
+#else
+    (void)properties;
+    (void)chunked;
+#endif
+
+    std::vector<ChunkRange> ranges;
+    for (size_t n = 0; n < sel.chunks; ++n) {
+        sel.getChunk(n, ranges);
+        std::lock_guard<std::mutex> lock{libraryMutex()};
+        readThroughLibrary(dataset, sel, ranges, data);
+        report();
+    }
+}
+
 }  // namespace
 
 Handle::Handle(std::string filename)
@@ -123,9 +325,9 @@ double Handle::getMax(const DataFormatBase* type) const {
     }
 }
 
-std::shared_ptr<Volume> Handle::getVolumeAtPathAsType(const Path& path,
-                                                      std::vector<Selection> selection,
-                                                      const DataFormatBase* type) const {
+std::shared_ptr<Volume> Handle::getVolumeAtPathAsType(
+    const Path& path, std::vector<Selection> selection, const DataFormatBase* type,
+    const std::function<void(double)>& progress) const {
 
     auto dataset = data_.openDataSet(path);
     ::inviwo::util::OnScopeExit closedataset{[&]() { dataset.close(); }};
@@ -140,10 +342,6 @@ std::shared_ptr<Volume> Handle::getVolumeAtPathAsType(const Path& path,
     dataSpace.getSimpleExtentDims(dataDimensions.data());
     const hsize_t dataSize = dataSpace.getSelectNpoints();
 
-    std::vector<hsize_t> start(rank);
-    std::vector<hsize_t> count(rank);
-    std::vector<hsize_t> stride(rank);
-
     /*
      * Column major, i.e. the FIRST listed dimension is the fasted changing
      * Inviwo, OpenGL, matlab, Fortran
@@ -156,35 +354,43 @@ std::shared_ptr<Volume> Handle::getVolumeAtPathAsType(const Path& path,
      */
     std::reverse(selection.begin(), selection.end());
 
+    ChunkedSelection sel(rank);
     size3_t volumeDimensions(1);
     int resRank = 0;
-    std::vector<hsize_t> memoryDimensions{1, 1, 1};
 
     for (size_t i = 0; i < rank; ++i) {
-        start[i] = selection[i].start;
-        count[i] =
+        sel.start[i] = selection[i].start;
+        sel.count[i] =
             static_cast<hsize_t>((selection[i].end - selection[i].start) / selection[i].stride);
-        stride[i] = selection[i].stride;
+        sel.stride[i] = selection[i].stride;
 
-        if (count[i] > 1) {
+        if (sel.count[i] == 0) throw Exception("Invalid selection, empty range", IVW_CONTEXT);
+        if (sel.count[i] > 1) {
             if (resRank > 2) throw Exception("Invalid selection, resulting rank > 3", IVW_CONTEXT);
-            memoryDimensions[resRank] = count[i];
-            volumeDimensions[resRank] = count[i];
+            volumeDimensions[resRank] = sel.count[i];
             resRank++;
         }
     }
 
-    dataSpace.selectHyperslab(H5S_SELECT_SET, count.data(), start.data(), stride.data(), nullptr);
-
-    H5::DataSpace memorySpace(3, memoryDimensions.data());
-    memorySpace.selectAll();
-
-    hsize_t selectionSize = memorySpace.getSelectNpoints();
+    const H5::DSetCreatPropList createProperties = dataset.getCreatePlist();
+    const bool chunked = createProperties.getLayout() == H5D_CHUNKED;
+    std::vector<hsize_t> chunk = dataDimensions;
+    if (chunked) {
+        createProperties.getChunk(static_cast<int>(rank), chunk.data());
+    } else {
+        // Read contiguous data in slabs along the slowest selected dimension to report progress
+        const auto it = std::find_if(sel.count.begin(), sel.count.end(),
+                                     [](hsize_t count) { return count > 1; });
+        if (it != sel.count.end()) {
+            const auto dim = it - sel.count.begin();
+            chunk[dim] = std::max<hsize_t>(1, (dataDimensions[dim] + 63) / 64);
+        }
+    }
+    sel.setChunk(chunk);
 
     LogInfo("Data rank: " << rank << " dims " << joinString(dataDimensions, " x ") << " size "
-                          << dataSize << " selection " << dataSpace.getSelectNpoints()
-                          << " memory size " << memorySpace.getSelectNpoints() << " memory dim "
-                          << volumeDimensions);
+                          << dataSize << " chunk " << joinString(chunk, " x ") << " chunks "
+                          << sel.chunks << " memory dim " << volumeDimensions);
 
     const DataFormatBase* format = type ? type : util::getDataFormatFromDataSet(dataset);
 
@@ -199,12 +405,12 @@ std::shared_ptr<Volume> Handle::getVolumeAtPathAsType(const Path& path,
             ValueType* data = vrprecision->getDataTyped();
 
             try {
-                dataset.read(data, TypeMap<ValueType>::getType(), memorySpace, dataSpace);
-            } catch (H5::DataSetIException& e) {
+                readChunks(dataset, createProperties, chunked, sel, data, progress);
+            } catch (const H5::Exception& e) {
                 throw Exception("HDF: unable to read data: " + e.getDetailMsg(), IVW_CONTEXT);
             }
 
-            auto res = ::inviwo::util::dataMinMax(data, selectionSize);
+            auto res = ::inviwo::util::dataMinMax(data, glm::compMul(volumeDimensions));
 
             LogInfo("Read HDF volume type: " << DataFormat<ValueType>::str()
                                              << " data range: " << res.first << ", " << res.second
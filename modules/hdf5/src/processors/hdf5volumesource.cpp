@@ -32,6 +32,8 @@
 #include <modules/hdf5/datastructures/hdf5path.h>
 #include <inviwo/core/io/datareader.h>
 #include <inviwo/core/io/datareaderexception.h>
+#include <inviwo/core/util/raiiutils.h>
+#include <algorithm>
 #include <functional>
 #include <numeric>
 #include <limits>
@@ -89,6 +91,8 @@ HDF5ToVolume::HDF5ToVolume()
                  {"ushort", "Unsigned Short", 3}},
                 0)
     , selection_("selection", "Selection", 6)
+    , preview_("preview", "Preview", false)
+    , previewStride_("previewStride", "Preview stride", 4, 2, 32)
     , dirty_(false) {
 
     addPort(inport_);
@@ -112,7 +116,8 @@ HDF5ToVolume::HDF5ToVolume()
     information_.addProperties(dataDimensions_, dataRange_);
 
     outputGroup_.addProperties(datatype_, overrideRange_, outDataRange_, valueRange_, valueUnit_,
-                               selection_);
+                               selection_, preview_, previewStride_);
+    previewStride_.visibilityDependsOn(preview_, [](const auto& p) { return p.get(); });
     outputGroup_.onChange([this]() {
         if (automaticEvaluation_) {
             dirty_ = true;
@@ -155,15 +160,19 @@ void HDF5ToVolume::process() {
     if (selection_.adjustBasis_) {
         mat4 basis = basis_;
 
-        auto sel = selection_.getSelection();
         auto maxSel = selection_.getMaxSelection();
+        auto sel = loadedSelection_.size() == maxSel.size() ? loadedSelection_
+                                                            : selection_.getSelection();
 
+        // Only dimensions with more than one sample are axes of the volume. The samples span
+        // count * stride elements of the selected range.
         int j = 0;
         for (size_t i = 0; i < sel.size(); ++i) {
-            if (sel[i].end - sel[i].start <= 1) continue;
+            const size_t count = (sel[i].end - sel[i].start) / sel[i].stride;
+            if (count <= 1) continue;
             if (j > 2) throw Exception("Invalid selection, resulting rank > 3", IVW_CONTEXT);
 
-            basis[j] *= static_cast<float>(sel[i].end - sel[i].start) /
+            basis[j] *= static_cast<float>(count * sel[i].stride) /
                         static_cast<float>(maxSel[i].end - maxSel[i].start);
             ++j;
         }
@@ -332,10 +341,24 @@ void HDF5ToVolume::makeVolume() {
                 }
             }();
 
-            volume_ = std::shared_ptr<Volume>(
-                data->getVolumeAtPathAsType(Path(data->getGroup().getObjName()) + volumeMeta.path_,
-                                            selection_.getSelection(), format));
+            auto selection = selection_.getSelection();
+            if (preview_) {
+                // Keep at least two samples along every dimension with more than one element,
+                // otherwise the dimension would be dropped from the volume
+                for (auto& sel : selection) {
+                    const size_t maxStride = std::max(size_t{1}, (sel.end - sel.start) / 2);
+                    const size_t stride = sel.stride * static_cast<size_t>(previewStride_.get());
+                    sel.stride = std::max(sel.stride, std::min(stride, maxStride));
+                }
+            }
+
+            updateProgress(0.0f);
+            ::inviwo::util::OnScopeExit finish{[this]() { getProgressBar().finishProgress(); }};
+            volume_ = std::shared_ptr<Volume>(data->getVolumeAtPathAsType(
+                Path(data->getGroup().getObjName()) + volumeMeta.path_, selection, format,
+                [this](double progress) { updateProgress(static_cast<float>(progress)); }));
 
+            loadedSelection_ = selection;
             dataRange_.set(volume_->dataMap_.dataRange);
             outport_.setData(volume_);
 
@@ -0,0 +1,178 @@
+/*********************************************************************************
+ *
+ * Inviwo - Interactive Visualization Workshop
+ *
+ * Copyright (c) 2021 Inviwo Foundation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************************/
+
+#include <warn/push>
+#include <warn/ignore/all>
+#include <gtest/gtest.h>
+#include <warn/pop>
+
+#include <modules/hdf5/datastructures/hdf5chunkedselection.h>
+
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+namespace inviwo {
+
+namespace hdf5 {
+
+namespace {
+
+ChunkedSelection makeSelection(std::vector<hsize_t> start, std::vector<hsize_t> count,
+                               std::vector<hsize_t> stride, std::vector<hsize_t> chunk) {
+    ChunkedSelection sel(start.size());
+    sel.start = std::move(start);
+    sel.count = std::move(count);
+    sel.stride = std::move(stride);
+    sel.setChunk(chunk);
+    return sel;
+}
+
+// Call f for every index of a row major block of the given size
+void forEachIndex(const std::vector<hsize_t>& size,
+                  const std::function<void(const std::vector<hsize_t>&)>& f) {
+    std::vector<hsize_t> index(size.size(), 0);
+    for (;;) {
+        f(index);
+        size_t d = size.size();
+        while (d-- > 0) {
+            if (++index[d] < size[d]) break;
+            index[d] = 0;
+        }
+        if (d == std::numeric_limits<size_t>::max()) break;
+    }
+}
+
+hsize_t linear(const std::vector<hsize_t>& index, const std::vector<hsize_t>& size) {
+    hsize_t result = 0;
+    for (size_t i = 0; i < size.size(); ++i) result = result * size[i] + index[i];
+    return result;
+}
+
+/*
+ * Read the selection from a dataset where every element holds its own linear index, by
+ * scattering each chunk as the library would hand it out: always a full chunk, also at the edges
+ * of the dataset where the elements outside the dataset are undefined.
+ */
+std::vector<int> readChunked(const ChunkedSelection& sel, const std::vector<hsize_t>& dims) {
+    const auto total = std::accumulate(sel.count.begin(), sel.count.end(), hsize_t{1},
+                                       std::multiplies<hsize_t>());
+    std::vector<int> data(total, -1);
+    std::vector<ChunkRange> ranges;
+    for (size_t n = 0; n < sel.chunks; ++n) {
+        sel.getChunk(n, ranges);
+        std::vector<int> chunk;
+        forEachIndex(sel.chunk, [&](const std::vector<hsize_t>& local) {
+            std::vector<hsize_t> global(local.size());
+            bool inside = true;
+            for (size_t i = 0; i < local.size(); ++i) {
+                global[i] = ranges[i].offset + local[i];
+                inside &= global[i] < dims[i];
+            }
+            chunk.push_back(inside ? static_cast<int>(linear(global, dims)) : -2);
+        });
+        scatterChunk(sel, ranges, chunk.data(), data.data());
+    }
+    return data;
+}
+
+std::vector<int> readDirect(const ChunkedSelection& sel, const std::vector<hsize_t>& dims) {
+    std::vector<int> data;
+    forEachIndex(sel.count, [&](const std::vector<hsize_t>& index) {
+        std::vector<hsize_t> global(index.size());
+        for (size_t i = 0; i < index.size(); ++i) {
+            global[i] = sel.start[i] + index[i] * sel.stride[i];
+        }
+        data.push_back(static_cast<int>(linear(global, dims)));
+    });
+    return data;
+}
+
+bool operator==(const ChunkRange& a, const ChunkRange& b) {
+    return a.offset == b.offset && a.first == b.first && a.count == b.count;
+}
+
+}  // namespace
+
+TEST(HDF5ChunkedSelection, StrideAcrossChunkBoundaries) {
+    // selects 1, 4, 7, 10, 13
+    const auto sel = makeSelection({1}, {5}, {3}, {4});
+    ASSERT_EQ(4u, sel.chunks);
+    const std::vector<ChunkRange> expected{{0, 0, 1}, {4, 1, 2}, {8, 3, 1}, {12, 4, 1}};
+    ASSERT_EQ(expected.size(), sel.ranges[0].size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_TRUE(expected[i] == sel.ranges[0][i]) << "chunk " << i;
+    }
+}
+
+TEST(HDF5ChunkedSelection, StrideLargerThanChunkSkipsChunks) {
+    // selects 0, 5, 10 from chunks of two elements
+    const auto sel = makeSelection({0}, {3}, {5}, {2});
+    ASSERT_EQ(3u, sel.chunks);
+    const std::vector<ChunkRange> expected{{0, 0, 1}, {4, 1, 1}, {10, 2, 1}};
+    ASSERT_EQ(expected.size(), sel.ranges[0].size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_TRUE(expected[i] == sel.ranges[0][i]) << "chunk " << i;
+    }
+}
+
+TEST(HDF5ChunkedSelection, GetChunkIsRowMajor) {
+    const auto sel = makeSelection({0, 0}, {4, 6}, {1, 1}, {2, 3});
+    ASSERT_EQ(4u, sel.chunks);
+    std::vector<ChunkRange> ranges;
+    sel.getChunk(1, ranges);
+    EXPECT_EQ(0u, ranges[0].offset);
+    EXPECT_EQ(3u, ranges[1].offset);
+    sel.getChunk(2, ranges);
+    EXPECT_EQ(2u, ranges[0].offset);
+    EXPECT_EQ(0u, ranges[1].offset);
+}
+
+TEST(HDF5ChunkedSelection, ScatterStridedSelection) {
+    const std::vector<hsize_t> dims{5, 7};
+    const auto sel = makeSelection({1, 0}, {2, 4}, {2, 2}, {2, 3});
+    EXPECT_EQ(readDirect(sel, dims), readChunked(sel, dims));
+}
+
+TEST(HDF5ChunkedSelection, ScatterPartialEdgeChunks) {
+    // 7 x 10 x 9 does not divide into 3 x 4 x 4 chunks
+    const std::vector<hsize_t> dims{7, 10, 9};
+    const auto whole = makeSelection({0, 0, 0}, dims, {1, 1, 1}, {3, 4, 4});
+    EXPECT_EQ(3u * 3u * 3u, whole.chunks);
+    EXPECT_EQ(readDirect(whole, dims), readChunked(whole, dims));
+
+    // ends in the last, partial chunk of every dimension
+    const auto strided = makeSelection({2, 1, 0}, {3, 3, 3}, {2, 4, 4}, {3, 4, 4});
+    EXPECT_EQ(readDirect(strided, dims), readChunked(strided, dims));
+}
+
+}  // namespace hdf5
+
+}  // namespace inviwo
@@ -174,10 +174,14 @@ void exposeImage(py::module& m) {
                 return py::array(pyutil::toNumPyFormat(df), shape, strides, data, py::cast<>(1));
             },
             [](Layer* layer, py::array data) {
-                auto rep = layer->getEditableRepresentation<LayerRAM>();
-                pyutil::checkDataFormat<2>(rep->getDataFormat(), rep->getDimensions(), data);
-
-                memcpy(rep->getData(), data.data(0), data.nbytes());
+                pyutil::checkDataFormat<2>(layer->getDataFormat(), layer->getDimensions(), data);
+
+                auto rep = pyutil::createLayerRAM(data, layer->getLayerType());
+                rep->setSwizzleMask(layer->getSwizzleMask());
+                rep->setInterpolation(layer->getInterpolation());
+                rep->setWrapping(layer->getWrapping());
+                layer->addRepresentation(rep);
+                layer->invalidateAllOther(rep.get());
             })
         .def("__repr__", [](const Layer& self) {
             return fmt::format(
@@ -91,10 +91,14 @@ void exposeVolume(pybind11::module& m) {
                 return py::array(pyutil::toNumPyFormat(df), shape, strides, data, py::cast<>(1));
             },
             [](Volume* volume, py::array data) {
-                auto rep = volume->getEditableRepresentation<VolumeRAM>();
-                pyutil::checkDataFormat<3>(rep->getDataFormat(), rep->getDimensions(), data);
+                pyutil::checkDataFormat<3>(volume->getDataFormat(), volume->getDimensions(), data);
 
-                memcpy(rep->getData(), data.data(0), data.nbytes());
+                auto rep = pyutil::createVolumeRAM(data);
+                rep->setSwizzleMask(volume->getSwizzleMask());
+                rep->setInterpolation(volume->getInterpolation());
+                rep->setWrapping(volume->getWrapping());
+                volume->addRepresentation(rep);
+                volume->invalidateAllOther(rep.get());
             })
         .def("__repr__", [](const Volume& volume) {
             std::ostringstream oss;
@@ -43,6 +43,7 @@
 #include <inviwo/core/common/inviwoapplication.h>
 #include <inviwo/core/network/processornetwork.h>
 #include <inviwo/core/processors/processor.h>
+#include <inviwo/core/datastructures/image/imagetypes.h>
 #include <inviwo/core/util/formats.h>
 #include <inviwo/core/util/stringconversion.h>
 
@@ -50,13 +51,29 @@ namespace inviwo {
 
 class BufferBase;
 class Layer;
+class LayerRAM;
 class Volume;
+class VolumeRAM;
 
 namespace pyutil {
 
 IVW_MODULE_PYTHON3_API pybind11::dtype toNumPyFormat(const DataFormatBase* df);
 IVW_MODULE_PYTHON3_API const DataFormatBase* getDataFormat(size_t components, pybind11::array& arr);
 IVW_MODULE_PYTHON3_API std::unique_ptr<BufferBase> createBuffer(pybind11::array& arr);
+
+/**
+ * Create a LayerRAM or VolumeRAM that reads its values directly from the memory of \p arr, which
+ * is kept alive by the representation. Arrays that are not contiguous are first converted into a
+ * contiguous copy. The data is copied only once the representation is modified, modifying the
+ * array in place afterwards will however be visible in the representation.
+ */
+IVW_MODULE_PYTHON3_API std::shared_ptr<LayerRAM> createLayerRAM(
+    pybind11::array& arr, LayerType layerType = LayerType::Color);
+IVW_MODULE_PYTHON3_API std::shared_ptr<VolumeRAM> createVolumeRAM(pybind11::array& arr);
+
+/**
+ * Create a Layer or Volume sharing the memory of \p arr, @see createLayerRAM and createVolumeRAM
+ */
 IVW_MODULE_PYTHON3_API std::unique_ptr<Layer> createLayer(pybind11::array& arr);
 IVW_MODULE_PYTHON3_API std::unique_ptr<Volume> createVolume(pybind11::array& arr);
 
@@ -48,10 +48,88 @@
 
 #include <inviwo/core/util/stdextensions.h>
 
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <numeric>
+#include <vector>
+
 namespace inviwo {
 
 namespace pyutil {
 
+namespace {
+
+/*
+ * The memory of the array can be used as is if it is one contiguous block, i.e. if it holds the
+ * same bytes as we would have copied. With a component axis, the components of each element also
+ * have to be interleaved, which rules out Fortran order.
+ */
+template <typename T>
+bool isAdoptable(const pybind11::array& arr, size_t spatialDims) {
+    const auto order = static_cast<size_t>(arr.ndim()) > spatialDims
+                           ? pybind11::array::c_style
+                           : pybind11::array::c_style | pybind11::array::f_style;
+    return (arr.flags() & order) &&
+           reinterpret_cast<std::uintptr_t>(arr.data()) % alignof(T) == 0;
+}
+
+/*
+ * Other arrays are copied. Like numpy's order='K', the copy keeps the order of the spatial axes in
+ * memory, so a view is interpreted the same way as the array it was taken from. The component axis
+ * is made the fastest one, so the components of each element are interleaved.
+ */
+template <typename T>
+pybind11::array adoptable(pybind11::array& arr, size_t spatialDims) {
+    if (isAdoptable<T>(arr, spatialDims)) return arr;
+
+    // axes from the slowest to the fastest in memory
+    std::vector<size_t> order(spatialDims);
+    std::iota(order.begin(), order.end(), size_t{0});
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return std::abs(arr.strides(a)) > std::abs(arr.strides(b));
+    });
+    if (static_cast<size_t>(arr.ndim()) > spatialDims) order.push_back(spatialDims);
+
+    pybind11::list axes;
+    pybind11::list inverse;
+    std::vector<size_t> position(order.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        axes.append(order[i]);
+        position[order[i]] = i;
+    }
+    for (auto i : position) inverse.append(i);
+
+    auto numpy = pybind11::module::import("numpy");
+    auto packed = pybind11::array::ensure(
+        numpy.attr("ascontiguousarray")(numpy.attr("transpose")(arr, axes)));
+    if (!packed || !(packed.flags() & pybind11::array::c_style) ||
+        reinterpret_cast<std::uintptr_t>(packed.data()) % alignof(T) != 0) {
+        throw pybind11::value_error("Could not convert the given array to a contiguous array");
+    }
+    // A view with the original shape, the data pointer still refers to the start of the copy
+    return pybind11::array::ensure(numpy.attr("transpose")(packed, inverse));
+}
+
+/*
+ * Keeps the array alive for as long as a representation reads from it. The last reference might
+ * be released from any thread, hence the GIL is acquired before the array is released.
+ */
+std::shared_ptr<const void> keepAlive(const pybind11::array& arr) {
+    return std::shared_ptr<const void>(new pybind11::array(arr), [](pybind11::array* array) {
+        if (Py_IsInitialized()) {
+            pybind11::gil_scoped_acquire gil;
+            delete array;
+        } else {
+            // The interpreter has been finalized, and the array with it.
+            array->release();
+            delete array;
+        }
+    });
+}
+
+}  // namespace
+
 pybind11::dtype toNumPyFormat(const DataFormatBase* df) {
     std::string format;
     switch (df->getNumericType()) {
@@ -102,29 +180,29 @@ struct BufferFromArrayDispatcher {
     }
 };
 
-struct LayerFromArrayDispatcher {
-    using type = std::unique_ptr<Layer>;
+struct LayerRAMFromArrayDispatcher {
+    using type = std::shared_ptr<LayerRAM>;
 
     template <typename Result, typename T>
-    std::unique_ptr<Layer> operator()(pybind11::array& arr) {
+    std::shared_ptr<LayerRAM> operator()(pybind11::array& arr, LayerType layerType) {
         using Type = typename T::type;
         size2_t dims(arr.shape(0), arr.shape(1));
-        auto layerRAM = std::make_shared<LayerRAMPrecision<Type>>(dims);
-        memcpy(layerRAM->getData(), arr.data(0), arr.nbytes());
-        return std::make_unique<Layer>(layerRAM);
+        auto data = adoptable<Type>(arr, 2);
+        return std::make_shared<LayerRAMPrecision<Type>>(
+            keepAlive(data), static_cast<const Type*>(data.data()), dims, layerType);
     }
 };
 
-struct VolumeFromArrayDispatcher {
-    using type = std::unique_ptr<Volume>;
+struct VolumeRAMFromArrayDispatcher {
+    using type = std::shared_ptr<VolumeRAM>;
 
     template <typename Result, typename T>
-    std::unique_ptr<Volume> operator()(pybind11::array& arr) {
+    std::shared_ptr<VolumeRAM> operator()(pybind11::array& arr) {
         using Type = typename T::type;
         size3_t dims(arr.shape(0), arr.shape(1), arr.shape(2));
-        auto volumeRAM = std::make_shared<VolumeRAMPrecision<Type>>(dims);
-        memcpy(volumeRAM->getData(), arr.data(0), arr.nbytes());
-        return std::make_unique<Volume>(volumeRAM);
+        auto data = adoptable<Type>(arr, 3);
+        return std::make_shared<VolumeRAMPrecision<Type>>(
+            keepAlive(data), static_cast<const Type*>(data.data()), dims);
     }
 };
 
@@ -137,23 +215,31 @@ std::unique_ptr<BufferBase> createBuffer(pybind11::array& arr) {
         df->getId(), dispatcher, arr);
 }
 
-std::unique_ptr<Layer> createLayer(pybind11::array& arr) {
+std::shared_ptr<LayerRAM> createLayerRAM(pybind11::array& arr, LayerType layerType) {
     auto ndim = arr.ndim();
     ivwAssert(ndim == 2 || ndim == 3, "Ndims must be either 2 or 3");
     auto df = pyutil::getDataFormat(ndim == 2 ? 1 : arr.shape(2), arr);
-    LayerFromArrayDispatcher dispatcher;
-    return dispatching::dispatch<std::unique_ptr<Layer>, dispatching::filter::All>(df->getId(),
-                                                                                   dispatcher, arr);
+    LayerRAMFromArrayDispatcher dispatcher;
+    return dispatching::dispatch<std::shared_ptr<LayerRAM>, dispatching::filter::All>(
+        df->getId(), dispatcher, arr, layerType);
 }
 
-std::unique_ptr<Volume> createVolume(pybind11::array& arr) {
+std::shared_ptr<VolumeRAM> createVolumeRAM(pybind11::array& arr) {
     auto ndim = arr.ndim();
     ivwAssert(ndim == 3 || ndim == 4, "Ndims must be either 3 or 4");
     auto df = pyutil::getDataFormat(ndim == 3 ? 1 : arr.shape(3), arr);
-    VolumeFromArrayDispatcher dispatcher;
-    return dispatching::dispatch<std::unique_ptr<Volume>, dispatching::filter::All>(
+    VolumeRAMFromArrayDispatcher dispatcher;
+    return dispatching::dispatch<std::shared_ptr<VolumeRAM>, dispatching::filter::All>(
         df->getId(), dispatcher, arr);
 }
 
+std::unique_ptr<Layer> createLayer(pybind11::array& arr) {
+    return std::make_unique<Layer>(createLayerRAM(arr));
+}
+
+std::unique_ptr<Volume> createVolume(pybind11::array& arr) {
+    return std::make_unique<Volume>(createVolumeRAM(arr));
+}
+
 }  // namespace pyutil
 }  // namespace inviwo
@@ -247,4 +247,87 @@ const static std::vector<std::string> dtypes = {{"float16"}, {"float32"}, {"floa
 
 INSTANTIATE_TEST_SUITE_P(DefaultTypes, DTypeTest, ::testing::ValuesIn(dtypes));
 
+TEST(Python3NumPy, VolumeSharesArrayMemory) {
+    PythonScript s;
+    s.setSource(
+        "import numpy as np\n"
+        "a = np.arange(24, dtype=np.float32).reshape((2, 3, 4), order='F')\n");
+    bool status = false;
+    s.run([&](pybind11::dict dict) {
+        auto arr = pybind11::cast<pybind11::array>(dict["a"]);
+        auto volume = pyutil::createVolume(arr);
+        EXPECT_EQ(size3_t(2, 3, 4), volume->getDimensions());
+
+        const auto ram = volume->getRepresentation<VolumeRAM>();
+        EXPECT_EQ(arr.data(), ram->getData());
+        EXPECT_EQ(5.0, ram->getAsDouble(size3_t(1, 2, 0)));
+
+        volume->getEditableRepresentation<VolumeRAM>()->setFromDouble(size3_t(0, 0, 0), 42.0);
+        EXPECT_NE(arr.data(), volume->getRepresentation<VolumeRAM>()->getData());
+        EXPECT_EQ(0.0f, *static_cast<const float*>(arr.data()));
+
+        status = true;
+    });
+    EXPECT_TRUE(status);
+}
+
+TEST(Python3NumPy, LayerFromNonContiguousArray) {
+    PythonScript s;
+    s.setSource(
+        "import numpy as np\n"
+        "a = np.arange(32, dtype=np.uint8).reshape((4, 8))[:, ::2]\n");
+    bool status = false;
+    s.run([&](pybind11::dict dict) {
+        auto arr = pybind11::cast<pybind11::array>(dict["a"]);
+        auto layer = pyutil::createLayer(arr);
+        EXPECT_EQ(size2_t(4, 4), layer->getDimensions());
+
+        // The slice is copied in the memory order of the array, like a contiguous array a[y, x]
+        // is at (x, y)
+        const auto ram = layer->getRepresentation<LayerRAM>();
+        EXPECT_EQ(0.0, ram->getAsDouble(size2_t(0, 0)));
+        EXPECT_EQ(18.0, ram->getAsDouble(size2_t(1, 2)));
+        EXPECT_EQ(12.0, ram->getAsDouble(size2_t(2, 1)));
+        EXPECT_EQ(30.0, ram->getAsDouble(size2_t(3, 3)));
+
+        status = true;
+    });
+    EXPECT_TRUE(status);
+}
+
+TEST(Python3NumPy, LayerFromViewMatchesCopy) {
+    PythonScript s;
+    s.setSource(
+        "import numpy as np\n"
+        "a = np.arange(96, dtype=np.uint8).reshape((4, 8, 3))\n"
+        "f = np.asfortranarray(np.arange(32, dtype=np.uint8).reshape((4, 8)))\n"
+        "views = [a[:, ::1], a[:, ::2], a[::2, 1:7], f[:, ::2]]\n"
+        "copies = [a.copy(), a[:, ::2].copy(), a[::2, 1:7].copy(),\n"
+        "          np.asfortranarray(f[:, ::2])]\n");
+    bool status = false;
+    s.run([&](pybind11::dict dict) {
+        auto views = pybind11::cast<std::vector<pybind11::array>>(dict["views"]);
+        auto copies = pybind11::cast<std::vector<pybind11::array>>(dict["copies"]);
+        ASSERT_EQ(views.size(), copies.size());
+        for (size_t i = 0; i < views.size(); ++i) {
+            auto view = pyutil::createLayer(views[i]);
+            auto copy = pyutil::createLayer(copies[i]);
+            ASSERT_EQ(copy->getDimensions(), view->getDimensions());
+
+            const auto viewRAM = view->getRepresentation<LayerRAM>();
+            const auto copyRAM = copy->getRepresentation<LayerRAM>();
+            const auto dims = view->getDimensions();
+            for (size_t y = 0; y < dims.y; ++y) {
+                for (size_t x = 0; x < dims.x; ++x) {
+                    EXPECT_EQ(copyRAM->getAsDVec4(size2_t(x, y)),
+                              viewRAM->getAsDVec4(size2_t(x, y)))
+                        << "array " << i << " at (" << x << ", " << y << ")";
+                }
+            }
+        }
+        status = true;
+    });
+    EXPECT_TRUE(status);
+}
+
 }  // namespace inviwo
@@ -36,7 +36,16 @@
 #include <modules/vectorfieldvisualization/properties/integrallineproperties.h>
 #include <modules/vectorfieldvisualization/datastructures/integralline.h>
 
+#include <tcb/span.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <tuple>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace inviwo {
 
@@ -54,6 +63,11 @@ public:
 
     const static bool IsTimeDependent = TimeDependent;
 
+    /**
+     * Number of seeds traced in lockstep by traceBatch
+     */
+    static constexpr size_t PacketSize = 16;
+
     /*
      * Various types used within this class
      */
@@ -64,27 +78,127 @@ public:
     using DataMatrix = Matrix<SpatialSampler::DataDimensions, double>;
     using DataHomogenouSpatialMatrixrix = Matrix<SpatialSampler::DataDimensions + 1, double>;
 
+    /**
+     * Integral lines stored as a structure of arrays. The points of line i are the elements
+     * [offsets[i], offsets[i + 1]) of positions, velocities, timestamps, and of each meta data
+     * vector. Timestamps are only stored by time dependent tracers. A batch can be reused for
+     * several calls to traceBatch to avoid allocations. The batch is only the working storage of
+     * the tracer, an IntegralLineSet still holds a separate IntegralLine with its own buffers
+     * per line, see createLine.
+     */
+    struct Batch {
+        std::vector<dvec3> positions;
+        std::vector<dvec3> velocities;
+        std::vector<double> timestamps;
+        std::vector<std::pair<std::string, std::vector<typename Sampler::ReturnType>>> metaData;
+        std::vector<size_t> offsets{0};
+        std::vector<size_t> seedIndices;  //!< index of the seed point within each line
+        std::vector<IntegralLine::TerminationReason> backwardTerminationReasons;
+        std::vector<IntegralLine::TerminationReason> forwardTerminationReasons;
+
+        size_t size() const { return offsets.size() - 1; }
+        size_t getNumberOfPoints(size_t line) const { return offsets[line + 1] - offsets[line]; }
+        void clear();
+        /**
+         * Copy line \p line into a separate IntegralLine
+         */
+        IntegralLine createLine(size_t line) const;
+    };
+
     IntegralLineTracer(std::shared_ptr<const Sampler> sampler,
                        const IntegralLineProperties& properties);
 
     Result traceFrom(const SpatialVector& pIn) const;
 
+    /**
+     * Trace an integral line from each of the \p seeds and append the lines to \p batch, in the
+     * order of the seeds. Lines are traced in packets of PacketSize seeds, where all lines of a
+     * packet are advanced one step at a time. Apart from growing \p batch, nothing is allocated
+     * per line or per step.
+     * @param seeds  a contiguous range of seed points convertible to SpatialVector, for example
+     *               a util::span or a std::vector
+     * @param batch  the lines are appended to the batch
+     */
+    template <typename Seeds>
+    void traceBatch(const Seeds& seeds, Batch& batch) const;
+
     void addMetaDataSampler(const std::string& name, std::shared_ptr<const Sampler> sampler);
 
     const DataHomogenouSpatialMatrixrix& getSeedTransformationMatrix() const;
 
 private:
+    /**
+     * The state of tracing one direction of a line within a packet
+     */
+    struct Lane {
+        size_t steps;     //!< the number of steps to take
+        size_t taken;     //!< the number of accepted steps so far
+        double stepSize;  //!< signed, negative when tracing backwards
+        SpatialVector pos;
+        DataVector velocity;  //!< the velocity at pos, if hasVelocity is set
+        bool hasVelocity;
+        IntegralLine::TerminationReason reason;
+        bool running;
+        std::vector<SpatialVector> positions;  //!< the traced points, excluding the seed
+        std::vector<DataVector> velocities;
+    };
+
+    /**
+     * Positions and velocities of the intermediate steps of the integration of a packet
+     */
+    struct Stages {
+        explicit Stages(size_t size)
+            : next(size)
+            , k1(size)
+            , k2(size)
+            , k3(size)
+            , k4(size)
+            , k5(size)
+            , k6(size)
+            , k7(size)
+            , accepted(size)
+            , missing(size) {}
+        std::vector<SpatialVector> next;
+        std::vector<DataVector> k1;
+        std::vector<DataVector> k2;
+        std::vector<DataVector> k3;
+        std::vector<DataVector> k4;
+        std::vector<DataVector> k5;
+        std::vector<DataVector> k6;
+        std::vector<DataVector> k7;
+        std::vector<char> accepted;  //!< false if the step was rejected by the error control
+        std::vector<size_t> missing;
+    };
+
     inline SpatialVector seedTransform(const SpatialVector& seed) const;
 
-    std::pair<SpatialVector, DataVector> step(const SpatialVector& oldPos,
-                                              const double stepSize) const;
+    SpatialVector move(const SpatialVector& pos, DataVector v, double stepSize) const;
+
+    /**
+     * Move \p pos by \p offset in data space, and by \p time for time dependent tracers
+     */
+    SpatialVector advance(const SpatialVector& pos, const DataVector& offset, double time) const;
+
+    DataVector direction(const DataVector& v) const;
+
+    /**
+     * Sample the velocity at all \p positions, using a single batch call to the sampler
+     */
+    void sample(util::span<const SpatialVector> positions,
+                util::span<DataVector> velocities) const;
+
+    /**
+     * Advance the lanes \p active of \p lanes by one step. The new positions are written to
+     * Stages::next and the velocities at the current positions to Stages::k1. RK45 also adapts
+     * the step sizes of the lanes and flags rejected steps in Stages::accepted.
+     */
+    void step(std::vector<Lane>& lanes, const std::vector<size_t>& active, Stages& stages) const;
 
-    bool addPoint(IntegralLine& line, const SpatialVector& pos) const;
-    bool addPoint(IntegralLine& line, const SpatialVector& pos,
-                  const DataVector& worldVelocity) const;
+    void integrate(std::vector<Lane>& lanes, Stages& stages) const;
 
-    IntegralLine::TerminationReason integrate(size_t steps, SpatialVector pos, IntegralLine& line,
-                                              bool fwd) const;
+    void addLine(Batch& batch, const SpatialVector& seed, const DataVector& seedVelocity,
+                 const Lane* bwd, const Lane* fwd, IntegralLine::TerminationReason bwdReason,
+                 IntegralLine::TerminationReason fwdReason) const;
 
     IntegralLineProperties::IntegrationScheme integrationScheme_;
 
@@ -93,6 +207,10 @@ private:
     IntegralLineProperties::Direction dir_;
     bool normalizeSamples_;
 
+    double tolerance_;
+    double minStepSize_;
+    double maxStepSize_;
+
     std::shared_ptr<const Sampler> sampler_;
     std::unordered_map<std::string, std::shared_ptr<const Sampler>> metaSamplers_;
 
@@ -100,6 +218,41 @@ private:
     DataHomogenouSpatialMatrixrix seedTransformation_;
 };
 
+template <typename SpatialSampler, bool TimeDependent>
+void IntegralLineTracer<SpatialSampler, TimeDependent>::Batch::clear() {
+    positions.clear();
+    velocities.clear();
+    timestamps.clear();
+    metaData.clear();
+    offsets.assign(1, 0);
+    seedIndices.clear();
+    backwardTerminationReasons.clear();
+    forwardTerminationReasons.clear();
+}
+
+template <typename SpatialSampler, bool TimeDependent>
+IntegralLine IntegralLineTracer<SpatialSampler, TimeDependent>::Batch::createLine(
+    size_t line) const {
+    const size_t begin = offsets[line];
+    const size_t end = offsets[line + 1];
+
+    IntegralLine res;
+    res.getPositions().assign(positions.data() + begin, positions.data() + end);
+    res.getMetaData<dvec3>("velocity", true).assign(velocities.data() + begin,
+                                                     velocities.data() + end);
+    if constexpr (TimeDependent) {
+        res.getMetaData<double>("timestamp", true)
+            .assign(timestamps.data() + begin, timestamps.data() + end);
+    }
+    for (const auto& [name, data] : metaData) {
+        res.getMetaData<typename Sampler::ReturnType>(name, true)
+            .assign(data.data() + begin, data.data() + end);
+    }
+    res.setBackwardTerminationReason(backwardTerminationReasons[line]);
+    res.setForwardTerminationReason(forwardTerminationReasons[line]);
+    return res;
+}
+
 template <typename SpatialSampler, bool TimeDependent>
 IntegralLineTracer<SpatialSampler, TimeDependent>::IntegralLineTracer(
     std::shared_ptr<const Sampler> sampler, const IntegralLineProperties& properties)
@@ -108,6 +261,9 @@ IntegralLineTracer<SpatialSampler, TimeDependent>::IntegralLineTracer(
     , stepSize_(properties.getStepSize())
     , dir_(properties.getStepDirection())
     , normalizeSamples_(properties.getNormalizeSamples())
+    , tolerance_(properties.getTolerance())
+    , minStepSize_(properties.getMinStepSize())
+    , maxStepSize_(std::max(properties.getMinStepSize(), properties.getMaxStepSize()))
     , sampler_(sampler)
     , invBasis_(glm::inverse(DataMatrix(sampler->getModelMatrix())))
     , seedTransformation_(
@@ -116,50 +272,94 @@ IntegralLineTracer<SpatialSampler, TimeDependent>::IntegralLineTracer(
 template <typename SpatialSampler, bool TimeDependent>
 typename IntegralLineTracer<SpatialSampler, TimeDependent>::Result
 IntegralLineTracer<SpatialSampler, TimeDependent>::traceFrom(const SpatialVector& pIn) const {
-    const SpatialVector p = seedTransform(pIn);
-    Result res;
-    IntegralLine& line = res.line;
+    Batch batch;
+    traceBatch(util::span<const SpatialVector>(&pIn, 1), batch);
+    return Result{batch.createLine(0), batch.seedIndices[0]};
+}
 
-    const auto [stepsBWD, stepsFWD] = [dir = dir_, steps = steps_,
-                                       &line]() -> std::pair<size_t, size_t> {
-        switch (dir) {
+template <typename SpatialSampler, bool TimeDependent>
+template <typename Seeds>
+void IntegralLineTracer<SpatialSampler, TimeDependent>::traceBatch(const Seeds& seeds,
+                                                                   Batch& batch) const {
+    using Reason = IntegralLine::TerminationReason;
+
+    const size_t steps = static_cast<size_t>(std::max(steps_, 0));
+    const auto [stepsBWD, stepsFWD, bwdReason, fwdReason] =
+        [&]() -> std::tuple<size_t, size_t, Reason, Reason> {
+        switch (dir_) {
             case inviwo::IntegralLineProperties::Direction::FWD:
-                line.setBackwardTerminationReason(IntegralLine::TerminationReason::StartPoint);
-                return {1, steps + 1};
+                return {1, steps + 1, Reason::StartPoint, Reason::Unknown};
             case inviwo::IntegralLineProperties::Direction::BWD:
-                line.setForwardTerminationReason(IntegralLine::TerminationReason::StartPoint);
-                return {steps + 1, 1};
+                return {steps + 1, 1, Reason::Unknown, Reason::StartPoint};
             default:
             case inviwo::IntegralLineProperties::Direction::BOTH: {
-                return {steps / 2 + 1, steps - (steps / 2) + 1};
+                return {steps / 2 + 1, steps - (steps / 2) + 1, Reason::Unknown, Reason::Unknown};
             }
         }
     }();
 
-    line.getPositions().reserve(steps_ + 2);
-    line.getMetaData<dvec3>("velocity", true).reserve(steps_ + 2);
-
-    if constexpr (TimeDependent) {
-        line.getMetaData<double>("timestamp", true).reserve(steps_ + 2);
-    }
-
-    for (auto& m : metaSamplers_) {
-        line.getMetaData<typename Sampler::ReturnType>(m.first, true).reserve(steps_ + 2);
+    if (batch.metaData.empty()) {
+        for (const auto& m : metaSamplers_) {
+            batch.metaData.emplace_back(m.first, std::vector<typename Sampler::ReturnType>{});
+        }
     }
 
-    if (!addPoint(line, p)) {
-        return res;  // Zero velocity at seed point
-    }
+    // Two lanes per seed, one for each direction. The lanes keep their allocations between
+    // packets.
+    std::vector<Lane> lanes(2 * PacketSize);
+    std::vector<SpatialVector> seedPos(PacketSize);
+    std::vector<DataVector> seedVelocity(PacketSize);
+    std::vector<bool> valid(PacketSize);
+    Stages stages(lanes.size());
+
+    // RK45 starts out with the step size, and then adapts it within [minStepSize, maxStepSize]
+    const double stepSize =
+        integrationScheme_ == IntegralLineProperties::IntegrationScheme::RK45
+            ? std::max(minStepSize_, std::min(maxStepSize_, stepSize_))
+            : stepSize_;
+
+    for (size_t first = 0; first < seeds.size(); first += PacketSize) {
+        const size_t count = std::min(PacketSize, seeds.size() - first);
+        for (size_t i = 0; i < count; ++i) {
+            seedPos[i] = seedTransform(SpatialVector(seeds[first + i]));
+        }
+        sample(util::span<const SpatialVector>(seedPos.data(), count),
+               util::span<DataVector>(seedVelocity.data(), count));
+
+        for (size_t i = 0; i < count; ++i) {
+            // A seed with zero velocity results in an empty line
+            valid[i] = glm::length(seedVelocity[i]) >= std::numeric_limits<double>::epsilon();
+            const auto init = [&](Lane& lane, size_t n, double stepSize) {
+                lane.steps = n;
+                lane.taken = 0;
+                lane.stepSize = stepSize;
+                lane.pos = seedPos[i];
+                lane.velocity = seedVelocity[i];
+                lane.hasVelocity = true;
+                lane.reason = Reason::StartPoint;
+                lane.running = valid[i];
+                lane.positions.clear();
+                lane.velocities.clear();
+            };
+            init(lanes[2 * i], stepsBWD, -stepSize);
+            init(lanes[2 * i + 1], stepsFWD, stepSize);
+        }
+        for (size_t i = 2 * count; i < lanes.size(); ++i) {
+            lanes[i].running = false;
+        }
 
-    line.setBackwardTerminationReason(integrate(stepsBWD, p, line, false));
+        integrate(lanes, stages);
 
-    if (line.getPositions().size() > 1) {
-        line.reverse();
-        res.seedIndex = line.getPositions().size() - 1;
+        for (size_t i = 0; i < count; ++i) {
+            if (valid[i]) {
+                addLine(batch, seedPos[i], seedVelocity[i], &lanes[2 * i], &lanes[2 * i + 1],
+                        lanes[2 * i].reason, lanes[2 * i + 1].reason);
+            } else {
+                addLine(batch, seedPos[i], seedVelocity[i], nullptr, nullptr, bwdReason,
+                        fwdReason);
+            }
+        }
     }
-
-    line.setForwardTerminationReason(integrate(stepsFWD, p, line, true));
-    return res;
 }
 
 template <typename SpatialSampler, bool TimeDependent>
@@ -190,95 +390,260 @@ IntegralLineTracer<SpatialSampler, TimeDependent>::seedTransform(const SpatialVe
 }
 
 template <typename SpatialSampler, bool TimeDependent>
-std::pair<typename IntegralLineTracer<SpatialSampler, TimeDependent>::SpatialVector,
-          typename IntegralLineTracer<SpatialSampler, TimeDependent>::DataVector>
-IntegralLineTracer<SpatialSampler, TimeDependent>::step(const SpatialVector& oldPos,
-                                                        const double stepSize) const {
-    auto normalize = [](const auto v) {
-        auto l = glm::length(v);
-        if (l == 0) return v;
-        return v / l;
-    };
+typename IntegralLineTracer<SpatialSampler, TimeDependent>::SpatialVector
+IntegralLineTracer<SpatialSampler, TimeDependent>::move(const SpatialVector& pos, DataVector v,
+                                                        double stepSize) const {
+    return advance(pos, direction(v) * stepSize, stepSize);
+}
 
-    auto move = [&](const auto& pos, auto v, const auto stepsize) {
-        if (normalizeSamples_) {
-            v = normalize(v);
+template <typename SpatialSampler, bool TimeDependent>
+typename IntegralLineTracer<SpatialSampler, TimeDependent>::SpatialVector
+IntegralLineTracer<SpatialSampler, TimeDependent>::advance(const SpatialVector& pos,
+                                                           const DataVector& offset,
+                                                           double time) const {
+    if constexpr (TimeDependent) {
+        return pos + SpatialVector(invBasis_ * offset, time);
+    } else {
+        return pos + invBasis_ * offset;
+    }
+}
+
+template <typename SpatialSampler, bool TimeDependent>
+typename IntegralLineTracer<SpatialSampler, TimeDependent>::DataVector
+IntegralLineTracer<SpatialSampler, TimeDependent>::direction(const DataVector& v) const {
+    if (normalizeSamples_) {
+        const auto l = glm::length(v);
+        if (l != 0) return v / l;
+    }
+    return v;
+}
+
+template <typename SpatialSampler, bool TimeDependent>
+void IntegralLineTracer<SpatialSampler, TimeDependent>::sample(
+    util::span<const SpatialVector> positions, util::span<DataVector> velocities) const {
+    if constexpr (std::is_same_v<typename Sampler::ReturnType, DataVector>) {
+        sampler_->sample(positions, velocities);
+    } else {
+        for (size_t i = 0; i < positions.size(); ++i) {
+            velocities[i] = sampler_->sample(positions[i]);
         }
-        auto offset = (invBasis_ * (v * stepsize));
-        if constexpr (TimeDependent) {
-            return pos + SpatialVector(offset, stepsize);
-        } else {
-            return pos + offset;
+    }
+}
+
+template <typename SpatialSampler, bool TimeDependent>
+void IntegralLineTracer<SpatialSampler, TimeDependent>::step(std::vector<Lane>& lanes,
+                                                             const std::vector<size_t>& active,
+                                                             Stages& stages) const {
+    const size_t count = active.size();
+    auto& next = stages.next;
+    const auto positions = util::span<const SpatialVector>(next.data(), count);
+
+    // Sample the velocity at the positions of the lanes moved by k * scale steps into res
+    const auto stage = [&](const std::vector<DataVector>& k, double scale,
+                           std::vector<DataVector>& res) {
+        for (size_t i = 0; i < count; ++i) {
+            const auto& lane = lanes[active[i]];
+            next[i] = move(lane.pos, k[i], lane.stepSize * scale);
         }
+        sample(positions, util::span<DataVector>(res.data(), count));
     };
 
-    auto k1 = sampler_->sample(oldPos);
+    // Only sample the velocity at the current positions that are not known already
+    size_t missing = 0;
+    for (size_t i = 0; i < count; ++i) {
+        auto& lane = lanes[active[i]];
+        if (lane.hasVelocity) {
+            stages.k1[i] = lane.velocity;
+        } else {
+            next[missing] = lane.pos;
+            stages.missing[missing++] = i;
+        }
+        lane.hasVelocity = false;
+        stages.accepted[i] = true;
+    }
+    sample(util::span<const SpatialVector>(next.data(), missing),
+           util::span<DataVector>(stages.k2.data(), missing));
+    for (size_t i = 0; i < missing; ++i) {
+        stages.k1[stages.missing[i]] = stages.k2[i];
+    }
 
     switch (integrationScheme_) {
         case inviwo::IntegralLineProperties::IntegrationScheme::Euler:
-            return {move(oldPos, k1, stepSize), k1};
+            for (size_t i = 0; i < count; ++i) {
+                const auto& lane = lanes[active[i]];
+                next[i] = move(lane.pos, stages.k1[i], lane.stepSize);
+            }
+            return;
+        case inviwo::IntegralLineProperties::IntegrationScheme::RK45: {
+            // Dormand-Prince 5(4), the rows of a are the weights of the previous stages, the last
+            // row gives the fifth order solution. e is the difference between the fifth and the
+            // embedded fourth order weights.
+            static constexpr double c[] = {1.0 / 5.0, 3.0 / 10.0, 4.0 / 5.0, 8.0 / 9.0, 1.0, 1.0};
+            static constexpr double a[6][6] = {
+                {1.0 / 5.0},
+                {3.0 / 40.0, 9.0 / 40.0},
+                {44.0 / 45.0, -56.0 / 15.0, 32.0 / 9.0},
+                {19372.0 / 6561.0, -25360.0 / 2187.0, 64448.0 / 6561.0, -212.0 / 729.0},
+                {9017.0 / 3168.0, -355.0 / 33.0, 46732.0 / 5247.0, 49.0 / 176.0,
+                 -5103.0 / 18656.0},
+                {35.0 / 384.0, 0.0, 500.0 / 1113.0, 125.0 / 192.0, -2187.0 / 6784.0,
+                 11.0 / 84.0}};
+            static constexpr double e[] = {71.0 / 57600.0,       0.0,          -71.0 / 16695.0,
+                                           71.0 / 1920.0,        -17253.0 / 339200.0,
+                                           22.0 / 525.0,         -1.0 / 40.0};
+            std::vector<DataVector>* k[] = {&stages.k1, &stages.k2, &stages.k3, &stages.k4,
+                                            &stages.k5, &stages.k6, &stages.k7};
+
+            for (size_t s = 1; s < 7; ++s) {
+                for (size_t i = 0; i < count; ++i) {
+                    const auto& lane = lanes[active[i]];
+                    DataVector v{0.0};
+                    for (size_t j = 0; j < s; ++j) {
+                        v += direction((*k[j])[i]) * a[s - 1][j];
+                    }
+                    next[i] = advance(lane.pos, v * lane.stepSize, c[s - 1] * lane.stepSize);
+                }
+                sample(positions, util::span<DataVector>(k[s]->data(), count));
+            }
+            // The last stage was sampled at the new position, it gives the error estimate and
+            // the velocity at the start of the next step.
+
+            // Accept the step if the error is within the tolerance, and scale the step size by
+            // (tolerance / error)^(1/5), with a safety factor and limits on the change.
+            for (size_t i = 0; i < count; ++i) {
+                auto& lane = lanes[active[i]];
+                DataVector v{0.0};
+                for (size_t j = 0; j < 7; ++j) {
+                    v += direction((*k[j])[i]) * e[j];
+                }
+                const double h = std::abs(lane.stepSize);
+                const double error = glm::length(invBasis_ * (v * h));
+                const double factor =
+                    error > 0.0 ? std::clamp(0.9 * std::pow(tolerance_ / error, 0.2), 0.2, 5.0)
+                                : 5.0;
+                // A NaN error is accepted as well, it can not be improved upon by retrying
+                const bool accept = !(error > tolerance_) || h <= minStepSize_;
+
+                stages.accepted[i] = accept;
+                lane.stepSize = std::copysign(
+                    std::max(minStepSize_, std::min(maxStepSize_, h * factor)), lane.stepSize);
+                lane.velocity = accept ? stages.k7[i] : stages.k1[i];
+                lane.hasVelocity = true;
+            }
+            return;
+        }
         default:
             [[fallthrough]];
         case inviwo::IntegralLineProperties::IntegrationScheme::RK4: {
-            const auto k2 = sampler_->sample(move(oldPos, k1, stepSize / 2));
-            const auto k3 = sampler_->sample(move(oldPos, k2, stepSize / 2));
-            const auto k4 = sampler_->sample(move(oldPos, k3, stepSize));
-            const auto&& K = [n = normalizeSamples_, normalize, &k1, &k2, &k3, &k4]() {
-                if (n) {
-                    return normalize(k1 + k2 + k2 + k3 + k3 + k4);
+            stage(stages.k1, 0.5, stages.k2);
+            stage(stages.k2, 0.5, stages.k3);
+            stage(stages.k3, 1.0, stages.k4);
+
+            for (size_t i = 0; i < count; ++i) {
+                const auto& lane = lanes[active[i]];
+                auto K = stages.k1[i] + stages.k2[i] + stages.k2[i] + stages.k3[i] +
+                         stages.k3[i] + stages.k4[i];
+                if (normalizeSamples_) {
+                    const auto l = glm::length(K);
+                    if (l != 0) K /= l;
                 } else {
-                    return (k1 + k2 + k2 + k3 + k3 + k4) * (1.0 / 6.0);
+                    K *= (1.0 / 6.0);
                 }
-            };
-            return {move(oldPos, K(), stepSize), k1};
+                next[i] = move(lane.pos, K, lane.stepSize);
+            }
+            return;
         }
     }
 }
 
 template <typename SpatialSampler, bool TimeDependent>
-bool IntegralLineTracer<SpatialSampler, TimeDependent>::addPoint(IntegralLine& line,
-                                                                 const SpatialVector& pos) const {
-    return addPoint(line, pos, sampler_->sample(pos));
-}
-
-template <typename SpatialSampler, bool TimeDependent>
-bool IntegralLineTracer<SpatialSampler, TimeDependent>::addPoint(
-    IntegralLine& line, const SpatialVector& pos, const DataVector& worldVelocity) const {
-
-    if (glm::length(worldVelocity) < std::numeric_limits<double>::epsilon()) {
-        return false;
-    }
-
-    line.getPositions().emplace_back(util::glm_convert<dvec3>(pos));
-    line.getMetaData<dvec3>("velocity").emplace_back(util::glm_convert<dvec3>(worldVelocity));
+void IntegralLineTracer<SpatialSampler, TimeDependent>::integrate(std::vector<Lane>& lanes,
+                                                                  Stages& stages) const {
+    std::vector<size_t> active;
+    active.reserve(lanes.size());
+
+    for (;;) {
+        active.clear();
+        for (size_t l = 0; l < lanes.size(); ++l) {
+            auto& lane = lanes[l];
+            if (!lane.running) continue;
+            if (lane.taken == lane.steps) {
+                lane.reason = lane.steps == 0 ? IntegralLine::TerminationReason::StartPoint
+                                              : IntegralLine::TerminationReason::Steps;
+                lane.running = false;
+            } else if (!sampler_->withinBounds(lane.pos)) {
+                lane.reason = IntegralLine::TerminationReason::OutOfBounds;
+                lane.running = false;
+            } else {
+                active.push_back(l);
+            }
+        }
+        if (active.empty()) return;
 
-    if constexpr (TimeDependent) {
-        line.getMetaData<double>("timestamp").emplace_back(pos[Sampler::SpatialDimensions - 1]);
-    }
+        step(lanes, active, stages);
 
-    for (auto& m : metaSamplers_) {
-        line.getMetaData<typename Sampler::ReturnType>(m.first).emplace_back(
-            util::glm_convert<dvec3>(m.second->sample(pos)));
+        for (size_t j = 0; j < active.size(); ++j) {
+            auto& lane = lanes[active[j]];
+            if (glm::length(stages.k1[j]) < std::numeric_limits<double>::epsilon()) {
+                lane.reason = IntegralLine::TerminationReason::ZeroVelocity;
+                lane.running = false;
+                continue;
+            }
+            // A rejected step is retried from the same position with a smaller step size
+            if (!stages.accepted[j]) continue;
+            lane.pos = stages.next[j];
+            lane.positions.push_back(stages.next[j]);
+            lane.velocities.push_back(stages.k1[j]);
+            ++lane.taken;
+        }
     }
-    return true;
 }
 
 template <typename SpatialSampler, bool TimeDependent>
-IntegralLine::TerminationReason IntegralLineTracer<SpatialSampler, TimeDependent>::integrate(
-    size_t steps, SpatialVector pos, IntegralLine& line, bool fwd) const {
-    if (steps == 0) return IntegralLine::TerminationReason::StartPoint;
-    for (size_t i = 0; i < steps; i++) {
-        if (!sampler_->withinBounds(pos)) {
-            return IntegralLine::TerminationReason::OutOfBounds;
+void IntegralLineTracer<SpatialSampler, TimeDependent>::addLine(
+    Batch& batch, const SpatialVector& seed, const DataVector& seedVelocity, const Lane* bwd,
+    const Lane* fwd, IntegralLine::TerminationReason bwdReason,
+    IntegralLine::TerminationReason fwdReason) const {
+
+    const size_t begin = batch.positions.size();
+    const auto add = [&](const SpatialVector& pos, const DataVector& velocity) {
+        batch.positions.emplace_back(util::glm_convert<dvec3>(pos));
+        batch.velocities.emplace_back(util::glm_convert<dvec3>(velocity));
+        if constexpr (TimeDependent) {
+            batch.timestamps.emplace_back(pos[Sampler::SpatialDimensions - 1]);
         }
-        auto res = step(pos, stepSize_ * (fwd ? 1.0 : -1.0));
-        pos = res.first;
+    };
 
-        if (!addPoint(line, pos, res.second)) {
-            return IntegralLine::TerminationReason::ZeroVelocity;
+    size_t seedIndex = 0;
+    if (bwd && fwd) {
+        for (size_t i = bwd->positions.size(); i-- > 0;) {
+            add(bwd->positions[i], bwd->velocities[i]);
+        }
+        seedIndex = bwd->positions.size();
+        add(seed, seedVelocity);
+        for (size_t i = 0; i < fwd->positions.size(); ++i) {
+            add(fwd->positions[i], fwd->velocities[i]);
+        }
+    }
+    const size_t end = batch.positions.size();
+
+    auto meta = batch.metaData.begin();
+    for (const auto& m : metaSamplers_) {
+        auto& data = (meta++)->second;
+        for (size_t i = begin; i < end; ++i) {
+            if constexpr (TimeDependent) {
+                data.emplace_back(m.second->sample(
+                    SpatialVector(batch.positions[i], batch.timestamps[i])));
+            } else {
+                data.emplace_back(m.second->sample(SpatialVector(batch.positions[i])));
+            }
         }
     }
-    return IntegralLine::TerminationReason::Steps;
+
+    batch.offsets.push_back(end);
+    batch.seedIndices.push_back(seedIndex);
+    batch.backwardTerminationReasons.push_back(bwdReason);
+    batch.forwardTerminationReasons.push_back(fwdReason);
 }
 
 using StreamLine2DTracer = IntegralLineTracer<SpatialSampler<2, 2, double>>;
@@ -39,10 +39,14 @@
 #include <inviwo/core/ports/imageport.h>
 #include <inviwo/core/util/utilities.h>
 #include <inviwo/core/util/foreach.h>
+#include <inviwo/core/util/parallelfor.h>
 #include <modules/vectorfieldvisualization/algorithms/integrallineoperations.h>
 #include <modules/vectorfieldvisualization/integrallinetracer.h>
 #include <modules/vectorfieldvisualization/ports/seedpointsport.h>
 
+#include <iterator>
+#include <vector>
+
 namespace inviwo {
 
 template <typename Tracer>
@@ -113,18 +117,39 @@ void IntegralLineTracerProcessor<Tracer>::process() {
         tracer.addMetaDataSampler(key, meta.second);
     }
 
-    std::mutex mutex;
+    using Seed = typename SeedPointVector<Tracer::Sampler::SpatialDimensions>::value_type;
     size_t startID = 0;
     for (const auto& seeds : seeds_) {
-        util::forEachParallel(*seeds, [&](const auto& p, size_t i) {
-            IntegralLine line = tracer.traceFrom(p);
-            auto size = line.getPositions().size();
-            if (size > 1) {
-                std::lock_guard<std::mutex> lock(mutex);
-                lines->push_back(std::move(line), startID + i);
+        // Each block of seeds is traced into its own batch, and its lines are copied into a
+        // list of IntegralLines per block. The lists are concatenated in seed order afterwards.
+        const size_t count = seeds->size();
+        const size_t blocks = util::parallelBlockCount(count, 4 * Tracer::PacketSize);
+        std::vector<std::vector<IntegralLine>> blockLines(blocks);
+        util::parallelFor(blocks, [&](size_t blockBegin, size_t blockEnd) {
+            typename Tracer::Batch batch;
+            for (size_t block = blockBegin; block < blockEnd; ++block) {
+                const size_t begin = block * count / blocks;
+                const size_t end = (block + 1) * count / blocks;
+                batch.clear();
+                tracer.traceBatch(util::span<const Seed>(seeds->data() + begin, end - begin),
+                                  batch);
+                for (size_t i = 0; i < batch.size(); ++i) {
+                    if (batch.getNumberOfPoints(i) > 1) {
+                        blockLines[block].push_back(batch.createLine(i));
+                        blockLines[block].back().setIndex(startID + begin + i);
+                    }
+                }
             }
         });
-        startID += seeds->size();
+
+        auto& vec = lines->getVector();
+        size_t total = vec.size();
+        for (const auto& block : blockLines) total += block.size();
+        vec.reserve(total);
+        for (auto& block : blockLines) {
+            std::move(block.begin(), block.end(), std::back_inserter(vec));
+        }
+        startID += count;
     }
 
     if (calculateCurvature_) {
@@ -41,7 +41,12 @@ namespace inviwo {
 
 class IVW_MODULE_VECTORFIELDVISUALIZATION_API IntegralLineProperties : public CompositeProperty {
 public:
-    enum class IntegrationScheme { Euler, RK4 };
+    /**
+     * Euler and RK4 use a fixed step size. RK45 is the embedded Runge-Kutta scheme by Dormand
+     * and Prince, which adapts the step size to keep the estimated error of each step below the
+     * tolerance.
+     */
+    enum class IntegrationScheme { Euler, RK4, RK45 };
 
     enum class Direction { FWD = 1, BWD = 2, BOTH = 3 };
 
@@ -55,7 +60,16 @@ public:
         const SpatialCoordinateTransformer<N>& T) const;
 
     int getNumberOfSteps() const;
+    /**
+     * The step size of the fixed step schemes, and the initial step size of RK45
+     */
     float getStepSize() const;
+    /**
+     * The largest estimated position error of a step accepted by RK45
+     */
+    float getTolerance() const;
+    float getMinStepSize() const;
+    float getMaxStepSize() const;
 
     IntegralLineProperties::Direction getStepDirection() const;
     IntegralLineProperties::IntegrationScheme getIntegrationScheme() const;
@@ -68,6 +82,9 @@ private:
 public:
     IntProperty numberOfSteps_;
     FloatProperty stepSize_;
+    FloatProperty tolerance_;
+    FloatProperty minStepSize_;
+    FloatProperty maxStepSize_;
     BoolProperty normalizeSamples_;
 
     TemplateOptionProperty<IntegralLineProperties::Direction> stepDirection_;
@@ -75,12 +75,12 @@ void IntegralLineSet::push_back(IntegralLine&& line, SetIndex updateIndex) {
     if (updateIndex == SetIndex::Yes) {
         line.setIndex(lines_.size());
     }
-    lines_.push_back(line);
+    lines_.push_back(std::move(line));
 }
 
 void IntegralLineSet::push_back(IntegralLine&& line, size_t idx) {
     line.setIndex(idx);
-    lines_.push_back(line);
+    lines_.push_back(std::move(line));
 }
 
 }  // namespace inviwo
@@ -35,6 +35,9 @@ IntegralLineProperties::IntegralLineProperties(std::string identifier, std::stri
     : CompositeProperty(identifier, displayName)
     , numberOfSteps_("steps", "Number of Steps", 100, 1, 1000)
     , stepSize_("stepSize", "Step size", 0.001f, 0.001f, 1.0f, 0.001f)
+    , tolerance_("tolerance", "Error Tolerance", 1e-5f, 1e-9f, 1e-2f, 1e-9f)
+    , minStepSize_("minStepSize", "Min Step Size", 0.0001f, 0.00001f, 1.0f, 0.00001f)
+    , maxStepSize_("maxStepSize", "Max Step Size", 0.1f, 0.00001f, 1.0f, 0.00001f)
     , normalizeSamples_("normalizeSamples", "Normalize Samples", true)
     , stepDirection_("stepDirection", "Step Direction")
     , integrationScheme_("integrationScheme", "Integration Scheme")
@@ -46,6 +49,9 @@ IntegralLineProperties::IntegralLineProperties(const IntegralLineProperties& rhs
     : CompositeProperty(rhs)
     , numberOfSteps_(rhs.numberOfSteps_)
     , stepSize_(rhs.stepSize_)
+    , tolerance_(rhs.tolerance_)
+    , minStepSize_(rhs.minStepSize_)
+    , maxStepSize_(rhs.maxStepSize_)
     , normalizeSamples_(rhs.normalizeSamples_)
     , stepDirection_(rhs.stepDirection_)
     , integrationScheme_(rhs.integrationScheme_)
@@ -63,6 +69,12 @@ int IntegralLineProperties::getNumberOfSteps() const { return numberOfSteps_.get
 
 float IntegralLineProperties::getStepSize() const { return stepSize_.get(); }
 
+float IntegralLineProperties::getTolerance() const { return tolerance_.get(); }
+
+float IntegralLineProperties::getMinStepSize() const { return minStepSize_.get(); }
+
+float IntegralLineProperties::getMaxStepSize() const { return maxStepSize_.get(); }
+
 IntegralLineProperties::Direction IntegralLineProperties::getStepDirection() const {
     return stepDirection_.get();
 }
@@ -86,6 +98,8 @@ void IntegralLineProperties::setUpProperties() {
                                  IntegralLineProperties::IntegrationScheme::Euler);
     integrationScheme_.addOption("rk4", "Runge-Kutta (RK4)",
                                  IntegralLineProperties::IntegrationScheme::RK4);
+    integrationScheme_.addOption("rk45", "Adaptive Runge-Kutta (RK45)",
+                                 IntegralLineProperties::IntegrationScheme::RK45);
     integrationScheme_.setSelectedValue(IntegralLineProperties::IntegrationScheme::RK4);
 
     seedPointsSpace_.addOption("data", "Data", CoordinateSpace::Data);
@@ -96,9 +110,27 @@ void IntegralLineProperties::setUpProperties() {
     addProperty(stepSize_);
     addProperty(stepDirection_);
     addProperty(integrationScheme_);
+    addProperty(tolerance_);
+    addProperty(minStepSize_);
+    addProperty(maxStepSize_);
     addProperty(seedPointsSpace_);
     addProperty(normalizeSamples_);
 
+    const auto isAdaptive = [](const auto& p) {
+        return p.get() == IntegralLineProperties::IntegrationScheme::RK45;
+    };
+    tolerance_.visibilityDependsOn(integrationScheme_, isAdaptive);
+    minStepSize_.visibilityDependsOn(integrationScheme_, isAdaptive);
+    maxStepSize_.visibilityDependsOn(integrationScheme_, isAdaptive);
+
+    // Keep minStepSize <= maxStepSize, moving the other limit along
+    minStepSize_.onChange([this]() {
+        if (maxStepSize_.get() < minStepSize_.get()) maxStepSize_.set(minStepSize_.get());
+    });
+    maxStepSize_.onChange([this]() {
+        if (minStepSize_.get() > maxStepSize_.get()) minStepSize_.set(maxStepSize_.get());
+    });
+
     setAllPropertiesCurrentStateAsDefault();
 }
 
@@ -0,0 +1,358 @@
+/*********************************************************************************
+ *
+ * Inviwo - Interactive Visualization Workshop
+ *
+ * Copyright (c) 2021 Inviwo Foundation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************************/
+
+#include <warn/push>
+#include <warn/ignore/all>
+#include <gtest/gtest.h>
+#include <warn/pop>
+
+#include <modules/vectorfieldvisualization/integrallinetracer.h>
+#include <modules/vectorfieldvisualization/properties/integrallineproperties.h>
+#include <inviwo/core/datastructures/volume/volume.h>
+
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace inviwo {
+
+namespace {
+
+/*
+ * Rotation around the z axis through the center of the unit cube, with a drift away from its
+ * middle plane in z. With drift, lines leave the volume after a varying number of steps. Lines
+ * that reach x > 0.85 stop at zero velocity.
+ */
+class RotationSampler : public SpatialSampler<3, 3, double> {
+public:
+    RotationSampler(std::shared_ptr<const Volume> volume, double drift)
+        : SpatialSampler<3, 3, double>(*volume), volume_{std::move(volume)}, drift_{drift} {}
+
+protected:
+    virtual dvec3 sampleDataSpace(const dvec3& pos) const override {
+        if (pos.x > 0.85) return dvec3(0.0);
+        const auto c = pos - dvec3(0.5);
+        return dvec3(-c.y, c.x, drift_ * c.z);
+    }
+    virtual bool withinBoundsDataSpace(const dvec3& pos) const override {
+        return glm::all(glm::greaterThanEqual(pos, dvec3(0.0))) &&
+               glm::all(glm::lessThanEqual(pos, dvec3(1.0)));
+    }
+
+private:
+    std::shared_ptr<const Volume> volume_;
+    double drift_;
+};
+
+std::shared_ptr<const SpatialSampler<3, 3, double>> createSampler(double drift = 1.0) {
+    auto volume = std::make_shared<Volume>(size3_t{8}, DataVec3Float64::get());
+    volume->setModelMatrix(mat4(1.0f));
+    volume->setWorldMatrix(mat4(1.0f));
+    return std::make_shared<RotationSampler>(volume, drift);
+}
+
+/*
+ * Traces one line at a time, sampling one position at a time, the way IntegralLineTracer did
+ * before lines were traced in packets. Used as the reference for traceBatch.
+ */
+class ReferenceTracer {
+public:
+    using Sampler = SpatialSampler<3, 3, double>;
+    using Reason = IntegralLine::TerminationReason;
+
+    ReferenceTracer(std::shared_ptr<const Sampler> sampler, const IntegralLineProperties& props)
+        : sampler_{std::move(sampler)}
+        , scheme_{props.getIntegrationScheme()}
+        , steps_{static_cast<size_t>(props.getNumberOfSteps())}
+        , stepSize_{props.getStepSize()}
+        , dir_{props.getStepDirection()}
+        , normalize_{props.getNormalizeSamples()}
+        , invBasis_{glm::inverse(dmat3(sampler_->getModelMatrix()))} {}
+
+    std::pair<IntegralLine, size_t> trace(const dvec3& seed) const {
+        IntegralLine line;
+        size_t seedIndex = 0;
+        size_t stepsBWD = steps_ / 2 + 1;
+        size_t stepsFWD = steps_ - steps_ / 2 + 1;
+        if (dir_ == IntegralLineProperties::Direction::FWD) {
+            line.setBackwardTerminationReason(Reason::StartPoint);
+            stepsBWD = 1;
+            stepsFWD = steps_ + 1;
+        } else if (dir_ == IntegralLineProperties::Direction::BWD) {
+            line.setForwardTerminationReason(Reason::StartPoint);
+            stepsBWD = steps_ + 1;
+            stepsFWD = 1;
+        }
+        line.getMetaData<dvec3>("velocity", true);
+        line.getMetaData<dvec3>("field", true);
+
+        if (!addPoint(line, seed, sampler_->sample(seed))) return {line, seedIndex};
+
+        line.setBackwardTerminationReason(integrate(stepsBWD, seed, line, -stepSize_));
+        if (line.getPositions().size() > 1) {
+            line.reverse();
+            seedIndex = line.getPositions().size() - 1;
+        }
+        line.setForwardTerminationReason(integrate(stepsFWD, seed, line, stepSize_));
+        return {line, seedIndex};
+    }
+
+private:
+    dvec3 direction(const dvec3& v) const {
+        const auto l = glm::length(v);
+        return normalize_ && l != 0.0 ? v / l : v;
+    }
+    dvec3 move(const dvec3& pos, const dvec3& v, double stepSize) const {
+        return pos + invBasis_ * (direction(v) * stepSize);
+    }
+
+    std::pair<dvec3, dvec3> step(const dvec3& pos, double stepSize) const {
+        const auto k1 = sampler_->sample(pos);
+        if (scheme_ == IntegralLineProperties::IntegrationScheme::Euler) {
+            return {move(pos, k1, stepSize), k1};
+        }
+        const auto k2 = sampler_->sample(move(pos, k1, stepSize / 2));
+        const auto k3 = sampler_->sample(move(pos, k2, stepSize / 2));
+        const auto k4 = sampler_->sample(move(pos, k3, stepSize));
+        const auto sum = k1 + k2 + k2 + k3 + k3 + k4;
+        const auto k = normalize_ ? direction(sum) : sum * (1.0 / 6.0);
+        return {move(pos, k, stepSize), k1};
+    }
+
+    bool addPoint(IntegralLine& line, const dvec3& pos, const dvec3& velocity) const {
+        if (glm::length(velocity) < std::numeric_limits<double>::epsilon()) return false;
+        line.getPositions().push_back(pos);
+        line.getMetaData<dvec3>("velocity").push_back(velocity);
+        line.getMetaData<dvec3>("field").push_back(sampler_->sample(pos));
+        return true;
+    }
+
+    Reason integrate(size_t steps, dvec3 pos, IntegralLine& line, double stepSize) const {
+        if (steps == 0) return Reason::StartPoint;
+        for (size_t i = 0; i < steps; ++i) {
+            if (!sampler_->withinBounds(pos)) return Reason::OutOfBounds;
+            const auto [next, velocity] = step(pos, stepSize);
+            pos = next;
+            if (!addPoint(line, pos, velocity)) return Reason::ZeroVelocity;
+        }
+        return Reason::Steps;
+    }
+
+    std::shared_ptr<const Sampler> sampler_;
+    IntegralLineProperties::IntegrationScheme scheme_;
+    size_t steps_;
+    double stepSize_;
+    IntegralLineProperties::Direction dir_;
+    bool normalize_;
+    dmat3 invBasis_;
+};
+
+void expectEqualLines(const IntegralLine& expected, const IntegralLine& line, size_t seed) {
+    EXPECT_EQ(expected.getBackwardTerminationReason(), line.getBackwardTerminationReason())
+        << "seed " << seed;
+    EXPECT_EQ(expected.getForwardTerminationReason(), line.getForwardTerminationReason())
+        << "seed " << seed;
+    ASSERT_EQ(expected.getPositions().size(), line.getPositions().size()) << "seed " << seed;
+    for (const auto& name : {"velocity", "field"}) {
+        ASSERT_EQ(expected.getMetaData<dvec3>(name).size(), line.getMetaData<dvec3>(name).size())
+            << "seed " << seed << " " << name;
+    }
+    for (size_t i = 0; i < expected.getPositions().size(); ++i) {
+        EXPECT_NEAR(0.0, glm::distance(expected.getPositions()[i], line.getPositions()[i]), 1e-12)
+            << "seed " << seed << " point " << i;
+        for (const auto& name : {"velocity", "field"}) {
+            EXPECT_NEAR(0.0,
+                        glm::distance(expected.getMetaData<dvec3>(name)[i],
+                                      line.getMetaData<dvec3>(name)[i]),
+                        1e-12)
+                << "seed " << seed << " point " << i << " " << name;
+        }
+    }
+}
+
+/*
+ * The largest deviation from the radius of the seed, and the total angle around the center of
+ * rotation, of a line traced in the xy plane of RotationSampler
+ */
+std::pair<double, double> circleError(const IntegralLine& line, const dvec3& seed) {
+    const auto radius = glm::length(dvec2(seed) - dvec2(0.5));
+    double error = 0.0;
+    double angle = 0.0;
+    const auto& positions = line.getPositions();
+    for (size_t i = 0; i < positions.size(); ++i) {
+        const auto c = dvec2(positions[i]) - dvec2(0.5);
+        error = std::max(error, std::abs(glm::length(c) - radius));
+        if (i > 0) {
+            const auto p = dvec2(positions[i - 1]) - dvec2(0.5);
+            angle += std::atan2(p.x * c.y - p.y * c.x, glm::dot(p, c));
+        }
+    }
+    return {error, angle};
+}
+
+}  // namespace
+
+TEST(IntegralLineTracer, BatchEqualsPerLine) {
+    const auto sampler = createSampler();
+
+    // More seeds than fit into two packets, and a last packet that is only partially filled.
+    // The center and the region x > 0.85 have zero velocity and give empty lines.
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<double> dist(0.05, 0.95);
+    std::vector<dvec3> seeds;
+    for (size_t i = 0; i < 2 * StreamLine3DTracer::PacketSize + 5; ++i) {
+        seeds.emplace_back(dist(rng), dist(rng), dist(rng));
+    }
+    seeds.emplace_back(0.5, 0.5, 0.5);
+    seeds.emplace_back(0.9, 0.5, 0.5);
+
+    using Scheme = IntegralLineProperties::IntegrationScheme;
+    using Direction = IntegralLineProperties::Direction;
+    using Reason = IntegralLine::TerminationReason;
+    for (auto scheme : {Scheme::Euler, Scheme::RK4}) {
+        for (auto dir : {Direction::FWD, Direction::BWD, Direction::BOTH}) {
+            for (bool normalize : {true, false}) {
+                IntegralLineProperties props("props", "Props");
+                props.integrationScheme_.setSelectedValue(scheme);
+                props.stepDirection_.setSelectedValue(dir);
+                props.normalizeSamples_.set(normalize);
+                props.numberOfSteps_.set(200);
+                props.stepSize_.set(0.01f);
+
+                StreamLine3DTracer tracer(sampler, props);
+                tracer.addMetaDataSampler("field", sampler);
+                const ReferenceTracer reference(sampler, props);
+
+                StreamLine3DTracer::Batch batch;
+                tracer.traceBatch(seeds, batch);
+                ASSERT_EQ(seeds.size(), batch.size());
+
+                size_t early = 0;
+                for (size_t i = 0; i < seeds.size(); ++i) {
+                    const auto [expected, seedIndex] = reference.trace(seeds[i]);
+                    expectEqualLines(expected, batch.createLine(i), i);
+                    EXPECT_EQ(seedIndex, batch.seedIndices[i]) << "seed " << i;
+
+                    const auto single = tracer.traceFrom(seeds[i]);
+                    expectEqualLines(expected, single.line, i);
+                    EXPECT_EQ(seedIndex, single.seedIndex) << "seed " << i;
+
+                    for (auto reason : {batch.backwardTerminationReasons[i],
+                                        batch.forwardTerminationReasons[i]}) {
+                        if (reason == Reason::OutOfBounds || reason == Reason::ZeroVelocity) {
+                            ++early;
+                        }
+                    }
+                }
+                // Some lanes of each packet stop before the others
+                EXPECT_GT(early, 0u);
+            }
+        }
+    }
+}
+
+TEST(IntegralLineTracer, RK45ClosesCircle) {
+    const auto sampler = createSampler(0.0);
+    const dvec3 seed{0.8, 0.5, 0.5};
+    const double tolerance = 1e-6;
+    const int steps = 200;
+
+    IntegralLineProperties props("props", "Props");
+    props.stepDirection_.setSelectedValue(IntegralLineProperties::Direction::FWD);
+    props.normalizeSamples_.set(false);
+    props.numberOfSteps_.set(steps);
+    props.stepSize_.set(0.01f);
+    props.tolerance_.set(static_cast<float>(tolerance));
+    props.minStepSize_.set(0.0001f);
+    props.maxStepSize_.set(1.0f);
+
+    props.integrationScheme_.setSelectedValue(IntegralLineProperties::IntegrationScheme::RK45);
+    const auto rk45 = StreamLine3DTracer(sampler, props).traceFrom(seed).line;
+    props.integrationScheme_.setSelectedValue(IntegralLineProperties::IntegrationScheme::RK4);
+    const auto rk4 = StreamLine3DTracer(sampler, props).traceFrom(seed).line;
+
+    EXPECT_EQ(IntegralLine::TerminationReason::Steps, rk45.getForwardTerminationReason());
+    EXPECT_EQ(IntegralLine::TerminationReason::Steps, rk4.getForwardTerminationReason());
+    ASSERT_EQ(rk4.getPositions().size(), rk45.getPositions().size());
+
+    // The adaptive steps grow beyond the initial step size, with the same number of steps RK45
+    // goes around the circle while RK4 covers a fraction of it.
+    const auto [rk45Error, rk45Angle] = circleError(rk45, seed);
+    const auto [rk4Error, rk4Angle] = circleError(rk4, seed);
+    EXPECT_GT(rk45Angle, glm::two_pi<double>());
+    EXPECT_LT(rk4Angle, glm::two_pi<double>());
+
+    // Every accepted step has an estimated error below the tolerance
+    EXPECT_LT(rk45Error, steps * tolerance);
+    EXPECT_LT(rk4Error, steps * tolerance);
+}
+
+TEST(IntegralLineTracer, RK45StopsAtMinStepSize) {
+    const auto sampler = createSampler(0.0);
+    const dvec3 seed{0.6, 0.5, 0.5};
+    const int steps = 50;
+
+    // The error of a step of the min step size on a circle of radius 0.1 is far above the
+    // tolerance, the steps are accepted at the min step size instead of being retried forever
+    IntegralLineProperties props("props", "Props");
+    props.integrationScheme_.setSelectedValue(IntegralLineProperties::IntegrationScheme::RK45);
+    props.stepDirection_.setSelectedValue(IntegralLineProperties::Direction::FWD);
+    props.normalizeSamples_.set(true);
+    props.numberOfSteps_.set(steps);
+    props.stepSize_.set(0.05f);
+    props.tolerance_.set(1e-9f);
+    props.minStepSize_.set(0.02f);
+    props.maxStepSize_.set(0.1f);
+
+    const auto line = StreamLine3DTracer(sampler, props).traceFrom(seed).line;
+    const auto& positions = line.getPositions();
+    EXPECT_EQ(IntegralLine::TerminationReason::Steps, line.getForwardTerminationReason());
+    ASSERT_GT(positions.size(), static_cast<size_t>(steps));
+    // The combined directions of the stages are slightly shorter than one
+    for (size_t i = 1; i < positions.size(); ++i) {
+        EXPECT_NEAR(0.02, glm::distance(positions[i - 1], positions[i]), 1e-4) << "step " << i;
+    }
+}
+
+TEST(IntegralLineProperties, MinStepSizeBelowMaxStepSize) {
+    IntegralLineProperties props("props", "Props");
+    props.maxStepSize_.set(0.01f);
+    props.minStepSize_.set(0.05f);
+    EXPECT_EQ(0.05f, props.getMinStepSize());
+    EXPECT_EQ(0.05f, props.getMaxStepSize());
+
+    props.maxStepSize_.set(0.02f);
+    EXPECT_EQ(0.02f, props.getMinStepSize());
+    EXPECT_EQ(0.02f, props.getMaxStepSize());
+}
+
+}  // namespace inviwo
@@ -32,10 +32,12 @@
 #include <inviwo/volume/volumemoduledefine.h>
 #include <inviwo/core/processors/poolprocessor.h>
 #include <inviwo/core/properties/boolproperty.h>
+#include <inviwo/core/properties/optionproperty.h>
 #include <inviwo/core/ports/volumeport.h>
 #include <inviwo/core/ports/meshport.h>
 #include <inviwo/dataframe/datastructures/dataframe.h>
 #include <inviwo/dataframe/properties/dataframeproperty.h>
+#include <modules/base/algorithm/volume/volumevoronoi.h>
 #include <optional>
 
 namespace inviwo {
@@ -59,6 +61,8 @@ namespace inviwo {
  *
  * ### Properties
  *   * __Weighted voronoi__ Choose whether the weighted version of voronoi should be used or not.
+ *   * __Method__ Exact finds the closest seed point for each voxel, Jump Flooding is an
+ *                approximation whose cost does not depend on the number of seed points.
  *
  */
 
@@ -77,6 +81,7 @@ private:
     DataFrameInport dataFrame_;
     VolumeOutport outport_;
     BoolProperty weighted_;
+    TemplateOptionProperty<util::VoronoiMethod> method_;
 
     DataFrameColumnProperty iCol_;
     DataFrameColumnProperty xCol_;
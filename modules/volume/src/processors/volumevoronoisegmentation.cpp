@@ -52,6 +52,10 @@ VolumeVoronoiSegmentation::VolumeVoronoiSegmentation()
     , dataFrame_("seedPoints")
     , outport_("outport")
     , weighted_("weighted", "Weighted voronoi", false)
+    , method_("method", "Method",
+              {{"exact", "Exact", util::VoronoiMethod::Exact},
+               {"jumpFlooding", "Jump Flooding", util::VoronoiMethod::JumpFlooding}},
+              0)
     , iCol_{"iCol", "Segment Index Column", dataFrame_, false, 0}
     , xCol_{"xCol", "X Coordinate Column", dataFrame_, false, 1}
     , yCol_{"yCol", "Y Coordinate Column", dataFrame_, false, 2}
@@ -62,7 +66,7 @@ VolumeVoronoiSegmentation::VolumeVoronoiSegmentation()
     addPort(dataFrame_);
     addPort(outport_);
 
-    addProperties(weighted_, iCol_, xCol_, yCol_, zCol_, wCol_);
+    addProperties(weighted_, method_, iCol_, xCol_, yCol_, zCol_, wCol_);
 }
 
 namespace {
@@ -80,7 +84,7 @@ constexpr auto copyColumn = [](const Column& col, auto& dstContainer, auto assig
 void VolumeVoronoiSegmentation::process() {
     auto calc = [dataFrame = dataFrame_.getData(), volume = volume_.getData(), iCol = iCol_.get(),
                  xCol = xCol_.get(), yCol = yCol_.get(), zCol = zCol_.get(), wCol = wCol_.get(),
-                 weighted = weighted_.get()]() {
+                 weighted = weighted_.get(), method = method_.get()]() {
         const auto nrows = dataFrame->getIndexColumn()->getSize();
         std::vector<std::pair<uint32_t, vec3>> seedPointsWithIndices(nrows);
 
@@ -111,7 +115,7 @@ void VolumeVoronoiSegmentation::process() {
 
         const auto voronoiVolume = util::voronoiSegmentation(
             volume->getDimensions(), volume->getCoordinateTransformer().getIndexToModelMatrix(),
-            seedPointsWithIndices, volume->getWrapping(), radii);
+            seedPointsWithIndices, volume->getWrapping(), radii, method);
 
         voronoiVolume->setModelMatrix(volume->getModelMatrix());
         voronoiVolume->setWorldMatrix(volume->getWorldMatrix());
@@ -0,0 +1,290 @@
+/*********************************************************************************
+ *
+ * Inviwo - Interactive Visualization Workshop
+ *
+ * Copyright (c) 2021 Inviwo Foundation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************************/
+
+#include <inviwo/core/datastructures/volume/volumebricked.h>
+
+#include <inviwo/core/datastructures/volume/volume.h>
+#include <inviwo/core/datastructures/volume/volumedisk.h>
+#include <inviwo/core/datastructures/volume/volumeramprecision.h>
+#include <inviwo/core/util/exception.h>
+#include <inviwo/core/util/indexmapper.h>
+#include <inviwo/core/util/parallelfor.h>
+#include <inviwo/core/util/stringconversion.h>
+
+#include <cstring>
+#include <future>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace inviwo {
+
+/**
+ * A least recently used cache of bricks. A brick that is being loaded is inserted as a future
+ * right away, such that concurrent requests for it wait for the first load instead of reading
+ * the brick again. The loading itself happens outside of the lock.
+ */
+class VolumeBricked::Cache {
+public:
+    using BrickFuture = std::shared_future<std::shared_ptr<const VolumeRAM>>;
+
+    explicit Cache(size_t capacity) : capacity_{capacity} {}
+
+    template <typename Load>
+    std::shared_ptr<const VolumeRAM> get(size_t key, size_t bytes, Load&& load) {
+        std::unique_lock<std::mutex> lock{mutex_};
+        if (auto it = map_.find(key); it != map_.end()) {
+            lru_.splice(lru_.begin(), lru_, it->second);
+            auto brick = it->second->brick;
+            lock.unlock();
+            return brick.get();
+        }
+
+        std::promise<std::shared_ptr<const VolumeRAM>> promise;
+        const auto id = ++loads_;
+        lru_.push_front(Entry{key, id, bytes, promise.get_future().share()});
+        map_[key] = lru_.begin();
+        size_ += bytes;
+        evict();
+        lock.unlock();
+
+        try {
+            std::shared_ptr<const VolumeRAM> brick = load();
+            promise.set_value(brick);
+            return brick;
+        } catch (...) {
+            promise.set_exception(std::current_exception());
+            lock.lock();
+            if (auto it = map_.find(key); it != map_.end() && it->second->id == id) {
+                erase(it);
+            }
+            throw;
+        }
+    }
+
+    void setCapacity(size_t capacity) {
+        std::scoped_lock lock{mutex_};
+        capacity_ = capacity;
+        evict();
+    }
+    size_t getCapacity() const {
+        std::scoped_lock lock{mutex_};
+        return capacity_;
+    }
+    size_t getSize() const {
+        std::scoped_lock lock{mutex_};
+        return size_;
+    }
+
+private:
+    struct Entry {
+        size_t key;
+        size_t id;
+        size_t bytes;
+        BrickFuture brick;
+    };
+    using Map = std::unordered_map<size_t, std::list<Entry>::iterator>;
+
+    // The most recently used brick is always kept, even if it is larger than the capacity
+    void evict() {
+        while (size_ > capacity_ && lru_.size() > 1) {
+            erase(map_.find(lru_.back().key));
+        }
+    }
+    void erase(Map::iterator it) {
+        size_ -= it->second->bytes;
+        lru_.erase(it->second);
+        map_.erase(it);
+    }
+
+    mutable std::mutex mutex_;
+    size_t capacity_;
+    size_t size_ = 0;
+    size_t loads_ = 0;
+    std::list<Entry> lru_;
+    Map map_;
+};
+
+namespace {
+
+// Copy the rows of a region of extent voxels from src at srcOffset into dst at dstOffset
+void copyRegion(const void* src, const size3_t& srcDims, const size3_t& srcOffset, void* dst,
+                const size3_t& dstDims, const size3_t& dstOffset, const size3_t& extent,
+                size_t voxelSize) {
+    const util::IndexMapper3D srcIm(srcDims);
+    const util::IndexMapper3D dstIm(dstDims);
+    const auto rowBytes = extent.x * voxelSize;
+    for (size_t z = 0; z < extent.z; ++z) {
+        for (size_t y = 0; y < extent.y; ++y) {
+            std::memcpy(static_cast<char*>(dst) + dstIm(dstOffset + size3_t{0, y, z}) * voxelSize,
+                        static_cast<const char*>(src) +
+                            srcIm(srcOffset + size3_t{0, y, z}) * voxelSize,
+                        rowBytes);
+        }
+    }
+}
+
+}  // namespace
+
+VolumeBricked::VolumeBricked(std::unique_ptr<VolumeBrickLoader> loader, size3_t dimensions,
+                             const DataFormatBase* format, size3_t brickSize,
+                             const SwizzleMask& swizzleMask, InterpolationType interpolation,
+                             const Wrapping3D& wrapping)
+    : VolumeRepresentation(format)
+    , dimensions_{dimensions}
+    , brickSize_{glm::max(brickSize, size3_t{1})}
+    , swizzleMask_{swizzleMask}
+    , interpolation_{interpolation}
+    , wrapping_{wrapping}
+    , loader_{std::move(loader)}
+    , cache_{std::make_shared<Cache>(defaultCacheCapacity)} {}
+
+VolumeBricked* VolumeBricked::clone() const { return new VolumeBricked(*this); }
+
+std::type_index VolumeBricked::getTypeIndex() const {
+    return std::type_index(typeid(VolumeBricked));
+}
+
+void VolumeBricked::setDimensions(size3_t) {
+    throw Exception("Can not set dimension of a Volume Bricked", IVW_CONTEXT);
+}
+
+const size3_t& VolumeBricked::getDimensions() const { return dimensions_; }
+
+void VolumeBricked::setSwizzleMask(const SwizzleMask& mask) { swizzleMask_ = mask; }
+
+SwizzleMask VolumeBricked::getSwizzleMask() const { return swizzleMask_; }
+
+void VolumeBricked::setInterpolation(InterpolationType interpolation) {
+    interpolation_ = interpolation;
+}
+
+InterpolationType VolumeBricked::getInterpolation() const { return interpolation_; }
+
+void VolumeBricked::setWrapping(const Wrapping3D& wrapping) { wrapping_ = wrapping; }
+
+Wrapping3D VolumeBricked::getWrapping() const { return wrapping_; }
+
+void VolumeBricked::setLoader(std::unique_ptr<VolumeBrickLoader> loader) {
+    loader_ = std::move(loader);
+    // Clones might still use the old cache together with their own copy of the old loader
+    cache_ = std::make_shared<Cache>(cache_->getCapacity());
+}
+
+const size3_t& VolumeBricked::getBrickSize() const { return brickSize_; }
+
+size3_t VolumeBricked::getBrickCount() const {
+    return (dimensions_ + brickSize_ - size3_t{1}) / brickSize_;
+}
+
+auto VolumeBricked::getBrick(const size3_t& brick) const -> Brick {
+    const auto count = getBrickCount();
+    if (glm::any(glm::greaterThanEqual(brick, count))) {
+        throw RangeException("Brick index " + toString(brick) + " is outside of the " +
+                                 toString(count) + " bricks of the volume",
+                             IVW_CONTEXT);
+    }
+    if (!loader_) throw Exception("No loader available to load bricks", IVW_CONTEXT);
+
+    const auto offset = brick * brickSize_;
+    const auto extent = glm::min(brickSize_, dimensions_ - offset);
+    const auto bytes = glm::compMul(extent) * getDataFormat()->getSize();
+
+    auto data = cache_->get(util::IndexMapper3D(count)(brick), bytes, [&]() {
+        auto ram = createVolumeRAM(extent, getDataFormat());
+        loader_->loadBrick(*this, offset, extent, ram->getData());
+        return ram;
+    });
+    return {std::move(data), offset};
+}
+
+auto VolumeBricked::getBrickContaining(const size3_t& pos) const -> Brick {
+    if (glm::any(glm::greaterThanEqual(pos, dimensions_))) {
+        throw RangeException("Position " + toString(pos) + " is outside of the volume " +
+                                 toString(dimensions_),
+                             IVW_CONTEXT);
+    }
+    return getBrick(pos / brickSize_);
+}
+
+void VolumeBricked::readRegion(const size3_t& offset, const size3_t& extent, void* dest) const {
+    if (glm::any(glm::greaterThan(offset + extent, dimensions_))) {
+        throw RangeException("Region " + toString(offset) + " + " + toString(extent) +
+                                 " is outside of the volume " + toString(dimensions_),
+                             IVW_CONTEXT);
+    }
+    if (glm::compMul(extent) == 0) return;
+
+    const auto first = offset / brickSize_;
+    const auto count = (offset + extent - size3_t{1}) / brickSize_ - first + size3_t{1};
+    const util::IndexMapper3D im(count);
+    const auto voxelSize = getDataFormat()->getSize();
+
+    // Every brick fills a disjoint part of dest, so the bricks can be loaded concurrently
+    util::parallelFor(glm::compMul(count), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const auto brick = getBrick(first + im(i));
+            const auto brickDims = brick.data->getDimensions();
+            const auto lo = glm::max(offset, brick.offset);
+            const auto hi = glm::min(offset + extent, brick.offset + brickDims);
+            copyRegion(brick.data->getData(), brickDims, lo - brick.offset, dest, extent,
+                       lo - offset, hi - lo, voxelSize);
+        }
+    });
+}
+
+std::shared_ptr<VolumeRAM> VolumeBricked::getSubVolume(const size3_t& offset,
+                                                       const size3_t& extent) const {
+    auto ram = createVolumeRAM(extent, getDataFormat(), nullptr, swizzleMask_, interpolation_,
+                               wrapping_);
+    readRegion(offset, extent, ram->getData());
+    return ram;
+}
+
+void VolumeBricked::setCacheCapacity(size_t bytes) { cache_->setCapacity(bytes); }
+
+size_t VolumeBricked::getCacheCapacity() const { return cache_->getCapacity(); }
+
+size_t VolumeBricked::getCacheSize() const { return cache_->getSize(); }
+
+const VolumeBricked* util::getBrickedRepresentation(const Volume& volume) {
+    if (volume.hasRepresentation<VolumeRAM>()) return nullptr;
+    if (volume.hasRepresentation<VolumeBricked>()) {
+        return volume.getRepresentation<VolumeBricked>();
+    }
+    if (volume.hasRepresentation<VolumeDisk>()) {
+        const auto disk = volume.getRepresentation<VolumeDisk>();
+        if (dynamic_cast<const VolumeBrickLoader*>(disk->getLoader())) {
+            return volume.getRepresentation<VolumeBricked>();
+        }
+    }
+    return nullptr;
+}
+
+}  // namespace inviwo
@@ -0,0 +1,161 @@
+/*********************************************************************************
+ *
+ * Inviwo - Interactive Visualization Workshop
+ *
+ * Copyright (c) 2021 Inviwo Foundation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************************/
+
+#include <inviwo/core/datastructures/volume/volumebrickedconverter.h>
+#include <inviwo/core/datastructures/volume/volumeramprecision.h>
+#include <inviwo/core/util/brickiterator.h>
+
+#include <algorithm>
+#include <mutex>
+
+namespace inviwo {
+
+namespace {
+
+void copyBrick(const VolumeRAM& ram, const size3_t& offset, const size3_t& extent, void* dest) {
+    ram.dispatch<void>([&](auto vrprecision) {
+        using ValueType = util::PrecisionValueType<decltype(vrprecision)>;
+        const auto it = util::BrickIterator{vrprecision->getDataTyped(),
+                                            vrprecision->getDimensions(), offset, extent};
+        std::copy(it, it.end(), static_cast<ValueType*>(dest));
+    });
+}
+
+// Serves bricks out of a VolumeRAM
+class RAMBrickLoader : public VolumeBrickLoader {
+public:
+    explicit RAMBrickLoader(std::shared_ptr<const VolumeRAM> ram) : ram_{std::move(ram)} {}
+    virtual RAMBrickLoader* clone() const override { return new RAMBrickLoader(*this); }
+    virtual void loadBrick(const VolumeRepresentation&, const size3_t& offset,
+                           const size3_t& extent, void* dest) const override {
+        copyBrick(*ram_, offset, extent, dest);
+    }
+
+private:
+    std::shared_ptr<const VolumeRAM> ram_;
+};
+
+// Fallback for loaders that can not read parts of a file, the whole volume is loaded once and
+// shared by all clones
+class DiskBrickLoader : public VolumeBrickLoader {
+public:
+    explicit DiskBrickLoader(std::shared_ptr<const VolumeDisk> disk)
+        : disk_{std::move(disk)}, state_{std::make_shared<State>()} {}
+    virtual DiskBrickLoader* clone() const override { return new DiskBrickLoader(*this); }
+    virtual void loadBrick(const VolumeRepresentation&, const size3_t& offset,
+                           const size3_t& extent, void* dest) const override {
+        std::shared_ptr<const VolumeRAM> ram;
+        {
+            std::scoped_lock lock{state_->mutex};
+            if (!state_->ram) {
+                state_->ram = std::static_pointer_cast<VolumeRAM>(disk_->createRepresentation());
+            }
+            ram = state_->ram;
+        }
+        copyBrick(*ram, offset, extent, dest);
+    }
+
+private:
+    struct State {
+        std::mutex mutex;
+        std::shared_ptr<const VolumeRAM> ram;
+    };
+    std::shared_ptr<const VolumeDisk> disk_;
+    std::shared_ptr<State> state_;
+};
+
+std::unique_ptr<VolumeBrickLoader> createBrickLoader(std::shared_ptr<const VolumeDisk> disk) {
+    if (auto loader = dynamic_cast<const VolumeBrickLoader*>(disk->getLoader())) {
+        return std::unique_ptr<VolumeBrickLoader>(loader->clone());
+    } else {
+        return std::make_unique<DiskBrickLoader>(std::move(disk));
+    }
+}
+
+void copyMetaData(const VolumeRepresentation& source, VolumeRepresentation& destination) {
+    destination.setSwizzleMask(source.getSwizzleMask());
+    destination.setInterpolation(source.getInterpolation());
+    destination.setWrapping(source.getWrapping());
+}
+
+}  // namespace
+
+std::shared_ptr<VolumeBricked> VolumeDisk2BrickedConverter::createFrom(
+    std::shared_ptr<const VolumeDisk> source) const {
+    return std::make_shared<VolumeBricked>(
+        createBrickLoader(source), source->getDimensions(), source->getDataFormat(),
+        size3_t(VolumeBricked::defaultBrickSize), source->getSwizzleMask(),
+        source->getInterpolation(), source->getWrapping());
+}
+
+void VolumeDisk2BrickedConverter::update(std::shared_ptr<const VolumeDisk> source,
+                                         std::shared_ptr<VolumeBricked> destination) const {
+    if (source->getDimensions() != destination->getDimensions() ||
+        source->getDataFormat() != destination->getDataFormat()) {
+        throw ConverterException("Can not update a VolumeBricked to new dimensions or format",
+                                 IVW_CONTEXT);
+    }
+    destination->setLoader(createBrickLoader(source));
+    copyMetaData(*source, *destination);
+}
+
+std::shared_ptr<VolumeBricked> VolumeRAM2BrickedConverter::createFrom(
+    std::shared_ptr<const VolumeRAM> source) const {
+    return std::make_shared<VolumeBricked>(
+        std::make_unique<RAMBrickLoader>(source), source->getDimensions(),
+        source->getDataFormat(), size3_t(VolumeBricked::defaultBrickSize),
+        source->getSwizzleMask(), source->getInterpolation(), source->getWrapping());
+}
+
+void VolumeRAM2BrickedConverter::update(std::shared_ptr<const VolumeRAM> source,
+                                        std::shared_ptr<VolumeBricked> destination) const {
+    if (source->getDimensions() != destination->getDimensions() ||
+        source->getDataFormat() != destination->getDataFormat()) {
+        throw ConverterException("Can not update a VolumeBricked to new dimensions or format",
+                                 IVW_CONTEXT);
+    }
+    destination->setLoader(std::make_unique<RAMBrickLoader>(source));
+    copyMetaData(*source, *destination);
+}
+
+std::shared_ptr<VolumeRAM> VolumeBricked2RAMConverter::createFrom(
+    std::shared_ptr<const VolumeBricked> source) const {
+    return source->getSubVolume(size3_t{0}, source->getDimensions());
+}
+
+void VolumeBricked2RAMConverter::update(std::shared_ptr<const VolumeBricked> source,
+                                        std::shared_ptr<VolumeRAM> destination) const {
+    if (source->getDimensions() != destination->getDimensions()) {
+        destination->setDimensions(source->getDimensions());
+    }
+    source->readRegion(size3_t{0}, source->getDimensions(), destination->getData());
+    copyMetaData(*source, *destination);
+}
+
+}  // namespace inviwo
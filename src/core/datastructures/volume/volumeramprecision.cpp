@@ -44,6 +44,21 @@ struct VolumeRamCreationDispatcher {
     }
 };
 
+struct SharedVolumeRamCreationDispatcher {
+    using type = std::shared_ptr<VolumeRAM>;
+    template <typename Result, typename T>
+    std::shared_ptr<VolumeRAM> operator()(std::shared_ptr<const void> owner, const void* data,
+                                          const size3_t& dimensions,
+                                          const SwizzleMask& swizzleMask,
+                                          InterpolationType interpolation,
+                                          const Wrapping3D& wrapping) {
+        using F = typename T::type;
+        return std::make_shared<VolumeRAMPrecision<F>>(std::move(owner),
+                                                       static_cast<const F*>(data), dimensions,
+                                                       swizzleMask, interpolation, wrapping);
+    }
+};
+
 std::shared_ptr<VolumeRAM> createVolumeRAM(const size3_t& dimensions, const DataFormatBase* format,
                                            void* dataPtr, const SwizzleMask& swizzleMask,
                                            InterpolationType interpolation,
@@ -53,4 +68,15 @@ std::shared_ptr<VolumeRAM> createVolumeRAM(const size3_t& dimensions, const Data
         format->getId(), disp, dataPtr, dimensions, swizzleMask, interpolation, wrapping);
 }
 
+std::shared_ptr<VolumeRAM> createVolumeRAM(const size3_t& dimensions, const DataFormatBase* format,
+                                           std::shared_ptr<const void> owner, const void* data,
+                                           const SwizzleMask& swizzleMask,
+                                           InterpolationType interpolation,
+                                           const Wrapping3D& wrapping) {
+    SharedVolumeRamCreationDispatcher disp;
+    return dispatching::dispatch<std::shared_ptr<VolumeRAM>, dispatching::filter::All>(
+        format->getId(), disp, std::move(owner), data, dimensions, swizzleMask, interpolation,
+        wrapping);
+}
+
 }  // namespace inviwo
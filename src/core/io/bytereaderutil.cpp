@@ -31,6 +31,9 @@
 #include <inviwo/core/io/datareaderexception.h>
 #include <inviwo/core/util/raiiutils.h>
 #include <inviwo/core/util/filesystem.h>
+#include <inviwo/core/util/parallelfor.h>
+
+#include <algorithm>
 
 namespace inviwo {
 
@@ -44,17 +47,15 @@ void util::readBytesIntoBuffer(const std::string& file, size_t offset, size_t by
         fin.read(static_cast<char*>(dest), bytes);
 
         if (!littleEndian && elementSize > 1) {
-            char* temp = new char[elementSize];
-
-            for (std::size_t i = 0; i < bytes; i += elementSize) {
-                for (std::size_t j = 0; j < elementSize; j++)
-                    temp[j] = static_cast<char*>(dest)[i + j];
-
-                for (std::size_t j = 0; j < elementSize; j++)
-                    static_cast<char*>(dest)[i + j] = temp[elementSize - j - 1];
-            }
-
-            delete[] temp;
+            auto data = static_cast<char*>(dest);
+            util::parallelFor(
+                bytes / elementSize,
+                [&](size_t begin, size_t end) {
+                    for (size_t i = begin; i < end; ++i) {
+                        std::reverse(data + i * elementSize, data + (i + 1) * elementSize);
+                    }
+                },
+                64 * 1024);
         }
     } else {
         throw DataReaderException("Error: Could not read from file: " + file,
@@ -0,0 +1,155 @@
+/*********************************************************************************
+ *
+ * Inviwo - Interactive Visualization Workshop
+ *
+ * Copyright (c) 2021 Inviwo Foundation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************************/
+
+#include <inviwo/core/io/memorymappedfile.h>
+#include <inviwo/core/util/exception.h>
+#include <inviwo/core/util/stringconversion.h>
+
+#include <fmt/format.h>
+
+#ifdef WIN32
+struct IUnknown;  // Workaround for "combaseapi.h(229): error C2187: syntax error: 'identifier' was
+                  // unexpected here" when using /permissive-
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace inviwo {
+
+#ifdef WIN32
+
+MemoryMappedFile::MemoryMappedFile(const std::string& file, size_t offset, size_t size)
+    : file_{file}
+    , size_{size}
+    , view_{nullptr}
+    , viewSize_{0}
+    , data_{nullptr}
+    , fileHandle_{INVALID_HANDLE_VALUE}
+    , mappingHandle_{nullptr} {
+
+    const auto cleanup = [&]() {
+        if (mappingHandle_) CloseHandle(mappingHandle_);
+        if (fileHandle_ != INVALID_HANDLE_VALUE) CloseHandle(fileHandle_);
+    };
+
+    fileHandle_ =
+        CreateFileW(util::toWstring(file).c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                    nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fileHandle_ == INVALID_HANDLE_VALUE) {
+        throw FileException(fmt::format("Could not open file: {}", file), IVW_CONTEXT);
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle_, &fileSize) ||
+        static_cast<size_t>(fileSize.QuadPart) < offset + size) {
+        cleanup();
+        throw FileException(
+            fmt::format("File is smaller than the expected {} bytes: {}", offset + size, file),
+            IVW_CONTEXT);
+    }
+    if (size == 0) return;
+
+    mappingHandle_ = CreateFileMappingW(fileHandle_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mappingHandle_) {
+        cleanup();
+        throw FileException(fmt::format("Could not map file: {}", file), IVW_CONTEXT);
+    }
+
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    const size_t alignedOffset = offset - offset % info.dwAllocationGranularity;
+    viewSize_ = size + (offset - alignedOffset);
+    view_ = MapViewOfFile(mappingHandle_, FILE_MAP_READ, static_cast<DWORD>(alignedOffset >> 32),
+                          static_cast<DWORD>(alignedOffset & 0xffffffff), viewSize_);
+    if (!view_) {
+        cleanup();
+        throw FileException(fmt::format("Could not map file: {}", file), IVW_CONTEXT);
+    }
+    data_ = static_cast<const char*>(view_) + (offset - alignedOffset);
+}
+
+MemoryMappedFile::~MemoryMappedFile() {
+    if (view_) UnmapViewOfFile(view_);
+    if (mappingHandle_) CloseHandle(mappingHandle_);
+    if (fileHandle_ != INVALID_HANDLE_VALUE) CloseHandle(fileHandle_);
+}
+
+#else
+
+MemoryMappedFile::MemoryMappedFile(const std::string& file, size_t offset, size_t size)
+    : file_{file}, size_{size}, view_{nullptr}, viewSize_{0}, data_{nullptr} {
+
+    const int fd = ::open(file.c_str(), O_RDONLY);
+    if (fd == -1) {
+        throw FileException(fmt::format("Could not open file: {}", file), IVW_CONTEXT);
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < offset + size) {
+        ::close(fd);
+        throw FileException(
+            fmt::format("File is smaller than the expected {} bytes: {}", offset + size, file),
+            IVW_CONTEXT);
+    }
+    if (size == 0) {
+        ::close(fd);
+        return;
+    }
+
+    const auto pageSize = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    const size_t alignedOffset = offset - offset % pageSize;
+    viewSize_ = size + (offset - alignedOffset);
+    void* view = ::mmap(nullptr, viewSize_, PROT_READ, MAP_PRIVATE, fd,
+                        static_cast<off_t>(alignedOffset));
+    // the mapping keeps its own reference to the file
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        throw FileException(fmt::format("Could not map file: {}", file), IVW_CONTEXT);
+    }
+    view_ = view;
+    data_ = static_cast<const char*>(view_) + (offset - alignedOffset);
+}
+
+MemoryMappedFile::~MemoryMappedFile() {
+    if (view_) ::munmap(view_, viewSize_);
+}
+
+#endif
+
+const void* MemoryMappedFile::data() const { return data_; }
+
+size_t MemoryMappedFile::size() const { return size_; }
+
+const std::string& MemoryMappedFile::getFile() const { return file_; }
+
+}  // namespace inviwo
@@ -29,7 +29,14 @@
 
 #include <inviwo/core/io/rawvolumeramloader.h>
 
+#include <inviwo/core/io/memorymappedfile.h>
 #include <inviwo/core/datastructures/volume/volumeramprecision.h>
+#include <inviwo/core/util/exception.h>
+#include <inviwo/core/util/filesystem.h>
+#include <inviwo/core/util/indexmapper.h>
+
+#include <algorithm>
+#include <cstring>
 
 namespace inviwo {
 
@@ -41,14 +48,29 @@ RawVolumeRAMLoader* RawVolumeRAMLoader::clone() const { return new RawVolumeRAML
 std::shared_ptr<VolumeRepresentation> RawVolumeRAMLoader::createRepresentation(
     const VolumeRepresentation& src) const {
 
-    const auto size = glm::compMul(src.getDimensions()) * src.getDataFormat()->getSize();
+    const auto format = src.getDataFormat();
+    const auto size = glm::compMul(src.getDimensions()) * format->getSize();
+
+    // Map the file directly when the values can be used as they are, i.e. they are stored little
+    // endian like the host, and are aligned in the file. Pages are then only read when accessed.
+    const auto componentSize = format->getSize() / format->getComponents();
+    if ((littleEndian_ || componentSize == 1) && offset_ % componentSize == 0) {
+        try {
+            auto file = std::make_shared<MemoryMappedFile>(rawFile_, offset_, size);
+            const auto data = file->data();
+            return createVolumeRAM(src.getDimensions(), format, std::move(file), data,
+                                   src.getSwizzleMask(), src.getInterpolation(),
+                                   src.getWrapping());
+        } catch (const FileException&) {
+            // Fall back to reading the file, which also handles files that are too short
+        }
+    }
+
     auto data = std::make_unique<char[]>(size);
-    util::readBytesIntoBuffer(rawFile_, offset_, size, littleEndian_,
-                              src.getDataFormat()->getSize(), data.get());
+    util::readBytesIntoBuffer(rawFile_, offset_, size, littleEndian_, componentSize, data.get());
 
-    auto volumeRAM =
-        createVolumeRAM(src.getDimensions(), src.getDataFormat(), data.get(), src.getSwizzleMask(),
-                        src.getInterpolation(), src.getWrapping());
+    auto volumeRAM = createVolumeRAM(src.getDimensions(), format, data.get(), src.getSwizzleMask(),
+                                     src.getInterpolation(), src.getWrapping());
     data.release();
 
     return volumeRAM;
@@ -58,16 +80,65 @@ void RawVolumeRAMLoader::updateRepresentation(std::shared_ptr<VolumeRepresentati
                                               const VolumeRepresentation& src) const {
     auto volumeDst = std::static_pointer_cast<VolumeRAM>(dest);
 
-    if (src.getDimensions() != volumeDst->getDimensions()) {
-        volumeDst->setDimensions(src.getDimensions());
-    }
-
-    const auto size = glm::compMul(src.getDimensions());
-    util::readBytesIntoBuffer(rawFile_, offset_, size * src.getDataFormat()->getSize(),
-                              littleEndian_, src.getDataFormat()->getSize(), volumeDst->getData());
+    // Writing into the destination would first copy its current data, which might be the whole
+    // mapped file. Read into a new buffer and hand that over instead.
+    const auto format = src.getDataFormat();
+    const auto size = glm::compMul(src.getDimensions()) * format->getSize();
+    auto data = std::make_unique<char[]>(size);
+    util::readBytesIntoBuffer(rawFile_, offset_, size, littleEndian_,
+                              format->getSize() / format->getComponents(), data.get());
+    volumeDst->setData(data.release(), src.getDimensions());
 
     volumeDst->setSwizzleMask(src.getSwizzleMask());
     volumeDst->setInterpolation(src.getInterpolation());
     volumeDst->setWrapping(src.getWrapping());
 }
+
+void RawVolumeRAMLoader::loadBrick(const VolumeRepresentation& src, const size3_t& offset,
+                                   const size3_t& extent, void* dest) const {
+    const auto format = src.getDataFormat();
+    const auto voxelSize = format->getSize();
+    const util::IndexMapper3D im(src.getDimensions());
+
+    // The rows of the brick are spread out over the bytes between its first and last voxel
+    const auto first = im(offset);
+    const auto last = im(offset + extent - size3_t{1}) + 1;
+    const auto rowBytes = extent.x * voxelSize;
+    const auto copyRows = [&](auto&& readRow) {
+        auto row = static_cast<char*>(dest);
+        for (size_t z = 0; z < extent.z; ++z) {
+            for (size_t y = 0; y < extent.y; ++y, row += rowBytes) {
+                readRow(im(offset + size3_t{0, y, z}) - first, row);
+            }
+        }
+    };
+
+    try {
+        const MemoryMappedFile file(rawFile_, offset_ + first * voxelSize,
+                                    (last - first) * voxelSize);
+        const auto data = static_cast<const char*>(file.data());
+        copyRows([&](size_t index, char* row) {
+            std::memcpy(row, data + index * voxelSize, rowBytes);
+        });
+    } catch (const FileException&) {
+        auto fin = filesystem::ifstream(rawFile_, std::ios::in | std::ios::binary);
+        copyRows([&](size_t index, char* row) {
+            fin.seekg(offset_ + (first + index) * voxelSize);
+            fin.read(row, rowBytes);
+        });
+        if (!fin.good()) {
+            throw DataReaderException("Error: Could not read from file: " + rawFile_, IVW_CONTEXT);
+        }
+    }
+
+    const auto componentSize = voxelSize / format->getComponents();
+    if (!littleEndian_ && componentSize > 1) {
+        auto data = static_cast<char*>(dest);
+        const auto components = glm::compMul(extent) * format->getComponents();
+        for (size_t i = 0; i < components; ++i) {
+            std::reverse(data + i * componentSize, data + (i + 1) * componentSize);
+        }
+    }
+}
+
 }  // namespace inviwo
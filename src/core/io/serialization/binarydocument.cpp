@@ -0,0 +1,314 @@
+/*********************************************************************************
+ *
+ * Inviwo - Interactive Visualization Workshop
+ *
+ * Copyright (c) 2021 Inviwo Foundation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************************/
+
+#include <inviwo/core/io/serialization/binarydocument.h>
+#include <inviwo/core/io/serialization/serializationexception.h>
+#include <inviwo/core/io/serialization/ticpp.h>
+#include <inviwo/core/util/filesystem.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace inviwo {
+
+namespace {
+
+/*
+ * Layout of a binary document:
+ *   magic "IVWB", one byte format version
+ *   string table: count, then length and bytes of each string
+ *   node tree: a sequence of nodes terminated by NodeKind::End. An element stores its name,
+ *   the number of attributes, key/value pairs and then its children, again terminated by End.
+ * All counts, lengths and string references are stored as unsigned LEB128 varints.
+ */
+constexpr std::array<char, 4> magic{'I', 'V', 'W', 'B'};
+constexpr char formatVersion = 1;
+
+enum class NodeKind : char { End, Element, Text, CData, Comment, Declaration };
+
+class BinaryWriter : public TiXmlVisitor {
+public:
+    virtual bool VisitExit(const TiXmlDocument&) override {
+        putKind(NodeKind::End);
+        return true;
+    }
+
+    virtual bool VisitEnter(const TiXmlElement& element,
+                            const TiXmlAttribute* firstAttribute) override {
+        putKind(NodeKind::Element);
+        putString(element.ValueStr());
+        size_t count = 0;
+        for (auto attr = firstAttribute; attr; attr = attr->Next()) ++count;
+        putSize(tree_, count);
+        for (auto attr = firstAttribute; attr; attr = attr->Next()) {
+            putString(attr->Name());
+            putString(attr->ValueStr());
+        }
+        return true;
+    }
+    virtual bool VisitExit(const TiXmlElement&) override {
+        putKind(NodeKind::End);
+        return true;
+    }
+
+    virtual bool Visit(const TiXmlDeclaration& declaration) override {
+        putKind(NodeKind::Declaration);
+        putString(declaration.Version());
+        putString(declaration.Encoding());
+        putString(declaration.Standalone());
+        return true;
+    }
+    virtual bool Visit(const TiXmlText& text) override {
+        putKind(text.CDATA() ? NodeKind::CData : NodeKind::Text);
+        putString(text.ValueStr());
+        return true;
+    }
+    virtual bool Visit(const TiXmlComment& comment) override {
+        putKind(NodeKind::Comment);
+        putString(comment.ValueStr());
+        return true;
+    }
+
+    void write(std::ostream& stream) const {
+        std::string table;
+        putSize(table, strings_.size());
+        for (const auto& str : strings_) {
+            putSize(table, str.size());
+            table.append(str);
+        }
+        stream.write(magic.data(), magic.size());
+        stream.put(formatVersion);
+        stream.write(table.data(), table.size());
+        stream.write(tree_.data(), tree_.size());
+    }
+
+private:
+    static void putSize(std::string& dest, size_t value) {
+        while (value >= 0x80) {
+            dest.push_back(static_cast<char>((value & 0x7f) | 0x80));
+            value >>= 7;
+        }
+        dest.push_back(static_cast<char>(value));
+    }
+    void putKind(NodeKind kind) { tree_.push_back(static_cast<char>(kind)); }
+    void putString(std::string_view str) {
+        auto it = index_.find(str);
+        if (it == index_.end()) {
+            strings_.emplace_back(str);
+            it = index_.emplace(strings_.back(), strings_.size() - 1).first;
+        }
+        putSize(tree_, it->second);
+    }
+
+    std::deque<std::string> strings_;  // deque, since index_ refers to the stored strings
+    std::unordered_map<std::string_view, size_t> index_;
+    std::string tree_;
+};
+
+/*
+ * Exposes the TinyXml element of a newly created top level element, to let the reader create
+ * the rest of the tree directly, just like the xml parser does.
+ */
+class RootElement : public TxElement {
+public:
+    using TxElement::TxElement;
+    TiXmlElement* get() const { return static_cast<TiXmlElement*>(GetTiXmlPointer()); }
+};
+
+class BinaryReader {
+public:
+    explicit BinaryReader(std::string data) : data_{std::move(data)}, pos_{0} {
+        if (data_.size() < magic.size() + 1 ||
+            !std::equal(magic.begin(), magic.end(), data_.begin())) {
+            throw SerializationException("Not a binary document", IVW_CONTEXT);
+        }
+        if (data_[magic.size()] != formatVersion) {
+            throw SerializationException(
+                "Unsupported binary document version: " +
+                    std::to_string(static_cast<int>(data_[magic.size()])),
+                IVW_CONTEXT);
+        }
+        pos_ = magic.size() + 1;
+
+        const auto count = getSize();
+        strings_.reserve(std::min(count, data_.size()));
+        for (size_t i = 0; i < count; ++i) {
+            const auto size = getSize();
+            if (size > data_.size() - pos_) fail();
+            strings_.push_back(std::string_view{data_}.substr(pos_, size));
+            pos_ += size;
+        }
+    }
+
+    void read(TxDocument& doc) {
+        for (auto kind = getKind(); kind != NodeKind::End; kind = getKind()) {
+            switch (kind) {
+                case NodeKind::Element: {
+                    RootElement root{std::string{getString()}};
+                    doc.LinkEndChild(&root);
+                    readElement(*root.get());
+                    break;
+                }
+                case NodeKind::Comment: {
+                    TxComment comment{std::string{getString()}};
+                    doc.LinkEndChild(&comment);
+                    break;
+                }
+                case NodeKind::Declaration: {
+                    const auto version = getString();
+                    const auto encoding = getString();
+                    const auto standalone = getString();
+                    TxDeclaration declaration{std::string{version}, std::string{encoding},
+                                              std::string{standalone}};
+                    doc.LinkEndChild(&declaration);
+                    break;
+                }
+                default:
+                    fail();
+            }
+        }
+    }
+
+private:
+    std::string_view getString() {
+        const auto index = getSize();
+        if (index >= strings_.size()) fail();
+        return strings_[index];
+    }
+    size_t getSize() {
+        size_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (pos_ >= data_.size()) fail();
+            const auto byte = static_cast<std::uint8_t>(data_[pos_++]);
+            value |= static_cast<size_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) return value;
+        }
+        fail();
+    }
+    NodeKind getKind() {
+        if (pos_ >= data_.size()) fail();
+        const auto kind = data_[pos_++];
+        if (kind > static_cast<char>(NodeKind::Declaration) || kind < 0) fail();
+        return static_cast<NodeKind>(kind);
+    }
+
+    // Reads the attributes and children of an element whose name has already been read.
+    void readElement(TiXmlElement& element) {
+        const auto count = getSize();
+        for (size_t i = 0; i < count; ++i) {
+            const auto key = getString();
+            const auto value = getString();
+            element.SetAttribute(std::string{key}, std::string{value});
+        }
+        for (auto kind = getKind(); kind != NodeKind::End; kind = getKind()) {
+            switch (kind) {
+                case NodeKind::Element: {
+                    auto child = new TiXmlElement(std::string{getString()});
+                    element.LinkEndChild(child);
+                    readElement(*child);
+                    break;
+                }
+                case NodeKind::Text:
+                case NodeKind::CData: {
+                    auto text = new TiXmlText(std::string{getString()});
+                    text->SetCDATA(kind == NodeKind::CData);
+                    element.LinkEndChild(text);
+                    break;
+                }
+                case NodeKind::Comment: {
+                    const auto value = getString();
+                    auto comment = new TiXmlComment();
+                    element.LinkEndChild(comment);
+                    comment->SetValue(std::string{value});
+                    break;
+                }
+                default:
+                    fail();
+            }
+        }
+    }
+
+    [[noreturn]] void fail() const {
+        throw SerializationException(
+            "Invalid binary document, unexpected data at byte " + std::to_string(pos_),
+            IVW_CONTEXT);
+    }
+
+    std::string data_;
+    size_t pos_;
+    std::vector<std::string_view> strings_;
+};
+
+}  // namespace
+
+bool util::isBinaryDocument(std::istream& stream) {
+    std::array<char, magic.size()> header{};
+    const auto start = stream.tellg();
+    stream.read(header.data(), header.size());
+    const bool found = stream.gcount() == static_cast<std::streamsize>(header.size()) &&
+                       header == magic;
+    stream.clear();
+    stream.seekg(start);
+    return found;
+}
+
+void util::writeBinaryDocument(const TxDocument& doc, std::ostream& stream) {
+    BinaryWriter writer;
+    doc.Accept(&writer);
+    writer.write(stream);
+    if (!stream) {
+        throw SerializationException("Could not write binary document",
+                                     IVW_CONTEXT_CUSTOM("writeBinaryDocument"));
+    }
+}
+
+void util::readBinaryDocument(std::istream& stream, TxDocument& doc) {
+    std::string data{std::istreambuf_iterator<char>{stream}, std::istreambuf_iterator<char>{}};
+    BinaryReader reader{std::move(data)};
+    reader.read(doc);
+}
+
+std::ifstream util::openDocument(std::string_view path) {
+    auto stream = filesystem::ifstream(std::string{path}, std::ios::in | std::ios::binary);
+    if (stream.is_open() && !isBinaryDocument(stream)) {
+        stream = filesystem::ifstream(std::string{path});
+    }
+    return stream;
+}
+
+}  // namespace inviwo
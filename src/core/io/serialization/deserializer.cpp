@@ -39,6 +39,8 @@
 #include <inviwo/core/util/exception.h>
 #include <inviwo/core/util/stringconversion.h>
 #include <inviwo/core/util/safecstr.h>
+#include <inviwo/core/util/filesystem.h>
+#include <inviwo/core/io/serialization/binarydocument.h>
 
 #include <inviwo/core/io/serialization/ticpp.h>
 
@@ -46,7 +48,12 @@ namespace inviwo {
 
 Deserializer::Deserializer(std::string_view fileName) : SerializeBase(fileName) {
     try {
-        doc_->LoadFile();
+        if (auto in = filesystem::ifstream(fileName_, std::ios::in | std::ios::binary);
+            in && util::isBinaryDocument(in)) {
+            util::readBinaryDocument(in, *doc_);
+        } else {
+            doc_->LoadFile();
+        }
         rootElement_ = doc_->FirstChildElement();
         rootElement_->GetAttribute(std::string{SerializeConstants::VersionAttribute},
                                    &inviwoWorkspaceVersion_, false);
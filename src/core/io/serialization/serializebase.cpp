@@ -29,6 +29,7 @@
 
 #include <inviwo/core/io/serialization/serializebase.h>
 #include <inviwo/core/io/serialization/ticpp.h>
+#include <inviwo/core/io/serialization/binarydocument.h>
 
 namespace inviwo {
 
@@ -46,7 +47,11 @@ SerializeBase::SerializeBase(std::istream& stream, std::string_view path)
     , doc_{std::make_unique<TxDocument>()}
     , rootElement_{nullptr}
     , retrieveChild_{true} {
-    stream >> *doc_;
+    if (util::isBinaryDocument(stream)) {
+        util::readBinaryDocument(stream, *doc_);
+    } else {
+        stream >> *doc_;
+    }
 }
 
 SerializeBase::~SerializeBase() = default;
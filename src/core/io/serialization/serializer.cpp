@@ -113,4 +113,16 @@ void Serializer::writeFile(std::ostream& stream, bool format) {
     }
 }
 
+void Serializer::writeFile(std::ostream& stream, DocumentFormat format) {
+    if (format == DocumentFormat::Binary) {
+        try {
+            util::writeBinaryDocument(*doc_, stream);
+        } catch (TxException& e) {
+            throw SerializationException(e.what(), IVW_CONTEXT);
+        }
+    } else {
+        writeFile(stream, true);
+    }
+}
+
 }  // namespace inviwo
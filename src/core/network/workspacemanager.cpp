@@ -35,6 +35,7 @@
 #include <inviwo/core/util/inviwosetupinfo.h>
 #include <inviwo/core/util/rendercontext.h>
 #include <inviwo/core/util/filesystem.h>
+#include <inviwo/core/util/stringconversion.h>
 #include <inviwo/core/io/serialization/serialization.h>
 
 #include <fmt/format.h>
@@ -143,7 +144,8 @@ void WorkspaceManager::clear() {
 }
 
 void WorkspaceManager::save(std::ostream& stream, std::string_view refPath,
-                            const ExceptionHandler& exceptionHandler, WorkspaceSaveMode mode) {
+                            const ExceptionHandler& exceptionHandler, WorkspaceSaveMode mode,
+                            DocumentFormat format) {
     Serializer serializer(refPath);
 
     if (mode != WorkspaceSaveMode::Undo) {
@@ -152,7 +154,7 @@ void WorkspaceManager::save(std::ostream& stream, std::string_view refPath,
     }
 
     serializers_.invoke(serializer, exceptionHandler, mode);
-    serializer.writeFile(stream, true);
+    serializer.writeFile(stream, format);
 }
 
 void WorkspaceManager::load(std::istream& stream, std::string_view refPath,
@@ -171,16 +173,21 @@ void WorkspaceManager::load(std::istream& stream, std::string_view refPath,
 
 void WorkspaceManager::save(std::string_view path, const ExceptionHandler& exceptionHandler,
                             WorkspaceSaveMode mode) {
-    auto ostream = filesystem::ofstream(std::string(path));
+    const auto format = toLower(filesystem::getFileExtension(path)) == binaryExtension
+                            ? DocumentFormat::Binary
+                            : DocumentFormat::Xml;
+    auto ostream = filesystem::ofstream(
+        std::string(path), format == DocumentFormat::Binary ? std::ios::out | std::ios::binary
+                                                            : std::ios::out);
     if (ostream.is_open()) {
-        save(ostream, path, exceptionHandler, mode);
+        save(ostream, path, exceptionHandler, mode, format);
     } else {
         throw AbortException(fmt::format("Could not open workspace file: {}", path), IVW_CONTEXT);
     }
 }
 
 void WorkspaceManager::load(std::string_view path, const ExceptionHandler& exceptionHandler) {
-    auto istream = filesystem::ifstream(std::string(path));
+    auto istream = util::openDocument(path);
     if (istream.is_open()) {
         load(istream, path, exceptionHandler);
     } else {
@@ -0,0 +1,204 @@
+/*********************************************************************************
+ *
+ * Inviwo - Interactive Visualization Workshop
+ *
+ * Copyright (c) 2021 Inviwo Foundation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************************/
+
+#include <warn/push>
+#include <warn/ignore/all>
+#include <gtest/gtest.h>
+#include <warn/pop>
+
+#include <inviwo/core/datastructures/volume/volume.h>
+#include <inviwo/core/datastructures/volume/volumeramprecision.h>
+#include <inviwo/core/datastructures/image/layer.h>
+#include <inviwo/core/datastructures/image/layerramprecision.h>
+#include <inviwo/core/datastructures/buffer/buffer.h>
+#include <inviwo/core/datastructures/buffer/bufferramprecision.h>
+
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace inviwo {
+
+TEST(CopyOnWrite, VolumeRAMSharesUntilDetached) {
+    VolumeRAMPrecision<float> volume(size3_t{4});
+    for (size_t i = 0; i < 4; ++i) volume.setFromDouble(size3_t{i, i, i}, static_cast<double>(i));
+    EXPECT_FALSE(volume.isShared());
+
+    std::unique_ptr<VolumeRAMPrecision<float>> copy{volume.cloneShared()};
+    EXPECT_TRUE(volume.isShared());
+    EXPECT_TRUE(copy->isShared());
+    const auto& constVolume = volume;
+    EXPECT_EQ(constVolume.getDataTyped(), std::as_const(*copy).getDataTyped());
+
+    copy->detach();
+    EXPECT_FALSE(volume.isShared());
+    EXPECT_FALSE(copy->isShared());
+    copy->setFromDouble(size3_t{0, 0, 0}, 42.0);
+    EXPECT_EQ(42.0, copy->getAsDouble(size3_t{0, 0, 0}));
+    EXPECT_EQ(0.0, volume.getAsDouble(size3_t{0, 0, 0}));
+    EXPECT_EQ(3.0, volume.getAsDouble(size3_t{3, 3, 3}));
+    EXPECT_EQ(3.0, copy->getAsDouble(size3_t{3, 3, 3}));
+
+    std::unique_ptr<VolumeRAMPrecision<float>> clone{volume.clone()};
+    EXPECT_FALSE(clone->isShared());
+    EXPECT_EQ(3.0, clone->getAsDouble(size3_t{3, 3, 3}));
+}
+
+TEST(CopyOnWrite, VolumeWrittenDataIsSharedUntilNextWrite) {
+    Volume volume(std::make_shared<VolumeRAMPrecision<float>>(size3_t{4}));
+    volume.getEditableRepresentation<VolumeRAM>()->setFromDouble(size3_t{0, 0, 0}, 1.0);
+
+    std::unique_ptr<Volume> clone{volume.clone()};
+    const auto data = volume.getRepresentation<VolumeRAM>()->getData();
+    EXPECT_EQ(data, clone->getRepresentation<VolumeRAM>()->getData());
+
+    clone->getEditableRepresentation<VolumeRAM>()->setFromDouble(size3_t{0, 0, 0}, 2.0);
+    EXPECT_NE(data, clone->getRepresentation<VolumeRAM>()->getData());
+    EXPECT_EQ(1.0, volume.getRepresentation<VolumeRAM>()->getAsDouble(size3_t{0, 0, 0}));
+    EXPECT_EQ(2.0, clone->getRepresentation<VolumeRAM>()->getAsDouble(size3_t{0, 0, 0}));
+
+    // The original is the only user of its data again and writes without copying
+    volume.getEditableRepresentation<VolumeRAM>()->setFromDouble(size3_t{0, 0, 0}, 3.0);
+    EXPECT_EQ(data, volume.getRepresentation<VolumeRAM>()->getData());
+    EXPECT_EQ(3.0, volume.getRepresentation<VolumeRAM>()->getAsDouble(size3_t{0, 0, 0}));
+}
+
+TEST(CopyOnWrite, VolumeRAMRemoveDataOwnership) {
+    auto data = new float[8]();
+    {
+        VolumeRAMPrecision<float> volume(data, size3_t{2});
+        std::unique_ptr<VolumeRAMPrecision<float>> copy{volume.cloneShared()};
+        volume.removeDataOwnership();
+        // The copy still owns the data it was created from, the volume owns a new copy
+        EXPECT_NE(data, volume.getDataTyped());
+        data = volume.getDataTyped();
+    }
+    delete[] data;
+}
+
+TEST(CopyOnWrite, VolumeSharesDataUntilEdited) {
+    auto ram = std::make_shared<VolumeRAMPrecision<float>>(size3_t{4});
+    ram->setFromDouble(size3_t{1, 2, 3}, 5.0);
+    const Volume volume(ram);
+
+    Volume copy(volume);
+    copy.setModelMatrix(mat4(2.0f));
+    EXPECT_EQ(volume.getRepresentation<VolumeRAM>()->getData(),
+              copy.getRepresentation<VolumeRAM>()->getData());
+
+    copy.getEditableRepresentation<VolumeRAM>()->setFromDouble(size3_t{1, 2, 3}, 7.0);
+    EXPECT_NE(volume.getRepresentation<VolumeRAM>()->getData(),
+              copy.getRepresentation<VolumeRAM>()->getData());
+    EXPECT_EQ(5.0, volume.getRepresentation<VolumeRAM>()->getAsDouble(size3_t{1, 2, 3}));
+    EXPECT_EQ(7.0, copy.getRepresentation<VolumeRAM>()->getAsDouble(size3_t{1, 2, 3}));
+}
+
+TEST(CopyOnWrite, VolumeConcurrentWriters) {
+    const size3_t dims{16, 16, 16};
+    const Volume volume(std::make_shared<VolumeRAMPrecision<float>>(dims));
+    Volume copy(volume);
+
+    // Every thread asks for editable access and writes its own slices of the shared copy
+    const size_t nThreads = 8;
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < nThreads; ++t) {
+        threads.emplace_back([&copy, dims, t, nThreads]() {
+            auto ram = copy.getEditableRepresentation<VolumeRAM>();
+            for (size_t z = t; z < dims.z; z += nThreads) {
+                for (size_t y = 0; y < dims.y; ++y) {
+                    for (size_t x = 0; x < dims.x; ++x) {
+                        ram->setFromDouble(size3_t{x, y, z}, static_cast<double>(z + 1));
+                    }
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    const auto written = copy.getRepresentation<VolumeRAM>();
+    const auto original = volume.getRepresentation<VolumeRAM>();
+    for (size_t z = 0; z < dims.z; ++z) {
+        for (size_t y = 0; y < dims.y; ++y) {
+            for (size_t x = 0; x < dims.x; ++x) {
+                EXPECT_EQ(static_cast<double>(z + 1), written->getAsDouble(size3_t{x, y, z}));
+                EXPECT_EQ(0.0, original->getAsDouble(size3_t{x, y, z}));
+            }
+        }
+    }
+}
+
+TEST(CopyOnWrite, LayerRAMSharesUntilDetached) {
+    LayerRAMPrecision<float> layer(size2_t{4, 3});
+    layer.setFromDouble(size2_t{1, 1}, 3.0);
+
+    std::unique_ptr<LayerRAMPrecision<float>> copy{layer.cloneShared()};
+    EXPECT_TRUE(layer.isShared());
+    const auto& constLayer = layer;
+    EXPECT_EQ(constLayer.getDataTyped(), std::as_const(*copy).getDataTyped());
+
+    layer.getDataTyped()[0] = 1.0f;
+    EXPECT_FALSE(layer.isShared());
+    EXPECT_FALSE(copy->isShared());
+    EXPECT_EQ(1.0, layer.getAsDouble(size2_t{0, 0}));
+    EXPECT_EQ(0.0, copy->getAsDouble(size2_t{0, 0}));
+    EXPECT_EQ(3.0, copy->getAsDouble(size2_t{1, 1}));
+
+    const Layer shared(std::shared_ptr<LayerRAMPrecision<float>>(copy->cloneShared()));
+    const Layer layerCopy(shared);
+    EXPECT_EQ(shared.getRepresentation<LayerRAM>()->getData(),
+              layerCopy.getRepresentation<LayerRAM>()->getData());
+}
+
+TEST(CopyOnWrite, BufferRAMSharesUntilDetached) {
+    BufferRAMPrecision<int> buffer(std::vector<int>{1, 2, 3});
+
+    std::unique_ptr<BufferRAMPrecision<int>> copy{buffer.cloneShared()};
+    EXPECT_TRUE(buffer.isShared());
+    const auto& constBuffer = buffer;
+    EXPECT_EQ(&constBuffer.getDataContainer(), &std::as_const(*copy).getDataContainer());
+
+    buffer.getDataContainer()[0] = 10;
+    EXPECT_FALSE(buffer.isShared());
+    EXPECT_FALSE(copy->isShared());
+    EXPECT_EQ(10, buffer.get(0));
+    EXPECT_EQ(1, copy->get(0));
+
+    std::unique_ptr<BufferRAMPrecision<int>> copy2{copy->cloneShared()};
+    copy->clear();
+    EXPECT_EQ(0u, copy->getSize());
+    EXPECT_EQ(3u, copy2->getSize());
+
+    const Buffer<int> shared(std::shared_ptr<BufferRAMPrecision<int>>(copy2->cloneShared()));
+    const Buffer<int> bufferCopy(shared);
+    EXPECT_EQ(shared.getRepresentation<BufferRAM>()->getData(),
+              bufferCopy.getRepresentation<BufferRAM>()->getData());
+}
+
+}  // namespace inviwo
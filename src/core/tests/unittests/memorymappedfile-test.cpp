@@ -0,0 +1,100 @@
+/*********************************************************************************
+ *
+ * Inviwo - Interactive Visualization Workshop
+ *
+ * Copyright (c) 2021 Inviwo Foundation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************************/
+
+#include <warn/push>
+#include <warn/ignore/all>
+#include <gtest/gtest.h>
+#include <warn/pop>
+
+#include <inviwo/core/io/memorymappedfile.h>
+#include <inviwo/core/io/tempfilehandle.h>
+#include <inviwo/core/datastructures/volume/volumeramprecision.h>
+#include <inviwo/core/util/exception.h>
+
+#include <cstdio>
+#include <numeric>
+#include <vector>
+
+namespace inviwo {
+
+namespace {
+
+// Writes a header byte followed by count consecutive floats starting at zero
+util::TempFileHandle writeFloats(size_t count) {
+    util::TempFileHandle tmp("inviwo", ".raw");
+    std::vector<float> values(count);
+    std::iota(values.begin(), values.end(), 0.0f);
+    const char header[4] = {'i', 'v', 'w', '0'};
+    std::fwrite(header, 1, sizeof(header), tmp);
+    std::fwrite(values.data(), sizeof(float), values.size(), tmp);
+    std::fflush(tmp);
+    return tmp;
+}
+
+}  // namespace
+
+TEST(MemoryMappedFile, ReadsRange) {
+    auto tmp = writeFloats(1000);
+    MemoryMappedFile file(tmp.getFileName(), 4 + 10 * sizeof(float), 5 * sizeof(float));
+    ASSERT_EQ(5 * sizeof(float), file.size());
+    const auto data = static_cast<const float*>(file.data());
+    EXPECT_EQ(10.0f, data[0]);
+    EXPECT_EQ(14.0f, data[4]);
+}
+
+TEST(MemoryMappedFile, ThrowsOnShortFile) {
+    auto tmp = writeFloats(10);
+    EXPECT_THROW(MemoryMappedFile(tmp.getFileName(), 4, 11 * sizeof(float)), FileException);
+}
+
+TEST(MemoryMappedFile, VolumeCopiesOnWrite) {
+    auto tmp = writeFloats(4 * 4 * 4);
+    auto file = std::make_shared<MemoryMappedFile>(tmp.getFileName(), 4, 64 * sizeof(float));
+    const auto mapped = static_cast<const float*>(file->data());
+
+    VolumeRAMPrecision<float> volume(file, mapped, size3_t{4});
+    file.reset();
+    EXPECT_TRUE(volume.isShared());
+
+    const auto& constVolume = volume;
+    EXPECT_EQ(mapped, constVolume.getDataTyped());
+    EXPECT_EQ(21.0, constVolume.getAsDouble(size3_t{1, 1, 1}));
+
+    auto copy = volume;
+    EXPECT_TRUE(copy.isShared());
+
+    volume.setFromDouble(size3_t{0, 0, 0}, 42.0);
+    EXPECT_FALSE(volume.isShared());
+    EXPECT_NE(mapped, constVolume.getDataTyped());
+    EXPECT_EQ(42.0, volume.getAsDouble(size3_t{0, 0, 0}));
+    EXPECT_EQ(63.0, volume.getAsDouble(size3_t{3, 3, 3}));
+    EXPECT_EQ(0.0, copy.getAsDouble(size3_t{0, 0, 0}));
+}
+
+}  // namespace inviwo
@@ -0,0 +1,142 @@
+/*********************************************************************************
+ *
+ * Inviwo - Interactive Visualization Workshop
+ *
+ * Copyright (c) 2021 Inviwo Foundation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************************/
+
+#include <warn/push>
+#include <warn/ignore/all>
+#include <gtest/gtest.h>
+#include <warn/pop>
+
+#include <inviwo/core/util/parallelfor.h>
+#include <inviwo/core/util/exception.h>
+#include <inviwo/core/util/indexmapper.h>
+
+#include <atomic>
+#include <numeric>
+#include <vector>
+
+namespace inviwo {
+
+TEST(ParallelFor, VisitsEachIndexOnce) {
+    std::vector<std::atomic<int>> visits(10000);
+    util::parallelFor(visits.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) ++visits[i];
+    });
+    for (const auto& v : visits) {
+        EXPECT_EQ(1, v.load());
+    }
+}
+
+TEST(ParallelFor, RespectsGrain) {
+    std::atomic<size_t> total{0};
+    util::parallelFor(
+        100,
+        [&](size_t begin, size_t end) {
+            EXPECT_GE(end - begin, 50u);
+            total += end - begin;
+        },
+        50);
+    EXPECT_EQ(100u, total.load());
+}
+
+TEST(ParallelFor, Empty) {
+    bool called = false;
+    util::parallelFor(0, [&](size_t, size_t) { called = true; });
+    EXPECT_FALSE(called);
+}
+
+TEST(ParallelFor, RethrowsException) {
+    EXPECT_THROW(util::parallelFor(1000,
+                                   [](size_t begin, size_t) {
+                                       if (begin == 0) throw Exception("block failed");
+                                   }),
+                 Exception);
+}
+
+TEST(ParallelFor, VisitsEachVoxelOnce) {
+    for (auto blocking : {util::Blocking::Slabs, util::Blocking::Bricks}) {
+        for (const auto dims : {size3_t{1, 1, 1}, size3_t{7, 5, 3}, size3_t{130, 70, 9},
+                                size3_t{1, 300, 200}}) {
+            const util::IndexMapper3D im(dims);
+            std::vector<std::atomic<int>> visits(glm::compMul(dims));
+            util::parallelFor(
+                dims,
+                [&](const size3_t& begin, const size3_t& end) {
+                    size3_t pos;
+                    for (pos.z = begin.z; pos.z < end.z; ++pos.z) {
+                        for (pos.y = begin.y; pos.y < end.y; ++pos.y) {
+                            for (pos.x = begin.x; pos.x < end.x; ++pos.x) {
+                                ++visits[im(pos)];
+                            }
+                        }
+                    }
+                },
+                blocking, size3_t{4});
+            for (const auto& v : visits) {
+                EXPECT_EQ(1, v.load());
+            }
+        }
+    }
+}
+
+TEST(ParallelFor, VisitsEachPixelOnce) {
+    const size2_t dims{100, 33};
+    const util::IndexMapper2D im(dims);
+    std::vector<std::atomic<int>> visits(glm::compMul(dims));
+    util::parallelFor(
+        dims,
+        [&](const size2_t& begin, const size2_t& end) {
+            for (size_t y = begin.y; y < end.y; ++y) {
+                for (size_t x = begin.x; x < end.x; ++x) ++visits[im(x, y)];
+            }
+        },
+        util::Blocking::Bricks, size2_t{16});
+    for (const auto& v : visits) {
+        EXPECT_EQ(1, v.load());
+    }
+}
+
+TEST(ParallelFor, Reduce) {
+    const size3_t dims{50, 40, 30};
+    const auto count = [](const size3_t& begin, const size3_t& end) {
+        return glm::compMul(end - begin);
+    };
+    for (auto blocking : {util::Blocking::Slabs, util::Blocking::Bricks}) {
+        EXPECT_EQ(glm::compMul(dims),
+                  util::parallelReduce(dims, size_t{0}, count, std::plus<>{}, blocking));
+    }
+    EXPECT_EQ(size_t{0}, util::parallelReduce(size3_t{0, 4, 4}, size_t{0}, count, std::plus<>{}));
+    EXPECT_EQ(size_t{12}, util::parallelReduce(
+                              size2_t{4, 3}, size_t{0},
+                              [](const size2_t& begin, const size2_t& end) {
+                                  return glm::compMul(end - begin);
+                              },
+                              std::plus<>{}));
+}
+
+}  // namespace inviwo
@@ -234,6 +234,30 @@ TEST(SerializationTest, vectorOfPointersTest) {
     delete outVector[2];
 }
 
+TEST(SerializationTest, binaryDocumentTest) {
+    std::vector<MinimumSerilizableClass> inVector, outVector;
+    inVector.push_back(MinimumSerilizableClass(0.1f));
+    inVector.push_back(MinimumSerilizableClass(0.2f));
+    inVector.push_back(MinimumSerilizableClass(0.3f));
+    const std::string inString = "a <string> with \"markup\" & a\nline break";
+    std::string outString;
+    std::string refpath = filesystem::findBasePath();
+    std::stringstream ss;
+    Serializer serializer(refpath);
+    serializer.serialize("serializedVector", inVector, "value");
+    serializer.serialize("serializedString", inString);
+    serializer.writeFile(ss, DocumentFormat::Binary);
+    EXPECT_TRUE(util::isBinaryDocument(ss));
+
+    Deserializer deserializer(ss, refpath);
+    deserializer.deserialize("serializedVector", outVector, "value");
+    deserializer.deserialize("serializedString", outString);
+    ASSERT_EQ(inVector.size(), outVector.size());
+
+    for (size_t i = 0; i < inVector.size(); i++) EXPECT_EQ(inVector[i], outVector[i]);
+    EXPECT_EQ(inString, outString);
+}
+
 TEST(SerializationTest, vec2Tests) {
     vec2 inVec(1.1f, 2.2f), outVec;
     outVec = serializationOfType(inVec);
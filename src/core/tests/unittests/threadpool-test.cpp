@@ -0,0 +1,165 @@
+/*********************************************************************************
+ *
+ * Inviwo - Interactive Visualization Workshop
+ *
+ * Copyright (c) 2021 Inviwo Foundation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************************/
+
+#include <warn/push>
+#include <warn/ignore/all>
+#include <gtest/gtest.h>
+#include <warn/pop>
+
+#include <inviwo/core/util/threadpool.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace inviwo {
+
+TEST(ThreadPool, Enqueue) {
+    ThreadPool pool(4);
+    std::vector<std::future<size_t>> results;
+    for (size_t i = 0; i < 1000; ++i) {
+        results.push_back(pool.enqueue([](size_t j) { return 2 * j; }, i));
+    }
+    for (size_t i = 0; i < results.size(); ++i) {
+        EXPECT_EQ(2 * i, results[i].get());
+    }
+}
+
+TEST(ThreadPool, EnqueueFromWorker) {
+    ThreadPool pool(2);
+    auto result = pool.enqueue([&pool]() { return pool.enqueue([]() { return 1; }).get() + 1; });
+    EXPECT_EQ(2, result.get());
+}
+
+TEST(ThreadPool, EnqueueBatch) {
+    ThreadPool pool(3);
+    std::vector<std::promise<void>> done(100);
+    std::vector<ThreadPool::Task> tasks;
+    for (auto& p : done) {
+        tasks.emplace_back([&p]() { p.set_value(); });
+    }
+    pool.enqueueBatch(std::move(tasks));
+    for (auto& p : done) {
+        EXPECT_NO_THROW(p.get_future().get());
+    }
+}
+
+TEST(ThreadPool, LargeTask) {
+    ThreadPool pool(1);
+    std::array<int, 64> data{};
+    data.back() = 3;
+    EXPECT_EQ(3, pool.enqueue([data]() { return data.back(); }).get());
+}
+
+TEST(ThreadPool, Exception) {
+    ThreadPool pool(1);
+    auto result = pool.enqueue([]() -> int { throw std::runtime_error("error"); });
+    EXPECT_THROW(result.get(), std::runtime_error);
+}
+
+namespace {
+
+// trySetSize only stops idle workers, retry until the pool has the requested size
+size_t resize(ThreadPool& pool, size_t size) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    auto result = pool.trySetSize(size);
+    while (result != size && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::yield();
+        result = pool.trySetSize(size);
+    }
+    return result;
+}
+
+}  // namespace
+
+TEST(ThreadPool, Resize) {
+    ThreadPool pool(4);
+    EXPECT_EQ(6u, pool.trySetSize(6));
+
+    // keep every worker busy, none of them can be stopped
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::atomic<size_t> started{0};
+    std::vector<std::future<void>> busy;
+    for (size_t i = 0; i < 6; ++i) {
+        busy.push_back(pool.enqueue([&started, released]() {
+            ++started;
+            released.wait();
+        }));
+    }
+    while (started < 6) std::this_thread::yield();
+    EXPECT_EQ(6u, pool.trySetSize(1));
+
+    release.set_value();
+    for (auto& f : busy) f.get();
+    EXPECT_EQ(1u, resize(pool, 1));
+    EXPECT_EQ(1u, pool.getSize());
+    EXPECT_EQ(5, pool.enqueue([]() { return 5; }).get());
+}
+
+TEST(ThreadPool, ResizeRunsEveryTaskOnce) {
+    constexpr size_t count = 20000;
+    std::vector<std::atomic<int>> runs(count);
+    std::atomic<size_t> finished{0};
+    std::promise<void> allDone;
+
+    ThreadPool pool(4);
+    // enqueue all tasks from one worker into its own queue, the other workers have to steal them
+    pool.enqueue([&]() {
+        std::vector<ThreadPool::Task> tasks;
+        for (size_t i = 0; i < count; ++i) {
+            tasks.emplace_back([&, i]() {
+                ++runs[i];
+                if (++finished == count) allDone.set_value();
+            });
+        }
+        pool.enqueueBatch(std::move(tasks));
+    }).get();
+
+    for (size_t size : {1, 8, 2, 6, 0, 3}) pool.trySetSize(size);
+
+    auto done = allDone.get_future();
+    ASSERT_EQ(std::future_status::ready, done.wait_for(std::chrono::seconds(30)));
+    for (size_t i = 0; i < count; ++i) {
+        EXPECT_EQ(1, runs[i]) << "task " << i;
+    }
+    EXPECT_EQ(0u, pool.getQueueSize());
+    EXPECT_EQ(1u, resize(pool, 1));
+}
+
+TEST(ThreadPool, NoWorkers) {
+    ThreadPool pool(0);
+    EXPECT_EQ(1, pool.enqueue([]() { return 1; }).get());
+}
+
+}  // namespace inviwo
@@ -0,0 +1,202 @@
+/*********************************************************************************
+ *
+ * Inviwo - Interactive Visualization Workshop
+ *
+ * Copyright (c) 2021 Inviwo Foundation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************************/
+
+#include <warn/push>
+#include <warn/ignore/all>
+#include <gtest/gtest.h>
+#include <warn/pop>
+
+#include <inviwo/core/datastructures/volume/volumebricked.h>
+#include <inviwo/core/datastructures/volume/volumebrickedconverter.h>
+#include <inviwo/core/datastructures/volume/volume.h>
+#include <inviwo/core/datastructures/volume/volumeramprecision.h>
+#include <inviwo/core/io/rawvolumeramloader.h>
+#include <inviwo/core/io/tempfilehandle.h>
+#include <inviwo/core/util/indexmapper.h>
+#include <inviwo/core/util/exception.h>
+#include <inviwo/core/util/volumesampler.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace inviwo {
+
+namespace {
+
+// Writes a header byte followed by consecutive floats, i.e. the value of each voxel is its index
+util::TempFileHandle writeRamp(const size3_t& dims, bool littleEndian = true) {
+    util::TempFileHandle tmp("inviwo", ".raw");
+    std::vector<float> values(glm::compMul(dims));
+    std::iota(values.begin(), values.end(), 0.0f);
+    if (!littleEndian) {
+        auto bytes = reinterpret_cast<char*>(values.data());
+        for (size_t i = 0; i < values.size(); ++i) {
+            std::reverse(bytes + i * sizeof(float), bytes + (i + 1) * sizeof(float));
+        }
+    }
+    const char header = 'i';
+    std::fwrite(&header, 1, 1, tmp);
+    std::fwrite(values.data(), sizeof(float), values.size(), tmp);
+    std::fflush(tmp);
+    return tmp;
+}
+
+VolumeBricked createBricked(const util::TempFileHandle& tmp, const size3_t& dims,
+                            bool littleEndian = true) {
+    return VolumeBricked(std::make_unique<RawVolumeRAMLoader>(tmp.getFileName(), 1, littleEndian),
+                         dims, DataFloat32::get(), size3_t{4});
+}
+
+}  // namespace
+
+TEST(VolumeBricked, LoadsBricks) {
+    const size3_t dims{10, 7, 5};
+    auto tmp = writeRamp(dims);
+    const auto bricked = createBricked(tmp, dims);
+    EXPECT_EQ(size3_t(3, 2, 2), bricked.getBrickCount());
+
+    const auto brick = bricked.getBrick(size3_t{2, 1, 1});
+    EXPECT_EQ(size3_t(8, 4, 4), brick.offset);
+    ASSERT_EQ(size3_t(2, 3, 1), brick.data->getDimensions());
+
+    const util::IndexMapper3D im(dims);
+    for (size_t y = 0; y < 3; ++y) {
+        for (size_t x = 0; x < 2; ++x) {
+            EXPECT_EQ(static_cast<double>(im(brick.offset + size3_t{x, y, 0})),
+                      brick.data->getAsDouble(size3_t{x, y, 0}));
+        }
+    }
+
+    const auto containing = bricked.getBrickContaining(size3_t{9, 6, 4});
+    EXPECT_EQ(brick.data, containing.data);
+
+    EXPECT_THROW(bricked.getBrick(size3_t{3, 0, 0}), RangeException);
+    EXPECT_THROW(bricked.getBrickContaining(size3_t{0, 7, 0}), RangeException);
+}
+
+TEST(VolumeBricked, ReadsRegionsAcrossBricks) {
+    const size3_t dims{10, 7, 5};
+    auto tmp = writeRamp(dims);
+    const auto bricked = createBricked(tmp, dims);
+
+    const size3_t offset{3, 2, 1};
+    const size3_t extent{6, 4, 3};
+    const auto region = bricked.getSubVolume(offset, extent);
+    ASSERT_EQ(extent, region->getDimensions());
+
+    const util::IndexMapper3D im(dims);
+    const util::IndexMapper3D regionIm(extent);
+    const auto data = static_cast<const float*>(region->getData());
+    for (size_t i = 0; i < glm::compMul(extent); ++i) {
+        EXPECT_EQ(static_cast<float>(im(offset + regionIm(i))), data[i]);
+    }
+
+    EXPECT_THROW(bricked.getSubVolume(offset, size3_t{8, 1, 1}), RangeException);
+}
+
+TEST(VolumeBricked, SwapsBigEndian) {
+    const size3_t dims{5, 5, 5};
+    auto tmp = writeRamp(dims, false);
+    const auto bricked = createBricked(tmp, dims, false);
+
+    const auto brick = bricked.getBrick(size3_t{1, 1, 1});
+    EXPECT_EQ(static_cast<double>(util::IndexMapper3D(dims)(size3_t{4, 4, 4})),
+              brick.data->getAsDouble(size3_t{0, 0, 0}));
+}
+
+TEST(VolumeBricked, EvictsLeastRecentlyUsed) {
+    const size3_t dims{8, 8, 8};
+    auto tmp = writeRamp(dims);
+    auto bricked = createBricked(tmp, dims);
+
+    const size_t brickBytes = 4 * 4 * 4 * sizeof(float);
+    bricked.setCacheCapacity(2 * brickBytes);
+
+    const auto first = bricked.getBrick(size3_t{0, 0, 0}).data;
+    bricked.getBrick(size3_t{1, 0, 0});
+    EXPECT_EQ(2 * brickBytes, bricked.getCacheSize());
+
+    // Touch the first brick, such that the second is evicted by the third
+    EXPECT_EQ(first, bricked.getBrick(size3_t{0, 0, 0}).data);
+    bricked.getBrick(size3_t{0, 1, 0});
+    EXPECT_EQ(2 * brickBytes, bricked.getCacheSize());
+    EXPECT_EQ(first, bricked.getBrick(size3_t{0, 0, 0}).data);
+
+    bricked.setCacheCapacity(0);
+    EXPECT_EQ(brickBytes, bricked.getCacheSize());
+}
+
+TEST(VolumeBricked, ConvertsToAndFromRAM) {
+    const size3_t dims{70, 3, 66};
+    auto ram = std::make_shared<VolumeRAMPrecision<float>>(dims);
+    auto data = ram->getDataTyped();
+    std::iota(data, data + glm::compMul(dims), 0.0f);
+
+    const auto bricked = VolumeRAM2BrickedConverter{}.createFrom(ram);
+    EXPECT_EQ(size3_t(2, 1, 2), bricked->getBrickCount());
+
+    const auto copy = VolumeBricked2RAMConverter{}.createFrom(bricked);
+    ASSERT_EQ(dims, copy->getDimensions());
+    EXPECT_TRUE(std::equal(data, data + glm::compMul(dims),
+                           static_cast<const float*>(copy->getData())));
+}
+
+TEST(VolumeBricked, SamplesThroughBricks) {
+    const size3_t dims{10, 7, 5};
+    auto tmp = writeRamp(dims);
+    const Volume bricked(std::make_shared<VolumeBricked>(createBricked(tmp, dims)));
+
+    auto ram = std::make_shared<VolumeRAMPrecision<float>>(dims);
+    std::iota(ram->getDataTyped(), ram->getDataTyped() + glm::compMul(dims), 0.0f);
+    const Volume volume(ram);
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> dist(-0.1, 1.1);
+    std::vector<dvec3> positions(200);
+    for (auto& p : positions) p = dvec3(dist(rng), dist(rng), dist(rng));
+    positions.push_back(dvec3(1.0));
+
+    const VolumeDoubleSampler<1> ramSampler(volume);
+    const VolumeDoubleSampler<1> brickSampler(bricked, CoordinateSpace::Data,
+                                              VolumeSamplerSource::Bricks);
+    std::vector<double> results(positions.size());
+    brickSampler.sample(positions, results);
+    for (size_t i = 0; i < positions.size(); ++i) {
+        const auto expected = ramSampler.sample(positions[i]);
+        EXPECT_DOUBLE_EQ(expected, brickSampler.sample(positions[i])) << "position " << i;
+        EXPECT_DOUBLE_EQ(expected, results[i]) << "position " << i;
+    }
+    // Only the bricked representation was used
+    EXPECT_FALSE(bricked.hasRepresentation<VolumeRAM>());
+}
+
+}  // namespace inviwo
@@ -0,0 +1,118 @@
+/*********************************************************************************
+ *
+ * Inviwo - Interactive Visualization Workshop
+ *
+ * Copyright (c) 2021 Inviwo Foundation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************************/
+
+#include <warn/push>
+#include <warn/ignore/all>
+#include <gtest/gtest.h>
+#include <warn/pop>
+
+#include <inviwo/core/datastructures/volume/volume.h>
+#include <inviwo/core/datastructures/volume/volumeramprecision.h>
+#include <inviwo/core/util/volumesampler.h>
+#include <inviwo/core/util/templatesampler.h>
+
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace inviwo {
+
+namespace {
+
+std::shared_ptr<Volume> createVolume(const size3_t& dims) {
+    auto ram = std::make_shared<VolumeRAMPrecision<vec3>>(dims);
+    std::mt19937 rng(17);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    auto data = ram->getDataTyped();
+    for (size_t i = 0; i < glm::compMul(dims); ++i) {
+        data[i] = vec3(dist(rng), dist(rng), dist(rng));
+    }
+    auto volume = std::make_shared<Volume>(ram);
+    mat4 model(2.0f);
+    model[3] = vec4(-0.5f, -0.5f, -0.5f, 1.0f);
+    volume->setModelMatrix(model);
+    return volume;
+}
+
+std::vector<dvec3> createPositions(size_t count) {
+    std::mt19937 rng(4);
+    // Include positions outside of the volume
+    std::uniform_real_distribution<double> dist(-0.1, 1.1);
+    std::vector<dvec3> positions(count);
+    for (auto& p : positions) p = dvec3(dist(rng), dist(rng), dist(rng));
+    positions.push_back(dvec3(1.0));
+    positions.push_back(dvec3(0.0));
+    return positions;
+}
+
+template <typename Sampler>
+void expectBatchEqualsSingle(const Sampler& sampler, const std::vector<dvec3>& positions,
+                             CoordinateSpace space) {
+    using ReturnType = typename Sampler::ReturnType;
+    std::vector<ReturnType> results(positions.size());
+    sampler.sample(positions, results, space);
+    auto inside = std::make_unique<bool[]>(positions.size());
+    sampler.withinBounds(positions, util::span<bool>(inside.get(), positions.size()), space);
+
+    for (size_t i = 0; i < positions.size(); ++i) {
+        EXPECT_EQ(sampler.sample(positions[i], space), results[i]) << "position " << i;
+        EXPECT_EQ(sampler.withinBounds(positions[i], space), inside[i]) << "position " << i;
+    }
+}
+
+}  // namespace
+
+TEST(VolumeSampler, BatchEqualsSingle) {
+    const auto volume = createVolume(size3_t{9, 7, 12});
+    const auto positions = createPositions(200);
+
+    const VolumeDoubleSampler<3> sampler(volume);
+    expectBatchEqualsSingle(sampler, positions, CoordinateSpace::Data);
+    expectBatchEqualsSingle(sampler, positions, CoordinateSpace::Model);
+
+    const VolumeDoubleSampler<3> modelSampler(volume, CoordinateSpace::Model);
+    std::vector<dvec3> results(positions.size());
+    modelSampler.sample(positions, results);
+    for (size_t i = 0; i < positions.size(); ++i) {
+        EXPECT_EQ(modelSampler.sample(positions[i]), results[i]) << "position " << i;
+    }
+}
+
+TEST(TemplateVolumeSampler, BatchEqualsSingle) {
+    const auto volume = createVolume(size3_t{9, 7, 12});
+    // The template sampler does not clamp to the last voxel, stay clear of the upper bound
+    auto positions = createPositions(200);
+    for (auto& p : positions) p = glm::min(p, dvec3(0.99));
+
+    const TemplateVolumeSampler<vec3, double> sampler(volume);
+    expectBatchEqualsSingle(sampler, positions, CoordinateSpace::Data);
+    expectBatchEqualsSingle(sampler, positions, CoordinateSpace::World);
+}
+
+}  // namespace inviwo
@@ -0,0 +1,118 @@
+/*********************************************************************************
+ *
+ * Inviwo - Interactive Visualization Workshop
+ *
+ * Copyright (c) 2021 Inviwo Foundation
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *********************************************************************************/
+
+#include <inviwo/core/util/parallelfor.h>
+#include <inviwo/core/common/inviwoapplication.h>
+#include <inviwo/core/util/threadpool.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <vector>
+
+namespace inviwo {
+
+namespace {
+
+struct ParallelForState {
+    std::function<void(size_t, size_t)> func;
+    size_t count;
+    size_t blocks;
+    std::atomic<size_t> next{0};
+    size_t done{0};  // guarded by mutex
+    std::exception_ptr exception;
+    std::mutex mutex;
+    std::condition_variable finished;
+
+    void run() {
+        for (size_t block = next++; block < blocks; block = next++) {
+            try {
+                func(block * count / blocks, (block + 1) * count / blocks);
+            } catch (...) {
+                std::scoped_lock lock{mutex};
+                if (!exception) exception = std::current_exception();
+            }
+            std::scoped_lock lock{mutex};
+            if (exception) {
+                // skip all blocks that have not been started
+                const auto skipped = next.exchange(blocks);
+                done += skipped < blocks ? blocks - skipped : 0;
+            }
+            if (++done == blocks) finished.notify_all();
+        }
+    }
+};
+
+size_t getPoolSize() {
+    return InviwoApplication::isInitialized() ? InviwoApplication::getPtr()->getPoolSize() : 0;
+}
+
+}  // namespace
+
+size_t util::parallelBlockCount(size_t count, size_t grain) {
+    const size_t poolSize = getPoolSize();
+    if (poolSize == 0) return std::min<size_t>(count, 1);
+    return std::max<size_t>(std::min(count / std::max<size_t>(grain, 1), 4 * (poolSize + 1)),
+                            std::min<size_t>(count, 1));
+}
+
+void util::parallelFor(size_t count, const std::function<void(size_t, size_t)>& func,
+                       size_t grain) {
+    if (count == 0) return;
+
+    const size_t poolSize = getPoolSize();
+    const size_t blocks = parallelBlockCount(count, grain);
+    if (poolSize == 0 || blocks <= 1) {
+        func(0, count);
+        return;
+    }
+
+    auto state = std::make_shared<ParallelForState>();
+    state->func = func;
+    state->count = count;
+    state->blocks = blocks;
+
+    // Workers that start after all blocks have been taken return immediately without touching
+    // func, hence we do not need to wait for them.
+    auto& pool = InviwoApplication::getPtr()->getThreadPool();
+    std::vector<ThreadPool::Task> workers;
+    for (size_t i = 1; i < std::min(blocks, poolSize + 1); ++i) {
+        workers.emplace_back([state]() { state->run(); });
+    }
+    pool.enqueueBatch(std::move(workers));
+    state->run();
+
+    std::unique_lock lock{state->mutex};
+    state->finished.wait(lock, [&]() { return state->done == state->blocks; });
+    if (state->exception) std::rethrow_exception(state->exception);
+}
+
+}  // namespace inviwo
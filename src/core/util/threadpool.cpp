@@ -32,94 +32,246 @@
 #include <inviwo/core/util/stdextensions.h>
 #include <inviwo/core/util/threadutil.h>
 
+#include <algorithm>
+#include <iterator>
+
 namespace inviwo {
 
+namespace {
+
+// the worker running on the current thread, if any
+thread_local void* currentThreadWorker = nullptr;
+
+}  // namespace
+
 // the constructor just launches some amount of workers
 ThreadPool::ThreadPool(size_t threads, std::function<void()> onThreadStart,
                        std::function<void()> onThreadStop)
     : onThreadStart_{std::move(onThreadStart)}, onThreadStop_{std::move(onThreadStop)} {
+    std::unique_lock<std::shared_mutex> lock(workers_mutex);
     while (workers.size() < threads) {
         workers.push_back(std::make_unique<Worker>(*this));
     }
 }
 
 size_t ThreadPool::trySetSize(size_t size) {
-    while (workers.size() < size) {
-        workers.push_back(std::make_unique<Worker>(*this));
-    }
+    std::vector<std::unique_ptr<Worker>> done;
+    std::deque<Task> orphans;
+    size_t result = 0;
+    {
+        std::unique_lock<std::shared_mutex> lock(workers_mutex);
+        while (workers.size() < size) {
+            workers.push_back(std::make_unique<Worker>(*this));
+        }
 
-    if (workers.size() > size) {
-        auto active = workers.size();
-        for (auto& worker : workers) {
-            auto exprected = State::Free;
-            if (worker->state.compare_exchange_strong(exprected, State::Stop)) {
-                --active;
-            } else if (exprected == State::Stop || exprected == State::Done) {
-                --active;
+        if (workers.size() > size) {
+            auto active = workers.size();
+            for (auto& worker : workers) {
+                auto exprected = State::Free;
+                if (worker->state.compare_exchange_strong(exprected, State::Stop)) {
+                    --active;
+                } else if (exprected == State::Stop || exprected == State::Done) {
+                    --active;
+                }
+                if (active <= size) break;
             }
-            if (active <= size) break;
-        }
 
-        condition.notify_all();
+            {
+                std::unique_lock<std::mutex> sleepLock(sleep_mutex);
+            }
+            condition.notify_all();
 
-        util::erase_remove_if(
-            workers, [](std::unique_ptr<Worker>& worker) { return worker->state == State::Done; });
+            auto it = std::stable_partition(
+                workers.begin(), workers.end(),
+                [](std::unique_ptr<Worker>& worker) { return worker->state != State::Done; });
+            std::move(it, workers.end(), std::back_inserter(done));
+            workers.erase(it, workers.end());
+        }
+
+        // Tasks that were added to a worker just before it stopped are handed to another worker.
+        for (auto& worker : done) {
+            std::deque<Task> left;
+            {
+                std::unique_lock<std::mutex> queueLock(worker->queue_mutex);
+                std::swap(left, worker->tasks);
+            }
+            pending -= left.size();
+            for (auto& task : left) {
+                if (workers.empty()) {
+                    orphans.push_back(std::move(task));
+                } else {
+                    push(*workers[next++ % workers.size()], std::move(task));
+                }
+            }
+        }
+        result = workers.size();
     }
-    return workers.size();
-}
+    wake(result);
+    done.clear();  // this will join the stopped threads.
+    for (auto& task : orphans) task();  // No worker threads left, just run the tasks.
 
-size_t ThreadPool::getSize() const { return workers.size(); }
+    return result;
+}
 
-size_t ThreadPool::getQueueSize() {
-    std::unique_lock<std::mutex> lock(queue_mutex);
-    return tasks.size();
+size_t ThreadPool::getSize() const {
+    std::shared_lock<std::shared_mutex> lock(workers_mutex);
+    return workers.size();
 }
 
+size_t ThreadPool::getQueueSize() { return pending; }
+
 ThreadPool::~ThreadPool() {
-    for (auto& worker : workers) worker->state = State::Abort;
+    std::unique_lock<std::shared_mutex> lock(workers_mutex);
+    auto stopping = std::move(workers);
+    lock.unlock();
+
+    for (auto& worker : stopping) worker->state = State::Abort;
+    {
+        std::unique_lock<std::mutex> sleepLock(sleep_mutex);
+    }
     condition.notify_all();
-    workers.clear();  // this will join all threads.
+    stopping.clear();  // this will join all threads.
 }
 
 ThreadPool::Worker::~Worker() { thread.join(); }
 
 ThreadPool::Worker::Worker(ThreadPool& pool)
-    : state{State::Free}, thread{[this, &pool]() {
-        pool.onThreadStart_();
-        util::OnScopeExit cleanup{[&pool]() { pool.onThreadStop_(); }};
+    : pool{pool}, state{State::Free}, thread{[this]() {
+        currentThreadWorker = this;
+        this->pool.onThreadStart_();
+        util::OnScopeExit cleanup{[this]() { this->pool.onThreadStop_(); }};
 
         for (;;) {
-            std::function<void()> task;
-            state = State::Free;
+            auto current = State::Working;
+            state.compare_exchange_strong(current, State::Free);
+            if (current == State::Abort) break;
+
+            // a stopping worker only finishes its own tasks
+            const bool stopping = current == State::Stop;
+            if (auto task = this->pool.take(*this, !stopping)) {
+                current = State::Free;
+                state.compare_exchange_strong(current, State::Working);
+                try {
+                    task();
+                } catch (...) {  // Make sure we don't leak any exceptions.
+                }
+                continue;
+            }
+            if (stopping) break;
+
+            ++this->pool.sleepers;
             {
-                std::unique_lock<std::mutex> lock(pool.queue_mutex);
-                pool.condition.wait(lock, [this, &pool] {
-                    return state == State::Abort || state == State::Stop || !pool.tasks.empty();
+                std::unique_lock<std::mutex> lock(this->pool.sleep_mutex);
+                this->pool.condition.wait(lock, [this] {
+                    return state == State::Abort || state == State::Stop ||
+                           this->pool.pending > 0;
                 });
-                if (state == State::Abort || (state == State::Stop && pool.tasks.empty())) break;
-                task = std::move(pool.tasks.front());
-                pool.tasks.pop();
-            }
-            state = State::Working;
-            try {
-                task();
-            } catch (...) {  // Make sure we don't leak any exceptions.
             }
+            --this->pool.sleepers;
         }
+        currentThreadWorker = nullptr;
         state = State::Done;
     }} {
 
     util::setThreadDescription(thread, "Inviwo Worker Thread");
 }
 
-void ThreadPool::enqueueRaw(std::function<void()> task) {
-    if (workers.empty()) {
-        task();  // No worker threads, just run the task.
+auto ThreadPool::take(Worker& worker, bool steal) -> Task {
+    {
+        std::unique_lock<std::mutex> lock(worker.queue_mutex);
+        if (!worker.tasks.empty()) {
+            auto task = std::move(worker.tasks.front());
+            worker.tasks.pop_front();
+            --pending;
+            return task;
+        }
+    }
+    if (!steal || pending == 0) return {};
+
+    std::shared_lock<std::shared_mutex> lock(workers_mutex);
+    const auto size = workers.size();
+    for (size_t i = 0; i < size; ++i) {
+        auto& victim = *workers[(worker.stealIndex + i) % size];
+        if (&victim == &worker) continue;
+        std::unique_lock<std::mutex> victimLock(victim.queue_mutex);
+        if (!victim.tasks.empty()) {
+            auto task = std::move(victim.tasks.back());
+            victim.tasks.pop_back();
+            --pending;
+            // start looking at the same worker the next time
+            worker.stealIndex = (worker.stealIndex + i) % size;
+            return task;
+        }
+    }
+    return {};
+}
+
+void ThreadPool::push(Worker& worker, Task task) {
+    std::unique_lock<std::mutex> lock(worker.queue_mutex);
+    worker.tasks.push_back(std::move(task));
+    ++pending;
+}
+
+void ThreadPool::wake(size_t count) {
+    if (count == 0 || sleepers == 0) return;
+    {
+        // make sure a worker that is about to sleep sees the new tasks
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+    }
+    if (count == 1) {
+        condition.notify_one();
+    } else {
+        condition.notify_all();
+    }
+}
+
+auto ThreadPool::currentWorker() -> Worker* {
+    auto worker = static_cast<Worker*>(currentThreadWorker);
+    return worker && &worker->pool == this ? worker : nullptr;
+}
+
+void ThreadPool::enqueueRaw(Task task) {
+    if (auto worker = currentWorker()) {
+        push(*worker, std::move(task));
     } else {
-        std::unique_lock<std::mutex> lock(queue_mutex);
-        tasks.emplace(std::move(task));
+        std::shared_lock<std::shared_mutex> lock(workers_mutex);
+        if (workers.empty()) {
+            lock.unlock();
+            task();  // No worker threads, just run the task.
+            return;
+        }
+        push(*workers[next++ % workers.size()], std::move(task));
+    }
+    wake(1);
+}
+
+void ThreadPool::enqueueBatch(std::vector<Task> tasks) {
+    if (tasks.empty()) return;
+
+    if (auto worker = currentWorker()) {
+        std::unique_lock<std::mutex> lock(worker->queue_mutex);
+        for (auto& task : tasks) worker->tasks.push_back(std::move(task));
+        pending += tasks.size();
+    } else {
+        std::shared_lock<std::shared_mutex> lock(workers_mutex);
+        if (workers.empty()) {
+            lock.unlock();
+            for (auto& task : tasks) task();  // No worker threads, just run the tasks.
+            return;
+        }
+        // split the batch into one consecutive range per worker
+        const auto size = std::min(workers.size(), tasks.size());
+        const auto first = next.fetch_add(size);
+        for (size_t i = 0; i < size; ++i) {
+            auto& worker = *workers[(first + i) % workers.size()];
+            const auto begin = tasks.size() * i / size;
+            const auto end = tasks.size() * (i + 1) / size;
+            std::unique_lock<std::mutex> queueLock(worker.queue_mutex);
+            for (auto j = begin; j < end; ++j) worker.tasks.push_back(std::move(tasks[j]));
+            pending += end - begin;
+        }
     }
-    condition.notify_one();
+    wake(tasks.size());
 }
 
 }  // namespace inviwo
@@ -105,6 +105,21 @@
 
 namespace inviwo {
 
+namespace {
+
+bool isWorkspaceExtension(std::string_view ext) {
+    return ext == "inv" || ext == WorkspaceManager::binaryExtension;
+}
+
+// Adds the extension of the selected file filter if the path does not name a workspace file
+void appendWorkspaceExtension(QString& path, const FileExtension& selected) {
+    if (!isWorkspaceExtension(toLower(filesystem::getFileExtension(utilqt::fromQString(path))))) {
+        path.append(selected.extension_ == WorkspaceManager::binaryExtension ? ".invb" : ".inv");
+    }
+}
+
+}  // namespace
+
 InviwoMainWindow::InviwoMainWindow(InviwoApplicationQt* app)
     : QMainWindow()
     , app_(app)
@@ -1044,6 +1059,8 @@ std::optional<QString> InviwoMainWindow::askForWorkspaceToOpen() {
         openFileDialog.addSidebarPath(PathType::Workspaces);
         openFileDialog.addSidebarPath(workspaceFileDir_);
         openFileDialog.addExtension("inv", "Inviwo File");
+        openFileDialog.addExtension(std::string{WorkspaceManager::binaryExtension},
+                                    "Inviwo Binary File");
         openFileDialog.setFileMode(FileMode::AnyFile);
 
         if (openFileDialog.exec()) {
@@ -1109,7 +1126,7 @@ bool InviwoMainWindow::openWorkspace(QString workspaceFileName, bool isExample)
 
 void InviwoMainWindow::appendWorkspace(const std::string& file) {
     NetworkLock lock(app_->getProcessorNetwork());
-    std::ifstream fs(file);
+    auto fs = util::openDocument(file);
     if (!fs) {
         LogError("Could not open workspace file: " << file);
         return;
@@ -1160,10 +1177,12 @@ void InviwoMainWindow::saveWorkspaceAs() {
     saveFileDialog.addSidebarPath(workspaceFileDir_);
 
     saveFileDialog.addExtension("inv", "Inviwo File");
+    saveFileDialog.addExtension(std::string{WorkspaceManager::binaryExtension},
+                                "Inviwo Binary File");
 
     if (saveFileDialog.exec()) {
         QString path = saveFileDialog.selectedFiles().at(0);
-        if (!path.endsWith(".inv")) path.append(".inv");
+        appendWorkspaceExtension(path, saveFileDialog.getSelectedFileExtension());
 
         saveWorkspace(path);
         setCurrentWorkspace(path);
@@ -1182,11 +1201,13 @@ void InviwoMainWindow::saveWorkspaceAsCopy() {
     saveFileDialog.addSidebarPath(workspaceFileDir_);
 
     saveFileDialog.addExtension("inv", "Inviwo File");
+    saveFileDialog.addExtension(std::string{WorkspaceManager::binaryExtension},
+                                "Inviwo Binary File");
 
     if (saveFileDialog.exec()) {
         QString path = saveFileDialog.selectedFiles().at(0);
 
-        if (!path.endsWith(".inv")) path.append(".inv");
+        appendWorkspaceExtension(path, saveFileDialog.getSelectedFileExtension());
 
         saveWorkspace(path);
         addToRecentWorkspaces(path);
@@ -1425,7 +1446,7 @@ void InviwoMainWindow::dragMoveEvent(QDragMoveEvent* event) {
         auto filename = utilqt::fromQString(urlList.front().toLocalFile());
         auto ext = toLower(filesystem::getFileExtension(filename));
 
-        if (ext == "inv" ||
+        if (isWorkspaceExtension(ext) ||
             !app_->getDataVisualizerManager()->getDataVisualizersForFile(filename).empty()) {
 
             if (event->keyboardModifiers() & Qt::ControlModifier) {
@@ -1456,7 +1477,8 @@ void InviwoMainWindow::dropEvent(QDropEvent* event) {
             for (auto& file : urlList) {
                 auto filename = file.toLocalFile();
 
-                if (toLower(filesystem::getFileExtension(utilqt::fromQString(filename))) == "inv") {
+                if (isWorkspaceExtension(
+                        toLower(filesystem::getFileExtension(utilqt::fromQString(filename))))) {
                     if (!first || keyModifiers & Qt::ControlModifier) {
                         appendWorkspace(utilqt::fromQString(filename));
                     } else {
@@ -39,6 +39,7 @@
 #include <warn/ignore/all>
 #include <QAction>
 #include <QEvent>
+#include <QFile>
 #include <QApplication>
 #include <QGuiApplication>
 #include <warn/pop>
@@ -57,11 +58,21 @@ public:
     AutoSaver()
         : path_{filesystem::getPath(PathType::Settings)}
         , restored_{[this]() -> std::optional<std::string> {
-            if (filesystem::fileExists(path_ + "/autosave.inv")) {
-                auto ifstream = filesystem::ifstream(path_ + "/autosave.inv");
+            const auto read = [](const std::string& file) {
+                auto ifstream = filesystem::ifstream(file, std::ios::in | std::ios::binary);
                 std::stringstream buffer;
                 buffer << ifstream.rdbuf();
                 return std::move(buffer).str();
+            };
+
+            if (filesystem::fileExists(path_ + "/autosave.invb")) {
+                return read(path_ + "/autosave.invb");
+            }
+            // Autosaves of older versions are xml, restore them once
+            if (filesystem::fileExists(path_ + "/autosave.inv")) {
+                auto str = read(path_ + "/autosave.inv");
+                QFile::remove(QString::fromStdString(path_ + "/autosave.inv"));
+                return str;
             }
 
             return std::nullopt;
@@ -86,9 +97,10 @@ public:
                 }
 
                 if (str) {
-                    auto ofstream = filesystem::ofstream(path_ + "/autosave.inv.tmp");
+                    auto ofstream = filesystem::ofstream(path_ + "/autosave.invb.tmp",
+                                                         std::ios::out | std::ios::binary);
                     ofstream << *str;
-                    filesystem::copyFile(path_ + "/autosave.inv.tmp", path_ + "/autosave.inv");
+                    filesystem::copyFile(path_ + "/autosave.invb.tmp", path_ + "/autosave.invb");
                 }
             }
         }} {}
@@ -165,7 +177,7 @@ void UndoManager::pushState() {
     try {
         manager_->save(
             stream, refPath_, [](ExceptionContext context) -> void { throw; },
-            WorkspaceSaveMode::Undo);
+            WorkspaceSaveMode::Undo, DocumentFormat::Binary);
     } catch (...) {
         return;
     }